@@ -1,5 +1,6 @@
 #pragma once
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 // Enable debugging if NDEBUG is not defined and WFE_MUTEX_DEBUG also isn't already defined.
@@ -14,6 +15,39 @@
 #include <unistd.h>
 #endif
 
+///< 128-bit value for tagged pointers and double-word state.
+/// Must be 16-byte aligned so both halves share a monitor granule.
+typedef struct {
+	uint64_t low;
+	uint64_t high;
+} __attribute__((aligned(16))) wfe_mutex_u128;
+
+///< How `wfe_mutex_wait_any` compares a word against `value`.
+typedef enum {
+	WFE_MUTEX_WAIT_DESC_EQUAL,           ///< Fires when the word equals `value`.
+	WFE_MUTEX_WAIT_DESC_NOT_EQUAL,       ///< Fires when the word differs from `value`.
+	WFE_MUTEX_WAIT_DESC_ANY_BIT_SET,     ///< Fires when any bit of `value` is set in the word.
+	WFE_MUTEX_WAIT_DESC_ANY_BIT_NOT_SET, ///< Fires when any bit of `value` is clear in the word.
+} wfe_mutex_wait_desc_condition;
+
+///< One word for `wfe_mutex_wait_any` to wait on.
+typedef struct {
+	void *ptr;
+	uint64_t value;
+	///< Size of the word in bytes, 1, 2, 4 or 8.
+	uint32_t size;
+	wfe_mutex_wait_desc_condition condition;
+} wfe_mutex_wait_desc;
+
+///< Number of single-byte flags in a doorbell block.
+#define WFE_MUTEX_DOORBELL_FLAGS 64
+
+///< Doorbell block, one flag per producer packed into a single monitor granule.
+/// Aligned so one monitor arm observes every flag.
+typedef struct {
+	uint8_t flags[WFE_MUTEX_DOORBELL_FLAGS];
+} __attribute__((aligned(WFE_MUTEX_DOORBELL_FLAGS))) wfe_mutex_doorbell;
+
 typedef void (*wait_for_value_i8_ptr)(uint8_t *ptr,  uint8_t value, bool low_power);
 typedef void (*wait_for_value_i16_ptr)(uint16_t *ptr, uint16_t value, bool low_power);
 typedef void (*wait_for_value_i32_ptr)(uint32_t *ptr, uint32_t value, bool low_power);
@@ -34,6 +68,98 @@ typedef bool (*wait_for_value_spurious_oneshot_i16_ptr)(uint16_t *ptr, uint16_t
 typedef bool (*wait_for_value_spurious_oneshot_i32_ptr)(uint32_t *ptr, uint32_t value, bool low_power);
 typedef bool (*wait_for_value_spurious_oneshot_i64_ptr)(uint64_t *ptr, uint64_t value, bool low_power);
 
+typedef uint8_t (*wait_for_change_i8_ptr)(uint8_t *ptr, uint8_t old_value, bool low_power);
+typedef uint16_t (*wait_for_change_i16_ptr)(uint16_t *ptr, uint16_t old_value, bool low_power);
+typedef uint32_t (*wait_for_change_i32_ptr)(uint32_t *ptr, uint32_t old_value, bool low_power);
+typedef uint64_t (*wait_for_change_i64_ptr)(uint64_t *ptr, uint64_t old_value, bool low_power);
+
+typedef uint8_t (*wait_for_masked_value_i8_ptr)(uint8_t *ptr,  uint8_t mask, uint8_t value, bool low_power);
+typedef uint16_t (*wait_for_masked_value_i16_ptr)(uint16_t *ptr, uint16_t mask, uint16_t value, bool low_power);
+typedef uint32_t (*wait_for_masked_value_i32_ptr)(uint32_t *ptr, uint32_t mask, uint32_t value, bool low_power);
+typedef uint64_t (*wait_for_masked_value_i64_ptr)(uint64_t *ptr, uint64_t mask, uint64_t value, bool low_power);
+
+typedef uint8_t (*wait_for_any_bit_set_i8_ptr)(uint8_t *ptr,  uint8_t mask, bool low_power);
+typedef uint16_t (*wait_for_any_bit_set_i16_ptr)(uint16_t *ptr, uint16_t mask, bool low_power);
+typedef uint32_t (*wait_for_any_bit_set_i32_ptr)(uint32_t *ptr, uint32_t mask, bool low_power);
+typedef uint64_t (*wait_for_any_bit_set_i64_ptr)(uint64_t *ptr, uint64_t mask, bool low_power);
+
+typedef uint8_t (*wait_for_sequence_ge_i8_ptr)(uint8_t *ptr,  uint8_t target, bool low_power);
+typedef uint16_t (*wait_for_sequence_ge_i16_ptr)(uint16_t *ptr, uint16_t target, bool low_power);
+typedef uint32_t (*wait_for_sequence_ge_i32_ptr)(uint32_t *ptr, uint32_t target, bool low_power);
+typedef uint64_t (*wait_for_sequence_ge_i64_ptr)(uint64_t *ptr, uint64_t target, bool low_power);
+
+typedef bool (*wait_for_masked_value_timeout_i8_ptr)(uint8_t *ptr,  uint8_t mask, uint8_t value, uint64_t nanoseconds, bool low_power, uint8_t *result);
+typedef bool (*wait_for_masked_value_timeout_i16_ptr)(uint16_t *ptr, uint16_t mask, uint16_t value, uint64_t nanoseconds, bool low_power, uint16_t *result);
+typedef bool (*wait_for_masked_value_timeout_i32_ptr)(uint32_t *ptr, uint32_t mask, uint32_t value, uint64_t nanoseconds, bool low_power, uint32_t *result);
+typedef bool (*wait_for_masked_value_timeout_i64_ptr)(uint64_t *ptr, uint64_t mask, uint64_t value, uint64_t nanoseconds, bool low_power, uint64_t *result);
+
+typedef bool (*wait_for_any_bit_set_timeout_i8_ptr)(uint8_t *ptr,  uint8_t mask, uint64_t nanoseconds, bool low_power, uint8_t *result);
+typedef bool (*wait_for_any_bit_set_timeout_i16_ptr)(uint16_t *ptr, uint16_t mask, uint64_t nanoseconds, bool low_power, uint16_t *result);
+typedef bool (*wait_for_any_bit_set_timeout_i32_ptr)(uint32_t *ptr, uint32_t mask, uint64_t nanoseconds, bool low_power, uint32_t *result);
+typedef bool (*wait_for_any_bit_set_timeout_i64_ptr)(uint64_t *ptr, uint64_t mask, uint64_t nanoseconds, bool low_power, uint64_t *result);
+
+typedef bool (*wait_for_sequence_ge_timeout_i8_ptr)(uint8_t *ptr,  uint8_t target, uint64_t nanoseconds, bool low_power, uint8_t *result);
+typedef bool (*wait_for_sequence_ge_timeout_i16_ptr)(uint16_t *ptr, uint16_t target, uint64_t nanoseconds, bool low_power, uint16_t *result);
+typedef bool (*wait_for_sequence_ge_timeout_i32_ptr)(uint32_t *ptr, uint32_t target, uint64_t nanoseconds, bool low_power, uint32_t *result);
+typedef bool (*wait_for_sequence_ge_timeout_i64_ptr)(uint64_t *ptr, uint64_t target, uint64_t nanoseconds, bool low_power, uint64_t *result);
+
+typedef void (*wait_for_value_i128_ptr)(wfe_mutex_u128 *ptr, wfe_mutex_u128 value, bool low_power);
+typedef wfe_mutex_u128 (*wait_for_masked_value_i128_ptr)(wfe_mutex_u128 *ptr, wfe_mutex_u128 mask, wfe_mutex_u128 value, bool low_power);
+
+typedef bool (*wait_for_bit_set_timeout_i8_ptr)(uint8_t *ptr,  uint8_t bit, uint64_t nanoseconds, bool low_power, uint8_t *result);
+typedef bool (*wait_for_bit_set_timeout_i16_ptr)(uint16_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint16_t *result);
+typedef bool (*wait_for_bit_set_timeout_i32_ptr)(uint32_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint32_t *result);
+typedef bool (*wait_for_bit_set_timeout_i64_ptr)(uint64_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint64_t *result);
+
+typedef bool (*wait_for_bit_not_set_timeout_i8_ptr)(uint8_t *ptr,  uint8_t bit, uint64_t nanoseconds, bool low_power, uint8_t *result);
+typedef bool (*wait_for_bit_not_set_timeout_i16_ptr)(uint16_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint16_t *result);
+typedef bool (*wait_for_bit_not_set_timeout_i32_ptr)(uint32_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint32_t *result);
+typedef bool (*wait_for_bit_not_set_timeout_i64_ptr)(uint64_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint64_t *result);
+
+typedef bool (*wait_for_value_until_i8_ptr)(uint8_t *ptr,  uint8_t value, uint64_t cycles_deadline, bool low_power);
+typedef bool (*wait_for_value_until_i16_ptr)(uint16_t *ptr, uint16_t value, uint64_t cycles_deadline, bool low_power);
+typedef bool (*wait_for_value_until_i32_ptr)(uint32_t *ptr, uint32_t value, uint64_t cycles_deadline, bool low_power);
+typedef bool (*wait_for_value_until_i64_ptr)(uint64_t *ptr, uint64_t value, uint64_t cycles_deadline, bool low_power);
+
+typedef bool (*wait_for_masked_value_until_i8_ptr)(uint8_t *ptr,  uint8_t mask, uint8_t value, uint64_t cycles_deadline, bool low_power, uint8_t *result);
+typedef bool (*wait_for_masked_value_until_i16_ptr)(uint16_t *ptr, uint16_t mask, uint16_t value, uint64_t cycles_deadline, bool low_power, uint16_t *result);
+typedef bool (*wait_for_masked_value_until_i32_ptr)(uint32_t *ptr, uint32_t mask, uint32_t value, uint64_t cycles_deadline, bool low_power, uint32_t *result);
+typedef bool (*wait_for_masked_value_until_i64_ptr)(uint64_t *ptr, uint64_t mask, uint64_t value, uint64_t cycles_deadline, bool low_power, uint64_t *result);
+
+typedef bool (*wait_for_any_bit_set_until_i8_ptr)(uint8_t *ptr,  uint8_t mask, uint64_t cycles_deadline, bool low_power, uint8_t *result);
+typedef bool (*wait_for_any_bit_set_until_i16_ptr)(uint16_t *ptr, uint16_t mask, uint64_t cycles_deadline, bool low_power, uint16_t *result);
+typedef bool (*wait_for_any_bit_set_until_i32_ptr)(uint32_t *ptr, uint32_t mask, uint64_t cycles_deadline, bool low_power, uint32_t *result);
+typedef bool (*wait_for_any_bit_set_until_i64_ptr)(uint64_t *ptr, uint64_t mask, uint64_t cycles_deadline, bool low_power, uint64_t *result);
+
+typedef bool (*wait_for_sequence_ge_until_i8_ptr)(uint8_t *ptr,  uint8_t target, uint64_t cycles_deadline, bool low_power, uint8_t *result);
+typedef bool (*wait_for_sequence_ge_until_i16_ptr)(uint16_t *ptr, uint16_t target, uint64_t cycles_deadline, bool low_power, uint16_t *result);
+typedef bool (*wait_for_sequence_ge_until_i32_ptr)(uint32_t *ptr, uint32_t target, uint64_t cycles_deadline, bool low_power, uint32_t *result);
+typedef bool (*wait_for_sequence_ge_until_i64_ptr)(uint64_t *ptr, uint64_t target, uint64_t cycles_deadline, bool low_power, uint64_t *result);
+
+typedef bool (*wait_for_bit_set_until_i8_ptr)(uint8_t *ptr,  uint8_t bit, uint64_t cycles_deadline, bool low_power, uint8_t *result);
+typedef bool (*wait_for_bit_set_until_i16_ptr)(uint16_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint16_t *result);
+typedef bool (*wait_for_bit_set_until_i32_ptr)(uint32_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint32_t *result);
+typedef bool (*wait_for_bit_set_until_i64_ptr)(uint64_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint64_t *result);
+
+typedef bool (*wait_for_bit_not_set_until_i8_ptr)(uint8_t *ptr,  uint8_t bit, uint64_t cycles_deadline, bool low_power, uint8_t *result);
+typedef bool (*wait_for_bit_not_set_until_i16_ptr)(uint16_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint16_t *result);
+typedef bool (*wait_for_bit_not_set_until_i32_ptr)(uint32_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint32_t *result);
+typedef bool (*wait_for_bit_not_set_until_i64_ptr)(uint64_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint64_t *result);
+
+typedef bool (*wait_for_bit_set_spurious_oneshot_i8_ptr)(uint8_t *ptr,  uint8_t bit, bool low_power, uint8_t *result);
+typedef bool (*wait_for_bit_set_spurious_oneshot_i16_ptr)(uint16_t *ptr, uint8_t bit, bool low_power, uint16_t *result);
+typedef bool (*wait_for_bit_set_spurious_oneshot_i32_ptr)(uint32_t *ptr, uint8_t bit, bool low_power, uint32_t *result);
+typedef bool (*wait_for_bit_set_spurious_oneshot_i64_ptr)(uint64_t *ptr, uint8_t bit, bool low_power, uint64_t *result);
+
+typedef bool (*wait_for_bit_not_set_spurious_oneshot_i8_ptr)(uint8_t *ptr,  uint8_t bit, bool low_power, uint8_t *result);
+typedef bool (*wait_for_bit_not_set_spurious_oneshot_i16_ptr)(uint16_t *ptr, uint8_t bit, bool low_power, uint16_t *result);
+typedef bool (*wait_for_bit_not_set_spurious_oneshot_i32_ptr)(uint32_t *ptr, uint8_t bit, bool low_power, uint32_t *result);
+typedef bool (*wait_for_bit_not_set_spurious_oneshot_i64_ptr)(uint64_t *ptr, uint8_t bit, bool low_power, uint64_t *result);
+
+typedef size_t (*wait_any_oneshot_ptr)(const wfe_mutex_wait_desc *descs, size_t n, size_t monitor_index, uint64_t nanoseconds, bool low_power);
+typedef uint64_t (*doorbell_wait_ptr)(wfe_mutex_doorbell *doorbell, bool low_power);
+typedef void (*sleep_until_ptr)(uint64_t cycles_deadline, bool low_power);
+
 typedef enum {
 	WAIT_TYPE_SPIN,
 	WAIT_TYPE_WFE,
@@ -42,13 +168,45 @@ typedef enum {
 	WAIT_TYPE_MONITORX,
 } wfe_mutex_wait_types;
 
+///< How long a caller expects a wait to take.
+typedef enum {
+	WFE_MUTEX_HINT_SHORT,  ///< Nanoseconds, like a lock handoff.
+	WFE_MUTEX_HINT_MEDIUM, ///< Microseconds.
+	WFE_MUTEX_HINT_LONG,   ///< Milliseconds or longer, like waiting on an empty queue.
+	WFE_MUTEX_HINT_COUNT,
+} wfe_mutex_wait_hint;
+
+///< How a hinted wait is performed.
+typedef enum {
+	WAIT_STRATEGY_SPIN,              ///< Pure spin-loop, never enters a wait state.
+	WAIT_STRATEGY_MONITOR,           ///< Backend wait with `low_power` false. C0.1 or the shallowest state.
+	WAIT_STRATEGY_MONITOR_LOW_POWER, ///< Backend wait with `low_power` true. C0.2 or deeper.
+	WAIT_STRATEGY_FUTEX,             ///< Low power backend wait that escalates to a futex.
+} wfe_mutex_wait_strategy;
+
+///< Longest a futex waiter sleeps before rechecking the word, for stores that weren't followed by a wake.
+#define WFE_MUTEX_FUTEX_POLL_NANOSECONDS 1000000
+
+// Backends, as reported in `wfe_mutex_features::available_backends` and selected by `WFE_MUTEX_STATIC_BACKEND`.
+#define WFE_MUTEX_BACKEND_SPIN     1
+#define WFE_MUTEX_BACKEND_WFE      2
+#define WFE_MUTEX_BACKEND_WFET     3
+#define WFE_MUTEX_BACKEND_MONITORX 4
+#define WFE_MUTEX_BACKEND_WAITPKG  5
+#define WFE_MUTEX_BACKEND_COUNT    6 ///< One past the last backend.
+#define WFE_MUTEX_BACKEND_BIT(backend) (1U << (backend))
+
 typedef struct {
 	// Frequency of cycle counter.
 	uint64_t cycle_hz;
 
-	// Cycle count handler
-	uint64_t cycles_per_nanosecond_multiplier;
-	uint64_t cycles_per_nanosecond_divisor;
+	///< Converts nanoseconds to cycles as `(nanoseconds * mult) >> shift` with a 128-bit intermediate.
+	uint64_t nanoseconds_to_cycles_mult;
+	uint32_t nanoseconds_to_cycles_shift;
+
+	///< Converts cycles to nanoseconds as `(cycles * mult) >> shift` with a 128-bit intermediate.
+	uint64_t cycles_to_nanoseconds_mult;
+	uint32_t cycles_to_nanoseconds_shift;
 
 	///< The size in which the monitor granule size is.
 	/// For optimal monitor usage, mutexes should not be in overlapping granules.
@@ -62,6 +220,23 @@ typedef struct {
 	///< What is used for waiting when a timeout is provided.
 	wfe_mutex_wait_types wait_type_timeout;
 
+	///< Median cycles from a store on one thread until a waiter on another thread returns, without and with `low_power`.
+	/// Used as the cost of leaving the backend's wait state. 0 for the spin-loop backend, which has none.
+	uint64_t wake_latency_cycles;
+	uint64_t wake_latency_low_power_cycles;
+
+	///< Measured median overshoot of a timed wait on the table's backend, without and with `low_power`.
+	/// Timed waits stop using the wait instruction this many cycles before their deadline and spin the rest.
+	uint64_t timeout_granularity_cycles;
+	uint64_t timeout_granularity_low_power_cycles;
+
+	///< Measured cycles between wake-ups from the Linux arch timer event stream, usually 10Khz.
+	/// Bounds how long a WFE without WFET waits. 0 if there is no event stream, timed WFE waits then spin, or not on ARM.
+	uint64_t event_stream_period_cycles;
+
+	///< Strategy used for each `wfe_mutex_wait_hint`, picked from the measured wake latency.
+	wfe_mutex_wait_strategy hint_strategy[WFE_MUTEX_HINT_COUNT];
+
 	// Mutex functions
 	wait_for_value_i8_ptr  wait_for_value_i8;
 	wait_for_value_i16_ptr wait_for_value_i16;
@@ -90,11 +265,178 @@ typedef struct {
 	wait_for_value_spurious_oneshot_i32_ptr wait_for_value_spurious_oneshot_i32;
 	wait_for_value_spurious_oneshot_i64_ptr wait_for_value_spurious_oneshot_i64;
 
+	// Wait for the value to differ from the old value. Returns the new value.
+	wait_for_change_i8_ptr  wait_for_change_i8;
+	wait_for_change_i16_ptr wait_for_change_i16;
+	wait_for_change_i32_ptr wait_for_change_i32;
+	wait_for_change_i64_ptr wait_for_change_i64;
+
+	// Predicate waits. Return the value that satisfied the predicate.
+	// Timeout variants return false on timeout and optionally write the last observed value to `result`.
+	wait_for_masked_value_i8_ptr  wait_for_masked_value_i8;
+	wait_for_masked_value_i16_ptr wait_for_masked_value_i16;
+	wait_for_masked_value_i32_ptr wait_for_masked_value_i32;
+	wait_for_masked_value_i64_ptr wait_for_masked_value_i64;
+
+	wait_for_any_bit_set_i8_ptr  wait_for_any_bit_set_i8;
+	wait_for_any_bit_set_i16_ptr wait_for_any_bit_set_i16;
+	wait_for_any_bit_set_i32_ptr wait_for_any_bit_set_i32;
+	wait_for_any_bit_set_i64_ptr wait_for_any_bit_set_i64;
+
+	wait_for_sequence_ge_i8_ptr  wait_for_sequence_ge_i8;
+	wait_for_sequence_ge_i16_ptr wait_for_sequence_ge_i16;
+	wait_for_sequence_ge_i32_ptr wait_for_sequence_ge_i32;
+	wait_for_sequence_ge_i64_ptr wait_for_sequence_ge_i64;
+
+	wait_for_masked_value_timeout_i8_ptr  wait_for_masked_value_timeout_i8;
+	wait_for_masked_value_timeout_i16_ptr wait_for_masked_value_timeout_i16;
+	wait_for_masked_value_timeout_i32_ptr wait_for_masked_value_timeout_i32;
+	wait_for_masked_value_timeout_i64_ptr wait_for_masked_value_timeout_i64;
+
+	wait_for_any_bit_set_timeout_i8_ptr  wait_for_any_bit_set_timeout_i8;
+	wait_for_any_bit_set_timeout_i16_ptr wait_for_any_bit_set_timeout_i16;
+	wait_for_any_bit_set_timeout_i32_ptr wait_for_any_bit_set_timeout_i32;
+	wait_for_any_bit_set_timeout_i64_ptr wait_for_any_bit_set_timeout_i64;
+
+	wait_for_sequence_ge_timeout_i8_ptr  wait_for_sequence_ge_timeout_i8;
+	wait_for_sequence_ge_timeout_i16_ptr wait_for_sequence_ge_timeout_i16;
+	wait_for_sequence_ge_timeout_i32_ptr wait_for_sequence_ge_timeout_i32;
+	wait_for_sequence_ge_timeout_i64_ptr wait_for_sequence_ge_timeout_i64;
+
+	// 128-bit waits. Only atomic when `supports_wait_for_i128` is set.
+	wait_for_value_i128_ptr wait_for_value_i128;
+	wait_for_masked_value_i128_ptr wait_for_masked_value_i128;
+
+	// Bit waits with a timeout or a single spurious wait. Return false on timeout or spurious wakeup.
+	// The last observed value is written to `result` if it isn't NULL.
+	wait_for_bit_set_timeout_i8_ptr  wait_for_bit_set_timeout_i8;
+	wait_for_bit_set_timeout_i16_ptr wait_for_bit_set_timeout_i16;
+	wait_for_bit_set_timeout_i32_ptr wait_for_bit_set_timeout_i32;
+	wait_for_bit_set_timeout_i64_ptr wait_for_bit_set_timeout_i64;
+
+	wait_for_bit_not_set_timeout_i8_ptr  wait_for_bit_not_set_timeout_i8;
+	wait_for_bit_not_set_timeout_i16_ptr wait_for_bit_not_set_timeout_i16;
+	wait_for_bit_not_set_timeout_i32_ptr wait_for_bit_not_set_timeout_i32;
+	wait_for_bit_not_set_timeout_i64_ptr wait_for_bit_not_set_timeout_i64;
+
+	// Timed waits against an absolute deadline in cycle counter ticks.
+	// The `_timeout_` variants compute the deadline once and call these.
+	wait_for_value_until_i8_ptr  wait_for_value_until_i8;
+	wait_for_value_until_i16_ptr wait_for_value_until_i16;
+	wait_for_value_until_i32_ptr wait_for_value_until_i32;
+	wait_for_value_until_i64_ptr wait_for_value_until_i64;
+
+	wait_for_masked_value_until_i8_ptr  wait_for_masked_value_until_i8;
+	wait_for_masked_value_until_i16_ptr wait_for_masked_value_until_i16;
+	wait_for_masked_value_until_i32_ptr wait_for_masked_value_until_i32;
+	wait_for_masked_value_until_i64_ptr wait_for_masked_value_until_i64;
+
+	wait_for_any_bit_set_until_i8_ptr  wait_for_any_bit_set_until_i8;
+	wait_for_any_bit_set_until_i16_ptr wait_for_any_bit_set_until_i16;
+	wait_for_any_bit_set_until_i32_ptr wait_for_any_bit_set_until_i32;
+	wait_for_any_bit_set_until_i64_ptr wait_for_any_bit_set_until_i64;
+
+	wait_for_sequence_ge_until_i8_ptr  wait_for_sequence_ge_until_i8;
+	wait_for_sequence_ge_until_i16_ptr wait_for_sequence_ge_until_i16;
+	wait_for_sequence_ge_until_i32_ptr wait_for_sequence_ge_until_i32;
+	wait_for_sequence_ge_until_i64_ptr wait_for_sequence_ge_until_i64;
+
+	wait_for_bit_set_until_i8_ptr  wait_for_bit_set_until_i8;
+	wait_for_bit_set_until_i16_ptr wait_for_bit_set_until_i16;
+	wait_for_bit_set_until_i32_ptr wait_for_bit_set_until_i32;
+	wait_for_bit_set_until_i64_ptr wait_for_bit_set_until_i64;
+
+	wait_for_bit_not_set_until_i8_ptr  wait_for_bit_not_set_until_i8;
+	wait_for_bit_not_set_until_i16_ptr wait_for_bit_not_set_until_i16;
+	wait_for_bit_not_set_until_i32_ptr wait_for_bit_not_set_until_i32;
+	wait_for_bit_not_set_until_i64_ptr wait_for_bit_not_set_until_i64;
+
+	wait_for_bit_set_spurious_oneshot_i8_ptr  wait_for_bit_set_spurious_oneshot_i8;
+	wait_for_bit_set_spurious_oneshot_i16_ptr wait_for_bit_set_spurious_oneshot_i16;
+	wait_for_bit_set_spurious_oneshot_i32_ptr wait_for_bit_set_spurious_oneshot_i32;
+	wait_for_bit_set_spurious_oneshot_i64_ptr wait_for_bit_set_spurious_oneshot_i64;
+
+	wait_for_bit_not_set_spurious_oneshot_i8_ptr  wait_for_bit_not_set_spurious_oneshot_i8;
+	wait_for_bit_not_set_spurious_oneshot_i16_ptr wait_for_bit_not_set_spurious_oneshot_i16;
+	wait_for_bit_not_set_spurious_oneshot_i32_ptr wait_for_bit_not_set_spurious_oneshot_i32;
+	wait_for_bit_not_set_spurious_oneshot_i64_ptr wait_for_bit_not_set_spurious_oneshot_i64;
+
+	// Arms the monitor on `descs[monitor_index]`, checks every word and waits once.
+	// The wait is bounded by `nanoseconds` unless it is zero.
+	// WFE without WFET is instead bounded by `event_stream_period_cycles`, and polls if there is no event stream.
+	// Returns the index of the first satisfied word, or `n` on spurious wakeup or timeout.
+	wait_any_oneshot_ptr wait_any_oneshot;
+
+	// Waits until any doorbell flag is set, clears the set flags and returns them as a bitmask.
+	doorbell_wait_ptr doorbell_wait;
+
+	// Sleeps until the cycle counter reaches the deadline using the backend's timer.
+	sleep_until_ptr sleep_until;
+
 	bool supports_wfe_mutex : 1;
 	bool supports_timed_wfe_mutex : 1;
 	bool supports_low_power_cstate_toggle : 1;
+
+	///< The OS allows umwait and tpause to enter C0.2, from `/sys/devices/system/cpu/umwait_control/enable_c02`.
+	/// When it doesn't, `low_power` waits on the waitpkg backend are C0.1 and `supports_low_power_cstate_toggle` is false.
+	bool umwait_c02_enabled : 1;
+
+	///< Process-wide barriers through `membarrier(MEMBARRIER_CMD_PRIVATE_EXPEDITED)` are available.
+	bool supports_membarrier : 1;
+
+	///< 128-bit waits observe both halves atomically through cmpxchg16b or LDAXP/STLXP.
+	/// Otherwise the spin fallback can return a value that was torn between two writes.
+	bool supports_wait_for_i128 : 1;
+
+	///< 16-byte aligned loads are single-copy atomic through FEAT_LSE2 or AVX.
+	/// 128-bit waits then confirm a match without writing to the watched line.
+	bool supports_atomic_load_u128 : 1;
+
+	///< Futex waits are available for `WAIT_STRATEGY_FUTEX`.
+	bool supports_futex : 1;
+
+	///< The cycle counter ticks at a constant rate regardless of frequency scaling and C-states.
+	/// Always true on ARM's generic timer, CPUID 0x80000007 EDX[8] on x86.
+	bool supports_invariant_cycle_counter : 1;
+
+	///< Running as a guest under a hypervisor, identified by `hypervisor_vendor`.
+	bool running_under_hypervisor : 1;
+
+	///< The hypervisor makes monitor waits exit to it, so init fell back to the spin-loop backend with futex waits for long hints.
+	/// Decided from `wake_latency_cycles`, a store on one thread taking over 5us to wake a waiter on another.
+	bool hypervisor_monitor_fallback : 1;
+
+	///< NUL-terminated hypervisor vendor, such as "KVMKVMKVM" from CPUID leaf 0x40000000 or the firmware's vendor. Empty if unknown.
+	char hypervisor_vendor[16];
+
+	///< OS limit in cycles on a single umwait or tpause, from `/sys/devices/system/cpu/umwait_control/max_time`.
+	/// 0 if waitpkg isn't available or the limit isn't reported.
+	uint32_t umwait_max_time_cycles;
+
+	///< Bitmask of `WFE_MUTEX_BACKEND_BIT` for every backend this CPU supports.
+	uint32_t available_backends;
+
+	///< Backend the functions in this table belong to, one of `WFE_MUTEX_BACKEND_*`.
+	uint32_t backend;
+
+	///< Measured at init for every available backend, indexed by `WFE_MUTEX_BACKEND_*`. Zero for the spin-loop backend.
+	/// Each backend's timed waits use their own entry, whichever backend is active.
+	uint64_t backend_timeout_granularity_cycles[WFE_MUTEX_BACKEND_COUNT];
+	uint64_t backend_timeout_granularity_low_power_cycles[WFE_MUTEX_BACKEND_COUNT];
+
+	///< Measured by `wfe_mutex_init_tuned`, indexed by `WFE_MUTEX_BACKEND_*`. Zero for backends that weren't measured.
+	/// Median cycles from a store on one thread until a waiter on another thread returns.
+	uint64_t tuned_wake_latency_cycles[WFE_MUTEX_BACKEND_COUNT];
+	/// Spurious oneshot wait returns per second while the waited word doesn't change.
+	uint64_t tuned_spurious_wakeups_per_second[WFE_MUTEX_BACKEND_COUNT];
+
+	///< Backend `wfe_mutex_init_tuned` picked, zero if it wasn't called.
+	uint32_t tuned_backend;
 } wfe_mutex_features;
 
+///< A backend's function table, from `wfe_mutex_get_backend`. Shares the layout of `wfe_mutex_features`.
+typedef wfe_mutex_features wfe_mutex_backend;
+
 #ifdef __cplusplus
 #define SYMBOL_EXPORT extern "C"
 #else
@@ -104,388 +446,1384 @@ typedef struct {
 SYMBOL_EXPORT
 void wfe_mutex_init();
 
+///< Initializes the library like `wfe_mutex_init`, then measures every available backend on two threads and
+/// switches to the one with the lowest wake latency. Takes a few milliseconds.
+/// The measurements are left in `wfe_mutex_features::tuned_*`.
+/// Builds with `WFE_MUTEX_STATIC_BACKEND` or `WFE_MUTEX_IFUNC` only measure, their dispatch is already fixed.
+SYMBOL_EXPORT
+void wfe_mutex_init_tuned();
+
 // Features
 SYMBOL_EXPORT
 const wfe_mutex_features *wfe_mutex_get_features();
 
+///< Switches the functions in `wfe_mutex_get_features()` to `backend`, one of `WFE_MUTEX_BACKEND_*`.
+/// Returns false if the CPU doesn't support it, or the build is `WFE_MUTEX_STATIC_BACKEND` or `WFE_MUTEX_IFUNC` and it isn't the active backend.
+/// Threads already waiting finish their wait on the previous backend, backends all observe each other's stores.
+SYMBOL_EXPORT
+bool wfe_mutex_set_backend(uint32_t backend);
+
+///< Returns the function table for `backend`, or NULL if the CPU doesn't support it.
+/// Obtain once after `wfe_mutex_init` and pass to the `_backend` lock functions to pin a lock to one backend.
+/// The table stays valid and unchanged by `wfe_mutex_set_backend`.
+SYMBOL_EXPORT
+const wfe_mutex_backend *wfe_mutex_get_backend(uint32_t backend);
+
+///< Issues a memory barrier on every running thread of the process.
+/// Falls back to a local full barrier if membarrier isn't supported.
+SYMBOL_EXPORT
+void wfe_mutex_membarrier();
+
+///< Reads the cycle counter that timeouts are measured in.
+SYMBOL_EXPORT
+uint64_t wfe_mutex_read_cycle_counter();
+
+///< Converts an absolute CLOCK_MONOTONIC time in nanoseconds to a cycle counter deadline.
+/// Times in the past return the current cycle counter so waits time out immediately.
+SYMBOL_EXPORT
+uint64_t wfe_mutex_deadline_from_clock_monotonic(uint64_t monotonic_nanoseconds);
+
+///< Waits until any of the `n` words is satisfied and returns the index of the first one that is.
+/// Words sharing one monitor granule are waited on with a single monitor arm.
+/// Otherwise the armed word is rotated round-robin with escalating timeouts so every word is still observed.
+/// A store to an unarmed word is seen within the current timeout, at most 100us, or the event stream period for WFE without WFET.
+SYMBOL_EXPORT
+size_t wfe_mutex_wait_any(const wfe_mutex_wait_desc *descs, size_t n, bool low_power);
+
+///< Waits until `*ptr == value` using the strategy `hint` maps to in `wfe_mutex_features::hint_strategy`.
+/// Long waits can sleep in a futex, wake them with `wfe_mutex_wake_i32` after the store.
+/// Waiters that aren't woken still observe the store within `WFE_MUTEX_FUTEX_POLL_NANOSECONDS`.
+SYMBOL_EXPORT
+void wfe_mutex_wait_for_value_hinted_i32(uint32_t *ptr, uint32_t value, wfe_mutex_wait_hint hint);
+
+///< Same as `wfe_mutex_wait_for_value_hinted_i32` for other widths.
+/// Futexes only wait on 32-bit words, so the futex strategy waits in the backend with `low_power` instead.
+SYMBOL_EXPORT
+void wfe_mutex_wait_for_value_hinted_i8(uint8_t *ptr, uint8_t value, wfe_mutex_wait_hint hint);
+SYMBOL_EXPORT
+void wfe_mutex_wait_for_value_hinted_i16(uint16_t *ptr, uint16_t value, wfe_mutex_wait_hint hint);
+SYMBOL_EXPORT
+void wfe_mutex_wait_for_value_hinted_i64(uint64_t *ptr, uint64_t value, wfe_mutex_wait_hint hint);
+
+///< Wakes one or all waiters sleeping in a futex on `ptr`. Does nothing if futexes aren't supported.
+SYMBOL_EXPORT
+void wfe_mutex_wake_i32(uint32_t *ptr, bool all);
+
+///< Every function dispatched through `wfe_mutex_features`.
+/// `X_TIMED` entries are the ones a timer backend like WFET replaces.
+#define WFE_MUTEX_BACKEND_FUNCTIONS(X, X_TIMED) \
+	X(wait_for_value_i8) \
+	X(wait_for_value_i16) \
+	X(wait_for_value_i32) \
+	X(wait_for_value_i64) \
+	X(wait_for_bit_set_i8) \
+	X(wait_for_bit_set_i16) \
+	X(wait_for_bit_set_i32) \
+	X(wait_for_bit_set_i64) \
+	X(wait_for_bit_not_set_i8) \
+	X(wait_for_bit_not_set_i16) \
+	X(wait_for_bit_not_set_i32) \
+	X(wait_for_bit_not_set_i64) \
+	X_TIMED(wait_for_value_timeout_i8) \
+	X_TIMED(wait_for_value_timeout_i16) \
+	X_TIMED(wait_for_value_timeout_i32) \
+	X_TIMED(wait_for_value_timeout_i64) \
+	X(wait_for_value_spurious_oneshot_i8) \
+	X(wait_for_value_spurious_oneshot_i16) \
+	X(wait_for_value_spurious_oneshot_i32) \
+	X(wait_for_value_spurious_oneshot_i64) \
+	X(wait_for_change_i8) \
+	X(wait_for_change_i16) \
+	X(wait_for_change_i32) \
+	X(wait_for_change_i64) \
+	X(wait_for_masked_value_i8) \
+	X(wait_for_masked_value_i16) \
+	X(wait_for_masked_value_i32) \
+	X(wait_for_masked_value_i64) \
+	X(wait_for_any_bit_set_i8) \
+	X(wait_for_any_bit_set_i16) \
+	X(wait_for_any_bit_set_i32) \
+	X(wait_for_any_bit_set_i64) \
+	X(wait_for_sequence_ge_i8) \
+	X(wait_for_sequence_ge_i16) \
+	X(wait_for_sequence_ge_i32) \
+	X(wait_for_sequence_ge_i64) \
+	X_TIMED(wait_for_masked_value_timeout_i8) \
+	X_TIMED(wait_for_masked_value_timeout_i16) \
+	X_TIMED(wait_for_masked_value_timeout_i32) \
+	X_TIMED(wait_for_masked_value_timeout_i64) \
+	X_TIMED(wait_for_any_bit_set_timeout_i8) \
+	X_TIMED(wait_for_any_bit_set_timeout_i16) \
+	X_TIMED(wait_for_any_bit_set_timeout_i32) \
+	X_TIMED(wait_for_any_bit_set_timeout_i64) \
+	X_TIMED(wait_for_sequence_ge_timeout_i8) \
+	X_TIMED(wait_for_sequence_ge_timeout_i16) \
+	X_TIMED(wait_for_sequence_ge_timeout_i32) \
+	X_TIMED(wait_for_sequence_ge_timeout_i64) \
+	X(wait_for_value_i128) \
+	X(wait_for_masked_value_i128) \
+	X_TIMED(wait_for_bit_set_timeout_i8) \
+	X_TIMED(wait_for_bit_set_timeout_i16) \
+	X_TIMED(wait_for_bit_set_timeout_i32) \
+	X_TIMED(wait_for_bit_set_timeout_i64) \
+	X_TIMED(wait_for_bit_not_set_timeout_i8) \
+	X_TIMED(wait_for_bit_not_set_timeout_i16) \
+	X_TIMED(wait_for_bit_not_set_timeout_i32) \
+	X_TIMED(wait_for_bit_not_set_timeout_i64) \
+	X_TIMED(wait_for_value_until_i8) \
+	X_TIMED(wait_for_value_until_i16) \
+	X_TIMED(wait_for_value_until_i32) \
+	X_TIMED(wait_for_value_until_i64) \
+	X_TIMED(wait_for_masked_value_until_i8) \
+	X_TIMED(wait_for_masked_value_until_i16) \
+	X_TIMED(wait_for_masked_value_until_i32) \
+	X_TIMED(wait_for_masked_value_until_i64) \
+	X_TIMED(wait_for_any_bit_set_until_i8) \
+	X_TIMED(wait_for_any_bit_set_until_i16) \
+	X_TIMED(wait_for_any_bit_set_until_i32) \
+	X_TIMED(wait_for_any_bit_set_until_i64) \
+	X_TIMED(wait_for_sequence_ge_until_i8) \
+	X_TIMED(wait_for_sequence_ge_until_i16) \
+	X_TIMED(wait_for_sequence_ge_until_i32) \
+	X_TIMED(wait_for_sequence_ge_until_i64) \
+	X_TIMED(wait_for_bit_set_until_i8) \
+	X_TIMED(wait_for_bit_set_until_i16) \
+	X_TIMED(wait_for_bit_set_until_i32) \
+	X_TIMED(wait_for_bit_set_until_i64) \
+	X_TIMED(wait_for_bit_not_set_until_i8) \
+	X_TIMED(wait_for_bit_not_set_until_i16) \
+	X_TIMED(wait_for_bit_not_set_until_i32) \
+	X_TIMED(wait_for_bit_not_set_until_i64) \
+	X(wait_for_bit_set_spurious_oneshot_i8) \
+	X(wait_for_bit_set_spurious_oneshot_i16) \
+	X(wait_for_bit_set_spurious_oneshot_i32) \
+	X(wait_for_bit_set_spurious_oneshot_i64) \
+	X(wait_for_bit_not_set_spurious_oneshot_i8) \
+	X(wait_for_bit_not_set_spurious_oneshot_i16) \
+	X(wait_for_bit_not_set_spurious_oneshot_i32) \
+	X(wait_for_bit_not_set_spurious_oneshot_i64) \
+	X_TIMED(wait_any_oneshot) \
+	X(doorbell_wait) \
+	X_TIMED(sleep_until)
+
+// Declares the function `symbol` with the type of the `name` field of `wfe_mutex_features`.
+#define WFE_MUTEX_DECLARE_BACKEND_FUNCTION(symbol, name) SYMBOL_EXPORT __typeof__(*((wfe_mutex_features*)0)->name) symbol;
+
+#if defined(WFE_MUTEX_STATIC_BACKEND)
+///< Header wrappers call the backend the library was built for directly instead of through `wfe_mutex_features`.
+/// `wfe_mutex_init` aborts if the CPU doesn't support that backend.
+#if WFE_MUTEX_STATIC_BACKEND == WFE_MUTEX_BACKEND_SPIN
+#define WFE_MUTEX_STATIC_PREFIX spinloop
+#define WFE_MUTEX_STATIC_TIMED_PREFIX spinloop
+#elif WFE_MUTEX_STATIC_BACKEND == WFE_MUTEX_BACKEND_WFE
+#define WFE_MUTEX_STATIC_PREFIX wfe
+#define WFE_MUTEX_STATIC_TIMED_PREFIX wfe
+#elif WFE_MUTEX_STATIC_BACKEND == WFE_MUTEX_BACKEND_WFET
+// WFET only replaces the timed waits, untimed waits are still plain WFE.
+#define WFE_MUTEX_STATIC_PREFIX wfe
+#define WFE_MUTEX_STATIC_TIMED_PREFIX wfet
+#elif WFE_MUTEX_STATIC_BACKEND == WFE_MUTEX_BACKEND_MONITORX
+#define WFE_MUTEX_STATIC_PREFIX mwaitx
+#define WFE_MUTEX_STATIC_TIMED_PREFIX mwaitx
+#elif WFE_MUTEX_STATIC_BACKEND == WFE_MUTEX_BACKEND_WAITPKG
+#define WFE_MUTEX_STATIC_PREFIX waitpkg
+#define WFE_MUTEX_STATIC_TIMED_PREFIX waitpkg
+#else
+#error "Unknown WFE_MUTEX_STATIC_BACKEND"
+#endif
+
+#define WFE_MUTEX_STATIC_SYMBOL_INNER(prefix, name) prefix##_##name
+#define WFE_MUTEX_STATIC_SYMBOL(prefix, name) WFE_MUTEX_STATIC_SYMBOL_INNER(prefix, name)
+#define WFE_MUTEX_DISPATCH(name) WFE_MUTEX_STATIC_SYMBOL(WFE_MUTEX_STATIC_PREFIX, name)
+#define WFE_MUTEX_DISPATCH_TIMED(name) WFE_MUTEX_STATIC_SYMBOL(WFE_MUTEX_STATIC_TIMED_PREFIX, name)
+
+#define WFE_MUTEX_STATIC_DECLARE(name) WFE_MUTEX_DECLARE_BACKEND_FUNCTION(WFE_MUTEX_DISPATCH(name), name)
+#define WFE_MUTEX_STATIC_DECLARE_TIMED(name) WFE_MUTEX_DECLARE_BACKEND_FUNCTION(WFE_MUTEX_DISPATCH_TIMED(name), name)
+WFE_MUTEX_BACKEND_FUNCTIONS(WFE_MUTEX_STATIC_DECLARE, WFE_MUTEX_STATIC_DECLARE_TIMED)
+#elif defined(WFE_MUTEX_IFUNC)
+///< Header wrappers call exported entry points that GNU IFUNC resolves to the detected backend at load time.
+/// After relocation these are direct calls and are valid before `wfe_mutex_init`, even from static constructors.
+#define WFE_MUTEX_DISPATCH(name) wfe_mutex_ifunc_##name
+#define WFE_MUTEX_DISPATCH_TIMED(name) wfe_mutex_ifunc_##name
+
+#define WFE_MUTEX_IFUNC_DECLARE(name) WFE_MUTEX_DECLARE_BACKEND_FUNCTION(WFE_MUTEX_DISPATCH(name), name)
+WFE_MUTEX_BACKEND_FUNCTIONS(WFE_MUTEX_IFUNC_DECLARE, WFE_MUTEX_IFUNC_DECLARE)
+#else
+#define WFE_MUTEX_DISPATCH(name) (wfe_mutex_get_features()->name)
+#define WFE_MUTEX_DISPATCH_TIMED(name) (wfe_mutex_get_features()->name)
+#endif
+
+///< Returns `(value * mult) >> shift` through a 128-bit intermediate, saturating if the result doesn't fit in 64 bits.
+static inline uint64_t wfe_mutex_mul_shift_u64(uint64_t value, uint64_t mult, uint32_t shift) {
+#if defined(__SIZEOF_INT128__)
+	const unsigned __int128 result = ((unsigned __int128)value * mult) >> shift;
+	return (result >> 64) ? ~0ULL : (uint64_t)result;
+#else
+	// 32-bit targets don't have a 128-bit type, multiply in 32-bit halves.
+	const uint64_t value_lo = (uint32_t)value;
+	const uint64_t value_hi = value >> 32;
+	const uint64_t mult_lo = (uint32_t)mult;
+	const uint64_t mult_hi = mult >> 32;
+
+	const uint64_t lo_lo = value_lo * mult_lo;
+	const uint64_t hi_lo = value_hi * mult_lo;
+	const uint64_t lo_hi = value_lo * mult_hi;
+	const uint64_t hi_hi = value_hi * mult_hi;
+
+	// Can't overflow, the maximum is exactly 2^64 - 1.
+	const uint64_t cross = (lo_lo >> 32) + (uint32_t)hi_lo + lo_hi;
+	const uint64_t low = (cross << 32) | (uint32_t)lo_lo;
+	const uint64_t high = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+
+	if (shift == 0) return high ? ~0ULL : low;
+	if (high >> shift) return ~0ULL;
+	return (high << (64 - shift)) | (low >> shift);
+#endif
+}
+
+///< Calculates the `mult` and `shift` that convert a `from_hz` rate to `to_hz` through `wfe_mutex_mul_shift_u64`.
+/// Uses the largest shift that fits, giving at least 63 significant bits of the ratio.
+static inline void wfe_mutex_calculate_mult_shift(uint64_t from_hz, uint64_t to_hz, uint64_t *mult, uint32_t *shift) {
+	uint64_t quotient = to_hz / from_hz;
+	uint64_t remainder = to_hz % from_hz;
+
+	uint32_t bits = 63;
+	while (bits && (quotient >> (64 - bits))) {
+		--bits;
+	}
+
+	// Long division for the fractional bits of the ratio.
+	for (uint32_t i = 0; i < bits; ++i) {
+		remainder <<= 1;
+		quotient <<= 1;
+		if (remainder >= from_hz) {
+			remainder -= from_hz;
+			quotient |= 1;
+		}
+	}
+
+	// Round to nearest.
+	if (remainder * 2 >= from_hz && quotient != ~0ULL) {
+		++quotient;
+	}
+
+	*mult = quotient;
+	*shift = bits;
+}
+
+static inline uint64_t wfe_mutex_calculate_cycles_for_nanoseconds(uint64_t nanoseconds) {
+	const wfe_mutex_features *features = wfe_mutex_get_features();
+	return wfe_mutex_mul_shift_u64(nanoseconds, features->nanoseconds_to_cycles_mult, features->nanoseconds_to_cycles_shift);
+}
+
+///< Converts cycle counter cycles to nanoseconds, the inverse of `wfe_mutex_calculate_cycles_for_nanoseconds`.
+static inline uint64_t wfe_mutex_calculate_nanoseconds_for_cycles(uint64_t cycles) {
+	const wfe_mutex_features *features = wfe_mutex_get_features();
+	return wfe_mutex_mul_shift_u64(cycles, features->cycles_to_nanoseconds_mult, features->cycles_to_nanoseconds_shift);
+}
+
+///< Returns the cycle counter deadline `nanoseconds` from now, for the `_until` waits and locks.
+static inline uint64_t wfe_mutex_deadline_from_nanoseconds(uint64_t nanoseconds) {
+	return wfe_mutex_read_cycle_counter() + wfe_mutex_calculate_cycles_for_nanoseconds(nanoseconds);
+}
+
 static inline void wfe_mutex_wait_for_value_i8(uint8_t *ptr, uint8_t value, bool low_power) {
-	wfe_mutex_get_features()->wait_for_value_i8(ptr, value, low_power);
+	WFE_MUTEX_DISPATCH(wait_for_value_i8)(ptr, value, low_power);
 }
 
 static inline void wfe_mutex_wait_for_value_i16(uint16_t *ptr, uint16_t value, bool low_power) {
-	wfe_mutex_get_features()->wait_for_value_i16(ptr, value, low_power);
+	WFE_MUTEX_DISPATCH(wait_for_value_i16)(ptr, value, low_power);
 }
 
 static inline void wfe_mutex_wait_for_value_i32(uint32_t *ptr, uint32_t value, bool low_power) {
-	wfe_mutex_get_features()->wait_for_value_i32(ptr, value, low_power);
+	WFE_MUTEX_DISPATCH(wait_for_value_i32)(ptr, value, low_power);
 }
 
 static inline void wfe_mutex_wait_for_value_i64(uint64_t *ptr, uint64_t value, bool low_power) {
-	wfe_mutex_get_features()->wait_for_value_i64(ptr, value, low_power);
+	WFE_MUTEX_DISPATCH(wait_for_value_i64)(ptr, value, low_power);
 }
 
 static inline uint8_t wfe_mutex_wait_for_bit_set_i8(uint8_t *ptr, uint8_t bit, bool low_power) {
-	return wfe_mutex_get_features()->wait_for_bit_set_i8(ptr, bit, low_power);
+	return WFE_MUTEX_DISPATCH(wait_for_bit_set_i8)(ptr, bit, low_power);
 }
 
 static inline uint16_t wfe_mutex_wait_for_bit_set_i16(uint16_t *ptr, uint8_t bit, bool low_power) {
-	return wfe_mutex_get_features()->wait_for_bit_set_i16(ptr, bit, low_power);
+	return WFE_MUTEX_DISPATCH(wait_for_bit_set_i16)(ptr, bit, low_power);
 }
 
 static inline uint32_t wfe_mutex_wait_for_bit_set_i32(uint32_t *ptr, uint8_t bit, bool low_power) {
-	return wfe_mutex_get_features()->wait_for_bit_set_i32(ptr, bit, low_power);
+	return WFE_MUTEX_DISPATCH(wait_for_bit_set_i32)(ptr, bit, low_power);
 }
 
 static inline uint64_t wfe_mutex_wait_for_bit_set_i64(uint64_t *ptr, uint8_t bit, bool low_power) {
-	return wfe_mutex_get_features()->wait_for_bit_set_i64(ptr, bit, low_power);
+	return WFE_MUTEX_DISPATCH(wait_for_bit_set_i64)(ptr, bit, low_power);
 }
 
 static inline uint8_t wfe_mutex_wait_for_bit_not_set_i8(uint8_t *ptr, uint8_t bit, bool low_power) {
-	return wfe_mutex_get_features()->wait_for_bit_not_set_i8(ptr, bit, low_power);
+	return WFE_MUTEX_DISPATCH(wait_for_bit_not_set_i8)(ptr, bit, low_power);
 }
 
 static inline uint16_t wfe_mutex_wait_for_bit_not_set_i16(uint16_t *ptr, uint8_t bit, bool low_power) {
-	return wfe_mutex_get_features()->wait_for_bit_not_set_i16(ptr, bit, low_power);
+	return WFE_MUTEX_DISPATCH(wait_for_bit_not_set_i16)(ptr, bit, low_power);
 }
 
 static inline uint32_t wfe_mutex_wait_for_bit_not_set_i32(uint32_t *ptr, uint8_t bit, bool low_power) {
-	return wfe_mutex_get_features()->wait_for_bit_not_set_i32(ptr, bit, low_power);
+	return WFE_MUTEX_DISPATCH(wait_for_bit_not_set_i32)(ptr, bit, low_power);
 }
 
 static inline uint64_t wfe_mutex_wait_for_bit_not_set_i64(uint64_t *ptr, uint8_t bit, bool low_power) {
-	return wfe_mutex_get_features()->wait_for_bit_not_set_i64(ptr, bit, low_power);
+	return WFE_MUTEX_DISPATCH(wait_for_bit_not_set_i64)(ptr, bit, low_power);
 }
 
 static inline bool wfe_mutex_wait_for_value_timeout_i8(uint8_t *ptr, uint8_t value, uint64_t nanoseconds, bool low_power) {
-	return wfe_mutex_get_features()->wait_for_value_timeout_i8(ptr, value, nanoseconds, low_power);
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_value_timeout_i8)(ptr, value, nanoseconds, low_power);
 }
 
 static inline bool wfe_mutex_wait_for_value_timeout_i16(uint16_t *ptr, uint16_t value, uint64_t nanoseconds, bool low_power) {
-	return wfe_mutex_get_features()->wait_for_value_timeout_i16(ptr, value, nanoseconds, low_power);
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_value_timeout_i16)(ptr, value, nanoseconds, low_power);
 }
 
 static inline bool wfe_mutex_wait_for_value_timeout_i32(uint32_t *ptr, uint32_t value, uint64_t nanoseconds, bool low_power) {
-	return wfe_mutex_get_features()->wait_for_value_timeout_i32(ptr, value, nanoseconds, low_power);
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_value_timeout_i32)(ptr, value, nanoseconds, low_power);
 }
 
 static inline bool wfe_mutex_wait_for_value_timeout_i64(uint64_t *ptr, uint64_t value, uint64_t nanoseconds, bool low_power) {
-	return wfe_mutex_get_features()->wait_for_value_timeout_i64(ptr, value, nanoseconds, low_power);
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_value_timeout_i64)(ptr, value, nanoseconds, low_power);
 }
 
 static inline bool wfe_mutex_wait_for_value_spurious_oneshot_i8(uint8_t *ptr, uint8_t value, bool low_power) {
-	return wfe_mutex_get_features()->wait_for_value_spurious_oneshot_i8(ptr, value, low_power);
+	return WFE_MUTEX_DISPATCH(wait_for_value_spurious_oneshot_i8)(ptr, value, low_power);
 }
 
 static inline bool wfe_mutex_wait_for_value_spurious_oneshot_i16(uint16_t *ptr, uint16_t value, bool low_power) {
-	return wfe_mutex_get_features()->wait_for_value_spurious_oneshot_i16(ptr, value, low_power);
+	return WFE_MUTEX_DISPATCH(wait_for_value_spurious_oneshot_i16)(ptr, value, low_power);
 }
 
 static inline bool wfe_mutex_wait_for_value_spurious_oneshot_i32(uint32_t *ptr, uint32_t value, bool low_power) {
-	return wfe_mutex_get_features()->wait_for_value_spurious_oneshot_i32(ptr, value, low_power);
+	return WFE_MUTEX_DISPATCH(wait_for_value_spurious_oneshot_i32)(ptr, value, low_power);
 }
 
 static inline bool wfe_mutex_wait_for_value_spurious_oneshot_i64(uint64_t *ptr, uint64_t value, bool low_power) {
-	return wfe_mutex_get_features()->wait_for_value_spurious_oneshot_i64(ptr, value, low_power);
+	return WFE_MUTEX_DISPATCH(wait_for_value_spurious_oneshot_i64)(ptr, value, low_power);
 }
 
-// getters
-static inline wait_for_value_i8_ptr get_wfe_mutex_wait_for_value_i8_ptr() {
-	return wfe_mutex_get_features()->wait_for_value_i8;
+static inline uint8_t wfe_mutex_wait_for_change_i8(uint8_t *ptr, uint8_t old_value, bool low_power) {
+	return WFE_MUTEX_DISPATCH(wait_for_change_i8)(ptr, old_value, low_power);
 }
 
-static inline wait_for_value_i16_ptr get_wfe_mutex_wait_for_value_i16_ptr() {
-	return wfe_mutex_get_features()->wait_for_value_i16;
+static inline uint16_t wfe_mutex_wait_for_change_i16(uint16_t *ptr, uint16_t old_value, bool low_power) {
+	return WFE_MUTEX_DISPATCH(wait_for_change_i16)(ptr, old_value, low_power);
 }
 
-static inline wait_for_value_i32_ptr get_wfe_mutex_wait_for_value_i32_ptr() {
-	return wfe_mutex_get_features()->wait_for_value_i32;
+static inline uint32_t wfe_mutex_wait_for_change_i32(uint32_t *ptr, uint32_t old_value, bool low_power) {
+	return WFE_MUTEX_DISPATCH(wait_for_change_i32)(ptr, old_value, low_power);
 }
 
-static inline wait_for_value_i64_ptr get_wfe_mutex_wait_for_value_i64_ptr() {
-	return wfe_mutex_get_features()->wait_for_value_i64;
+static inline uint64_t wfe_mutex_wait_for_change_i64(uint64_t *ptr, uint64_t old_value, bool low_power) {
+	return WFE_MUTEX_DISPATCH(wait_for_change_i64)(ptr, old_value, low_power);
 }
 
-static inline wait_for_bit_set_i8_ptr get_wfe_mutex_wait_for_bit_set_i8_ptr() {
-	return wfe_mutex_get_features()->wait_for_bit_set_i8;
+static inline uint8_t wfe_mutex_wait_for_masked_value_i8(uint8_t *ptr, uint8_t mask, uint8_t value, bool low_power) {
+	return WFE_MUTEX_DISPATCH(wait_for_masked_value_i8)(ptr, mask, value, low_power);
 }
 
-static inline wait_for_bit_set_i16_ptr get_wfe_mutex_wait_for_bit_set_i16_ptr() {
-	return wfe_mutex_get_features()->wait_for_bit_set_i16;
+static inline uint16_t wfe_mutex_wait_for_masked_value_i16(uint16_t *ptr, uint16_t mask, uint16_t value, bool low_power) {
+	return WFE_MUTEX_DISPATCH(wait_for_masked_value_i16)(ptr, mask, value, low_power);
 }
 
-static inline wait_for_bit_set_i32_ptr get_wfe_mutex_wait_for_bit_set_i32_ptr() {
-	return wfe_mutex_get_features()->wait_for_bit_set_i32;
+static inline uint32_t wfe_mutex_wait_for_masked_value_i32(uint32_t *ptr, uint32_t mask, uint32_t value, bool low_power) {
+	return WFE_MUTEX_DISPATCH(wait_for_masked_value_i32)(ptr, mask, value, low_power);
 }
 
-static inline wait_for_bit_set_i64_ptr get_wfe_mutex_wait_for_bit_set_i64_ptr() {
-	return wfe_mutex_get_features()->wait_for_bit_set_i64;
+static inline uint64_t wfe_mutex_wait_for_masked_value_i64(uint64_t *ptr, uint64_t mask, uint64_t value, bool low_power) {
+	return WFE_MUTEX_DISPATCH(wait_for_masked_value_i64)(ptr, mask, value, low_power);
 }
 
-static inline wait_for_bit_set_i8_ptr get_wfe_mutex_wait_for_bit_not_set_i8_ptr() {
-	return wfe_mutex_get_features()->wait_for_bit_not_set_i8;
+static inline uint8_t wfe_mutex_wait_for_any_bit_set_i8(uint8_t *ptr, uint8_t mask, bool low_power) {
+	return WFE_MUTEX_DISPATCH(wait_for_any_bit_set_i8)(ptr, mask, low_power);
 }
 
-static inline wait_for_bit_set_i16_ptr get_wfe_mutex_wait_for_bit_not_set_i16_ptr() {
-	return wfe_mutex_get_features()->wait_for_bit_not_set_i16;
+static inline uint16_t wfe_mutex_wait_for_any_bit_set_i16(uint16_t *ptr, uint16_t mask, bool low_power) {
+	return WFE_MUTEX_DISPATCH(wait_for_any_bit_set_i16)(ptr, mask, low_power);
 }
 
-static inline wait_for_bit_set_i32_ptr get_wfe_mutex_wait_for_bit_not_set_i32_ptr() {
-	return wfe_mutex_get_features()->wait_for_bit_not_set_i32;
+static inline uint32_t wfe_mutex_wait_for_any_bit_set_i32(uint32_t *ptr, uint32_t mask, bool low_power) {
+	return WFE_MUTEX_DISPATCH(wait_for_any_bit_set_i32)(ptr, mask, low_power);
 }
 
-static inline wait_for_bit_set_i64_ptr get_wfe_mutex_wait_for_bit_not_set_i64_ptr() {
-	return wfe_mutex_get_features()->wait_for_bit_not_set_i64;
+static inline uint64_t wfe_mutex_wait_for_any_bit_set_i64(uint64_t *ptr, uint64_t mask, bool low_power) {
+	return WFE_MUTEX_DISPATCH(wait_for_any_bit_set_i64)(ptr, mask, low_power);
 }
 
-static inline wait_for_value_timeout_i8_ptr get_wfe_mutex_wait_for_value_timeout_i8_ptr() {
-	return wfe_mutex_get_features()->wait_for_value_timeout_i8;
+static inline uint8_t wfe_mutex_wait_for_sequence_ge_i8(uint8_t *ptr, uint8_t target, bool low_power) {
+	return WFE_MUTEX_DISPATCH(wait_for_sequence_ge_i8)(ptr, target, low_power);
 }
 
-static inline wait_for_value_timeout_i16_ptr get_wfe_mutex_wait_for_value_timeout_i16_ptr() {
-	return wfe_mutex_get_features()->wait_for_value_timeout_i16;
+static inline uint16_t wfe_mutex_wait_for_sequence_ge_i16(uint16_t *ptr, uint16_t target, bool low_power) {
+	return WFE_MUTEX_DISPATCH(wait_for_sequence_ge_i16)(ptr, target, low_power);
 }
 
-static inline wait_for_value_timeout_i32_ptr get_wfe_mutex_wait_for_value_timeout_i32_ptr() {
-	return wfe_mutex_get_features()->wait_for_value_timeout_i32;
+static inline uint32_t wfe_mutex_wait_for_sequence_ge_i32(uint32_t *ptr, uint32_t target, bool low_power) {
+	return WFE_MUTEX_DISPATCH(wait_for_sequence_ge_i32)(ptr, target, low_power);
 }
 
-static inline wait_for_value_timeout_i64_ptr get_wfe_mutex_wait_for_value_timeout_i64_ptr() {
-	return wfe_mutex_get_features()->wait_for_value_timeout_i64;
+static inline uint64_t wfe_mutex_wait_for_sequence_ge_i64(uint64_t *ptr, uint64_t target, bool low_power) {
+	return WFE_MUTEX_DISPATCH(wait_for_sequence_ge_i64)(ptr, target, low_power);
 }
 
-static inline wait_for_value_spurious_oneshot_i8_ptr get_wfe_mutex_wait_for_value_spurious_oneshot_i8_ptr() {
-	return wfe_mutex_get_features()->wait_for_value_spurious_oneshot_i8;
+static inline bool wfe_mutex_wait_for_masked_value_timeout_i8(uint8_t *ptr, uint8_t mask, uint8_t value, uint64_t nanoseconds, bool low_power, uint8_t *result) {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_masked_value_timeout_i8)(ptr, mask, value, nanoseconds, low_power, result);
 }
 
-static inline wait_for_value_spurious_oneshot_i16_ptr get_wfe_mutex_wait_for_value_spurious_oneshot_i16_ptr() {
-	return wfe_mutex_get_features()->wait_for_value_spurious_oneshot_i16;
+static inline bool wfe_mutex_wait_for_masked_value_timeout_i16(uint16_t *ptr, uint16_t mask, uint16_t value, uint64_t nanoseconds, bool low_power, uint16_t *result) {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_masked_value_timeout_i16)(ptr, mask, value, nanoseconds, low_power, result);
 }
 
-static inline wait_for_value_spurious_oneshot_i32_ptr get_wfe_mutex_wait_for_value_spurious_oneshot_i32_ptr() {
-	return wfe_mutex_get_features()->wait_for_value_spurious_oneshot_i32;
+static inline bool wfe_mutex_wait_for_masked_value_timeout_i32(uint32_t *ptr, uint32_t mask, uint32_t value, uint64_t nanoseconds, bool low_power, uint32_t *result) {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_masked_value_timeout_i32)(ptr, mask, value, nanoseconds, low_power, result);
 }
 
-static inline wait_for_value_spurious_oneshot_i64_ptr get_wfe_mutex_wait_for_value_spurious_oneshot_i64_ptr() {
-	return wfe_mutex_get_features()->wait_for_value_spurious_oneshot_i64;
+static inline bool wfe_mutex_wait_for_masked_value_timeout_i64(uint64_t *ptr, uint64_t mask, uint64_t value, uint64_t nanoseconds, bool low_power, uint64_t *result) {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_masked_value_timeout_i64)(ptr, mask, value, nanoseconds, low_power, result);
 }
 
-// mutex interface
-typedef struct {
-	uint32_t mutex;
-} wfe_mutex_lock;
+static inline bool wfe_mutex_wait_for_any_bit_set_timeout_i8(uint8_t *ptr, uint8_t mask, uint64_t nanoseconds, bool low_power, uint8_t *result) {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_any_bit_set_timeout_i8)(ptr, mask, nanoseconds, low_power, result);
+}
 
-typedef struct {
-	// Top-bit determines write-lock.
-	// Lower 31-bits gives the number of shared locks.
-	uint32_t mutex;
-} wfe_mutex_rwlock;
+static inline bool wfe_mutex_wait_for_any_bit_set_timeout_i16(uint16_t *ptr, uint16_t mask, uint64_t nanoseconds, bool low_power, uint16_t *result) {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_any_bit_set_timeout_i16)(ptr, mask, nanoseconds, low_power, result);
+}
 
-#define WFE_MUTEX_LOCK_INITIALIZER \
-{ 0 }
+static inline bool wfe_mutex_wait_for_any_bit_set_timeout_i32(uint32_t *ptr, uint32_t mask, uint64_t nanoseconds, bool low_power, uint32_t *result) {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_any_bit_set_timeout_i32)(ptr, mask, nanoseconds, low_power, result);
+}
 
-#define WFE_MUTEX_RWLOCK_INITIALIZER \
-{ 0 }
+static inline bool wfe_mutex_wait_for_any_bit_set_timeout_i64(uint64_t *ptr, uint64_t mask, uint64_t nanoseconds, bool low_power, uint64_t *result) {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_any_bit_set_timeout_i64)(ptr, mask, nanoseconds, low_power, result);
+}
 
-#if defined(WFE_MUTEX_DEBUG) && WFE_MUTEX_DEBUG == 1
-static inline void print_error(const char* msg) {
-	write(STDERR_FILENO, msg, strlen(msg));
-	__builtin_unreachable();
-	__builtin_trap();
+static inline bool wfe_mutex_wait_for_sequence_ge_timeout_i8(uint8_t *ptr, uint8_t target, uint64_t nanoseconds, bool low_power, uint8_t *result) {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_sequence_ge_timeout_i8)(ptr, target, nanoseconds, low_power, result);
 }
 
-static inline void sanity_check_rdwrlock_value(uint32_t value) {
-	const uint32_t TOP_BIT = 1U << 31;
+static inline bool wfe_mutex_wait_for_sequence_ge_timeout_i16(uint16_t *ptr, uint16_t target, uint64_t nanoseconds, bool low_power, uint16_t *result) {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_sequence_ge_timeout_i16)(ptr, target, nanoseconds, low_power, result);
+}
 
-	if (value & TOP_BIT) {
-		// If the top bit is set then we are expecting all the lower bits to be zero.
-		if (value & ~TOP_BIT) {
-			// Programming error.
-			print_error("rdwrlock state inconsistent! Has write lock set and also shared mutex bits!\n");
-		}
-	}
+static inline bool wfe_mutex_wait_for_sequence_ge_timeout_i32(uint32_t *ptr, uint32_t target, uint64_t nanoseconds, bool low_power, uint32_t *result) {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_sequence_ge_timeout_i32)(ptr, target, nanoseconds, low_power, result);
 }
 
-static inline void sanity_check_rdwrlock_read_ready_value(uint32_t value) {
-	const uint32_t TOP_BIT = 1U << 31;
+static inline bool wfe_mutex_wait_for_sequence_ge_timeout_i64(uint64_t *ptr, uint64_t target, uint64_t nanoseconds, bool low_power, uint64_t *result) {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_sequence_ge_timeout_i64)(ptr, target, nanoseconds, low_power, result);
+}
 
-	if (value & TOP_BIT) {
-		// Programming error.
-		print_error("rdwrlock state inconsistent! Expected no writer ownership!!\n");
-	}
+static inline void wfe_mutex_wait_for_value_i128(wfe_mutex_u128 *ptr, wfe_mutex_u128 value, bool low_power) {
+	WFE_MUTEX_DISPATCH(wait_for_value_i128)(ptr, value, low_power);
 }
 
-static inline void sanity_check_rdwrlock_mutex(uint32_t *mutex) {
-	uint32_t value = __atomic_load_n(mutex, __ATOMIC_SEQ_CST);
-	sanity_check_rdwrlock_value(value);
+static inline wfe_mutex_u128 wfe_mutex_wait_for_masked_value_i128(wfe_mutex_u128 *ptr, wfe_mutex_u128 mask, wfe_mutex_u128 value, bool low_power) {
+	return WFE_MUTEX_DISPATCH(wait_for_masked_value_i128)(ptr, mask, value, low_power);
 }
 
-static inline void sanity_check_rdwrlock_unlock_mutex(uint32_t *mutex) {
-	// On mutex unlock the top bit must be set and the rest of the bits zero
-	const uint32_t TOP_BIT = 1U << 31;
+static inline bool wfe_mutex_wait_for_bit_set_timeout_i8(uint8_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint8_t *result) {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_bit_set_timeout_i8)(ptr, bit, nanoseconds, low_power, result);
+}
 
-	uint32_t value = __atomic_load_n(mutex, __ATOMIC_SEQ_CST);
+static inline bool wfe_mutex_wait_for_bit_set_timeout_i16(uint16_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint16_t *result) {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_bit_set_timeout_i16)(ptr, bit, nanoseconds, low_power, result);
+}
 
-	if (value & TOP_BIT) {
-		// If the top bit is set then we are expecting all the lower bits to be zero.
-		if (value & ~TOP_BIT) {
-			// Programming error.
-			print_error("rdwrlock state inconsistent! Has write lock set and also shared mutex bits!\n");
-		}
-	}
-	else {
-		// If top bit is unset with unlock then this is a programming error.
-		if (value & ~TOP_BIT) {
-			print_error("rdwrlock trying to write unlock. Wasn't unique locked and has shared readers!\n");
-		}
-		else {
-			print_error("rdwrlock trying to write unlock. Wasn't unique locked!\n");
-		}
-	}
+static inline bool wfe_mutex_wait_for_bit_set_timeout_i32(uint32_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint32_t *result) {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_bit_set_timeout_i32)(ptr, bit, nanoseconds, low_power, result);
 }
 
-static inline void sanity_check_rdwrlock_unlock_shared_mutex(uint32_t *mutex) {
-	// On shared unlock the top-bit must not be set and the lower bits must not be zero.
-	const uint32_t TOP_BIT = 1U << 31;
+static inline bool wfe_mutex_wait_for_bit_set_timeout_i64(uint64_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint64_t *result) {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_bit_set_timeout_i64)(ptr, bit, nanoseconds, low_power, result);
+}
 
-	uint32_t value = __atomic_load_n(mutex, __ATOMIC_SEQ_CST);
+static inline bool wfe_mutex_wait_for_bit_not_set_timeout_i8(uint8_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint8_t *result) {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_bit_not_set_timeout_i8)(ptr, bit, nanoseconds, low_power, result);
+}
 
-	if (value & TOP_BIT) {
-		print_error("rdwrlock trying to read unlock. Was unique locked!\n");
-	}
-	else {
-		if ((value & ~TOP_BIT) == 0) {
-			print_error("rdwrlock trying to read unlock. Wasn't read locked!\n");
-		}
-	}
+static inline bool wfe_mutex_wait_for_bit_not_set_timeout_i16(uint16_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint16_t *result) {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_bit_not_set_timeout_i16)(ptr, bit, nanoseconds, low_power, result);
 }
 
-static inline void sanity_check_wrlock_value(uint32_t value) {
-	// Write lock values can only be 0 and 1
-	if (value & ~1U) {
-		// Programming error.
-		print_error("wrlock state inconsistent! Has invalid upper bits set!\n");
-	}
+static inline bool wfe_mutex_wait_for_bit_not_set_timeout_i32(uint32_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint32_t *result) {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_bit_not_set_timeout_i32)(ptr, bit, nanoseconds, low_power, result);
 }
 
-static inline void sanity_check_wrlock_mutex(uint32_t *mutex) {
-	uint32_t value = __atomic_load_n(mutex, __ATOMIC_SEQ_CST);
-	sanity_check_wrlock_value(value);
+static inline bool wfe_mutex_wait_for_bit_not_set_timeout_i64(uint64_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint64_t *result) {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_bit_not_set_timeout_i64)(ptr, bit, nanoseconds, low_power, result);
 }
 
-static inline void sanity_check_wrlock_unlock_mutex(uint32_t *mutex) {
-	// On mutex unlock, only the bottom bit must be set
-	uint32_t value = __atomic_load_n(mutex, __ATOMIC_SEQ_CST);
+static inline bool wfe_mutex_wait_for_value_until_i8(uint8_t *ptr, uint8_t value, uint64_t cycles_deadline, bool low_power) {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_value_until_i8)(ptr, value, cycles_deadline, low_power);
+}
 
+static inline bool wfe_mutex_wait_for_value_until_i16(uint16_t *ptr, uint16_t value, uint64_t cycles_deadline, bool low_power) {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_value_until_i16)(ptr, value, cycles_deadline, low_power);
+}
 
-	// Write lock values can only be 0 and 1
-	if (value & ~1U) {
-		// Programming error.
-		print_error("wrlock state inconsistent! Has invalid upper bits set!\n");
-	}
-	if ((value & 1) == 0) {
-		// Tried to unlock a mutex that isn't locked.
-		print_error("rdwrlock trying to write unlock. Wasn't unique locked!\n");
-	}
+static inline bool wfe_mutex_wait_for_value_until_i32(uint32_t *ptr, uint32_t value, uint64_t cycles_deadline, bool low_power) {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_value_until_i32)(ptr, value, cycles_deadline, low_power);
 }
 
-#else
-// readwrite lock mutex checks
-static inline void sanity_check_rdwrlock_value(uint32_t value) {}
-static inline void sanity_check_rdwrlock_mutex(uint32_t *mutex) {}
-static inline void sanity_check_rdwrlock_unlock_mutex(uint32_t *mutex) {}
-static inline void sanity_check_rdwrlock_unlock_shared_mutex(uint32_t *mutex) {}
-static inline void sanity_check_rdwrlock_read_ready_value(uint32_t value) {}
+static inline bool wfe_mutex_wait_for_value_until_i64(uint64_t *ptr, uint64_t value, uint64_t cycles_deadline, bool low_power) {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_value_until_i64)(ptr, value, cycles_deadline, low_power);
+}
 
-// write lock mutex checks
-static inline void sanity_check_wrlock_value(uint32_t value) {}
-static inline void sanity_check_wrlock_mutex(uint32_t *mutex) {}
-static inline void sanity_check_wrlock_unlock_mutex(uint32_t *mutex) {}
-#endif
+static inline bool wfe_mutex_wait_for_masked_value_until_i8(uint8_t *ptr, uint8_t mask, uint8_t value, uint64_t cycles_deadline, bool low_power, uint8_t *result) {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_masked_value_until_i8)(ptr, mask, value, cycles_deadline, low_power, result);
+}
 
-static inline void wfe_mutex_lock_lock(wfe_mutex_lock *lock, bool low_power) {
-	uint32_t expected = 0;
-	uint32_t desired = 1;
+static inline bool wfe_mutex_wait_for_masked_value_until_i16(uint16_t *ptr, uint16_t mask, uint16_t value, uint64_t cycles_deadline, bool low_power, uint16_t *result) {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_masked_value_until_i16)(ptr, mask, value, cycles_deadline, low_power, result);
+}
 
-	sanity_check_wrlock_mutex(&lock->mutex);
+static inline bool wfe_mutex_wait_for_masked_value_until_i32(uint32_t *ptr, uint32_t mask, uint32_t value, uint64_t cycles_deadline, bool low_power, uint32_t *result) {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_masked_value_until_i32)(ptr, mask, value, cycles_deadline, low_power, result);
+}
 
-	// Try to CAS immediately.
-	if (__atomic_compare_exchange_n(&lock->mutex, &expected, desired, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) return;
+static inline bool wfe_mutex_wait_for_masked_value_until_i64(uint64_t *ptr, uint64_t mask, uint64_t value, uint64_t cycles_deadline, bool low_power, uint64_t *result) {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_masked_value_until_i64)(ptr, mask, value, cycles_deadline, low_power, result);
+}
 
-	wait_for_value_i32_ptr wait_ptr = get_wfe_mutex_wait_for_value_i32_ptr();
-	do {
-		wait_ptr(&lock->mutex, 0, low_power);
-		expected = 0;
-		sanity_check_wrlock_mutex(&lock->mutex);
-	} while (__atomic_compare_exchange_n(&lock->mutex, &expected, desired, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE) == false);
+static inline bool wfe_mutex_wait_for_any_bit_set_until_i8(uint8_t *ptr, uint8_t mask, uint64_t cycles_deadline, bool low_power, uint8_t *result) {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_any_bit_set_until_i8)(ptr, mask, cycles_deadline, low_power, result);
 }
 
-static inline bool wfe_mutex_lock_trylock(wfe_mutex_lock *lock) {
-	uint32_t expected = 0;
-	uint32_t desired = 1;
+static inline bool wfe_mutex_wait_for_any_bit_set_until_i16(uint16_t *ptr, uint16_t mask, uint64_t cycles_deadline, bool low_power, uint16_t *result) {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_any_bit_set_until_i16)(ptr, mask, cycles_deadline, low_power, result);
+}
 
-	sanity_check_wrlock_mutex(&lock->mutex);
+static inline bool wfe_mutex_wait_for_any_bit_set_until_i32(uint32_t *ptr, uint32_t mask, uint64_t cycles_deadline, bool low_power, uint32_t *result) {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_any_bit_set_until_i32)(ptr, mask, cycles_deadline, low_power, result);
+}
 
-	// Try to CAS immediately.
-	if (__atomic_compare_exchange_n(&lock->mutex, &expected, desired, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) return true;
-	return false;
+static inline bool wfe_mutex_wait_for_any_bit_set_until_i64(uint64_t *ptr, uint64_t mask, uint64_t cycles_deadline, bool low_power, uint64_t *result) {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_any_bit_set_until_i64)(ptr, mask, cycles_deadline, low_power, result);
 }
 
-static inline void wfe_mutex_lock_unlock(wfe_mutex_lock *lock) {
-	sanity_check_wrlock_mutex(&lock->mutex);
+static inline bool wfe_mutex_wait_for_sequence_ge_until_i8(uint8_t *ptr, uint8_t target, uint64_t cycles_deadline, bool low_power, uint8_t *result) {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_sequence_ge_until_i8)(ptr, target, cycles_deadline, low_power, result);
+}
 
-	sanity_check_wrlock_unlock_mutex(&lock->mutex);
+static inline bool wfe_mutex_wait_for_sequence_ge_until_i16(uint16_t *ptr, uint16_t target, uint64_t cycles_deadline, bool low_power, uint16_t *result) {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_sequence_ge_until_i16)(ptr, target, cycles_deadline, low_power, result);
+}
 
-	// Unlocking is just storing zero.
-	__atomic_store_n(&lock->mutex, 0, __ATOMIC_RELEASE);
+static inline bool wfe_mutex_wait_for_sequence_ge_until_i32(uint32_t *ptr, uint32_t target, uint64_t cycles_deadline, bool low_power, uint32_t *result) {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_sequence_ge_until_i32)(ptr, target, cycles_deadline, low_power, result);
 }
 
-static inline bool wfe_mutex_lock_timedlock(wfe_mutex_lock *lock, uint64_t nanoseconds, bool low_power) {
-	uint32_t expected = 0;
-	uint32_t desired = 1;
+static inline bool wfe_mutex_wait_for_sequence_ge_until_i64(uint64_t *ptr, uint64_t target, uint64_t cycles_deadline, bool low_power, uint64_t *result) {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_sequence_ge_until_i64)(ptr, target, cycles_deadline, low_power, result);
+}
 
-	sanity_check_wrlock_mutex(&lock->mutex);
+static inline bool wfe_mutex_wait_for_bit_set_until_i8(uint8_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint8_t *result) {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_bit_set_until_i8)(ptr, bit, cycles_deadline, low_power, result);
+}
 
-	// Try to CAS immediately.
-	if (__atomic_compare_exchange_n(&lock->mutex, &expected, desired, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) return true;
+static inline bool wfe_mutex_wait_for_bit_set_until_i16(uint16_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint16_t *result) {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_bit_set_until_i16)(ptr, bit, cycles_deadline, low_power, result);
+}
 
-	wait_for_value_timeout_i32_ptr wait_ptr = get_wfe_mutex_wait_for_value_timeout_i32_ptr();
+static inline bool wfe_mutex_wait_for_bit_set_until_i32(uint32_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint32_t *result) {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_bit_set_until_i32)(ptr, bit, cycles_deadline, low_power, result);
+}
+
+static inline bool wfe_mutex_wait_for_bit_set_until_i64(uint64_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint64_t *result) {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_bit_set_until_i64)(ptr, bit, cycles_deadline, low_power, result);
+}
+
+static inline bool wfe_mutex_wait_for_bit_not_set_until_i8(uint8_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint8_t *result) {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_bit_not_set_until_i8)(ptr, bit, cycles_deadline, low_power, result);
+}
+
+static inline bool wfe_mutex_wait_for_bit_not_set_until_i16(uint16_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint16_t *result) {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_bit_not_set_until_i16)(ptr, bit, cycles_deadline, low_power, result);
+}
+
+static inline bool wfe_mutex_wait_for_bit_not_set_until_i32(uint32_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint32_t *result) {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_bit_not_set_until_i32)(ptr, bit, cycles_deadline, low_power, result);
+}
+
+static inline bool wfe_mutex_wait_for_bit_not_set_until_i64(uint64_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint64_t *result) {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_bit_not_set_until_i64)(ptr, bit, cycles_deadline, low_power, result);
+}
+
+static inline bool wfe_mutex_wait_for_bit_set_spurious_oneshot_i8(uint8_t *ptr, uint8_t bit, bool low_power, uint8_t *result) {
+	return WFE_MUTEX_DISPATCH(wait_for_bit_set_spurious_oneshot_i8)(ptr, bit, low_power, result);
+}
+
+static inline bool wfe_mutex_wait_for_bit_set_spurious_oneshot_i16(uint16_t *ptr, uint8_t bit, bool low_power, uint16_t *result) {
+	return WFE_MUTEX_DISPATCH(wait_for_bit_set_spurious_oneshot_i16)(ptr, bit, low_power, result);
+}
+
+static inline bool wfe_mutex_wait_for_bit_set_spurious_oneshot_i32(uint32_t *ptr, uint8_t bit, bool low_power, uint32_t *result) {
+	return WFE_MUTEX_DISPATCH(wait_for_bit_set_spurious_oneshot_i32)(ptr, bit, low_power, result);
+}
+
+static inline bool wfe_mutex_wait_for_bit_set_spurious_oneshot_i64(uint64_t *ptr, uint8_t bit, bool low_power, uint64_t *result) {
+	return WFE_MUTEX_DISPATCH(wait_for_bit_set_spurious_oneshot_i64)(ptr, bit, low_power, result);
+}
+
+static inline bool wfe_mutex_wait_for_bit_not_set_spurious_oneshot_i8(uint8_t *ptr, uint8_t bit, bool low_power, uint8_t *result) {
+	return WFE_MUTEX_DISPATCH(wait_for_bit_not_set_spurious_oneshot_i8)(ptr, bit, low_power, result);
+}
+
+static inline bool wfe_mutex_wait_for_bit_not_set_spurious_oneshot_i16(uint16_t *ptr, uint8_t bit, bool low_power, uint16_t *result) {
+	return WFE_MUTEX_DISPATCH(wait_for_bit_not_set_spurious_oneshot_i16)(ptr, bit, low_power, result);
+}
+
+static inline bool wfe_mutex_wait_for_bit_not_set_spurious_oneshot_i32(uint32_t *ptr, uint8_t bit, bool low_power, uint32_t *result) {
+	return WFE_MUTEX_DISPATCH(wait_for_bit_not_set_spurious_oneshot_i32)(ptr, bit, low_power, result);
+}
+
+static inline bool wfe_mutex_wait_for_bit_not_set_spurious_oneshot_i64(uint64_t *ptr, uint8_t bit, bool low_power, uint64_t *result) {
+	return WFE_MUTEX_DISPATCH(wait_for_bit_not_set_spurious_oneshot_i64)(ptr, bit, low_power, result);
+}
+
+static inline size_t wfe_mutex_wait_any_oneshot(const wfe_mutex_wait_desc *descs, size_t n, size_t monitor_index, uint64_t nanoseconds, bool low_power) {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_any_oneshot)(descs, n, monitor_index, nanoseconds, low_power);
+}
+
+static inline uint64_t wfe_mutex_doorbell_wait(wfe_mutex_doorbell *doorbell, bool low_power) {
+	return WFE_MUTEX_DISPATCH(doorbell_wait)(doorbell, low_power);
+}
+
+static inline void wfe_mutex_sleep_until(uint64_t cycles_deadline, bool low_power) {
+	WFE_MUTEX_DISPATCH_TIMED(sleep_until)(cycles_deadline, low_power);
+}
+
+///< Sleeps for `cycles` cycle counter ticks. Meant for short backoff and pacing delays, not thread scheduling.
+static inline void wfe_mutex_sleep_cycles(uint64_t cycles, bool low_power) {
+	wfe_mutex_sleep_until(wfe_mutex_read_cycle_counter() + cycles, low_power);
+}
+
+static inline void wfe_mutex_sleep_nanoseconds(uint64_t nanoseconds, bool low_power) {
+	wfe_mutex_sleep_until(wfe_mutex_deadline_from_nanoseconds(nanoseconds), low_power);
+}
+
+// getters
+static inline wait_for_value_i8_ptr get_wfe_mutex_wait_for_value_i8_ptr() {
+	return WFE_MUTEX_DISPATCH(wait_for_value_i8);
+}
+
+static inline wait_for_value_i16_ptr get_wfe_mutex_wait_for_value_i16_ptr() {
+	return WFE_MUTEX_DISPATCH(wait_for_value_i16);
+}
+
+static inline wait_for_value_i32_ptr get_wfe_mutex_wait_for_value_i32_ptr() {
+	return WFE_MUTEX_DISPATCH(wait_for_value_i32);
+}
+
+static inline wait_for_value_i64_ptr get_wfe_mutex_wait_for_value_i64_ptr() {
+	return WFE_MUTEX_DISPATCH(wait_for_value_i64);
+}
+
+static inline wait_for_bit_set_i8_ptr get_wfe_mutex_wait_for_bit_set_i8_ptr() {
+	return WFE_MUTEX_DISPATCH(wait_for_bit_set_i8);
+}
+
+static inline wait_for_bit_set_i16_ptr get_wfe_mutex_wait_for_bit_set_i16_ptr() {
+	return WFE_MUTEX_DISPATCH(wait_for_bit_set_i16);
+}
+
+static inline wait_for_bit_set_i32_ptr get_wfe_mutex_wait_for_bit_set_i32_ptr() {
+	return WFE_MUTEX_DISPATCH(wait_for_bit_set_i32);
+}
+
+static inline wait_for_bit_set_i64_ptr get_wfe_mutex_wait_for_bit_set_i64_ptr() {
+	return WFE_MUTEX_DISPATCH(wait_for_bit_set_i64);
+}
+
+static inline wait_for_bit_set_i8_ptr get_wfe_mutex_wait_for_bit_not_set_i8_ptr() {
+	return WFE_MUTEX_DISPATCH(wait_for_bit_not_set_i8);
+}
+
+static inline wait_for_bit_set_i16_ptr get_wfe_mutex_wait_for_bit_not_set_i16_ptr() {
+	return WFE_MUTEX_DISPATCH(wait_for_bit_not_set_i16);
+}
+
+static inline wait_for_bit_set_i32_ptr get_wfe_mutex_wait_for_bit_not_set_i32_ptr() {
+	return WFE_MUTEX_DISPATCH(wait_for_bit_not_set_i32);
+}
+
+static inline wait_for_bit_set_i64_ptr get_wfe_mutex_wait_for_bit_not_set_i64_ptr() {
+	return WFE_MUTEX_DISPATCH(wait_for_bit_not_set_i64);
+}
+
+static inline wait_for_value_timeout_i8_ptr get_wfe_mutex_wait_for_value_timeout_i8_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_value_timeout_i8);
+}
+
+static inline wait_for_value_timeout_i16_ptr get_wfe_mutex_wait_for_value_timeout_i16_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_value_timeout_i16);
+}
+
+static inline wait_for_value_timeout_i32_ptr get_wfe_mutex_wait_for_value_timeout_i32_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_value_timeout_i32);
+}
+
+static inline wait_for_value_timeout_i64_ptr get_wfe_mutex_wait_for_value_timeout_i64_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_value_timeout_i64);
+}
+
+static inline wait_for_value_spurious_oneshot_i8_ptr get_wfe_mutex_wait_for_value_spurious_oneshot_i8_ptr() {
+	return WFE_MUTEX_DISPATCH(wait_for_value_spurious_oneshot_i8);
+}
+
+static inline wait_for_value_spurious_oneshot_i16_ptr get_wfe_mutex_wait_for_value_spurious_oneshot_i16_ptr() {
+	return WFE_MUTEX_DISPATCH(wait_for_value_spurious_oneshot_i16);
+}
+
+static inline wait_for_value_spurious_oneshot_i32_ptr get_wfe_mutex_wait_for_value_spurious_oneshot_i32_ptr() {
+	return WFE_MUTEX_DISPATCH(wait_for_value_spurious_oneshot_i32);
+}
+
+static inline wait_for_value_spurious_oneshot_i64_ptr get_wfe_mutex_wait_for_value_spurious_oneshot_i64_ptr() {
+	return WFE_MUTEX_DISPATCH(wait_for_value_spurious_oneshot_i64);
+}
+
+static inline wait_for_change_i8_ptr get_wfe_mutex_wait_for_change_i8_ptr() {
+	return WFE_MUTEX_DISPATCH(wait_for_change_i8);
+}
+
+static inline wait_for_change_i16_ptr get_wfe_mutex_wait_for_change_i16_ptr() {
+	return WFE_MUTEX_DISPATCH(wait_for_change_i16);
+}
+
+static inline wait_for_change_i32_ptr get_wfe_mutex_wait_for_change_i32_ptr() {
+	return WFE_MUTEX_DISPATCH(wait_for_change_i32);
+}
+
+static inline wait_for_change_i64_ptr get_wfe_mutex_wait_for_change_i64_ptr() {
+	return WFE_MUTEX_DISPATCH(wait_for_change_i64);
+}
+
+static inline wait_for_masked_value_i8_ptr get_wfe_mutex_wait_for_masked_value_i8_ptr() {
+	return WFE_MUTEX_DISPATCH(wait_for_masked_value_i8);
+}
+
+static inline wait_for_masked_value_i16_ptr get_wfe_mutex_wait_for_masked_value_i16_ptr() {
+	return WFE_MUTEX_DISPATCH(wait_for_masked_value_i16);
+}
+
+static inline wait_for_masked_value_i32_ptr get_wfe_mutex_wait_for_masked_value_i32_ptr() {
+	return WFE_MUTEX_DISPATCH(wait_for_masked_value_i32);
+}
+
+static inline wait_for_masked_value_i64_ptr get_wfe_mutex_wait_for_masked_value_i64_ptr() {
+	return WFE_MUTEX_DISPATCH(wait_for_masked_value_i64);
+}
+
+static inline wait_for_any_bit_set_i8_ptr get_wfe_mutex_wait_for_any_bit_set_i8_ptr() {
+	return WFE_MUTEX_DISPATCH(wait_for_any_bit_set_i8);
+}
+
+static inline wait_for_any_bit_set_i16_ptr get_wfe_mutex_wait_for_any_bit_set_i16_ptr() {
+	return WFE_MUTEX_DISPATCH(wait_for_any_bit_set_i16);
+}
+
+static inline wait_for_any_bit_set_i32_ptr get_wfe_mutex_wait_for_any_bit_set_i32_ptr() {
+	return WFE_MUTEX_DISPATCH(wait_for_any_bit_set_i32);
+}
+
+static inline wait_for_any_bit_set_i64_ptr get_wfe_mutex_wait_for_any_bit_set_i64_ptr() {
+	return WFE_MUTEX_DISPATCH(wait_for_any_bit_set_i64);
+}
+
+static inline wait_for_sequence_ge_i8_ptr get_wfe_mutex_wait_for_sequence_ge_i8_ptr() {
+	return WFE_MUTEX_DISPATCH(wait_for_sequence_ge_i8);
+}
+
+static inline wait_for_sequence_ge_i16_ptr get_wfe_mutex_wait_for_sequence_ge_i16_ptr() {
+	return WFE_MUTEX_DISPATCH(wait_for_sequence_ge_i16);
+}
+
+static inline wait_for_sequence_ge_i32_ptr get_wfe_mutex_wait_for_sequence_ge_i32_ptr() {
+	return WFE_MUTEX_DISPATCH(wait_for_sequence_ge_i32);
+}
+
+static inline wait_for_sequence_ge_i64_ptr get_wfe_mutex_wait_for_sequence_ge_i64_ptr() {
+	return WFE_MUTEX_DISPATCH(wait_for_sequence_ge_i64);
+}
+
+static inline wait_for_masked_value_timeout_i8_ptr get_wfe_mutex_wait_for_masked_value_timeout_i8_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_masked_value_timeout_i8);
+}
+
+static inline wait_for_masked_value_timeout_i16_ptr get_wfe_mutex_wait_for_masked_value_timeout_i16_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_masked_value_timeout_i16);
+}
+
+static inline wait_for_masked_value_timeout_i32_ptr get_wfe_mutex_wait_for_masked_value_timeout_i32_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_masked_value_timeout_i32);
+}
+
+static inline wait_for_masked_value_timeout_i64_ptr get_wfe_mutex_wait_for_masked_value_timeout_i64_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_masked_value_timeout_i64);
+}
+
+static inline wait_for_any_bit_set_timeout_i8_ptr get_wfe_mutex_wait_for_any_bit_set_timeout_i8_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_any_bit_set_timeout_i8);
+}
+
+static inline wait_for_any_bit_set_timeout_i16_ptr get_wfe_mutex_wait_for_any_bit_set_timeout_i16_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_any_bit_set_timeout_i16);
+}
+
+static inline wait_for_any_bit_set_timeout_i32_ptr get_wfe_mutex_wait_for_any_bit_set_timeout_i32_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_any_bit_set_timeout_i32);
+}
+
+static inline wait_for_any_bit_set_timeout_i64_ptr get_wfe_mutex_wait_for_any_bit_set_timeout_i64_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_any_bit_set_timeout_i64);
+}
+
+static inline wait_for_sequence_ge_timeout_i8_ptr get_wfe_mutex_wait_for_sequence_ge_timeout_i8_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_sequence_ge_timeout_i8);
+}
+
+static inline wait_for_sequence_ge_timeout_i16_ptr get_wfe_mutex_wait_for_sequence_ge_timeout_i16_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_sequence_ge_timeout_i16);
+}
+
+static inline wait_for_sequence_ge_timeout_i32_ptr get_wfe_mutex_wait_for_sequence_ge_timeout_i32_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_sequence_ge_timeout_i32);
+}
+
+static inline wait_for_sequence_ge_timeout_i64_ptr get_wfe_mutex_wait_for_sequence_ge_timeout_i64_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_sequence_ge_timeout_i64);
+}
+
+static inline wait_for_value_i128_ptr get_wfe_mutex_wait_for_value_i128_ptr() {
+	return WFE_MUTEX_DISPATCH(wait_for_value_i128);
+}
+
+static inline wait_for_masked_value_i128_ptr get_wfe_mutex_wait_for_masked_value_i128_ptr() {
+	return WFE_MUTEX_DISPATCH(wait_for_masked_value_i128);
+}
+
+static inline wait_for_bit_set_timeout_i8_ptr get_wfe_mutex_wait_for_bit_set_timeout_i8_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_bit_set_timeout_i8);
+}
+
+static inline wait_for_bit_set_timeout_i16_ptr get_wfe_mutex_wait_for_bit_set_timeout_i16_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_bit_set_timeout_i16);
+}
+
+static inline wait_for_bit_set_timeout_i32_ptr get_wfe_mutex_wait_for_bit_set_timeout_i32_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_bit_set_timeout_i32);
+}
+
+static inline wait_for_bit_set_timeout_i64_ptr get_wfe_mutex_wait_for_bit_set_timeout_i64_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_bit_set_timeout_i64);
+}
+
+static inline wait_for_bit_not_set_timeout_i8_ptr get_wfe_mutex_wait_for_bit_not_set_timeout_i8_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_bit_not_set_timeout_i8);
+}
+
+static inline wait_for_bit_not_set_timeout_i16_ptr get_wfe_mutex_wait_for_bit_not_set_timeout_i16_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_bit_not_set_timeout_i16);
+}
+
+static inline wait_for_bit_not_set_timeout_i32_ptr get_wfe_mutex_wait_for_bit_not_set_timeout_i32_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_bit_not_set_timeout_i32);
+}
+
+static inline wait_for_bit_not_set_timeout_i64_ptr get_wfe_mutex_wait_for_bit_not_set_timeout_i64_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_bit_not_set_timeout_i64);
+}
+
+static inline wait_for_value_until_i8_ptr get_wfe_mutex_wait_for_value_until_i8_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_value_until_i8);
+}
+
+static inline wait_for_value_until_i16_ptr get_wfe_mutex_wait_for_value_until_i16_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_value_until_i16);
+}
+
+static inline wait_for_value_until_i32_ptr get_wfe_mutex_wait_for_value_until_i32_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_value_until_i32);
+}
+
+static inline wait_for_value_until_i64_ptr get_wfe_mutex_wait_for_value_until_i64_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_value_until_i64);
+}
+
+static inline wait_for_masked_value_until_i8_ptr get_wfe_mutex_wait_for_masked_value_until_i8_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_masked_value_until_i8);
+}
+
+static inline wait_for_masked_value_until_i16_ptr get_wfe_mutex_wait_for_masked_value_until_i16_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_masked_value_until_i16);
+}
+
+static inline wait_for_masked_value_until_i32_ptr get_wfe_mutex_wait_for_masked_value_until_i32_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_masked_value_until_i32);
+}
+
+static inline wait_for_masked_value_until_i64_ptr get_wfe_mutex_wait_for_masked_value_until_i64_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_masked_value_until_i64);
+}
+
+static inline wait_for_any_bit_set_until_i8_ptr get_wfe_mutex_wait_for_any_bit_set_until_i8_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_any_bit_set_until_i8);
+}
+
+static inline wait_for_any_bit_set_until_i16_ptr get_wfe_mutex_wait_for_any_bit_set_until_i16_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_any_bit_set_until_i16);
+}
+
+static inline wait_for_any_bit_set_until_i32_ptr get_wfe_mutex_wait_for_any_bit_set_until_i32_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_any_bit_set_until_i32);
+}
+
+static inline wait_for_any_bit_set_until_i64_ptr get_wfe_mutex_wait_for_any_bit_set_until_i64_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_any_bit_set_until_i64);
+}
+
+static inline wait_for_sequence_ge_until_i8_ptr get_wfe_mutex_wait_for_sequence_ge_until_i8_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_sequence_ge_until_i8);
+}
+
+static inline wait_for_sequence_ge_until_i16_ptr get_wfe_mutex_wait_for_sequence_ge_until_i16_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_sequence_ge_until_i16);
+}
+
+static inline wait_for_sequence_ge_until_i32_ptr get_wfe_mutex_wait_for_sequence_ge_until_i32_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_sequence_ge_until_i32);
+}
+
+static inline wait_for_sequence_ge_until_i64_ptr get_wfe_mutex_wait_for_sequence_ge_until_i64_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_sequence_ge_until_i64);
+}
+
+static inline wait_for_bit_set_until_i8_ptr get_wfe_mutex_wait_for_bit_set_until_i8_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_bit_set_until_i8);
+}
+
+static inline wait_for_bit_set_until_i16_ptr get_wfe_mutex_wait_for_bit_set_until_i16_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_bit_set_until_i16);
+}
+
+static inline wait_for_bit_set_until_i32_ptr get_wfe_mutex_wait_for_bit_set_until_i32_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_bit_set_until_i32);
+}
+
+static inline wait_for_bit_set_until_i64_ptr get_wfe_mutex_wait_for_bit_set_until_i64_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_bit_set_until_i64);
+}
+
+static inline wait_for_bit_not_set_until_i8_ptr get_wfe_mutex_wait_for_bit_not_set_until_i8_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_bit_not_set_until_i8);
+}
+
+static inline wait_for_bit_not_set_until_i16_ptr get_wfe_mutex_wait_for_bit_not_set_until_i16_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_bit_not_set_until_i16);
+}
+
+static inline wait_for_bit_not_set_until_i32_ptr get_wfe_mutex_wait_for_bit_not_set_until_i32_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_bit_not_set_until_i32);
+}
+
+static inline wait_for_bit_not_set_until_i64_ptr get_wfe_mutex_wait_for_bit_not_set_until_i64_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_for_bit_not_set_until_i64);
+}
+
+static inline wait_for_bit_set_spurious_oneshot_i8_ptr get_wfe_mutex_wait_for_bit_set_spurious_oneshot_i8_ptr() {
+	return WFE_MUTEX_DISPATCH(wait_for_bit_set_spurious_oneshot_i8);
+}
+
+static inline wait_for_bit_set_spurious_oneshot_i16_ptr get_wfe_mutex_wait_for_bit_set_spurious_oneshot_i16_ptr() {
+	return WFE_MUTEX_DISPATCH(wait_for_bit_set_spurious_oneshot_i16);
+}
+
+static inline wait_for_bit_set_spurious_oneshot_i32_ptr get_wfe_mutex_wait_for_bit_set_spurious_oneshot_i32_ptr() {
+	return WFE_MUTEX_DISPATCH(wait_for_bit_set_spurious_oneshot_i32);
+}
+
+static inline wait_for_bit_set_spurious_oneshot_i64_ptr get_wfe_mutex_wait_for_bit_set_spurious_oneshot_i64_ptr() {
+	return WFE_MUTEX_DISPATCH(wait_for_bit_set_spurious_oneshot_i64);
+}
+
+static inline wait_for_bit_not_set_spurious_oneshot_i8_ptr get_wfe_mutex_wait_for_bit_not_set_spurious_oneshot_i8_ptr() {
+	return WFE_MUTEX_DISPATCH(wait_for_bit_not_set_spurious_oneshot_i8);
+}
+
+static inline wait_for_bit_not_set_spurious_oneshot_i16_ptr get_wfe_mutex_wait_for_bit_not_set_spurious_oneshot_i16_ptr() {
+	return WFE_MUTEX_DISPATCH(wait_for_bit_not_set_spurious_oneshot_i16);
+}
+
+static inline wait_for_bit_not_set_spurious_oneshot_i32_ptr get_wfe_mutex_wait_for_bit_not_set_spurious_oneshot_i32_ptr() {
+	return WFE_MUTEX_DISPATCH(wait_for_bit_not_set_spurious_oneshot_i32);
+}
+
+static inline wait_for_bit_not_set_spurious_oneshot_i64_ptr get_wfe_mutex_wait_for_bit_not_set_spurious_oneshot_i64_ptr() {
+	return WFE_MUTEX_DISPATCH(wait_for_bit_not_set_spurious_oneshot_i64);
+}
+
+static inline wait_any_oneshot_ptr get_wfe_mutex_wait_any_oneshot_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(wait_any_oneshot);
+}
+
+static inline doorbell_wait_ptr get_wfe_mutex_doorbell_wait_ptr() {
+	return WFE_MUTEX_DISPATCH(doorbell_wait);
+}
+
+static inline sleep_until_ptr get_wfe_mutex_sleep_until_ptr() {
+	return WFE_MUTEX_DISPATCH_TIMED(sleep_until);
+}
+
+// mutex interface
+typedef struct {
+	uint32_t mutex;
+} wfe_mutex_lock;
+
+typedef struct {
+	// Top-bit determines write-lock.
+	// Lower 31-bits gives the number of shared locks.
+	uint32_t mutex;
+} wfe_mutex_rwlock;
+
+#define WFE_MUTEX_LOCK_INITIALIZER \
+{ 0 }
+
+#define WFE_MUTEX_RWLOCK_INITIALIZER \
+{ 0 }
+
+#if defined(WFE_MUTEX_DEBUG) && WFE_MUTEX_DEBUG == 1
+static inline void print_error(const char* msg) {
+	write(STDERR_FILENO, msg, strlen(msg));
+	__builtin_unreachable();
+	__builtin_trap();
+}
+
+static inline void sanity_check_rdwrlock_value(uint32_t value) {
+	const uint32_t TOP_BIT = 1U << 31;
+
+	if (value & TOP_BIT) {
+		// If the top bit is set then we are expecting all the lower bits to be zero.
+		if (value & ~TOP_BIT) {
+			// Programming error.
+			print_error("rdwrlock state inconsistent! Has write lock set and also shared mutex bits!\n");
+		}
+	}
+}
+
+static inline void sanity_check_rdwrlock_read_ready_value(uint32_t value) {
+	const uint32_t TOP_BIT = 1U << 31;
+
+	if (value & TOP_BIT) {
+		// Programming error.
+		print_error("rdwrlock state inconsistent! Expected no writer ownership!!\n");
+	}
+}
+
+static inline void sanity_check_rdwrlock_mutex(uint32_t *mutex) {
+	uint32_t value = __atomic_load_n(mutex, __ATOMIC_SEQ_CST);
+	sanity_check_rdwrlock_value(value);
+}
+
+static inline void sanity_check_rdwrlock_unlock_mutex(uint32_t *mutex) {
+	// On mutex unlock the top bit must be set and the rest of the bits zero
+	const uint32_t TOP_BIT = 1U << 31;
+
+	uint32_t value = __atomic_load_n(mutex, __ATOMIC_SEQ_CST);
+
+	if (value & TOP_BIT) {
+		// If the top bit is set then we are expecting all the lower bits to be zero.
+		if (value & ~TOP_BIT) {
+			// Programming error.
+			print_error("rdwrlock state inconsistent! Has write lock set and also shared mutex bits!\n");
+		}
+	}
+	else {
+		// If top bit is unset with unlock then this is a programming error.
+		if (value & ~TOP_BIT) {
+			print_error("rdwrlock trying to write unlock. Wasn't unique locked and has shared readers!\n");
+		}
+		else {
+			print_error("rdwrlock trying to write unlock. Wasn't unique locked!\n");
+		}
+	}
+}
+
+static inline void sanity_check_rdwrlock_unlock_shared_mutex(uint32_t *mutex) {
+	// On shared unlock the top-bit must not be set and the lower bits must not be zero.
+	const uint32_t TOP_BIT = 1U << 31;
+
+	uint32_t value = __atomic_load_n(mutex, __ATOMIC_SEQ_CST);
+
+	if (value & TOP_BIT) {
+		print_error("rdwrlock trying to read unlock. Was unique locked!\n");
+	}
+	else {
+		if ((value & ~TOP_BIT) == 0) {
+			print_error("rdwrlock trying to read unlock. Wasn't read locked!\n");
+		}
+	}
+}
+
+static inline void sanity_check_wrlock_value(uint32_t value) {
+	// Write lock values can only be 0 and 1
+	if (value & ~1U) {
+		// Programming error.
+		print_error("wrlock state inconsistent! Has invalid upper bits set!\n");
+	}
+}
+
+static inline void sanity_check_wrlock_mutex(uint32_t *mutex) {
+	uint32_t value = __atomic_load_n(mutex, __ATOMIC_SEQ_CST);
+	sanity_check_wrlock_value(value);
+}
+
+static inline void sanity_check_wrlock_unlock_mutex(uint32_t *mutex) {
+	// On mutex unlock, only the bottom bit must be set
+	uint32_t value = __atomic_load_n(mutex, __ATOMIC_SEQ_CST);
+
+
+	// Write lock values can only be 0 and 1
+	if (value & ~1U) {
+		// Programming error.
+		print_error("wrlock state inconsistent! Has invalid upper bits set!\n");
+	}
+	if ((value & 1) == 0) {
+		// Tried to unlock a mutex that isn't locked.
+		print_error("rdwrlock trying to write unlock. Wasn't unique locked!\n");
+	}
+}
+
+#else
+// readwrite lock mutex checks
+static inline void sanity_check_rdwrlock_value(uint32_t value) {}
+static inline void sanity_check_rdwrlock_mutex(uint32_t *mutex) {}
+static inline void sanity_check_rdwrlock_unlock_mutex(uint32_t *mutex) {}
+static inline void sanity_check_rdwrlock_unlock_shared_mutex(uint32_t *mutex) {}
+static inline void sanity_check_rdwrlock_read_ready_value(uint32_t value) {}
+
+// write lock mutex checks
+static inline void sanity_check_wrlock_value(uint32_t value) {}
+static inline void sanity_check_wrlock_mutex(uint32_t *mutex) {}
+static inline void sanity_check_wrlock_unlock_mutex(uint32_t *mutex) {}
+#endif
+
+///< Locks using `backend` from `wfe_mutex_get_backend` instead of the active backend. NULL uses the active backend.
+static inline void wfe_mutex_lock_lock_backend(wfe_mutex_lock *lock, const wfe_mutex_backend *backend, bool low_power) {
+	uint32_t expected = 0;
+	uint32_t desired = 1;
+
+	sanity_check_wrlock_mutex(&lock->mutex);
+
+	// Try to CAS immediately.
+	if (__atomic_compare_exchange_n(&lock->mutex, &expected, desired, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) return;
+
+	wait_for_value_i32_ptr wait_ptr = backend ? backend->wait_for_value_i32 : get_wfe_mutex_wait_for_value_i32_ptr();
+	do {
+		wait_ptr(&lock->mutex, 0, low_power);
+		expected = 0;
+		sanity_check_wrlock_mutex(&lock->mutex);
+	} while (__atomic_compare_exchange_n(&lock->mutex, &expected, desired, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE) == false);
+}
+
+static inline void wfe_mutex_lock_lock(wfe_mutex_lock *lock, bool low_power) {
+	wfe_mutex_lock_lock_backend(lock, NULL, low_power);
+}
+
+static inline bool wfe_mutex_lock_trylock(wfe_mutex_lock *lock) {
+	uint32_t expected = 0;
+	uint32_t desired = 1;
+
+	sanity_check_wrlock_mutex(&lock->mutex);
+
+	// Try to CAS immediately.
+	if (__atomic_compare_exchange_n(&lock->mutex, &expected, desired, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) return true;
+	return false;
+}
+
+static inline void wfe_mutex_lock_unlock(wfe_mutex_lock *lock) {
+	sanity_check_wrlock_mutex(&lock->mutex);
+
+	sanity_check_wrlock_unlock_mutex(&lock->mutex);
+
+	// Unlocking is just storing zero.
+	__atomic_store_n(&lock->mutex, 0, __ATOMIC_RELEASE);
+}
+
+// Waits for and takes the lock after the initial CAS has failed. Shared by the relative and `_until` timed locks.
+static inline bool wfe_mutex_lock_timedlock_wait_until(wfe_mutex_lock *lock, uint64_t cycles_deadline, bool low_power) {
+	uint32_t expected;
+	uint32_t desired = 1;
+
+	wait_for_value_until_i32_ptr wait_ptr = get_wfe_mutex_wait_for_value_until_i32_ptr();
+	do {
+		// If timed-out then early exit
+		if (!wait_ptr(&lock->mutex, 0, cycles_deadline, low_power)) return false;
+		expected = 0;
+		sanity_check_wrlock_mutex(&lock->mutex);
+	} while (__atomic_compare_exchange_n(&lock->mutex, &expected, desired, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE) == false);
+
+	return true;
+}
+
+///< Tries to lock until the cycle counter reaches `cycles_deadline`, see `wfe_mutex_deadline_from_nanoseconds`.
+/// Lost CAS races retry against the same deadline, so the total wait stays bounded under contention.
+static inline bool wfe_mutex_lock_timedlock_until(wfe_mutex_lock *lock, uint64_t cycles_deadline, bool low_power) {
+	uint32_t expected = 0;
+	uint32_t desired = 1;
+
+	sanity_check_wrlock_mutex(&lock->mutex);
+
+	// Try to CAS immediately.
+	if (__atomic_compare_exchange_n(&lock->mutex, &expected, desired, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) return true;
+
+	return wfe_mutex_lock_timedlock_wait_until(lock, cycles_deadline, low_power);
+}
+
+static inline bool wfe_mutex_lock_timedlock(wfe_mutex_lock *lock, uint64_t nanoseconds, bool low_power) {
+	uint32_t expected = 0;
+	uint32_t desired = 1;
+
+	sanity_check_wrlock_mutex(&lock->mutex);
+
+	// Try to CAS immediately, the cycle counter for the deadline is only read once this fails.
+	if (__atomic_compare_exchange_n(&lock->mutex, &expected, desired, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) return true;
+
+	return wfe_mutex_lock_timedlock_wait_until(lock, wfe_mutex_deadline_from_nanoseconds(nanoseconds), low_power);
+}
+
+///< Read-locks using `backend` from `wfe_mutex_get_backend` instead of the active backend. NULL uses the active backend.
+static inline void wfe_mutex_rwlock_rdlock_backend(wfe_mutex_rwlock *lock, const wfe_mutex_backend *backend, bool low_power) {
+	sanity_check_rdwrlock_mutex(&lock->mutex);
+
+	// Getting a write-lock is waiting for the top-bit to be zero in the mutex and incrementing the bottom 31-bits.
+	const uint32_t TOP_BIT = 1U << 31;
+	uint32_t expected = 0;
+	uint32_t desired = expected + 1;
+
+	// Uncontended mutex check.
+	if (__atomic_compare_exchange_n(&lock->mutex, &expected, desired, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) return;
+
+	// Read-only mutex check
+	expected &= ~TOP_BIT;
+	desired = expected + 1;
+	if (__atomic_compare_exchange_n(&lock->mutex, &expected, desired, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) return;
+
+	wait_for_bit_set_i32_ptr wait_ptr = backend ? backend->wait_for_bit_not_set_i32 : get_wfe_mutex_wait_for_bit_not_set_i32_ptr();
+	do {
+		expected = wait_ptr(&lock->mutex, 31, low_power);
+		sanity_check_rdwrlock_value(expected);
+		sanity_check_rdwrlock_read_ready_value(expected);
+		// write-lock bit no longer set, increment by one to obtain read-lock.
+		desired = expected + 1;
+	} while (__atomic_compare_exchange_n(&lock->mutex, &expected, desired, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE) == false);
+}
+
+static inline void wfe_mutex_rwlock_rdlock(wfe_mutex_rwlock *lock, bool low_power) {
+	wfe_mutex_rwlock_rdlock_backend(lock, NULL, low_power);
+}
+
+///< Write-locks using `backend` from `wfe_mutex_get_backend` instead of the active backend. NULL uses the active backend.
+static inline void wfe_mutex_rwlock_wrlock_backend(wfe_mutex_rwlock *lock, const wfe_mutex_backend *backend, bool low_power) {
+	sanity_check_rdwrlock_mutex(&lock->mutex);
+
+	// Getting a write-lock is waiting for a value of zero in the mutex and then setting the top-bit.
+	const uint32_t TOP_BIT = 1U << 31;
+	uint32_t expected = 0;
+	uint32_t desired = TOP_BIT;
+
+	// Try to CAS immediately.
+	if (__atomic_compare_exchange_n(&lock->mutex, &expected, desired, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) return;
+
+	wait_for_value_i32_ptr wait_ptr = backend ? backend->wait_for_value_i32 : get_wfe_mutex_wait_for_value_i32_ptr();
+	do {
+		wait_ptr(&lock->mutex, 0, low_power);
+		expected = 0;
+		sanity_check_rdwrlock_mutex(&lock->mutex);
+	} while (__atomic_compare_exchange_n(&lock->mutex, &expected, desired, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE) == false);
+}
+
+static inline void wfe_mutex_rwlock_wrlock(wfe_mutex_rwlock *lock, bool low_power) {
+	wfe_mutex_rwlock_wrlock_backend(lock, NULL, low_power);
+}
+
+// Waits for and takes a read-lock after the initial CASes have failed. Shared by the relative and `_until` timed read-locks.
+static inline bool wfe_mutex_rwlock_timedrdlock_wait_until(wfe_mutex_rwlock *lock, uint64_t cycles_deadline, bool low_power) {
+	uint32_t expected;
+	uint32_t desired;
+
+	wait_for_bit_not_set_until_i32_ptr wait_ptr = get_wfe_mutex_wait_for_bit_not_set_until_i32_ptr();
+	do {
+		// If timed-out then early exit
+		if (!wait_ptr(&lock->mutex, 31, cycles_deadline, low_power, &expected)) return false;
+		sanity_check_rdwrlock_value(expected);
+		sanity_check_rdwrlock_read_ready_value(expected);
+		// write-lock bit no longer set, increment by one to obtain read-lock.
+		desired = expected + 1;
+	} while (__atomic_compare_exchange_n(&lock->mutex, &expected, desired, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE) == false);
+	return true;
+}
+
+// Waits for and takes the write-lock after the initial CAS has failed. Shared by the relative and `_until` timed write-locks.
+static inline bool wfe_mutex_rwlock_timedwrlock_wait_until(wfe_mutex_rwlock *lock, uint64_t cycles_deadline, bool low_power) {
+	const uint32_t TOP_BIT = 1U << 31;
+	uint32_t expected;
+	uint32_t desired = TOP_BIT;
+
+	wait_for_value_until_i32_ptr wait_ptr = get_wfe_mutex_wait_for_value_until_i32_ptr();
 	do {
-		// If timed-out then early exit
-		if (!wait_ptr(&lock->mutex, 0, nanoseconds, low_power)) return false;
+		if (!wait_ptr(&lock->mutex, 0, cycles_deadline, low_power)) return false;
 		expected = 0;
-		sanity_check_wrlock_mutex(&lock->mutex);
+		sanity_check_rdwrlock_mutex(&lock->mutex);
 	} while (__atomic_compare_exchange_n(&lock->mutex, &expected, desired, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE) == false);
-
 	return true;
 }
 
-static inline void wfe_mutex_rwlock_rdlock(wfe_mutex_rwlock *lock, bool low_power) {
+static inline bool wfe_mutex_rwlock_timedrdlock_until(wfe_mutex_rwlock *lock, uint64_t cycles_deadline, bool low_power) {
 	sanity_check_rdwrlock_mutex(&lock->mutex);
 
-	// Getting a write-lock is waiting for the top-bit to be zero in the mutex and incrementing the bottom 31-bits.
+	// Getting a read-lock is waiting for the top-bit to be zero in the mutex and incrementing the bottom 31-bits.
 	const uint32_t TOP_BIT = 1U << 31;
 	uint32_t expected = 0;
 	uint32_t desired = expected + 1;
 
 	// Uncontended mutex check.
-	if (__atomic_compare_exchange_n(&lock->mutex, &expected, desired, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) return;
+	if (__atomic_compare_exchange_n(&lock->mutex, &expected, desired, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) return true;
 
 	// Read-only mutex check
 	expected &= ~TOP_BIT;
 	desired = expected + 1;
-	if (__atomic_compare_exchange_n(&lock->mutex, &expected, desired, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) return;
+	if (__atomic_compare_exchange_n(&lock->mutex, &expected, desired, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) return true;
 
-	wait_for_bit_set_i32_ptr wait_ptr = get_wfe_mutex_wait_for_bit_not_set_i32_ptr();
-	do {
-		expected = wait_ptr(&lock->mutex, 31, low_power);
-		sanity_check_rdwrlock_value(expected);
-		sanity_check_rdwrlock_read_ready_value(expected);
-		// write-lock bit no longer set, increment by one to obtain read-lock.
-		desired = expected + 1;
-	} while (__atomic_compare_exchange_n(&lock->mutex, &expected, desired, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE) == false);
+	return wfe_mutex_rwlock_timedrdlock_wait_until(lock, cycles_deadline, low_power);
 }
 
-static inline void wfe_mutex_rwlock_wrlock(wfe_mutex_rwlock *lock, bool low_power) {
+static inline bool wfe_mutex_rwlock_timedrdlock(wfe_mutex_rwlock *lock, uint64_t nanoseconds, bool low_power) {
+	sanity_check_rdwrlock_mutex(&lock->mutex);
+
+	const uint32_t TOP_BIT = 1U << 31;
+	uint32_t expected = 0;
+	uint32_t desired = expected + 1;
+
+	// Uncontended mutex check.
+	if (__atomic_compare_exchange_n(&lock->mutex, &expected, desired, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) return true;
+
+	// Read-only mutex check
+	expected &= ~TOP_BIT;
+	desired = expected + 1;
+	if (__atomic_compare_exchange_n(&lock->mutex, &expected, desired, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) return true;
+
+	// Only read the cycle counter for the deadline once the CASes have failed.
+	return wfe_mutex_rwlock_timedrdlock_wait_until(lock, wfe_mutex_deadline_from_nanoseconds(nanoseconds), low_power);
+}
+
+static inline bool wfe_mutex_rwlock_timedwrlock_until(wfe_mutex_rwlock *lock, uint64_t cycles_deadline, bool low_power) {
 	sanity_check_rdwrlock_mutex(&lock->mutex);
 
 	// Getting a write-lock is waiting for a value of zero in the mutex and then setting the top-bit.
@@ -494,37 +1832,22 @@ static inline void wfe_mutex_rwlock_wrlock(wfe_mutex_rwlock *lock, bool low_powe
 	uint32_t desired = TOP_BIT;
 
 	// Try to CAS immediately.
-	if (__atomic_compare_exchange_n(&lock->mutex, &expected, desired, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) return;
+	if (__atomic_compare_exchange_n(&lock->mutex, &expected, desired, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) return true;
 
-	wait_for_value_i32_ptr wait_ptr = get_wfe_mutex_wait_for_value_i32_ptr();
-	do {
-		wait_ptr(&lock->mutex, 0, low_power);
-		expected = 0;
-		sanity_check_rdwrlock_mutex(&lock->mutex);
-	} while (__atomic_compare_exchange_n(&lock->mutex, &expected, desired, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE) == false);
+	return wfe_mutex_rwlock_timedwrlock_wait_until(lock, cycles_deadline, low_power);
 }
 
-// TODO: Need to implement.
-// static inline bool wfe_mutex_rwlock_timedrdlock(wfe_mutex_rwlock *lock, uint64_t nanoseconds, bool low_power);
-
 static inline bool wfe_mutex_rwlock_timedwrlock(wfe_mutex_rwlock *lock, uint64_t nanoseconds, bool low_power) {
 	sanity_check_rdwrlock_mutex(&lock->mutex);
 
-	// Getting a write-lock is waiting for a value of zero in the mutex and then setting the top-bit.
 	const uint32_t TOP_BIT = 1U << 31;
 	uint32_t expected = 0;
 	uint32_t desired = TOP_BIT;
 
-	// Try to CAS immediately.
+	// Try to CAS immediately, the cycle counter for the deadline is only read once this fails.
 	if (__atomic_compare_exchange_n(&lock->mutex, &expected, desired, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) return true;
 
-	wait_for_value_timeout_i32_ptr wait_ptr = get_wfe_mutex_wait_for_value_timeout_i32_ptr();
-	do {
-		if (!wait_ptr(&lock->mutex, 0, nanoseconds, low_power)) return false;
-		expected = 0;
-		sanity_check_rdwrlock_mutex(&lock->mutex);
-	} while (__atomic_compare_exchange_n(&lock->mutex, &expected, desired, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE) == false);
-	return true;
+	return wfe_mutex_rwlock_timedwrlock_wait_until(lock, wfe_mutex_deadline_from_nanoseconds(nanoseconds), low_power);
 }
 
 static inline bool wfe_mutex_rwlock_trylock(wfe_mutex_rwlock *lock) {
@@ -568,3 +1891,608 @@ static inline void wfe_mutex_rwlock_read_unlock(wfe_mutex_rwlock *lock) {
 	// Unlocked shared is just decrementing 1.
 	__atomic_fetch_sub(&lock->mutex, 1, __ATOMIC_ACQUIRE);
 }
+
+// multiple lock interface
+// Locks several locks at once without deadlocking against other threads locking an overlapping set in a different order.
+#define WFE_MUTEX_LOCK_MANY_LOCK          0 ///< `lock` is a `wfe_mutex_lock`.
+#define WFE_MUTEX_LOCK_MANY_RWLOCK_WRITE  1 ///< `lock` is a `wfe_mutex_rwlock` locked exclusively.
+#define WFE_MUTEX_LOCK_MANY_RWLOCK_READ   2 ///< `lock` is a `wfe_mutex_rwlock` locked shared.
+
+typedef struct {
+	void *lock;
+	uint32_t type;
+} wfe_mutex_lock_many_entry;
+
+static inline void wfe_mutex_lock_many_entry_lock(wfe_mutex_lock_many_entry *entry, bool low_power) {
+	switch (entry->type) {
+		case WFE_MUTEX_LOCK_MANY_LOCK: wfe_mutex_lock_lock((wfe_mutex_lock*)entry->lock, low_power); break;
+		case WFE_MUTEX_LOCK_MANY_RWLOCK_WRITE: wfe_mutex_rwlock_wrlock((wfe_mutex_rwlock*)entry->lock, low_power); break;
+		case WFE_MUTEX_LOCK_MANY_RWLOCK_READ: wfe_mutex_rwlock_rdlock((wfe_mutex_rwlock*)entry->lock, low_power); break;
+	}
+}
+
+static inline bool wfe_mutex_lock_many_entry_trylock(wfe_mutex_lock_many_entry *entry) {
+	switch (entry->type) {
+		case WFE_MUTEX_LOCK_MANY_LOCK: return wfe_mutex_lock_trylock((wfe_mutex_lock*)entry->lock);
+		case WFE_MUTEX_LOCK_MANY_RWLOCK_WRITE: return wfe_mutex_rwlock_trylock((wfe_mutex_rwlock*)entry->lock);
+		case WFE_MUTEX_LOCK_MANY_RWLOCK_READ: return wfe_mutex_rwlock_trylock_shared((wfe_mutex_rwlock*)entry->lock);
+	}
+	return false;
+}
+
+static inline void wfe_mutex_lock_many_entry_unlock(wfe_mutex_lock_many_entry *entry) {
+	switch (entry->type) {
+		case WFE_MUTEX_LOCK_MANY_LOCK: wfe_mutex_lock_unlock((wfe_mutex_lock*)entry->lock); break;
+		case WFE_MUTEX_LOCK_MANY_RWLOCK_WRITE: wfe_mutex_rwlock_unlock((wfe_mutex_rwlock*)entry->lock); break;
+		case WFE_MUTEX_LOCK_MANY_RWLOCK_READ: wfe_mutex_rwlock_read_unlock((wfe_mutex_rwlock*)entry->lock); break;
+	}
+}
+
+///< Locks every entry. Entries are sorted in to address order in place, and each lock may only be listed once.
+/// Blocks on one lock at a time and only trylocks the rest. When a lock is contended, everything is released and the thread
+/// backs off on the contended lock with a single monitor wait before blocking on it first.
+static inline void wfe_mutex_lock_many(wfe_mutex_lock_many_entry *entries, size_t count, bool low_power) {
+	// Insertion sort, lock counts are expected to be tiny.
+	for (size_t i = 1; i < count; ++i) {
+		wfe_mutex_lock_many_entry entry = entries[i];
+		size_t j = i;
+		for (; j > 0 && (uintptr_t)entries[j - 1].lock > (uintptr_t)entry.lock; --j) {
+			entries[j] = entries[j - 1];
+		}
+		entries[j] = entry;
+	}
+
+	wait_for_value_spurious_oneshot_i32_ptr wait_ptr = get_wfe_mutex_wait_for_value_spurious_oneshot_i32_ptr();
+	size_t first = 0;
+
+	while (count) {
+		wfe_mutex_lock_many_entry_lock(&entries[first], low_power);
+
+		size_t failed = count;
+		for (size_t i = 0; i < count; ++i) {
+			if (i == first) continue;
+			if (!wfe_mutex_lock_many_entry_trylock(&entries[i])) {
+				failed = i;
+				break;
+			}
+		}
+
+		if (failed == count) return;
+
+		// Back out everything that was locked.
+		for (size_t i = 0; i < failed; ++i) {
+			if (i == first) continue;
+			wfe_mutex_lock_many_entry_unlock(&entries[i]);
+		}
+		wfe_mutex_lock_many_entry_unlock(&entries[first]);
+
+		// Both lock types are a uint32_t that is zero when unlocked.
+		// A shared entry only needs the writer to leave, which is the top bit of the rwlock.
+		if (entries[failed].type == WFE_MUTEX_LOCK_MANY_RWLOCK_READ) {
+			wfe_mutex_wait_for_bit_not_set_spurious_oneshot_i32((uint32_t*)entries[failed].lock, 31, low_power, 0);
+		}
+		else {
+			wait_ptr((uint32_t*)entries[failed].lock, 0, low_power);
+		}
+		first = failed;
+	}
+}
+
+///< Unlocks every entry locked by `wfe_mutex_lock_many`.
+static inline void wfe_mutex_unlock_many(wfe_mutex_lock_many_entry *entries, size_t count) {
+	for (size_t i = count; i > 0; --i) {
+		wfe_mutex_lock_many_entry_unlock(&entries[i - 1]);
+	}
+}
+
+// flat combining interface
+// Threads publish an operation in to their own publication slot, then either become the combiner or wait for the combiner
+// to execute their operation. The combiner executes every pending operation in a batch, keeping the protected data hot in a single
+// core's cache instead of bouncing the data and the lock between every thread.
+typedef void (*wfe_mutex_flat_combining_op)(void *data, void *arg);
+
+#define WFE_MUTEX_FLAT_COMBINING_SLOT_EMPTY   0
+#define WFE_MUTEX_FLAT_COMBINING_SLOT_PENDING 1
+#define WFE_MUTEX_FLAT_COMBINING_SLOT_DONE    2
+
+typedef struct {
+	// Only word that the publishing thread waits on.
+	uint32_t state;
+	wfe_mutex_flat_combining_op op;
+	// Argument passed to the operation, results are written back through this.
+	void *arg;
+} wfe_mutex_flat_combining_slot;
+
+typedef struct {
+	wfe_mutex_lock combiner;
+	uint32_t slot_count;
+	// Distance between publication slots in bytes, so each slot lives in its own monitor granule.
+	uint32_t slot_stride;
+	void *data;
+	uint8_t *slots;
+} wfe_mutex_flat_combining;
+
+///< Returns the number of bytes each publication slot needs to not share a monitor granule.
+/// Call after `wfe_mutex_init` since it depends on the detected monitor granule size.
+static inline uint32_t wfe_mutex_flat_combining_slot_stride() {
+	uint32_t stride = wfe_mutex_get_features()->monitor_granule_size_bytes_max;
+
+	// Spin-loop implementation doesn't report a granule size, assume a cacheline.
+	if (stride < 64) {
+		stride = 64;
+	}
+
+	while (stride < sizeof(wfe_mutex_flat_combining_slot)) {
+		stride *= 2;
+	}
+
+	return stride;
+}
+
+///< Initializes a flat combining object.
+/// `slots` must be `slot_count * wfe_mutex_flat_combining_slot_stride()` bytes and aligned to the stride.
+/// Each thread using the object needs its own slot index.
+static inline void wfe_mutex_flat_combining_init(wfe_mutex_flat_combining *fc, void *data, void *slots, uint32_t slot_count) {
+	fc->combiner.mutex = 0;
+	fc->slot_count = slot_count;
+	fc->slot_stride = wfe_mutex_flat_combining_slot_stride();
+	fc->data = data;
+	fc->slots = (uint8_t*)slots;
+
+	for (uint32_t i = 0; i < slot_count; ++i) {
+		wfe_mutex_flat_combining_slot *slot = (wfe_mutex_flat_combining_slot*)(fc->slots + i * fc->slot_stride);
+		slot->state = WFE_MUTEX_FLAT_COMBINING_SLOT_EMPTY;
+		slot->op = 0;
+		slot->arg = 0;
+	}
+}
+
+static inline wfe_mutex_flat_combining_slot *wfe_mutex_flat_combining_get_slot(wfe_mutex_flat_combining *fc, uint32_t slot_index) {
+	return (wfe_mutex_flat_combining_slot*)(fc->slots + slot_index * fc->slot_stride);
+}
+
+static inline bool wfe_mutex_flat_combining_try_become_combiner(wfe_mutex_flat_combining *fc) {
+	// Sequentially consistent so a failed attempt is ordered after the slot publication.
+	uint32_t expected = 0;
+	return __atomic_compare_exchange_n(&fc->combiner.mutex, &expected, 1, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+///< Executes all pending operations. Must be called with the combiner lock held, returns with it released.
+static inline void wfe_mutex_flat_combining_combine(wfe_mutex_flat_combining *fc) {
+	while (true) {
+		for (uint32_t i = 0; i < fc->slot_count; ++i) {
+			wfe_mutex_flat_combining_slot *slot = wfe_mutex_flat_combining_get_slot(fc, i);
+			if (__atomic_load_n(&slot->state, __ATOMIC_ACQUIRE) == WFE_MUTEX_FLAT_COMBINING_SLOT_PENDING) {
+				slot->op(fc->data, slot->arg);
+				__atomic_store_n(&slot->state, WFE_MUTEX_FLAT_COMBINING_SLOT_DONE, __ATOMIC_RELEASE);
+			}
+		}
+
+		__atomic_store_n(&fc->combiner.mutex, 0, __ATOMIC_SEQ_CST);
+
+		// A thread may have published after its slot was scanned but failed to become the combiner before the release.
+		// That thread is now waiting on its slot, so the releasing combiner is responsible for picking it up.
+		// If the combiner lock was taken by someone else then that thread's release will do the same check.
+		bool has_pending = false;
+		for (uint32_t i = 0; i < fc->slot_count; ++i) {
+			wfe_mutex_flat_combining_slot *slot = wfe_mutex_flat_combining_get_slot(fc, i);
+			if (__atomic_load_n(&slot->state, __ATOMIC_SEQ_CST) == WFE_MUTEX_FLAT_COMBINING_SLOT_PENDING) {
+				has_pending = true;
+				break;
+			}
+		}
+
+		if (!has_pending || !wfe_mutex_flat_combining_try_become_combiner(fc)) return;
+	}
+}
+
+///< Executes `op(data, arg)` with mutual exclusion against every other operation on this object.
+/// Returns once the operation has executed, either by this thread or by the current combiner.
+static inline void wfe_mutex_flat_combining_execute(wfe_mutex_flat_combining *fc, uint32_t slot_index, wfe_mutex_flat_combining_op op, void *arg, bool low_power) {
+	wfe_mutex_flat_combining_slot *slot = wfe_mutex_flat_combining_get_slot(fc, slot_index);
+	slot->op = op;
+	slot->arg = arg;
+	__atomic_store_n(&slot->state, WFE_MUTEX_FLAT_COMBINING_SLOT_PENDING, __ATOMIC_SEQ_CST);
+
+	if (wfe_mutex_flat_combining_try_become_combiner(fc)) {
+		// Our own operation is executed in the first pass.
+		wfe_mutex_flat_combining_combine(fc);
+	}
+	else {
+		wfe_mutex_wait_for_value_i32(&slot->state, WFE_MUTEX_FLAT_COMBINING_SLOT_DONE, low_power);
+	}
+
+	__atomic_store_n(&slot->state, WFE_MUTEX_FLAT_COMBINING_SLOT_EMPTY, __ATOMIC_RELAXED);
+}
+
+// biased lock interface
+// A lock that is taken almost exclusively by a single "bias owner" thread.
+// The bias owner acquires and releases with plain stores, other threads revoke the bias with a process-wide barrier.
+typedef struct {
+	// Set by the bias owner while it holds the lock through the fast path. Only written by the bias owner.
+	uint32_t owner_locked;
+	// Set by non-owners while they acquire or hold the lock. Forces the bias owner on to the slow path.
+	uint32_t revoked;
+	// Set by the bias owner when it holds the lock through the slow path. Only accessed by the bias owner.
+	uint32_t owner_slow_path;
+	// Bias owner needs a full barrier on the fast path since membarrier isn't available.
+	uint32_t owner_needs_fence;
+	// Serializes non-owners, and the bias owner while the bias is revoked.
+	wfe_mutex_lock lock;
+} wfe_mutex_biased_lock;
+
+// Statically initialized biased locks always fence on the owner path, use `wfe_mutex_biased_lock_init` for the fast path.
+#define WFE_MUTEX_BIASED_LOCK_INITIALIZER \
+{ 0, 0, 0, 1, WFE_MUTEX_LOCK_INITIALIZER }
+
+///< Initializes a biased lock. Call after `wfe_mutex_init` so the owner path can rely on membarrier.
+static inline void wfe_mutex_biased_lock_init(wfe_mutex_biased_lock *lock) {
+	lock->owner_locked = 0;
+	lock->revoked = 0;
+	lock->owner_slow_path = 0;
+	lock->owner_needs_fence = !wfe_mutex_get_features()->supports_membarrier;
+	lock->lock.mutex = 0;
+}
+
+///< Locks the mutex from the bias owner thread. Only one thread may ever use the owner functions on a lock.
+static inline void wfe_mutex_biased_lock_owner_lock(wfe_mutex_biased_lock *lock, bool low_power) {
+	__atomic_store_n(&lock->owner_locked, 1, __ATOMIC_RELAXED);
+
+	// The store must be visible before checking for revocation.
+	// Revoking threads issue a membarrier which provides the full barrier on this thread's behalf.
+	if (lock->owner_needs_fence) {
+		__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	}
+	else {
+		__atomic_signal_fence(__ATOMIC_SEQ_CST);
+	}
+
+	if (__atomic_load_n(&lock->revoked, __ATOMIC_ACQUIRE) == 0) return;
+
+	// Bias is revoked, step back and take the lock like everyone else.
+	__atomic_store_n(&lock->owner_locked, 0, __ATOMIC_RELEASE);
+	wfe_mutex_lock_lock(&lock->lock, low_power);
+	lock->owner_slow_path = 1;
+}
+
+static inline void wfe_mutex_biased_lock_owner_unlock(wfe_mutex_biased_lock *lock) {
+	if (lock->owner_slow_path) {
+		lock->owner_slow_path = 0;
+		wfe_mutex_lock_unlock(&lock->lock);
+		return;
+	}
+
+	// Unlocking is just storing zero.
+	__atomic_store_n(&lock->owner_locked, 0, __ATOMIC_RELEASE);
+}
+
+///< Locks the mutex from any thread that isn't the bias owner.
+static inline void wfe_mutex_biased_lock_lock(wfe_mutex_biased_lock *lock, bool low_power) {
+	wfe_mutex_lock_lock(&lock->lock, low_power);
+
+	// Revoke the bias, then wait for the bias owner to leave its critical section.
+	// After the membarrier either the owner has observed the revocation, or its owner_locked store is visible here.
+	__atomic_store_n(&lock->revoked, 1, __ATOMIC_SEQ_CST);
+	wfe_mutex_membarrier();
+	wfe_mutex_wait_for_value_i32(&lock->owner_locked, 0, low_power);
+}
+
+static inline void wfe_mutex_biased_lock_unlock(wfe_mutex_biased_lock *lock) {
+	__atomic_store_n(&lock->revoked, 0, __ATOMIC_RELEASE);
+	wfe_mutex_lock_unlock(&lock->lock);
+}
+
+// time-published queue lock interface
+// A FIFO queue lock that tolerates preempted waiters. Waiters periodically publish a cycle counter timestamp while they wait.
+// On unlock, waiters whose timestamp looks stale are assumed to be descheduled and are skipped, they rejoin the back of the queue.
+#define WFE_MUTEX_QUEUE_LOCK_NODE_WAITING 0
+#define WFE_MUTEX_QUEUE_LOCK_NODE_GRANTED 1
+#define WFE_MUTEX_QUEUE_LOCK_NODE_SKIPPED 2
+
+///< Default time without a published timestamp before a waiter is considered preempted.
+#define WFE_MUTEX_QUEUE_LOCK_DEFAULT_PATIENCE_NANOSECONDS 1000000ULL
+
+typedef struct wfe_mutex_queue_lock_node {
+	struct wfe_mutex_queue_lock_node *next;
+	// Last cycle counter published by the waiting thread.
+	uint64_t time;
+	// Only word that the waiting thread waits on.
+	uint32_t state;
+} wfe_mutex_queue_lock_node;
+
+typedef struct {
+	wfe_mutex_queue_lock_node *tail;
+	// Waiters publish their timestamp four times per patience period.
+	uint64_t patience_nanoseconds;
+} wfe_mutex_queue_lock;
+
+#define WFE_MUTEX_QUEUE_LOCK_INITIALIZER \
+{ 0, WFE_MUTEX_QUEUE_LOCK_DEFAULT_PATIENCE_NANOSECONDS }
+
+///< Locks the mutex. `node` is owned by the lock until the matching unlock and is passed to it.
+/// For optimal monitor usage nodes should not share monitor granules.
+static inline void wfe_mutex_queue_lock_lock(wfe_mutex_queue_lock *lock, wfe_mutex_queue_lock_node *node, bool low_power) {
+	const uint64_t publish_interval = lock->patience_nanoseconds / 4;
+
+	while (true) {
+		__atomic_store_n(&node->next, 0, __ATOMIC_RELAXED);
+		__atomic_store_n(&node->time, wfe_mutex_read_cycle_counter(), __ATOMIC_RELAXED);
+		__atomic_store_n(&node->state, WFE_MUTEX_QUEUE_LOCK_NODE_WAITING, __ATOMIC_RELAXED);
+
+		wfe_mutex_queue_lock_node *pred = __atomic_exchange_n(&lock->tail, node, __ATOMIC_ACQ_REL);
+
+		// Uncontended
+		if (!pred) return;
+
+		__atomic_store_n(&pred->next, node, __ATOMIC_RELEASE);
+
+		// Wait for the handoff or the skip, publishing that this thread is still running each time the wait times out.
+		uint32_t state;
+		while ((state = __atomic_load_n(&node->state, __ATOMIC_ACQUIRE)) == WFE_MUTEX_QUEUE_LOCK_NODE_WAITING) {
+			__atomic_store_n(&node->time, wfe_mutex_read_cycle_counter(), __ATOMIC_RELAXED);
+			wfe_mutex_wait_for_any_bit_set_timeout_i32(&node->state,
+				WFE_MUTEX_QUEUE_LOCK_NODE_GRANTED | WFE_MUTEX_QUEUE_LOCK_NODE_SKIPPED, publish_interval, low_power, 0);
+		}
+
+		if (state == WFE_MUTEX_QUEUE_LOCK_NODE_GRANTED) return;
+
+		// Skipped as preempted. The unlocking thread is done with the node, rejoin the queue.
+	}
+}
+
+static inline bool wfe_mutex_queue_lock_trylock(wfe_mutex_queue_lock *lock, wfe_mutex_queue_lock_node *node) {
+	node->next = 0;
+	node->time = wfe_mutex_read_cycle_counter();
+	node->state = WFE_MUTEX_QUEUE_LOCK_NODE_WAITING;
+
+	wfe_mutex_queue_lock_node *expected = 0;
+	return __atomic_compare_exchange_n(&lock->tail, &expected, node, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}
+
+static inline void wfe_mutex_queue_lock_unlock(wfe_mutex_queue_lock *lock, wfe_mutex_queue_lock_node *node) {
+	const uint64_t patience_cycles = wfe_mutex_calculate_cycles_for_nanoseconds(lock->patience_nanoseconds);
+	wfe_mutex_queue_lock_node *current = node;
+
+	while (true) {
+		wfe_mutex_queue_lock_node *next = __atomic_load_n(&current->next, __ATOMIC_ACQUIRE);
+		if (!next) {
+			// No known successor, try to release the lock.
+			wfe_mutex_queue_lock_node *expected = current;
+			if (__atomic_compare_exchange_n(&lock->tail, &expected, 0, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+				if (current != node) {
+					__atomic_store_n(&current->state, WFE_MUTEX_QUEUE_LOCK_NODE_SKIPPED, __ATOMIC_RELEASE);
+				}
+				return;
+			}
+
+			// A successor is between swapping the tail and linking itself, this is only a few instructions.
+			while ((next = __atomic_load_n(&current->next, __ATOMIC_ACQUIRE)) == 0);
+		}
+
+		if (current != node) {
+			// Last access of a skipped node, its owner is free to rejoin the queue after this.
+			__atomic_store_n(&current->state, WFE_MUTEX_QUEUE_LOCK_NODE_SKIPPED, __ATOMIC_RELEASE);
+		}
+
+		// Hand off to the successor if it published recently.
+		const int64_t since_published = (int64_t)(wfe_mutex_read_cycle_counter() - __atomic_load_n(&next->time, __ATOMIC_RELAXED));
+		if (since_published <= (int64_t)patience_cycles) {
+			__atomic_store_n(&next->state, WFE_MUTEX_QUEUE_LOCK_NODE_GRANTED, __ATOMIC_RELEASE);
+			return;
+		}
+
+		current = next;
+	}
+}
+
+// eventcount interface
+// Lets consumers of lock-free structures sleep until a producer makes progress, without missing wakeups.
+// Consumer:
+//   key = prepare_wait; if the condition is now true: cancel_wait; otherwise: commit_wait(key)
+// Producer:
+//   make the condition true; notify_{one,all}
+typedef struct {
+	// Incremented on every notify that has waiters.
+	uint32_t epoch;
+	// Number of threads between prepare_wait and commit_wait/cancel_wait.
+	uint32_t waiters;
+} wfe_mutex_eventcount;
+
+#define WFE_MUTEX_EVENTCOUNT_INITIALIZER \
+{ 0, 0 }
+
+///< Registers the thread as a waiter. Returns the key to pass to commit_wait.
+/// The caller must re-check its condition after this before committing to the wait.
+static inline uint32_t wfe_mutex_eventcount_prepare_wait(wfe_mutex_eventcount *ec) {
+	__atomic_fetch_add(&ec->waiters, 1, __ATOMIC_SEQ_CST);
+	return __atomic_load_n(&ec->epoch, __ATOMIC_SEQ_CST);
+}
+
+///< Unregisters the thread as a waiter when the re-checked condition was already true.
+static inline void wfe_mutex_eventcount_cancel_wait(wfe_mutex_eventcount *ec) {
+	__atomic_fetch_sub(&ec->waiters, 1, __ATOMIC_RELAXED);
+}
+
+///< Waits until a notify happens after the matching prepare_wait, then unregisters the thread as a waiter.
+static inline void wfe_mutex_eventcount_commit_wait(wfe_mutex_eventcount *ec, uint32_t key, bool low_power) {
+	// Multiple notifies can advance the epoch past key + 1, so wait for any change instead of an exact value.
+	wfe_mutex_wait_for_change_i32(&ec->epoch, key, low_power);
+
+	__atomic_fetch_sub(&ec->waiters, 1, __ATOMIC_RELAXED);
+}
+
+///< Wakes every waiting thread. Only a load when there are no waiters.
+static inline void wfe_mutex_eventcount_notify_all(wfe_mutex_eventcount *ec) {
+	// Order the producer's condition update before checking for waiters, pairs with prepare_wait.
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&ec->waiters, __ATOMIC_RELAXED) == 0) return;
+
+	__atomic_fetch_add(&ec->epoch, 1, __ATOMIC_RELEASE);
+}
+
+///< Wakes at least one waiting thread.
+/// Monitor based waits can't target a single waiter, so this is the same as notify_all.
+static inline void wfe_mutex_eventcount_notify_one(wfe_mutex_eventcount *ec) {
+	wfe_mutex_eventcount_notify_all(ec);
+}
+
+// doorbell interface
+// Up to 64 producers signal one consumer. The consumer arms the monitor once for the whole block
+// and a vector compare finds every rung flag when it wakes.
+// Producer:
+//   publish work; ring(index)
+// Consumer:
+//   mask = wfe_mutex_doorbell_wait; handle every set bit in mask
+#define WFE_MUTEX_DOORBELL_INITIALIZER \
+{ { 0 } }
+
+///< Returns how many flags fit in the detected monitor granule.
+/// Producers should only use flags below this so a single monitor arm observes all of them.
+/// Call after `wfe_mutex_init` since it depends on the detected monitor granule size.
+static inline uint32_t wfe_mutex_doorbell_flag_count() {
+	uint32_t granule = wfe_mutex_get_features()->monitor_granule_size_bytes_min;
+
+	// Spin-loop implementation doesn't report a granule size, every flag is polled.
+	if (granule == 0 || granule > WFE_MUTEX_DOORBELL_FLAGS) return WFE_MUTEX_DOORBELL_FLAGS;
+	return granule;
+}
+
+///< Sets the producer's flag, waking the consumer.
+static inline void wfe_mutex_doorbell_ring(wfe_mutex_doorbell *doorbell, uint32_t index) {
+	__atomic_store_n(&doorbell->flags[index], 1, __ATOMIC_RELEASE);
+}
+
+// cancel token interface
+// Lets shutdown and cancellation paths interrupt a thread blocked in a wait or lock.
+// Waiters wait on both the word and the token through `wfe_mutex_wait_any`.
+// Placing the token in the same monitor granule as the waited on word lets a single monitor arm observe both,
+// otherwise the token is observed as late as a store to an unarmed `wfe_mutex_wait_any` word.
+typedef struct {
+	uint32_t cancelled;
+} wfe_mutex_cancel_token;
+
+#define WFE_MUTEX_CANCEL_TOKEN_INITIALIZER \
+{ 0 }
+
+///< Cancels every wait and lock attempt using the token, current and future, until reset.
+static inline void wfe_mutex_cancel_token_cancel(wfe_mutex_cancel_token *token) {
+	__atomic_store_n(&token->cancelled, 1, __ATOMIC_RELEASE);
+}
+
+static inline void wfe_mutex_cancel_token_reset(wfe_mutex_cancel_token *token) {
+	__atomic_store_n(&token->cancelled, 0, __ATOMIC_RELEASE);
+}
+
+static inline bool wfe_mutex_cancel_token_is_cancelled(wfe_mutex_cancel_token *token) {
+	return __atomic_load_n(&token->cancelled, __ATOMIC_ACQUIRE) != 0;
+}
+
+static inline wfe_mutex_wait_desc wfe_mutex_cancel_token_desc(wfe_mutex_cancel_token *token) {
+	wfe_mutex_wait_desc desc = { &token->cancelled, 0, sizeof(token->cancelled), WFE_MUTEX_WAIT_DESC_NOT_EQUAL };
+	return desc;
+}
+
+///< Cancellable waits return true once the value matches and false if the token was cancelled first.
+
+static inline bool wfe_mutex_wait_for_value_cancellable_i8(uint8_t *ptr,  uint8_t value, wfe_mutex_cancel_token *token, bool low_power) {
+	wfe_mutex_wait_desc descs[2] = {
+		{ ptr, value, sizeof(*ptr), WFE_MUTEX_WAIT_DESC_EQUAL },
+		wfe_mutex_cancel_token_desc(token),
+	};
+	return wfe_mutex_wait_any(descs, 2, low_power) == 0;
+}
+
+static inline bool wfe_mutex_wait_for_value_cancellable_i16(uint16_t *ptr, uint16_t value, wfe_mutex_cancel_token *token, bool low_power) {
+	wfe_mutex_wait_desc descs[2] = {
+		{ ptr, value, sizeof(*ptr), WFE_MUTEX_WAIT_DESC_EQUAL },
+		wfe_mutex_cancel_token_desc(token),
+	};
+	return wfe_mutex_wait_any(descs, 2, low_power) == 0;
+}
+
+static inline bool wfe_mutex_wait_for_value_cancellable_i32(uint32_t *ptr, uint32_t value, wfe_mutex_cancel_token *token, bool low_power) {
+	wfe_mutex_wait_desc descs[2] = {
+		{ ptr, value, sizeof(*ptr), WFE_MUTEX_WAIT_DESC_EQUAL },
+		wfe_mutex_cancel_token_desc(token),
+	};
+	return wfe_mutex_wait_any(descs, 2, low_power) == 0;
+}
+
+static inline bool wfe_mutex_wait_for_value_cancellable_i64(uint64_t *ptr, uint64_t value, wfe_mutex_cancel_token *token, bool low_power) {
+	wfe_mutex_wait_desc descs[2] = {
+		{ ptr, value, sizeof(*ptr), WFE_MUTEX_WAIT_DESC_EQUAL },
+		wfe_mutex_cancel_token_desc(token),
+	};
+	return wfe_mutex_wait_any(descs, 2, low_power) == 0;
+}
+
+///< Returns true if the lock was acquired and false if the token was cancelled first.
+static inline bool wfe_mutex_lock_lock_cancellable(wfe_mutex_lock *lock, wfe_mutex_cancel_token *token, bool low_power) {
+	uint32_t expected = 0;
+	uint32_t desired = 1;
+
+	sanity_check_wrlock_mutex(&lock->mutex);
+
+	// Try to CAS immediately.
+	if (__atomic_compare_exchange_n(&lock->mutex, &expected, desired, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) return true;
+
+	do {
+		if (!wfe_mutex_wait_for_value_cancellable_i32(&lock->mutex, 0, token, low_power)) return false;
+		expected = 0;
+		sanity_check_wrlock_mutex(&lock->mutex);
+	} while (__atomic_compare_exchange_n(&lock->mutex, &expected, desired, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE) == false);
+
+	return true;
+}
+
+///< Returns true if the read-lock was acquired and false if the token was cancelled first.
+static inline bool wfe_mutex_rwlock_rdlock_cancellable(wfe_mutex_rwlock *lock, wfe_mutex_cancel_token *token, bool low_power) {
+	sanity_check_rdwrlock_mutex(&lock->mutex);
+
+	// Getting a read-lock is waiting for the top-bit to be zero in the mutex and incrementing the bottom 31-bits.
+	const uint32_t TOP_BIT = 1U << 31;
+	uint32_t expected = 0;
+	uint32_t desired = expected + 1;
+
+	// Uncontended mutex check.
+	if (__atomic_compare_exchange_n(&lock->mutex, &expected, desired, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) return true;
+
+	// Read-only mutex check
+	expected &= ~TOP_BIT;
+	desired = expected + 1;
+	if (__atomic_compare_exchange_n(&lock->mutex, &expected, desired, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) return true;
+
+	wfe_mutex_wait_desc descs[2] = {
+		{ &lock->mutex, TOP_BIT, sizeof(lock->mutex), WFE_MUTEX_WAIT_DESC_ANY_BIT_NOT_SET },
+		wfe_mutex_cancel_token_desc(token),
+	};
+
+	do {
+		if (wfe_mutex_wait_any(descs, 2, low_power) != 0) return false;
+		expected = __atomic_load_n(&lock->mutex, __ATOMIC_ACQUIRE) & ~TOP_BIT;
+		sanity_check_rdwrlock_value(expected);
+		// write-lock bit no longer set, increment by one to obtain read-lock.
+		desired = expected + 1;
+	} while (__atomic_compare_exchange_n(&lock->mutex, &expected, desired, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE) == false);
+	return true;
+}
+
+///< Returns true if the write-lock was acquired and false if the token was cancelled first.
+static inline bool wfe_mutex_rwlock_wrlock_cancellable(wfe_mutex_rwlock *lock, wfe_mutex_cancel_token *token, bool low_power) {
+	sanity_check_rdwrlock_mutex(&lock->mutex);
+
+	// Getting a write-lock is waiting for a value of zero in the mutex and then setting the top-bit.
+	const uint32_t TOP_BIT = 1U << 31;
+	uint32_t expected = 0;
+	uint32_t desired = TOP_BIT;
+
+	// Try to CAS immediately.
+	if (__atomic_compare_exchange_n(&lock->mutex, &expected, desired, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) return true;
+
+	do {
+		if (!wfe_mutex_wait_for_value_cancellable_i32(&lock->mutex, 0, token, low_power)) return false;
+		expected = 0;
+		sanity_check_rdwrlock_mutex(&lock->mutex);
+	} while (__atomic_compare_exchange_n(&lock->mutex, &expected, desired, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE) == false);
+	return true;
+}
@@ -1,6 +1,14 @@
 #pragma once
 #include <wfe_mutex/wfe_mutex.h>
 
+#ifdef __cplusplus
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#endif
+
 #ifdef __cplusplus
 namespace wfe_mutex {
 	template<bool low_power>
@@ -66,6 +74,193 @@ namespace wfe_mutex {
 		private:
 			native_handle_type mut = WFE_MUTEX_RWLOCK_INITIALIZER;
 	};
+
+	// Marks a shared_mutex to be locked in shared mode by scoped_lock.
+	template<bool low_power>
+	struct shared_lock_tag final {
+		shared_mutex<low_power> &mut;
+	};
+
+	template<bool low_power>
+	shared_lock_tag<low_power> shared(shared_mutex<low_power> &mut) {
+		return {mut};
+	}
+
+	namespace detail {
+		template<bool low_power>
+		wfe_mutex_lock_many_entry make_lock_many_entry(mutex<low_power> &mut) {
+			return {&mut.native_handle(), WFE_MUTEX_LOCK_MANY_LOCK};
+		}
+
+		template<bool low_power>
+		wfe_mutex_lock_many_entry make_lock_many_entry(shared_mutex<low_power> &mut) {
+			return {&mut.native_handle(), WFE_MUTEX_LOCK_MANY_RWLOCK_WRITE};
+		}
+
+		template<bool low_power>
+		wfe_mutex_lock_many_entry make_lock_many_entry(shared_lock_tag<low_power> tag) {
+			return {&tag.mut.native_handle(), WFE_MUTEX_LOCK_MANY_RWLOCK_READ};
+		}
+
+		template<bool low_power>
+		constexpr bool is_low_power(const mutex<low_power>&) { return low_power; }
+		template<bool low_power>
+		constexpr bool is_low_power(const shared_mutex<low_power>&) { return low_power; }
+		template<bool low_power>
+		constexpr bool is_low_power(const shared_lock_tag<low_power>&) { return low_power; }
+	}
+
+	// Deadlock-free lock of multiple mutexes using wfe_mutex_lock_many.
+	// eg: `wfe_mutex::scoped_lock lk {mutex_a, shared_mutex_b, wfe_mutex::shared(shared_mutex_c)};`
+	// Waits in low power mode if any of the mutexes are low power.
+	template<size_t N>
+	class scoped_lock final {
+		public:
+			static_assert(N > 0, "scoped_lock needs at least one mutex");
+
+			template<typename... Locks>
+			explicit scoped_lock(Locks&&... locks)
+				: entries {detail::make_lock_many_entry(std::forward<Locks>(locks))...} {
+				wfe_mutex_lock_many(entries, N, (detail::is_low_power(locks) || ...));
+			}
+
+			scoped_lock(const scoped_lock&) = delete;
+			scoped_lock& operator=(const scoped_lock&) = delete;
+
+			~scoped_lock() {
+				wfe_mutex_unlock_many(entries, N);
+			}
+
+		private:
+			wfe_mutex_lock_many_entry entries[N];
+	};
+
+	template<typename... Locks>
+	scoped_lock(Locks&&...) -> scoped_lock<sizeof...(Locks)>;
+
+	// std::atomic-like wrapper whose wait uses wfe_mutex_wait_for_change instead of futex.
+	// Monitor based waits wake on the store itself, so notify_one/notify_all don't wake anything.
+	// Unlike std::atomic a store alone wakes waiters, and a waiter is never woken by notify without a change in value.
+	template<typename T, bool low_power = false>
+	class atomic final {
+		public:
+			static_assert(std::is_trivially_copyable_v<T>, "wfe_mutex::atomic requires a trivially copyable type");
+			static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8, "wfe_mutex::atomic requires an 8, 16, 32 or 64-bit type");
+
+			constexpr atomic() noexcept = default;
+			constexpr atomic(T desired) noexcept : value {desired} {}
+			atomic(const atomic&) = delete;
+			atomic& operator=(const atomic&) = delete;
+
+			T load(std::memory_order order = std::memory_order_seq_cst) const noexcept {
+				return __atomic_load_n(&value, to_builtin_order(order));
+			}
+
+			void store(T desired, std::memory_order order = std::memory_order_seq_cst) noexcept {
+				__atomic_store_n(&value, desired, to_builtin_order(order));
+			}
+
+			T exchange(T desired, std::memory_order order = std::memory_order_seq_cst) noexcept {
+				return __atomic_exchange_n(&value, desired, to_builtin_order(order));
+			}
+
+			bool compare_exchange_weak(T &expected, T desired, std::memory_order success, std::memory_order failure) noexcept {
+				return __atomic_compare_exchange_n(&value, &expected, desired, true, to_builtin_order(success), to_builtin_order(failure));
+			}
+
+			bool compare_exchange_weak(T &expected, T desired, std::memory_order order = std::memory_order_seq_cst) noexcept {
+				return compare_exchange_weak(expected, desired, order, to_failure_order(order));
+			}
+
+			bool compare_exchange_strong(T &expected, T desired, std::memory_order success, std::memory_order failure) noexcept {
+				return __atomic_compare_exchange_n(&value, &expected, desired, false, to_builtin_order(success), to_builtin_order(failure));
+			}
+
+			bool compare_exchange_strong(T &expected, T desired, std::memory_order order = std::memory_order_seq_cst) noexcept {
+				return compare_exchange_strong(expected, desired, order, to_failure_order(order));
+			}
+
+			T fetch_add(T arg, std::memory_order order = std::memory_order_seq_cst) noexcept {
+				return __atomic_fetch_add(&value, arg, to_builtin_order(order));
+			}
+
+			T fetch_sub(T arg, std::memory_order order = std::memory_order_seq_cst) noexcept {
+				return __atomic_fetch_sub(&value, arg, to_builtin_order(order));
+			}
+
+			operator T() const noexcept {
+				return load();
+			}
+
+			T operator=(T desired) noexcept {
+				store(desired);
+				return desired;
+			}
+
+			///< Waits until the value differs from `old`. Returns the new value.
+			/// The wait always observes the new value with acquire semantics or stronger, `order` is accepted for std::atomic compatibility.
+			T wait(T old, std::memory_order order = std::memory_order_seq_cst) const noexcept {
+				(void)order;
+				if constexpr (sizeof(T) == 1) {
+					return from_bits(wfe_mutex_wait_for_change_i8(ptr<uint8_t>(), to_bits<uint8_t>(old), low_power));
+				}
+				else if constexpr (sizeof(T) == 2) {
+					return from_bits(wfe_mutex_wait_for_change_i16(ptr<uint16_t>(), to_bits<uint16_t>(old), low_power));
+				}
+				else if constexpr (sizeof(T) == 4) {
+					return from_bits(wfe_mutex_wait_for_change_i32(ptr<uint32_t>(), to_bits<uint32_t>(old), low_power));
+				}
+				else {
+					return from_bits(wfe_mutex_wait_for_change_i64(ptr<uint64_t>(), to_bits<uint64_t>(old), low_power));
+				}
+			}
+
+			///< Doesn't wake anything. Waiters already wake on the store that changed the value.
+			void notify_one() noexcept {}
+			void notify_all() noexcept {}
+
+		private:
+			alignas(sizeof(T)) T value {};
+
+			static constexpr int to_builtin_order(std::memory_order order) noexcept {
+				switch (order) {
+					case std::memory_order_relaxed: return __ATOMIC_RELAXED;
+					case std::memory_order_consume: return __ATOMIC_CONSUME;
+					case std::memory_order_acquire: return __ATOMIC_ACQUIRE;
+					case std::memory_order_release: return __ATOMIC_RELEASE;
+					case std::memory_order_acq_rel: return __ATOMIC_ACQ_REL;
+					default: return __ATOMIC_SEQ_CST;
+				}
+			}
+
+			// A failed compare exchange only loads, so it can't have release semantics.
+			static constexpr std::memory_order to_failure_order(std::memory_order order) noexcept {
+				switch (order) {
+					case std::memory_order_release: return std::memory_order_relaxed;
+					case std::memory_order_acq_rel: return std::memory_order_acquire;
+					default: return order;
+				}
+			}
+
+			template<typename U>
+			U *ptr() const noexcept {
+				return reinterpret_cast<U*>(const_cast<T*>(&value));
+			}
+
+			template<typename U>
+			static U to_bits(T val) noexcept {
+				U bits;
+				memcpy(&bits, &val, sizeof(T));
+				return bits;
+			}
+
+			template<typename U>
+			static T from_bits(U bits) noexcept {
+				T val;
+				memcpy(&val, &bits, sizeof(T));
+				return val;
+			}
+	};
 }
 
 #endif
@@ -0,0 +1,78 @@
+#include "microbench.h"
+
+#include <pthread.h>
+#include <thread>
+
+int main() {
+	size_t Count = CalculateDesiredSpinCount();
+	constexpr size_t IterationCount = 5;
+
+	wfe_mutex_init();
+
+	fprintf(stderr, "Wait implementation:         %s\n", get_wait_type_name(wfe_mutex_get_features()->wait_type));
+	fprintf(stderr, "Supports membarrier:         %d\n", wfe_mutex_get_features()->supports_membarrier);
+
+	// Spin a thread that does nothing to ensure pthreads doesn't hit specialized non-threaded mutex case.
+	std::thread t(Thread);
+	t.join();
+
+	{
+		fprintf(stderr, "biased lock - owner lock\n");
+		for (size_t j = 0; j < IterationCount; ++j) {
+			wfe_mutex_biased_lock lock;
+			wfe_mutex_biased_lock_init(&lock);
+			Benchmark (Count, [&lock]() {
+				wfe_mutex_biased_lock_owner_lock(&lock, false);
+				wfe_mutex_biased_lock_owner_unlock(&lock);
+			});
+		}
+	}
+
+	{
+		fprintf(stderr, "biased lock - owner lock - fenced\n");
+		for (size_t j = 0; j < IterationCount; ++j) {
+			wfe_mutex_biased_lock lock = WFE_MUTEX_BIASED_LOCK_INITIALIZER;
+			Benchmark (Count, [&lock]() {
+				wfe_mutex_biased_lock_owner_lock(&lock, false);
+				wfe_mutex_biased_lock_owner_unlock(&lock);
+			});
+		}
+	}
+
+	{
+		fprintf(stderr, "mutex - unique lock\n");
+		for (size_t j = 0; j < IterationCount; ++j) {
+			wfe_mutex_lock lock = WFE_MUTEX_LOCK_INITIALIZER;
+			Benchmark (Count, [&lock]() {
+				wfe_mutex_lock_lock(&lock, false);
+				wfe_mutex_lock_unlock(&lock);
+			});
+		}
+	}
+
+	{
+		fprintf(stderr, "pthread mutex - unique lock\n");
+		for (size_t j = 0; j < IterationCount; ++j) {
+			pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+			Benchmark (Count, [&lock]() {
+				while (pthread_mutex_lock(&lock) != 0);
+				pthread_mutex_unlock(&lock);
+			});
+		}
+	}
+
+	{
+		// Revoking the bias requires a membarrier per lock, this is expected to be slow.
+		fprintf(stderr, "biased lock - non-owner lock\n");
+		for (size_t j = 0; j < IterationCount; ++j) {
+			wfe_mutex_biased_lock lock;
+			wfe_mutex_biased_lock_init(&lock);
+			Benchmark (Count / 100, [&lock]() {
+				wfe_mutex_biased_lock_lock(&lock, false);
+				wfe_mutex_biased_lock_unlock(&lock);
+			});
+		}
+	}
+
+	return 0;
+}
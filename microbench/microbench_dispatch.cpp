@@ -0,0 +1,73 @@
+#include "microbench.h"
+
+#include <stdio.h>
+
+// Measures the cost of reaching a backend function. Every wait is already satisfied so it returns immediately,
+// leaving only the call overhead.
+int main() {
+	size_t Count = CalculateDesiredSpinCount();
+	constexpr size_t IterationCount = 5;
+
+	wfe_mutex_init();
+
+	fprintf(stderr, "Wait implementation:         %s\n", get_wait_type_name(wfe_mutex_get_features()->wait_type));
+#if defined(WFE_MUTEX_STATIC_BACKEND)
+	fprintf(stderr, "Static backend:              yes\n");
+#else
+	fprintf(stderr, "Static backend:              no\n");
+#endif
+
+	{
+		fprintf(stderr, "wait_for_value_i32 - header wrapper\n");
+		for (size_t j = 0; j < IterationCount; ++j) {
+			uint32_t value = 0;
+			Benchmark (Count, [&value]() {
+				wfe_mutex_wait_for_value_i32(&value, 0, false);
+			});
+		}
+	}
+
+	{
+		fprintf(stderr, "wait_for_value_i32 - features lookup per call\n");
+		for (size_t j = 0; j < IterationCount; ++j) {
+			uint32_t value = 0;
+			Benchmark (Count, [&value]() {
+				wfe_mutex_get_features()->wait_for_value_i32(&value, 0, false);
+			});
+		}
+	}
+
+	{
+		fprintf(stderr, "wait_for_value_i32 - cached function pointer\n");
+		for (size_t j = 0; j < IterationCount; ++j) {
+			uint32_t value = 0;
+			wait_for_value_i32_ptr wait = wfe_mutex_get_features()->wait_for_value_i32;
+			Benchmark (Count, [&value, wait]() {
+				wait(&value, 0, false);
+			});
+		}
+	}
+
+	{
+		fprintf(stderr, "mutex - unique lock\n");
+		for (size_t j = 0; j < IterationCount; ++j) {
+			wfe_mutex_lock lock = WFE_MUTEX_LOCK_INITIALIZER;
+			Benchmark (Count, [&lock]() {
+				wfe_mutex_lock_lock(&lock, false);
+				wfe_mutex_lock_unlock(&lock);
+			});
+		}
+	}
+
+	{
+		fprintf(stderr, "mutex - unique lock through a pinned backend handle\n");
+		const wfe_mutex_backend *backend = wfe_mutex_get_backend(wfe_mutex_get_features()->backend);
+		for (size_t j = 0; j < IterationCount; ++j) {
+			wfe_mutex_lock lock = WFE_MUTEX_LOCK_INITIALIZER;
+			Benchmark (Count, [&lock, backend]() {
+				wfe_mutex_lock_lock_backend(&lock, backend, false);
+				wfe_mutex_lock_unlock(&lock);
+			});
+		}
+	}
+}
@@ -0,0 +1,108 @@
+#include "microbench.h"
+
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <pthread.h>
+#include <stdlib.h>
+#include <thread>
+#include <vector>
+
+// Ensure the shared data is worst-case far away from the locks.
+__attribute__((aligned(2048)))
+static uint64_t Counter{};
+
+__attribute__((aligned(2048)))
+static wfe_mutex_lock mutex_lock = WFE_MUTEX_LOCK_INITIALIZER;
+
+__attribute__((aligned(2048)))
+static pthread_mutex_t pthread_lock = PTHREAD_MUTEX_INITIALIZER;
+
+__attribute__((aligned(2048)))
+static wfe_mutex_flat_combining flat_combining;
+
+__attribute__((aligned(2048)))
+static std::atomic<uint32_t> Ready{};
+
+static void increment_op(void *data, void *arg) {
+	++*reinterpret_cast<uint64_t*>(data);
+}
+
+template<typename F>
+void RunContended(const char *Name, size_t ThreadCount, size_t IncrementsPerThread, F&& ThreadFunc) {
+	Counter = 0;
+	Ready = 0;
+
+	std::vector<std::thread> Threads;
+	for (size_t i = 0; i < ThreadCount; ++i) {
+		Threads.emplace_back([&ThreadFunc, i, IncrementsPerThread]() {
+			while (Ready.load() == 0);
+			ThreadFunc(i, IncrementsPerThread);
+		});
+	}
+
+	const auto Begin = std::chrono::high_resolution_clock::now();
+	Ready.store(1);
+	for (auto &t : Threads) {
+		t.join();
+	}
+	const auto End = std::chrono::high_resolution_clock::now();
+	const auto Diff = std::chrono::duration_cast<std::chrono::nanoseconds>(End - Begin).count();
+
+	const double OpsPerSecond = (double)(ThreadCount * IncrementsPerThread) / ((double)Diff / 1'000'000'000.0);
+	fprintf(stderr, "%s: %zu threads, counter %" PRIu64 ", %lf ops/second\n", Name, ThreadCount, Counter, OpsPerSecond);
+}
+
+int main(int argc, char **argv) {
+	wfe_mutex_init();
+
+	fprintf(stderr, "Wait implementation:         %s\n", get_wait_type_name(wfe_mutex_get_features()->wait_type));
+	fprintf(stderr, "Monitor granule size max:    %d\n", wfe_mutex_get_features()->monitor_granule_size_bytes_max);
+
+	size_t ThreadCount = std::thread::hardware_concurrency();
+	if (argc >= 2) {
+		ThreadCount = strtoul(argv[1], nullptr, 0);
+	}
+	if (ThreadCount < 2) {
+		ThreadCount = 2;
+	}
+
+	constexpr size_t IncrementsPerThread = 1'000'000;
+	constexpr size_t IterationCount = 5;
+
+	const uint32_t Stride = wfe_mutex_flat_combining_slot_stride();
+	void *Slots = aligned_alloc(Stride, Stride * ThreadCount);
+	wfe_mutex_flat_combining_init(&flat_combining, &Counter, Slots, ThreadCount);
+	fprintf(stderr, "Flat combining slot stride:  %d\n", Stride);
+
+	for (size_t j = 0; j < IterationCount; ++j) {
+		RunContended("flat_combining", ThreadCount, IncrementsPerThread, [](size_t ThreadIndex, size_t Increments) {
+			for (size_t i = 0; i < Increments; ++i) {
+				wfe_mutex_flat_combining_execute(&flat_combining, ThreadIndex, increment_op, nullptr, false);
+			}
+		});
+	}
+
+	for (size_t j = 0; j < IterationCount; ++j) {
+		RunContended("wfe_mutex_lock", ThreadCount, IncrementsPerThread, [](size_t ThreadIndex, size_t Increments) {
+			for (size_t i = 0; i < Increments; ++i) {
+				wfe_mutex_lock_lock(&mutex_lock, false);
+				++Counter;
+				wfe_mutex_lock_unlock(&mutex_lock);
+			}
+		});
+	}
+
+	for (size_t j = 0; j < IterationCount; ++j) {
+		RunContended("pthread_mutex", ThreadCount, IncrementsPerThread, [](size_t ThreadIndex, size_t Increments) {
+			for (size_t i = 0; i < Increments; ++i) {
+				pthread_mutex_lock(&pthread_lock);
+				++Counter;
+				pthread_mutex_unlock(&pthread_lock);
+			}
+		});
+	}
+
+	free(Slots);
+	return 0;
+}
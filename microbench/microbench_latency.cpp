@@ -180,6 +180,9 @@ void Test_mutex_test() {
 		fprintf(stderr, "Monitor granule size min:    %d\n", wfe_mutex_get_features()->monitor_granule_size_bytes_min);
 		fprintf(stderr, "Monitor granule size max:    %d\n", wfe_mutex_get_features()->monitor_granule_size_bytes_max);
 		fprintf(stderr, "Cycle counter hz:            %" PRId64 "\n", wfe_mutex_get_features()->cycle_hz);
+		fprintf(stderr, "Hypervisor:                  %s\n",
+			wfe_mutex_get_features()->running_under_hypervisor ? wfe_mutex_get_features()->hypervisor_vendor : "none");
+		fprintf(stderr, "Hypervisor monitor fallback: %s\n", wfe_mutex_get_features()->hypervisor_monitor_fallback ? "yes" : "no");
 	}
 
 	if (needs_non_spin_impl) {
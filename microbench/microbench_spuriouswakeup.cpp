@@ -76,6 +76,7 @@ int main() {
 	fprintf(stderr, "Monitor granule size min:    %d\n", wfe_mutex_get_features()->monitor_granule_size_bytes_min);
 	fprintf(stderr, "Monitor granule size max:    %d\n", wfe_mutex_get_features()->monitor_granule_size_bytes_max);
 	fprintf(stderr, "Cycle counter hz:            %" PRId64 "\n", wfe_mutex_get_features()->cycle_hz);
+	fprintf(stderr, "Event stream period cycles:  %" PRIu64 "\n", wfe_mutex_get_features()->event_stream_period_cycles);
 
 	size_t LoopAmount = 5000;
 	uint64_t Total{};
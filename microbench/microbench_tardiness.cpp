@@ -43,8 +43,14 @@ void DoTimeout(uint64_t Nanoseconds) {
 		fprintf(stderr, "Monitor granule size min:    %d\n", wfe_mutex_get_features()->monitor_granule_size_bytes_min);
 		fprintf(stderr, "Monitor granule size max:    %d\n", wfe_mutex_get_features()->monitor_granule_size_bytes_max);
 		fprintf(stderr, "Cycle counter hz:            %ld\n", wfe_mutex_get_features()->cycle_hz);
-		fprintf(stderr, "Cycle counter multiplier:    %ld\n", wfe_mutex_get_features()->cycles_per_nanosecond_multiplier);
-		fprintf(stderr, "Cycle counter divisor:    %" PRId64 "\n", wfe_mutex_get_features()->cycles_per_nanosecond_divisor);
+		fprintf(stderr, "Nanoseconds to cycles mult:  %" PRIu64 "\n", wfe_mutex_get_features()->nanoseconds_to_cycles_mult);
+		fprintf(stderr, "Nanoseconds to cycles shift: %u\n", wfe_mutex_get_features()->nanoseconds_to_cycles_shift);
+		fprintf(stderr, "Invariant cycle counter:     %s\n", wfe_mutex_get_features()->supports_invariant_cycle_counter ? "yes" : "no");
+		fprintf(stderr, "Timeout granularity ns:      %" PRIu64 "\n", wfe_mutex_calculate_nanoseconds_for_cycles(wfe_mutex_get_features()->timeout_granularity_cycles));
+		fprintf(stderr, "Timeout granularity lp ns:   %" PRIu64 "\n", wfe_mutex_calculate_nanoseconds_for_cycles(wfe_mutex_get_features()->timeout_granularity_low_power_cycles));
+		fprintf(stderr, "Event stream period ns:      %" PRIu64 "\n", wfe_mutex_calculate_nanoseconds_for_cycles(wfe_mutex_get_features()->event_stream_period_cycles));
+		fprintf(stderr, "umwait max time cycles:      %u\n", wfe_mutex_get_features()->umwait_max_time_cycles);
+		fprintf(stderr, "umwait C0.2 enabled:         %s\n", wfe_mutex_get_features()->umwait_c02_enabled ? "yes" : "no");
 	}
 
 	if (needs_non_spin_impl) {
@@ -143,6 +149,25 @@ int main(int argc, char **argv) {
 		constexpr bool low_power = true;
 		DoTimeout<true, true, true, lock_func, unlock_func, timeout_func, lock_type, lock, low_power>(SecsToNano(2));
 	}
+	else if (test == "monitor_mutex_unique_short") {
+		// Short enough that the timeout engine's spin before the deadline is a large part of the wait.
+		constexpr auto lock_func = wfe_mutex_lock_lock;
+		constexpr auto unlock_func = wfe_mutex_lock_unlock;
+		constexpr auto lock = &mutex_lock;
+		constexpr auto timeout_func = mutex_timeout_func;
+		using lock_type = std::remove_pointer_t<decltype(lock)>;
+		constexpr bool low_power = false;
+		DoTimeout<true, true, true, lock_func, unlock_func, timeout_func, lock_type, lock, low_power>(100000);
+	}
+	else if (test == "monitor_mutex_unique_short_lp") {
+		constexpr auto lock_func = wfe_mutex_lock_lock;
+		constexpr auto unlock_func = wfe_mutex_lock_unlock;
+		constexpr auto lock = &mutex_lock;
+		constexpr auto timeout_func = mutex_timeout_func;
+		using lock_type = std::remove_pointer_t<decltype(lock)>;
+		constexpr bool low_power = true;
+		DoTimeout<true, true, true, lock_func, unlock_func, timeout_func, lock_type, lock, low_power>(100000);
+	}
 	else if (test == "pthread_mutex") {
 		constexpr auto lock_func = pthread_mutex_lock_func;
 		constexpr auto unlock_func = pthread_mutex_unlock_func;
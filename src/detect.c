@@ -5,17 +5,37 @@
 
 #include <wfe_mutex/wfe_mutex.h>
 
+#include <pthread.h>
+#include <sched.h>
 #include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
 #include <time.h>
 
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <linux/membarrier.h>
+#include <linux/perf_event.h>
+#include <sys/auxv.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 wfe_mutex_features Features = {
 	.cycle_hz = 0,
-	.cycles_per_nanosecond_multiplier = 1,
-	.cycles_per_nanosecond_divisor = 1,
+	.nanoseconds_to_cycles_mult = 1,
+	.nanoseconds_to_cycles_shift = 0,
+	.cycles_to_nanoseconds_mult = 1,
+	.cycles_to_nanoseconds_shift = 0,
 
 	.wait_type = WAIT_TYPE_SPIN,
 	.wait_type_timeout = WAIT_TYPE_SPIN,
 
+	.hint_strategy = { WAIT_STRATEGY_SPIN, WAIT_STRATEGY_SPIN, WAIT_STRATEGY_SPIN },
+
 	.wait_for_value_i8  = spinloop_wait_for_value_i8,
 	.wait_for_value_i16 = spinloop_wait_for_value_i16,
 	.wait_for_value_i32 = spinloop_wait_for_value_i32,
@@ -26,6 +46,11 @@ wfe_mutex_features Features = {
 	.wait_for_value_timeout_i32 = spinloop_wait_for_value_timeout_i32,
 	.wait_for_value_timeout_i64 = spinloop_wait_for_value_timeout_i64,
 
+	.wait_for_value_until_i8  = spinloop_wait_for_value_until_i8,
+	.wait_for_value_until_i16 = spinloop_wait_for_value_until_i16,
+	.wait_for_value_until_i32 = spinloop_wait_for_value_until_i32,
+	.wait_for_value_until_i64 = spinloop_wait_for_value_until_i64,
+
 	.wait_for_bit_set_i8 = spinloop_wait_for_bit_set_i8,
 	.wait_for_bit_set_i16 = spinloop_wait_for_bit_set_i16,
 	.wait_for_bit_set_i32 = spinloop_wait_for_bit_set_i32,
@@ -41,11 +66,209 @@ wfe_mutex_features Features = {
 	.wait_for_value_spurious_oneshot_i32 = spinloop_wait_for_value_spurious_oneshot_i32,
 	.wait_for_value_spurious_oneshot_i64 = spinloop_wait_for_value_spurious_oneshot_i64,
 
+	.wait_for_change_i8  = spinloop_wait_for_change_i8,
+	.wait_for_change_i16 = spinloop_wait_for_change_i16,
+	.wait_for_change_i32 = spinloop_wait_for_change_i32,
+	.wait_for_change_i64 = spinloop_wait_for_change_i64,
+
+	.wait_for_masked_value_i8  = spinloop_wait_for_masked_value_i8,
+	.wait_for_masked_value_i16 = spinloop_wait_for_masked_value_i16,
+	.wait_for_masked_value_i32 = spinloop_wait_for_masked_value_i32,
+	.wait_for_masked_value_i64 = spinloop_wait_for_masked_value_i64,
+
+	.wait_for_any_bit_set_i8  = spinloop_wait_for_any_bit_set_i8,
+	.wait_for_any_bit_set_i16 = spinloop_wait_for_any_bit_set_i16,
+	.wait_for_any_bit_set_i32 = spinloop_wait_for_any_bit_set_i32,
+	.wait_for_any_bit_set_i64 = spinloop_wait_for_any_bit_set_i64,
+
+	.wait_for_sequence_ge_i8  = spinloop_wait_for_sequence_ge_i8,
+	.wait_for_sequence_ge_i16 = spinloop_wait_for_sequence_ge_i16,
+	.wait_for_sequence_ge_i32 = spinloop_wait_for_sequence_ge_i32,
+	.wait_for_sequence_ge_i64 = spinloop_wait_for_sequence_ge_i64,
+
+	.wait_for_masked_value_timeout_i8  = spinloop_wait_for_masked_value_timeout_i8,
+	.wait_for_masked_value_timeout_i16 = spinloop_wait_for_masked_value_timeout_i16,
+	.wait_for_masked_value_timeout_i32 = spinloop_wait_for_masked_value_timeout_i32,
+	.wait_for_masked_value_timeout_i64 = spinloop_wait_for_masked_value_timeout_i64,
+
+	.wait_for_masked_value_until_i8  = spinloop_wait_for_masked_value_until_i8,
+	.wait_for_masked_value_until_i16 = spinloop_wait_for_masked_value_until_i16,
+	.wait_for_masked_value_until_i32 = spinloop_wait_for_masked_value_until_i32,
+	.wait_for_masked_value_until_i64 = spinloop_wait_for_masked_value_until_i64,
+
+	.wait_for_any_bit_set_timeout_i8  = spinloop_wait_for_any_bit_set_timeout_i8,
+	.wait_for_any_bit_set_timeout_i16 = spinloop_wait_for_any_bit_set_timeout_i16,
+	.wait_for_any_bit_set_timeout_i32 = spinloop_wait_for_any_bit_set_timeout_i32,
+	.wait_for_any_bit_set_timeout_i64 = spinloop_wait_for_any_bit_set_timeout_i64,
+
+	.wait_for_any_bit_set_until_i8  = spinloop_wait_for_any_bit_set_until_i8,
+	.wait_for_any_bit_set_until_i16 = spinloop_wait_for_any_bit_set_until_i16,
+	.wait_for_any_bit_set_until_i32 = spinloop_wait_for_any_bit_set_until_i32,
+	.wait_for_any_bit_set_until_i64 = spinloop_wait_for_any_bit_set_until_i64,
+
+	.wait_for_sequence_ge_timeout_i8  = spinloop_wait_for_sequence_ge_timeout_i8,
+	.wait_for_sequence_ge_timeout_i16 = spinloop_wait_for_sequence_ge_timeout_i16,
+	.wait_for_sequence_ge_timeout_i32 = spinloop_wait_for_sequence_ge_timeout_i32,
+	.wait_for_sequence_ge_timeout_i64 = spinloop_wait_for_sequence_ge_timeout_i64,
+
+	.wait_for_sequence_ge_until_i8  = spinloop_wait_for_sequence_ge_until_i8,
+	.wait_for_sequence_ge_until_i16 = spinloop_wait_for_sequence_ge_until_i16,
+	.wait_for_sequence_ge_until_i32 = spinloop_wait_for_sequence_ge_until_i32,
+	.wait_for_sequence_ge_until_i64 = spinloop_wait_for_sequence_ge_until_i64,
+
+	.wait_for_value_i128 = spinloop_wait_for_value_i128,
+	.wait_for_masked_value_i128 = spinloop_wait_for_masked_value_i128,
+
+	.wait_for_bit_set_timeout_i8  = spinloop_wait_for_bit_set_timeout_i8,
+	.wait_for_bit_set_timeout_i16 = spinloop_wait_for_bit_set_timeout_i16,
+	.wait_for_bit_set_timeout_i32 = spinloop_wait_for_bit_set_timeout_i32,
+	.wait_for_bit_set_timeout_i64 = spinloop_wait_for_bit_set_timeout_i64,
+
+	.wait_for_bit_set_until_i8  = spinloop_wait_for_bit_set_until_i8,
+	.wait_for_bit_set_until_i16 = spinloop_wait_for_bit_set_until_i16,
+	.wait_for_bit_set_until_i32 = spinloop_wait_for_bit_set_until_i32,
+	.wait_for_bit_set_until_i64 = spinloop_wait_for_bit_set_until_i64,
+
+	.wait_for_bit_not_set_timeout_i8  = spinloop_wait_for_bit_not_set_timeout_i8,
+	.wait_for_bit_not_set_timeout_i16 = spinloop_wait_for_bit_not_set_timeout_i16,
+	.wait_for_bit_not_set_timeout_i32 = spinloop_wait_for_bit_not_set_timeout_i32,
+	.wait_for_bit_not_set_timeout_i64 = spinloop_wait_for_bit_not_set_timeout_i64,
+
+	.wait_for_bit_not_set_until_i8  = spinloop_wait_for_bit_not_set_until_i8,
+	.wait_for_bit_not_set_until_i16 = spinloop_wait_for_bit_not_set_until_i16,
+	.wait_for_bit_not_set_until_i32 = spinloop_wait_for_bit_not_set_until_i32,
+	.wait_for_bit_not_set_until_i64 = spinloop_wait_for_bit_not_set_until_i64,
+
+	.wait_for_bit_set_spurious_oneshot_i8  = spinloop_wait_for_bit_set_spurious_oneshot_i8,
+	.wait_for_bit_set_spurious_oneshot_i16 = spinloop_wait_for_bit_set_spurious_oneshot_i16,
+	.wait_for_bit_set_spurious_oneshot_i32 = spinloop_wait_for_bit_set_spurious_oneshot_i32,
+	.wait_for_bit_set_spurious_oneshot_i64 = spinloop_wait_for_bit_set_spurious_oneshot_i64,
+
+	.wait_for_bit_not_set_spurious_oneshot_i8  = spinloop_wait_for_bit_not_set_spurious_oneshot_i8,
+	.wait_for_bit_not_set_spurious_oneshot_i16 = spinloop_wait_for_bit_not_set_spurious_oneshot_i16,
+	.wait_for_bit_not_set_spurious_oneshot_i32 = spinloop_wait_for_bit_not_set_spurious_oneshot_i32,
+	.wait_for_bit_not_set_spurious_oneshot_i64 = spinloop_wait_for_bit_not_set_spurious_oneshot_i64,
+
+	.wait_any_oneshot = spinloop_wait_any_oneshot,
+	.doorbell_wait = spinloop_doorbell_wait,
+	.sleep_until = spinloop_sleep_until,
+
 	.supports_wfe_mutex = false,
 	.supports_timed_wfe_mutex = false,
 	.supports_low_power_cstate_toggle = false,
+	.supports_membarrier = false,
+	.supports_wait_for_i128 = false,
+
+	.available_backends = WFE_MUTEX_BACKEND_BIT(WFE_MUTEX_BACKEND_SPIN),
+	.backend = WFE_MUTEX_BACKEND_SPIN,
 };
 
+// Resets every function to the spin-loop implementation. Other backends start from this.
+static void set_backend_spin(wfe_mutex_features *features) {
+#define SET_SPINLOOP_FUNCTION(name) features->name = spinloop_##name;
+	WFE_MUTEX_BACKEND_FUNCTIONS(SET_SPINLOOP_FUNCTION, SET_SPINLOOP_FUNCTION)
+#undef SET_SPINLOOP_FUNCTION
+
+	features->wait_type = WAIT_TYPE_SPIN;
+	features->wait_type_timeout = WAIT_TYPE_SPIN;
+
+	features->monitor_granule_size_bytes_min = 0;
+	features->monitor_granule_size_bytes_max = 0;
+
+	features->supports_wfe_mutex = false;
+	features->supports_timed_wfe_mutex = false;
+	features->supports_low_power_cstate_toggle = false;
+
+	features->backend = WFE_MUTEX_BACKEND_SPIN;
+}
+
+static void set_cycle_counter_conversion() {
+	// Snapdragon devices historically use a 19.2Mhz cycle counter, which gives around 52.08 nanoseconds per cycle.
+	// Apple M1 uses a 24Mhz cycle counter which gives around 41.6666... nanoseconds per cycle.
+	// NVIDIA Tegra goes up to 31.25Mhz which gives 32 nanoseconds per cycle, a clean divide.
+	// Modern x86 CPUs have a very high cycle counter frequency, AMD Zen 3 5995WX = 2.7Ghz.
+	// None of these are an integer ratio of 1Ghz, so the ratio is kept as a 64-bit fixed point fraction.
+	if (!Features.cycle_hz) {
+		return;
+	}
+
+	const uint64_t NanosecondsInSecond = 1000000000ULL;
+	wfe_mutex_calculate_mult_shift(NanosecondsInSecond, Features.cycle_hz, &Features.nanoseconds_to_cycles_mult, &Features.nanoseconds_to_cycles_shift);
+	wfe_mutex_calculate_mult_shift(Features.cycle_hz, NanosecondsInSecond, &Features.cycles_to_nanoseconds_mult, &Features.cycles_to_nanoseconds_shift);
+}
+
+static void set_hypervisor_vendor(const char *vendor, size_t length) {
+	Features.running_under_hypervisor = true;
+
+	length = length < sizeof(Features.hypervisor_vendor) - 1 ? length : sizeof(Features.hypervisor_vendor) - 1;
+	memcpy(Features.hypervisor_vendor, vendor, length);
+	Features.hypervisor_vendor[length] = 0;
+}
+
+// Returns true and the first line of `path` in `line` if the file could be read.
+static bool read_first_line(const char *path, char *line, size_t size) {
+	FILE *fp = fopen(path, "r");
+	if (!fp) {
+		return false;
+	}
+
+	const bool result = fgets(line, size, fp) != NULL;
+	fclose(fp);
+	if (result) {
+		line[strcspn(line, "\n")] = 0;
+	}
+	return result;
+}
+
+static void detect_hypervisor_firmware() {
+#if defined(__linux__)
+	// Userspace can't issue SMCCC hypervisor calls, use what the kernel learned from firmware instead.
+	char line[128];
+
+	// Only populated for Xen guests.
+	if (read_first_line("/sys/hypervisor/type", line, sizeof(line)) && line[0]) {
+		set_hypervisor_vendor(line, strlen(line));
+		return;
+	}
+
+	// Device-tree guests are handed a hypervisor node.
+	if (read_first_line("/proc/device-tree/hypervisor/compatible", line, sizeof(line)) && line[0]) {
+		set_hypervisor_vendor(line, strlen(line));
+		return;
+	}
+
+	// ACPI guests report the virtual platform through DMI.
+	static const char *DMIVirtualPlatforms[] = {
+		"KVM",
+		"QEMU",
+		"VMware",
+		"VirtualBox",
+		"Virtual Machine",
+		"Xen",
+		"Parallels",
+		"Google Compute Engine",
+	};
+
+	static const char *DMIFiles[] = {
+		"/sys/class/dmi/id/product_name",
+		"/sys/class/dmi/id/sys_vendor",
+	};
+
+	for (size_t i = 0; i < sizeof(DMIFiles) / sizeof(DMIFiles[0]); ++i) {
+		if (!read_first_line(DMIFiles[i], line, sizeof(line))) {
+			continue;
+		}
+
+		for (size_t j = 0; j < sizeof(DMIVirtualPlatforms) / sizeof(DMIVirtualPlatforms[0]); ++j) {
+			if (strstr(line, DMIVirtualPlatforms[j])) {
+				set_hypervisor_vendor(DMIVirtualPlatforms[j], strlen(DMIVirtualPlatforms[j]));
+				return;
+			}
+		}
+	}
+#endif
+}
+
 #if defined(_M_ARM_64) || defined(_M_ARM_32)
 
 #if defined(_M_ARM_64)
@@ -91,51 +314,273 @@ uint32_t get_exclusive_monitor_granule_size() {
 }
 #endif
 
-static void detect() {
-	Features.wait_type = WAIT_TYPE_WFE,
-	Features.wait_type_timeout = WAIT_TYPE_WFE,
+static void set_backend_wfe(wfe_mutex_features *features) {
+	set_backend_spin(features);
+	features->backend = WFE_MUTEX_BACKEND_WFE;
+
+	features->wait_type = WAIT_TYPE_WFE;
+	features->wait_type_timeout = WAIT_TYPE_WFE;
+
+	features->monitor_granule_size_bytes_min = features->monitor_granule_size_bytes_max = get_exclusive_monitor_granule_size();
+
+	features->wait_for_value_i8  = wfe_wait_for_value_i8;
+	features->wait_for_value_i16 = wfe_wait_for_value_i16;
+	features->wait_for_value_i32 = wfe_wait_for_value_i32;
+#if defined(_M_ARM_64)
+	features->wait_for_value_i64 = wfe_wait_for_value_i64;
+#endif
+
+	features->wait_for_value_timeout_i8  = wfe_wait_for_value_timeout_i8;
+	features->wait_for_value_timeout_i16 = wfe_wait_for_value_timeout_i16;
+	features->wait_for_value_timeout_i32 = wfe_wait_for_value_timeout_i32;
+#if defined(_M_ARM_64)
+	features->wait_for_value_timeout_i64 = wfe_wait_for_value_timeout_i64;
+#endif
+
+	features->wait_for_value_until_i8  = wfe_wait_for_value_until_i8;
+	features->wait_for_value_until_i16 = wfe_wait_for_value_until_i16;
+	features->wait_for_value_until_i32 = wfe_wait_for_value_until_i32;
+#if defined(_M_ARM_64)
+	features->wait_for_value_until_i64 = wfe_wait_for_value_until_i64;
+#endif
+
+	features->wait_for_value_spurious_oneshot_i8  = wfe_wait_for_value_spurious_oneshot_i8;
+	features->wait_for_value_spurious_oneshot_i16 = wfe_wait_for_value_spurious_oneshot_i16;
+	features->wait_for_value_spurious_oneshot_i32 = wfe_wait_for_value_spurious_oneshot_i32;
+#if defined(_M_ARM_64)
+	features->wait_for_value_spurious_oneshot_i64 = wfe_wait_for_value_spurious_oneshot_i64;
+#endif
+
+	features->wait_for_change_i8  = wfe_wait_for_change_i8;
+	features->wait_for_change_i16 = wfe_wait_for_change_i16;
+	features->wait_for_change_i32 = wfe_wait_for_change_i32;
+#if defined(_M_ARM_64)
+	features->wait_for_change_i64 = wfe_wait_for_change_i64;
+#endif
+
+	features->wait_for_masked_value_i8  = wfe_wait_for_masked_value_i8;
+	features->wait_for_masked_value_i16 = wfe_wait_for_masked_value_i16;
+	features->wait_for_masked_value_i32 = wfe_wait_for_masked_value_i32;
+#if defined(_M_ARM_64)
+	features->wait_for_masked_value_i64 = wfe_wait_for_masked_value_i64;
+#endif
+
+	features->wait_for_any_bit_set_i8  = wfe_wait_for_any_bit_set_i8;
+	features->wait_for_any_bit_set_i16 = wfe_wait_for_any_bit_set_i16;
+	features->wait_for_any_bit_set_i32 = wfe_wait_for_any_bit_set_i32;
+#if defined(_M_ARM_64)
+	features->wait_for_any_bit_set_i64 = wfe_wait_for_any_bit_set_i64;
+#endif
+
+	features->wait_for_sequence_ge_i8  = wfe_wait_for_sequence_ge_i8;
+	features->wait_for_sequence_ge_i16 = wfe_wait_for_sequence_ge_i16;
+	features->wait_for_sequence_ge_i32 = wfe_wait_for_sequence_ge_i32;
+#if defined(_M_ARM_64)
+	features->wait_for_sequence_ge_i64 = wfe_wait_for_sequence_ge_i64;
+#endif
+
+	features->wait_for_masked_value_timeout_i8  = wfe_wait_for_masked_value_timeout_i8;
+	features->wait_for_masked_value_timeout_i16 = wfe_wait_for_masked_value_timeout_i16;
+	features->wait_for_masked_value_timeout_i32 = wfe_wait_for_masked_value_timeout_i32;
+#if defined(_M_ARM_64)
+	features->wait_for_masked_value_timeout_i64 = wfe_wait_for_masked_value_timeout_i64;
+#endif
 
-	Features.monitor_granule_size_bytes_min = Features.monitor_granule_size_bytes_max = get_exclusive_monitor_granule_size();
+	features->wait_for_masked_value_until_i8  = wfe_wait_for_masked_value_until_i8;
+	features->wait_for_masked_value_until_i16 = wfe_wait_for_masked_value_until_i16;
+	features->wait_for_masked_value_until_i32 = wfe_wait_for_masked_value_until_i32;
+#if defined(_M_ARM_64)
+	features->wait_for_masked_value_until_i64 = wfe_wait_for_masked_value_until_i64;
+#endif
 
-	Features.wait_for_value_i8  = wfe_wait_for_value_i8;
-	Features.wait_for_value_i16 = wfe_wait_for_value_i16;
-	Features.wait_for_value_i32 = wfe_wait_for_value_i32;
+	features->wait_for_any_bit_set_timeout_i8  = wfe_wait_for_any_bit_set_timeout_i8;
+	features->wait_for_any_bit_set_timeout_i16 = wfe_wait_for_any_bit_set_timeout_i16;
+	features->wait_for_any_bit_set_timeout_i32 = wfe_wait_for_any_bit_set_timeout_i32;
 #if defined(_M_ARM_64)
-	Features.wait_for_value_i64 = wfe_wait_for_value_i64;
+	features->wait_for_any_bit_set_timeout_i64 = wfe_wait_for_any_bit_set_timeout_i64;
 #endif
 
-	Features.wait_for_value_timeout_i8  = wfe_wait_for_value_timeout_i8;
-	Features.wait_for_value_timeout_i16 = wfe_wait_for_value_timeout_i16;
-	Features.wait_for_value_timeout_i32 = wfe_wait_for_value_timeout_i32;
+	features->wait_for_any_bit_set_until_i8  = wfe_wait_for_any_bit_set_until_i8;
+	features->wait_for_any_bit_set_until_i16 = wfe_wait_for_any_bit_set_until_i16;
+	features->wait_for_any_bit_set_until_i32 = wfe_wait_for_any_bit_set_until_i32;
 #if defined(_M_ARM_64)
-	Features.wait_for_value_timeout_i64 = wfe_wait_for_value_timeout_i64;
+	features->wait_for_any_bit_set_until_i64 = wfe_wait_for_any_bit_set_until_i64;
 #endif
 
-	Features.wait_for_value_spurious_oneshot_i8  = wfe_wait_for_value_spurious_oneshot_i8;
-	Features.wait_for_value_spurious_oneshot_i16 = wfe_wait_for_value_spurious_oneshot_i16;
-	Features.wait_for_value_spurious_oneshot_i32 = wfe_wait_for_value_spurious_oneshot_i32;
+	features->wait_for_sequence_ge_timeout_i8  = wfe_wait_for_sequence_ge_timeout_i8;
+	features->wait_for_sequence_ge_timeout_i16 = wfe_wait_for_sequence_ge_timeout_i16;
+	features->wait_for_sequence_ge_timeout_i32 = wfe_wait_for_sequence_ge_timeout_i32;
 #if defined(_M_ARM_64)
-	Features.wait_for_value_spurious_oneshot_i64 = wfe_wait_for_value_spurious_oneshot_i64;
+	features->wait_for_sequence_ge_timeout_i64 = wfe_wait_for_sequence_ge_timeout_i64;
 #endif
 
-	Features.wait_for_bit_set_i8 = wfe_wait_for_bit_set_i8;
-	Features.wait_for_bit_set_i16 = wfe_wait_for_bit_set_i16;
-	Features.wait_for_bit_set_i32 = wfe_wait_for_bit_set_i32;
+	features->wait_for_sequence_ge_until_i8  = wfe_wait_for_sequence_ge_until_i8;
+	features->wait_for_sequence_ge_until_i16 = wfe_wait_for_sequence_ge_until_i16;
+	features->wait_for_sequence_ge_until_i32 = wfe_wait_for_sequence_ge_until_i32;
 #if defined(_M_ARM_64)
-	Features.wait_for_bit_set_i64 = wfe_wait_for_bit_set_i64;
+	features->wait_for_sequence_ge_until_i64 = wfe_wait_for_sequence_ge_until_i64;
 #endif
 
-	Features.wait_for_bit_not_set_i8 = wfe_wait_for_bit_not_set_i8;
-	Features.wait_for_bit_not_set_i16 = wfe_wait_for_bit_not_set_i16;
-	Features.wait_for_bit_not_set_i32 = wfe_wait_for_bit_not_set_i32;
+	features->wait_for_bit_set_timeout_i8  = wfe_wait_for_bit_set_timeout_i8;
+	features->wait_for_bit_set_timeout_i16 = wfe_wait_for_bit_set_timeout_i16;
+	features->wait_for_bit_set_timeout_i32 = wfe_wait_for_bit_set_timeout_i32;
 #if defined(_M_ARM_64)
-	Features.wait_for_bit_not_set_i64 = wfe_wait_for_bit_not_set_i64;
+	features->wait_for_bit_set_timeout_i64 = wfe_wait_for_bit_set_timeout_i64;
 #endif
 
+	features->wait_for_bit_set_until_i8  = wfe_wait_for_bit_set_until_i8;
+	features->wait_for_bit_set_until_i16 = wfe_wait_for_bit_set_until_i16;
+	features->wait_for_bit_set_until_i32 = wfe_wait_for_bit_set_until_i32;
+#if defined(_M_ARM_64)
+	features->wait_for_bit_set_until_i64 = wfe_wait_for_bit_set_until_i64;
+#endif
+
+	features->wait_for_bit_not_set_timeout_i8  = wfe_wait_for_bit_not_set_timeout_i8;
+	features->wait_for_bit_not_set_timeout_i16 = wfe_wait_for_bit_not_set_timeout_i16;
+	features->wait_for_bit_not_set_timeout_i32 = wfe_wait_for_bit_not_set_timeout_i32;
+#if defined(_M_ARM_64)
+	features->wait_for_bit_not_set_timeout_i64 = wfe_wait_for_bit_not_set_timeout_i64;
+#endif
+
+	features->wait_for_bit_not_set_until_i8  = wfe_wait_for_bit_not_set_until_i8;
+	features->wait_for_bit_not_set_until_i16 = wfe_wait_for_bit_not_set_until_i16;
+	features->wait_for_bit_not_set_until_i32 = wfe_wait_for_bit_not_set_until_i32;
+#if defined(_M_ARM_64)
+	features->wait_for_bit_not_set_until_i64 = wfe_wait_for_bit_not_set_until_i64;
+#endif
+
+	features->wait_for_bit_set_spurious_oneshot_i8  = wfe_wait_for_bit_set_spurious_oneshot_i8;
+	features->wait_for_bit_set_spurious_oneshot_i16 = wfe_wait_for_bit_set_spurious_oneshot_i16;
+	features->wait_for_bit_set_spurious_oneshot_i32 = wfe_wait_for_bit_set_spurious_oneshot_i32;
+#if defined(_M_ARM_64)
+	features->wait_for_bit_set_spurious_oneshot_i64 = wfe_wait_for_bit_set_spurious_oneshot_i64;
+#endif
+
+	features->wait_for_bit_not_set_spurious_oneshot_i8  = wfe_wait_for_bit_not_set_spurious_oneshot_i8;
+	features->wait_for_bit_not_set_spurious_oneshot_i16 = wfe_wait_for_bit_not_set_spurious_oneshot_i16;
+	features->wait_for_bit_not_set_spurious_oneshot_i32 = wfe_wait_for_bit_not_set_spurious_oneshot_i32;
+#if defined(_M_ARM_64)
+	features->wait_for_bit_not_set_spurious_oneshot_i64 = wfe_wait_for_bit_not_set_spurious_oneshot_i64;
+#endif
+
+	features->wait_any_oneshot = wfe_wait_any_oneshot;
+	features->doorbell_wait = wfe_doorbell_wait;
+	features->sleep_until = wfe_sleep_until;
+
+#if defined(_M_ARM_64)
+	features->wait_for_value_i128 = wfe_wait_for_value_i128;
+	features->wait_for_masked_value_i128 = wfe_wait_for_masked_value_i128;
+#endif
+
+	features->wait_for_bit_set_i8 = wfe_wait_for_bit_set_i8;
+	features->wait_for_bit_set_i16 = wfe_wait_for_bit_set_i16;
+	features->wait_for_bit_set_i32 = wfe_wait_for_bit_set_i32;
+#if defined(_M_ARM_64)
+	features->wait_for_bit_set_i64 = wfe_wait_for_bit_set_i64;
+#endif
+
+	features->wait_for_bit_not_set_i8 = wfe_wait_for_bit_not_set_i8;
+	features->wait_for_bit_not_set_i16 = wfe_wait_for_bit_not_set_i16;
+	features->wait_for_bit_not_set_i32 = wfe_wait_for_bit_not_set_i32;
+#if defined(_M_ARM_64)
+	features->wait_for_bit_not_set_i64 = wfe_wait_for_bit_not_set_i64;
+#endif
+
+	// ARMv8 always supports wfe_mutex
+	features->supports_wfe_mutex = true;
+
+	// ARMv8 doesn't support a lower power cstate toggle.
+}
+
+#if defined(_M_ARM_64)
+static void set_backend_wfet(wfe_mutex_features *features) {
+	// WFET only replaces the timed waits, untimed waits are still plain WFE.
+	set_backend_wfe(features);
+	features->backend = WFE_MUTEX_BACKEND_WFET;
+
+	features->wait_type_timeout = WAIT_TYPE_WFET;
+	features->supports_timed_wfe_mutex = true;
+
+	features->wait_for_value_timeout_i8  = wfet_wait_for_value_timeout_i8;
+	features->wait_for_value_timeout_i16 = wfet_wait_for_value_timeout_i16;
+	features->wait_for_value_timeout_i32 = wfet_wait_for_value_timeout_i32;
+	features->wait_for_value_timeout_i64 = wfet_wait_for_value_timeout_i64;
+
+	features->wait_for_value_until_i8  = wfet_wait_for_value_until_i8;
+	features->wait_for_value_until_i16 = wfet_wait_for_value_until_i16;
+	features->wait_for_value_until_i32 = wfet_wait_for_value_until_i32;
+	features->wait_for_value_until_i64 = wfet_wait_for_value_until_i64;
+
+	features->wait_for_masked_value_timeout_i8  = wfet_wait_for_masked_value_timeout_i8;
+	features->wait_for_masked_value_timeout_i16 = wfet_wait_for_masked_value_timeout_i16;
+	features->wait_for_masked_value_timeout_i32 = wfet_wait_for_masked_value_timeout_i32;
+	features->wait_for_masked_value_timeout_i64 = wfet_wait_for_masked_value_timeout_i64;
+
+	features->wait_for_masked_value_until_i8  = wfet_wait_for_masked_value_until_i8;
+	features->wait_for_masked_value_until_i16 = wfet_wait_for_masked_value_until_i16;
+	features->wait_for_masked_value_until_i32 = wfet_wait_for_masked_value_until_i32;
+	features->wait_for_masked_value_until_i64 = wfet_wait_for_masked_value_until_i64;
+
+	features->wait_for_any_bit_set_timeout_i8  = wfet_wait_for_any_bit_set_timeout_i8;
+	features->wait_for_any_bit_set_timeout_i16 = wfet_wait_for_any_bit_set_timeout_i16;
+	features->wait_for_any_bit_set_timeout_i32 = wfet_wait_for_any_bit_set_timeout_i32;
+	features->wait_for_any_bit_set_timeout_i64 = wfet_wait_for_any_bit_set_timeout_i64;
+
+	features->wait_for_any_bit_set_until_i8  = wfet_wait_for_any_bit_set_until_i8;
+	features->wait_for_any_bit_set_until_i16 = wfet_wait_for_any_bit_set_until_i16;
+	features->wait_for_any_bit_set_until_i32 = wfet_wait_for_any_bit_set_until_i32;
+	features->wait_for_any_bit_set_until_i64 = wfet_wait_for_any_bit_set_until_i64;
+
+	features->wait_for_sequence_ge_timeout_i8  = wfet_wait_for_sequence_ge_timeout_i8;
+	features->wait_for_sequence_ge_timeout_i16 = wfet_wait_for_sequence_ge_timeout_i16;
+	features->wait_for_sequence_ge_timeout_i32 = wfet_wait_for_sequence_ge_timeout_i32;
+	features->wait_for_sequence_ge_timeout_i64 = wfet_wait_for_sequence_ge_timeout_i64;
+
+	features->wait_for_sequence_ge_until_i8  = wfet_wait_for_sequence_ge_until_i8;
+	features->wait_for_sequence_ge_until_i16 = wfet_wait_for_sequence_ge_until_i16;
+	features->wait_for_sequence_ge_until_i32 = wfet_wait_for_sequence_ge_until_i32;
+	features->wait_for_sequence_ge_until_i64 = wfet_wait_for_sequence_ge_until_i64;
+
+	features->wait_for_bit_set_timeout_i8  = wfet_wait_for_bit_set_timeout_i8;
+	features->wait_for_bit_set_timeout_i16 = wfet_wait_for_bit_set_timeout_i16;
+	features->wait_for_bit_set_timeout_i32 = wfet_wait_for_bit_set_timeout_i32;
+	features->wait_for_bit_set_timeout_i64 = wfet_wait_for_bit_set_timeout_i64;
+
+	features->wait_for_bit_set_until_i8  = wfet_wait_for_bit_set_until_i8;
+	features->wait_for_bit_set_until_i16 = wfet_wait_for_bit_set_until_i16;
+	features->wait_for_bit_set_until_i32 = wfet_wait_for_bit_set_until_i32;
+	features->wait_for_bit_set_until_i64 = wfet_wait_for_bit_set_until_i64;
+
+	features->wait_for_bit_not_set_timeout_i8  = wfet_wait_for_bit_not_set_timeout_i8;
+	features->wait_for_bit_not_set_timeout_i16 = wfet_wait_for_bit_not_set_timeout_i16;
+	features->wait_for_bit_not_set_timeout_i32 = wfet_wait_for_bit_not_set_timeout_i32;
+	features->wait_for_bit_not_set_timeout_i64 = wfet_wait_for_bit_not_set_timeout_i64;
+
+	features->wait_for_bit_not_set_until_i8  = wfet_wait_for_bit_not_set_until_i8;
+	features->wait_for_bit_not_set_until_i16 = wfet_wait_for_bit_not_set_until_i16;
+	features->wait_for_bit_not_set_until_i32 = wfet_wait_for_bit_not_set_until_i32;
+	features->wait_for_bit_not_set_until_i64 = wfet_wait_for_bit_not_set_until_i64;
+
+	features->wait_any_oneshot = wfet_wait_any_oneshot;
+	features->sleep_until = wfet_sleep_until;
+}
+#endif
+
+static void detect() {
 	// ARMv8 always supports wfe_mutex
-	Features.supports_wfe_mutex = true;
+	Features.available_backends |= WFE_MUTEX_BACKEND_BIT(WFE_MUTEX_BACKEND_WFE);
 
 #if defined(_M_ARM_64)
+	// LDAXP/STLXP is always available on ARMv8.
+	Features.supports_wait_for_i128 = true;
+
+	// AA64MMFR2.AT reports FEAT_LSE2, encoded by number for assemblers that predate the name.
+	uint64_t mmfr2;
+	__asm ("mrs %[Res], S3_0_C0_C7_2;\n"
+		: [Res] "=r" (mmfr2));
+#define LSE2_OFFSET 32
+	Features.supports_atomic_load_u128 = ((mmfr2 >> LSE2_OFFSET) & 0xF) != 0;
+
 	// Need to read AA64ISAR2 to see if WFXT is supported.
 	// Linux cpuid emulation allows userspace to read this register directly.
 	uint64_t isar2;
@@ -143,53 +588,422 @@ static void detect() {
 		: [Res] "=r" (isar2));
 #define WFXT_OFFSET 0
 	if ((isar2 >> WFXT_OFFSET) & 0xF) {
-		Features.wait_type_timeout = WAIT_TYPE_WFET;
-		Features.supports_timed_wfe_mutex = true;
-
-		Features.wait_for_value_timeout_i8  = wfet_wait_for_value_timeout_i8;
-		Features.wait_for_value_timeout_i16 = wfet_wait_for_value_timeout_i16;
-		Features.wait_for_value_timeout_i32 = wfet_wait_for_value_timeout_i32;
-		Features.wait_for_value_timeout_i64 = wfet_wait_for_value_timeout_i64;
+		Features.available_backends |= WFE_MUTEX_BACKEND_BIT(WFE_MUTEX_BACKEND_WFET);
+		set_backend_wfet(&Features);
+		return;
 	}
 #endif
 
-	// ARMv8 doesn't support a lower power cstate toggle.
+	set_backend_wfe(&Features);
+}
+
+static void detect_umwait_control() {
+	// Only x86 waitpkg has OS controlled wait limits.
+}
+
+static void detect_hypervisor() {
+	detect_hypervisor_firmware();
 }
 
 static void detect_cycle_counter_frequency() {
 	Features.cycle_hz = get_cycle_counter_frequency();
 
-	// Calculate cycles per nanosecond
-	const uint64_t NanosecondsInSecond = 1000000000ULL;
-	if (Features.cycle_hz > NanosecondsInSecond) {
-		// Cycle counter frequency is greater than 1Ghz. Claim 1:1
-		// Assume that a 10,000 cycle scale is close enough to not matter.
-		// TODO: Make this more accurate?
-		const uint64_t NanosecondsInSecond = 1000000000ULL;
-		Features.cycles_per_nanosecond_multiplier = 10000;
-		Features.cycles_per_nanosecond_divisor = (NanosecondsInSecond * 10000) / Features.cycle_hz;
+	// The generic timer always ticks at the constant CNTFRQ rate.
+	Features.supports_invariant_cycle_counter = true;
+	set_cycle_counter_conversion();
+}
+
+static bool has_event_stream() {
+#if defined(__linux__)
+	// The kernel reports whether it enabled the arch timer event stream in the ELF hwcaps.
+#if defined(_M_ARM_64)
+#define HWCAP_EVTSTRM_BIT 2
+#else
+#define HWCAP_EVTSTRM_BIT 21
+#endif
+	return (getauxval(AT_HWCAP) >> HWCAP_EVTSTRM_BIT) & 1;
+#else
+	return false;
+#endif
+}
+
+#define EVENT_STREAM_SAMPLES 9
+
+static void detect_event_stream() {
+	Features.event_stream_period_cycles = 0;
+
+	// Without the event stream nothing bounds a WFE on a word that never changes.
+	if (!has_event_stream()) {
+		return;
 	}
-	else {
-		// Cycle counter frequency is less than 1Ghz. Just divide nanoseconds by frequency.
-		// Snapdragon devices historically use a 19.2Mhz cycle counter, which gives around 52.08 cycles per nanosecond.
-		// Apple M1 uses a 24Mhz cycle counter which gives around 41.6666... cycles per nanosecond.
-		// NVIDIA Tegra goes up to 31.25Mhz which gives 32 cycles per nanosecond, a clean divide.
-		Features.cycles_per_nanosecond_multiplier = 1;
-		Features.cycles_per_nanosecond_divisor = NanosecondsInSecond / Features.cycle_hz;
+
+	// Each WFE on a word that never changes ends on the next event stream tick, or an interrupt.
+	// The first waits can return early on a pending event, they only line the samples up with a tick.
+	uint32_t word = 0;
+	wfe_wait_for_value_spurious_oneshot_i32(&word, 1, false);
+	wfe_wait_for_value_spurious_oneshot_i32(&word, 1, false);
+
+	uint64_t interval[EVENT_STREAM_SAMPLES];
+	uint64_t last = read_cycle_counter();
+	for (size_t i = 0; i < EVENT_STREAM_SAMPLES; ++i) {
+		wfe_wait_for_value_spurious_oneshot_i32(&word, 1, false);
+		const uint64_t now = read_cycle_counter();
+		interval[i] = now - last;
+		last = now;
 	}
+
+	// Median, so an interrupt or a preemption doesn't skew the result.
+	for (size_t i = 1; i < EVENT_STREAM_SAMPLES; ++i) {
+		const uint64_t value = interval[i];
+		size_t j = i;
+		for (; j > 0 && interval[j - 1] > value; --j) {
+			interval[j] = interval[j - 1];
+		}
+		interval[j] = value;
+	}
+
+	Features.event_stream_period_cycles = interval[EVENT_STREAM_SAMPLES / 2];
 }
 
 #elif defined(_M_X86_64) || defined(_M_X86_32)
 #include <cpuid.h>
 
+static void set_monitor_granule_size(wfe_mutex_features *features) {
+	uint32_t eax, ebx, ecx, edx;
+	__cpuid_count(0, 0, eax, ebx, ecx, edx);
+	if (eax >= 5) {
+		__cpuid_count(5, 0, eax, ebx, ecx, edx);
+		features->monitor_granule_size_bytes_min = eax & 0xFFFF;
+		features->monitor_granule_size_bytes_max = ebx & 0xFFFF;
+	}
+}
+
+static void set_backend_mwaitx(wfe_mutex_features *features) {
+	set_backend_spin(features);
+	features->backend = WFE_MUTEX_BACKEND_MONITORX;
+
+	features->supports_wfe_mutex = true;
+
+	// Monitorx always supports waiting with a maximum wait time.
+	features->supports_timed_wfe_mutex = true;
+
+	// Monitorx always supports low power cstate toggle
+	features->supports_low_power_cstate_toggle = true;
+
+	features->wait_type = WAIT_TYPE_MONITORX;
+	features->wait_type_timeout = WAIT_TYPE_MONITORX;
+
+	features->wait_for_value_i8  = mwaitx_wait_for_value_i8;
+	features->wait_for_value_i16 = mwaitx_wait_for_value_i16;
+	features->wait_for_value_i32 = mwaitx_wait_for_value_i32;
+	features->wait_for_value_i64 = mwaitx_wait_for_value_i64;
+
+	features->wait_for_value_timeout_i8  = mwaitx_wait_for_value_timeout_i8;
+	features->wait_for_value_timeout_i16 = mwaitx_wait_for_value_timeout_i16;
+	features->wait_for_value_timeout_i32 = mwaitx_wait_for_value_timeout_i32;
+	features->wait_for_value_timeout_i64 = mwaitx_wait_for_value_timeout_i64;
+
+	features->wait_for_value_until_i8  = mwaitx_wait_for_value_until_i8;
+	features->wait_for_value_until_i16 = mwaitx_wait_for_value_until_i16;
+	features->wait_for_value_until_i32 = mwaitx_wait_for_value_until_i32;
+	features->wait_for_value_until_i64 = mwaitx_wait_for_value_until_i64;
+
+	features->wait_for_value_spurious_oneshot_i8  = mwaitx_wait_for_value_spurious_oneshot_i8;
+	features->wait_for_value_spurious_oneshot_i16 = mwaitx_wait_for_value_spurious_oneshot_i16;
+	features->wait_for_value_spurious_oneshot_i32 = mwaitx_wait_for_value_spurious_oneshot_i32;
+	features->wait_for_value_spurious_oneshot_i64 = mwaitx_wait_for_value_spurious_oneshot_i64;
+
+	features->wait_for_change_i8  = mwaitx_wait_for_change_i8;
+	features->wait_for_change_i16 = mwaitx_wait_for_change_i16;
+	features->wait_for_change_i32 = mwaitx_wait_for_change_i32;
+	features->wait_for_change_i64 = mwaitx_wait_for_change_i64;
+
+	features->wait_for_masked_value_i8  = mwaitx_wait_for_masked_value_i8;
+	features->wait_for_masked_value_i16 = mwaitx_wait_for_masked_value_i16;
+	features->wait_for_masked_value_i32 = mwaitx_wait_for_masked_value_i32;
+	features->wait_for_masked_value_i64 = mwaitx_wait_for_masked_value_i64;
+
+	features->wait_for_any_bit_set_i8  = mwaitx_wait_for_any_bit_set_i8;
+	features->wait_for_any_bit_set_i16 = mwaitx_wait_for_any_bit_set_i16;
+	features->wait_for_any_bit_set_i32 = mwaitx_wait_for_any_bit_set_i32;
+	features->wait_for_any_bit_set_i64 = mwaitx_wait_for_any_bit_set_i64;
+
+	features->wait_for_sequence_ge_i8  = mwaitx_wait_for_sequence_ge_i8;
+	features->wait_for_sequence_ge_i16 = mwaitx_wait_for_sequence_ge_i16;
+	features->wait_for_sequence_ge_i32 = mwaitx_wait_for_sequence_ge_i32;
+	features->wait_for_sequence_ge_i64 = mwaitx_wait_for_sequence_ge_i64;
+
+	features->wait_for_masked_value_timeout_i8  = mwaitx_wait_for_masked_value_timeout_i8;
+	features->wait_for_masked_value_timeout_i16 = mwaitx_wait_for_masked_value_timeout_i16;
+	features->wait_for_masked_value_timeout_i32 = mwaitx_wait_for_masked_value_timeout_i32;
+	features->wait_for_masked_value_timeout_i64 = mwaitx_wait_for_masked_value_timeout_i64;
+
+	features->wait_for_masked_value_until_i8  = mwaitx_wait_for_masked_value_until_i8;
+	features->wait_for_masked_value_until_i16 = mwaitx_wait_for_masked_value_until_i16;
+	features->wait_for_masked_value_until_i32 = mwaitx_wait_for_masked_value_until_i32;
+	features->wait_for_masked_value_until_i64 = mwaitx_wait_for_masked_value_until_i64;
+
+	features->wait_for_any_bit_set_timeout_i8  = mwaitx_wait_for_any_bit_set_timeout_i8;
+	features->wait_for_any_bit_set_timeout_i16 = mwaitx_wait_for_any_bit_set_timeout_i16;
+	features->wait_for_any_bit_set_timeout_i32 = mwaitx_wait_for_any_bit_set_timeout_i32;
+	features->wait_for_any_bit_set_timeout_i64 = mwaitx_wait_for_any_bit_set_timeout_i64;
+
+	features->wait_for_any_bit_set_until_i8  = mwaitx_wait_for_any_bit_set_until_i8;
+	features->wait_for_any_bit_set_until_i16 = mwaitx_wait_for_any_bit_set_until_i16;
+	features->wait_for_any_bit_set_until_i32 = mwaitx_wait_for_any_bit_set_until_i32;
+	features->wait_for_any_bit_set_until_i64 = mwaitx_wait_for_any_bit_set_until_i64;
+
+	features->wait_for_sequence_ge_timeout_i8  = mwaitx_wait_for_sequence_ge_timeout_i8;
+	features->wait_for_sequence_ge_timeout_i16 = mwaitx_wait_for_sequence_ge_timeout_i16;
+	features->wait_for_sequence_ge_timeout_i32 = mwaitx_wait_for_sequence_ge_timeout_i32;
+	features->wait_for_sequence_ge_timeout_i64 = mwaitx_wait_for_sequence_ge_timeout_i64;
+
+	features->wait_for_sequence_ge_until_i8  = mwaitx_wait_for_sequence_ge_until_i8;
+	features->wait_for_sequence_ge_until_i16 = mwaitx_wait_for_sequence_ge_until_i16;
+	features->wait_for_sequence_ge_until_i32 = mwaitx_wait_for_sequence_ge_until_i32;
+	features->wait_for_sequence_ge_until_i64 = mwaitx_wait_for_sequence_ge_until_i64;
+
+	features->wait_for_bit_set_timeout_i8  = mwaitx_wait_for_bit_set_timeout_i8;
+	features->wait_for_bit_set_timeout_i16 = mwaitx_wait_for_bit_set_timeout_i16;
+	features->wait_for_bit_set_timeout_i32 = mwaitx_wait_for_bit_set_timeout_i32;
+	features->wait_for_bit_set_timeout_i64 = mwaitx_wait_for_bit_set_timeout_i64;
+
+	features->wait_for_bit_set_until_i8  = mwaitx_wait_for_bit_set_until_i8;
+	features->wait_for_bit_set_until_i16 = mwaitx_wait_for_bit_set_until_i16;
+	features->wait_for_bit_set_until_i32 = mwaitx_wait_for_bit_set_until_i32;
+	features->wait_for_bit_set_until_i64 = mwaitx_wait_for_bit_set_until_i64;
+
+	features->wait_for_bit_not_set_timeout_i8  = mwaitx_wait_for_bit_not_set_timeout_i8;
+	features->wait_for_bit_not_set_timeout_i16 = mwaitx_wait_for_bit_not_set_timeout_i16;
+	features->wait_for_bit_not_set_timeout_i32 = mwaitx_wait_for_bit_not_set_timeout_i32;
+	features->wait_for_bit_not_set_timeout_i64 = mwaitx_wait_for_bit_not_set_timeout_i64;
+
+	features->wait_for_bit_not_set_until_i8  = mwaitx_wait_for_bit_not_set_until_i8;
+	features->wait_for_bit_not_set_until_i16 = mwaitx_wait_for_bit_not_set_until_i16;
+	features->wait_for_bit_not_set_until_i32 = mwaitx_wait_for_bit_not_set_until_i32;
+	features->wait_for_bit_not_set_until_i64 = mwaitx_wait_for_bit_not_set_until_i64;
+
+	features->wait_for_bit_set_spurious_oneshot_i8  = mwaitx_wait_for_bit_set_spurious_oneshot_i8;
+	features->wait_for_bit_set_spurious_oneshot_i16 = mwaitx_wait_for_bit_set_spurious_oneshot_i16;
+	features->wait_for_bit_set_spurious_oneshot_i32 = mwaitx_wait_for_bit_set_spurious_oneshot_i32;
+	features->wait_for_bit_set_spurious_oneshot_i64 = mwaitx_wait_for_bit_set_spurious_oneshot_i64;
+
+	features->wait_for_bit_not_set_spurious_oneshot_i8  = mwaitx_wait_for_bit_not_set_spurious_oneshot_i8;
+	features->wait_for_bit_not_set_spurious_oneshot_i16 = mwaitx_wait_for_bit_not_set_spurious_oneshot_i16;
+	features->wait_for_bit_not_set_spurious_oneshot_i32 = mwaitx_wait_for_bit_not_set_spurious_oneshot_i32;
+	features->wait_for_bit_not_set_spurious_oneshot_i64 = mwaitx_wait_for_bit_not_set_spurious_oneshot_i64;
+
+	features->wait_any_oneshot = mwaitx_wait_any_oneshot;
+	features->doorbell_wait = mwaitx_doorbell_wait;
+	features->sleep_until = mwaitx_sleep_until;
+
+#if defined(_M_X86_64)
+	if (features->supports_wait_for_i128) {
+		features->wait_for_value_i128 = mwaitx_wait_for_value_i128;
+		features->wait_for_masked_value_i128 = mwaitx_wait_for_masked_value_i128;
+	}
+#endif
+
+	features->wait_for_bit_set_i8 = mwaitx_wait_for_bit_set_i8;
+	features->wait_for_bit_set_i16 = mwaitx_wait_for_bit_set_i16;
+	features->wait_for_bit_set_i32 = mwaitx_wait_for_bit_set_i32;
+	features->wait_for_bit_set_i64 = mwaitx_wait_for_bit_set_i64;
+
+	features->wait_for_bit_not_set_i8 = mwaitx_wait_for_bit_not_set_i8;
+	features->wait_for_bit_not_set_i16 = mwaitx_wait_for_bit_not_set_i16;
+	features->wait_for_bit_not_set_i32 = mwaitx_wait_for_bit_not_set_i32;
+	features->wait_for_bit_not_set_i64 = mwaitx_wait_for_bit_not_set_i64;
+
+	set_monitor_granule_size(features);
+}
+
+// Set once `detect_umwait_control` has read the OS settings. IFUNC resolvers pick the backend before that.
+static bool umwait_control_detected = false;
+
+static void set_backend_waitpkg(wfe_mutex_features *features) {
+	set_backend_spin(features);
+	features->backend = WFE_MUTEX_BACKEND_WAITPKG;
+
+	features->supports_wfe_mutex = true;
+
+	// waitpkg always supports waiting with a maximum wait time.
+	features->supports_timed_wfe_mutex = true;
+
+	// waitpkg supports the low power cstate toggle unless the OS disabled C0.2.
+	// Until `detect_umwait_control` has run, assume the reset state that allows it.
+	features->supports_low_power_cstate_toggle = !umwait_control_detected || features->umwait_c02_enabled;
+
+	features->wait_type = WAIT_TYPE_WAITPKG;
+	features->wait_type_timeout = WAIT_TYPE_WAITPKG;
+
+	features->wait_for_value_i8  = waitpkg_wait_for_value_i8;
+	features->wait_for_value_i16 = waitpkg_wait_for_value_i16;
+	features->wait_for_value_i32 = waitpkg_wait_for_value_i32;
+	features->wait_for_value_i64 = waitpkg_wait_for_value_i64;
+
+	features->wait_for_value_timeout_i8  = waitpkg_wait_for_value_timeout_i8;
+	features->wait_for_value_timeout_i16 = waitpkg_wait_for_value_timeout_i16;
+	features->wait_for_value_timeout_i32 = waitpkg_wait_for_value_timeout_i32;
+	features->wait_for_value_timeout_i64 = waitpkg_wait_for_value_timeout_i64;
+
+	features->wait_for_value_until_i8  = waitpkg_wait_for_value_until_i8;
+	features->wait_for_value_until_i16 = waitpkg_wait_for_value_until_i16;
+	features->wait_for_value_until_i32 = waitpkg_wait_for_value_until_i32;
+	features->wait_for_value_until_i64 = waitpkg_wait_for_value_until_i64;
+
+	features->wait_for_value_spurious_oneshot_i8  = waitpkg_wait_for_value_spurious_oneshot_i8;
+	features->wait_for_value_spurious_oneshot_i16 = waitpkg_wait_for_value_spurious_oneshot_i16;
+	features->wait_for_value_spurious_oneshot_i32 = waitpkg_wait_for_value_spurious_oneshot_i32;
+	features->wait_for_value_spurious_oneshot_i64 = waitpkg_wait_for_value_spurious_oneshot_i64;
+
+	features->wait_for_change_i8  = waitpkg_wait_for_change_i8;
+	features->wait_for_change_i16 = waitpkg_wait_for_change_i16;
+	features->wait_for_change_i32 = waitpkg_wait_for_change_i32;
+	features->wait_for_change_i64 = waitpkg_wait_for_change_i64;
+
+	features->wait_for_masked_value_i8  = waitpkg_wait_for_masked_value_i8;
+	features->wait_for_masked_value_i16 = waitpkg_wait_for_masked_value_i16;
+	features->wait_for_masked_value_i32 = waitpkg_wait_for_masked_value_i32;
+	features->wait_for_masked_value_i64 = waitpkg_wait_for_masked_value_i64;
+
+	features->wait_for_any_bit_set_i8  = waitpkg_wait_for_any_bit_set_i8;
+	features->wait_for_any_bit_set_i16 = waitpkg_wait_for_any_bit_set_i16;
+	features->wait_for_any_bit_set_i32 = waitpkg_wait_for_any_bit_set_i32;
+	features->wait_for_any_bit_set_i64 = waitpkg_wait_for_any_bit_set_i64;
+
+	features->wait_for_sequence_ge_i8  = waitpkg_wait_for_sequence_ge_i8;
+	features->wait_for_sequence_ge_i16 = waitpkg_wait_for_sequence_ge_i16;
+	features->wait_for_sequence_ge_i32 = waitpkg_wait_for_sequence_ge_i32;
+	features->wait_for_sequence_ge_i64 = waitpkg_wait_for_sequence_ge_i64;
+
+	features->wait_for_masked_value_timeout_i8  = waitpkg_wait_for_masked_value_timeout_i8;
+	features->wait_for_masked_value_timeout_i16 = waitpkg_wait_for_masked_value_timeout_i16;
+	features->wait_for_masked_value_timeout_i32 = waitpkg_wait_for_masked_value_timeout_i32;
+	features->wait_for_masked_value_timeout_i64 = waitpkg_wait_for_masked_value_timeout_i64;
+
+	features->wait_for_masked_value_until_i8  = waitpkg_wait_for_masked_value_until_i8;
+	features->wait_for_masked_value_until_i16 = waitpkg_wait_for_masked_value_until_i16;
+	features->wait_for_masked_value_until_i32 = waitpkg_wait_for_masked_value_until_i32;
+	features->wait_for_masked_value_until_i64 = waitpkg_wait_for_masked_value_until_i64;
+
+	features->wait_for_any_bit_set_timeout_i8  = waitpkg_wait_for_any_bit_set_timeout_i8;
+	features->wait_for_any_bit_set_timeout_i16 = waitpkg_wait_for_any_bit_set_timeout_i16;
+	features->wait_for_any_bit_set_timeout_i32 = waitpkg_wait_for_any_bit_set_timeout_i32;
+	features->wait_for_any_bit_set_timeout_i64 = waitpkg_wait_for_any_bit_set_timeout_i64;
+
+	features->wait_for_any_bit_set_until_i8  = waitpkg_wait_for_any_bit_set_until_i8;
+	features->wait_for_any_bit_set_until_i16 = waitpkg_wait_for_any_bit_set_until_i16;
+	features->wait_for_any_bit_set_until_i32 = waitpkg_wait_for_any_bit_set_until_i32;
+	features->wait_for_any_bit_set_until_i64 = waitpkg_wait_for_any_bit_set_until_i64;
+
+	features->wait_for_sequence_ge_timeout_i8  = waitpkg_wait_for_sequence_ge_timeout_i8;
+	features->wait_for_sequence_ge_timeout_i16 = waitpkg_wait_for_sequence_ge_timeout_i16;
+	features->wait_for_sequence_ge_timeout_i32 = waitpkg_wait_for_sequence_ge_timeout_i32;
+	features->wait_for_sequence_ge_timeout_i64 = waitpkg_wait_for_sequence_ge_timeout_i64;
+
+	features->wait_for_sequence_ge_until_i8  = waitpkg_wait_for_sequence_ge_until_i8;
+	features->wait_for_sequence_ge_until_i16 = waitpkg_wait_for_sequence_ge_until_i16;
+	features->wait_for_sequence_ge_until_i32 = waitpkg_wait_for_sequence_ge_until_i32;
+	features->wait_for_sequence_ge_until_i64 = waitpkg_wait_for_sequence_ge_until_i64;
+
+	features->wait_for_bit_set_timeout_i8  = waitpkg_wait_for_bit_set_timeout_i8;
+	features->wait_for_bit_set_timeout_i16 = waitpkg_wait_for_bit_set_timeout_i16;
+	features->wait_for_bit_set_timeout_i32 = waitpkg_wait_for_bit_set_timeout_i32;
+	features->wait_for_bit_set_timeout_i64 = waitpkg_wait_for_bit_set_timeout_i64;
+
+	features->wait_for_bit_set_until_i8  = waitpkg_wait_for_bit_set_until_i8;
+	features->wait_for_bit_set_until_i16 = waitpkg_wait_for_bit_set_until_i16;
+	features->wait_for_bit_set_until_i32 = waitpkg_wait_for_bit_set_until_i32;
+	features->wait_for_bit_set_until_i64 = waitpkg_wait_for_bit_set_until_i64;
+
+	features->wait_for_bit_not_set_timeout_i8  = waitpkg_wait_for_bit_not_set_timeout_i8;
+	features->wait_for_bit_not_set_timeout_i16 = waitpkg_wait_for_bit_not_set_timeout_i16;
+	features->wait_for_bit_not_set_timeout_i32 = waitpkg_wait_for_bit_not_set_timeout_i32;
+	features->wait_for_bit_not_set_timeout_i64 = waitpkg_wait_for_bit_not_set_timeout_i64;
+
+	features->wait_for_bit_not_set_until_i8  = waitpkg_wait_for_bit_not_set_until_i8;
+	features->wait_for_bit_not_set_until_i16 = waitpkg_wait_for_bit_not_set_until_i16;
+	features->wait_for_bit_not_set_until_i32 = waitpkg_wait_for_bit_not_set_until_i32;
+	features->wait_for_bit_not_set_until_i64 = waitpkg_wait_for_bit_not_set_until_i64;
+
+	features->wait_for_bit_set_spurious_oneshot_i8  = waitpkg_wait_for_bit_set_spurious_oneshot_i8;
+	features->wait_for_bit_set_spurious_oneshot_i16 = waitpkg_wait_for_bit_set_spurious_oneshot_i16;
+	features->wait_for_bit_set_spurious_oneshot_i32 = waitpkg_wait_for_bit_set_spurious_oneshot_i32;
+	features->wait_for_bit_set_spurious_oneshot_i64 = waitpkg_wait_for_bit_set_spurious_oneshot_i64;
+
+	features->wait_for_bit_not_set_spurious_oneshot_i8  = waitpkg_wait_for_bit_not_set_spurious_oneshot_i8;
+	features->wait_for_bit_not_set_spurious_oneshot_i16 = waitpkg_wait_for_bit_not_set_spurious_oneshot_i16;
+	features->wait_for_bit_not_set_spurious_oneshot_i32 = waitpkg_wait_for_bit_not_set_spurious_oneshot_i32;
+	features->wait_for_bit_not_set_spurious_oneshot_i64 = waitpkg_wait_for_bit_not_set_spurious_oneshot_i64;
+
+	features->wait_any_oneshot = waitpkg_wait_any_oneshot;
+	features->doorbell_wait = waitpkg_doorbell_wait;
+	features->sleep_until = waitpkg_sleep_until;
+
+#if defined(_M_X86_64)
+	if (features->supports_wait_for_i128) {
+		features->wait_for_value_i128 = waitpkg_wait_for_value_i128;
+		features->wait_for_masked_value_i128 = waitpkg_wait_for_masked_value_i128;
+	}
+#endif
+
+	features->wait_for_bit_set_i8 = waitpkg_wait_for_bit_set_i8;
+	features->wait_for_bit_set_i16 = waitpkg_wait_for_bit_set_i16;
+	features->wait_for_bit_set_i32 = waitpkg_wait_for_bit_set_i32;
+	features->wait_for_bit_set_i64 = waitpkg_wait_for_bit_set_i64;
+
+	features->wait_for_bit_not_set_i8 = waitpkg_wait_for_bit_not_set_i8;
+	features->wait_for_bit_not_set_i16 = waitpkg_wait_for_bit_not_set_i16;
+	features->wait_for_bit_not_set_i32 = waitpkg_wait_for_bit_not_set_i32;
+	features->wait_for_bit_not_set_i64 = waitpkg_wait_for_bit_not_set_i64;
+
+	set_monitor_granule_size(features);
+}
+
+// Reads files, so it runs from `wfe_mutex_detect_features` rather than `detect`, which IFUNC resolvers call.
+static void detect_umwait_control() {
+	if (!(Features.available_backends & WFE_MUTEX_BACKEND_BIT(WFE_MUTEX_BACKEND_WAITPKG))) {
+		return;
+	}
+
+	// The kernel programs IA32_UMWAIT_CONTROL and reports it here. Without the files assume the MSR's reset state,
+	// C0.2 allowed and no time limit.
+	char line[32];
+	Features.umwait_c02_enabled = true;
+	Features.umwait_max_time_cycles = 0;
+
+	if (read_first_line("/sys/devices/system/cpu/umwait_control/enable_c02", line, sizeof(line))) {
+		Features.umwait_c02_enabled = strtoul(line, NULL, 10) != 0;
+	}
+
+	if (read_first_line("/sys/devices/system/cpu/umwait_control/max_time", line, sizeof(line))) {
+		Features.umwait_max_time_cycles = strtoul(line, NULL, 10);
+	}
+
+	umwait_control_detected = true;
+
+	// The backend may already be set from the reset state assumption, apply the OS setting to it.
+	if (Features.backend == WFE_MUTEX_BACKEND_WAITPKG) {
+		set_backend_waitpkg(&Features);
+	}
+}
+
 static void detect() {
-	// Try to detect AMD monitorx first.
 	uint32_t eax, ebx, ecx, edx;
 
 	uint32_t feature_limit;
 	__cpuid_count(0, 0, eax, ebx, ecx, edx);
 	feature_limit = eax;
 
+#if defined(_M_X86_64)
+	// 128-bit waits need cmpxchg16b to observe both halves atomically.
+	__cpuid_count(1, 0, eax, ebx, ecx, edx);
+#define CMPXCHG16B_BIT 13
+	Features.supports_wait_for_i128 = (ecx >> CMPXCHG16B_BIT) & 1;
+#define AVX_BIT 28
+	Features.supports_atomic_load_u128 = Features.supports_wait_for_i128 && ((ecx >> AVX_BIT) & 1);
+#endif
+
 	__cpuid_count(0x80000000U, 0, eax, ebx, ecx, edx);
 
 	// if CPUID limit is >= 0x8000_0001.
@@ -197,48 +1011,7 @@ static void detect() {
 		__cpuid_count(0x80000001U, 0, eax, ebx, ecx, edx);
 #define MONITORX_BIT 29
 		if ((ecx >> MONITORX_BIT) & 1) {
-			// Monitorx supported.
-			Features.supports_wfe_mutex = true;
-
-			// Monitorx always supports waiting with a maximum wait time.
-			Features.supports_timed_wfe_mutex = true;
-
-			// Monitorx always supports low power cstate toggle
-			Features.supports_low_power_cstate_toggle = true;
-
-			Features.wait_type = WAIT_TYPE_MONITORX,
-			Features.wait_type_timeout = WAIT_TYPE_MONITORX,
-
-			Features.wait_for_value_i8  = mwaitx_wait_for_value_i8;
-			Features.wait_for_value_i16 = mwaitx_wait_for_value_i16;
-			Features.wait_for_value_i32 = mwaitx_wait_for_value_i32;
-			Features.wait_for_value_i64 = mwaitx_wait_for_value_i64;
-
-			Features.wait_for_value_timeout_i8  = mwaitx_wait_for_value_timeout_i8;
-			Features.wait_for_value_timeout_i16 = mwaitx_wait_for_value_timeout_i16;
-			Features.wait_for_value_timeout_i32 = mwaitx_wait_for_value_timeout_i32;
-			Features.wait_for_value_timeout_i64 = mwaitx_wait_for_value_timeout_i64;
-
-			Features.wait_for_value_spurious_oneshot_i8  = mwaitx_wait_for_value_spurious_oneshot_i8;
-			Features.wait_for_value_spurious_oneshot_i16 = mwaitx_wait_for_value_spurious_oneshot_i16;
-			Features.wait_for_value_spurious_oneshot_i32 = mwaitx_wait_for_value_spurious_oneshot_i32;
-			Features.wait_for_value_spurious_oneshot_i64 = mwaitx_wait_for_value_spurious_oneshot_i64;
-
-			Features.wait_for_bit_set_i8 = mwaitx_wait_for_bit_set_i8;
-			Features.wait_for_bit_set_i16 = mwaitx_wait_for_bit_set_i16;
-			Features.wait_for_bit_set_i32 = mwaitx_wait_for_bit_set_i32;
-			Features.wait_for_bit_set_i64 = mwaitx_wait_for_bit_set_i64;
-
-			Features.wait_for_bit_not_set_i8 = mwaitx_wait_for_bit_not_set_i8;
-			Features.wait_for_bit_not_set_i16 = mwaitx_wait_for_bit_not_set_i16;
-			Features.wait_for_bit_not_set_i32 = mwaitx_wait_for_bit_not_set_i32;
-			Features.wait_for_bit_not_set_i64 = mwaitx_wait_for_bit_not_set_i64;
-			if (feature_limit >= 5) {
-				__cpuid_count(5, 0, eax, ebx, ecx, edx);
-				Features.monitor_granule_size_bytes_min = eax & 0xFFFF;
-				Features.monitor_granule_size_bytes_max = ebx & 0xFFFF;
-			}
-			return;
+			Features.available_backends |= WFE_MUTEX_BACKEND_BIT(WFE_MUTEX_BACKEND_MONITORX);
 		}
 	}
 
@@ -249,57 +1022,47 @@ static void detect() {
 		__cpuid_count(7, 0, eax, ebx, ecx, edx);
 #define WAITPKG_BIT 5
 		if ((ecx >> WAITPKG_BIT) & 1) {
-			// waitpkg supported.
-			Features.supports_wfe_mutex = true;
-
-			// waitpkg always supports waiting with a maximum wait time.
-			Features.supports_timed_wfe_mutex = true;
-
-			// waitpkg always supports low power cstate toggle
-			Features.supports_low_power_cstate_toggle = true;
-
-			Features.wait_type = WAIT_TYPE_WAITPKG,
-			Features.wait_type_timeout = WAIT_TYPE_WAITPKG,
-
-			Features.wait_for_value_i8  = waitpkg_wait_for_value_i8;
-			Features.wait_for_value_i16 = waitpkg_wait_for_value_i16;
-			Features.wait_for_value_i32 = waitpkg_wait_for_value_i32;
-			Features.wait_for_value_i64 = waitpkg_wait_for_value_i64;
-
-			Features.wait_for_value_timeout_i8  = waitpkg_wait_for_value_timeout_i8;
-			Features.wait_for_value_timeout_i16 = waitpkg_wait_for_value_timeout_i16;
-			Features.wait_for_value_timeout_i32 = waitpkg_wait_for_value_timeout_i32;
-			Features.wait_for_value_timeout_i64 = waitpkg_wait_for_value_timeout_i64;
-
-			Features.wait_for_value_spurious_oneshot_i8  = waitpkg_wait_for_value_spurious_oneshot_i8;
-			Features.wait_for_value_spurious_oneshot_i16 = waitpkg_wait_for_value_spurious_oneshot_i16;
-			Features.wait_for_value_spurious_oneshot_i32 = waitpkg_wait_for_value_spurious_oneshot_i32;
-			Features.wait_for_value_spurious_oneshot_i64 = waitpkg_wait_for_value_spurious_oneshot_i64;
-
-			Features.wait_for_bit_set_i8 = waitpkg_wait_for_bit_set_i8;
-			Features.wait_for_bit_set_i16 = waitpkg_wait_for_bit_set_i16;
-			Features.wait_for_bit_set_i32 = waitpkg_wait_for_bit_set_i32;
-			Features.wait_for_bit_set_i64 = waitpkg_wait_for_bit_set_i64;
-
-			Features.wait_for_bit_not_set_i8 = waitpkg_wait_for_bit_not_set_i8;
-			Features.wait_for_bit_not_set_i16 = waitpkg_wait_for_bit_not_set_i16;
-			Features.wait_for_bit_not_set_i32 = waitpkg_wait_for_bit_not_set_i32;
-			Features.wait_for_bit_not_set_i64 = waitpkg_wait_for_bit_not_set_i64;
-			if (feature_limit >= 5) {
-				__cpuid_count(5, 0, eax, ebx, ecx, edx);
-				Features.monitor_granule_size_bytes_min = eax & 0xFFFF;
-				Features.monitor_granule_size_bytes_max = ebx & 0xFFFF;
-			}
+			Features.available_backends |= WFE_MUTEX_BACKEND_BIT(WFE_MUTEX_BACKEND_WAITPKG);
 		}
 	}
+
+	// Prefer AMD monitorx first.
+	if (Features.available_backends & WFE_MUTEX_BACKEND_BIT(WFE_MUTEX_BACKEND_MONITORX)) {
+		set_backend_mwaitx(&Features);
+	}
+	else if (Features.available_backends & WFE_MUTEX_BACKEND_BIT(WFE_MUTEX_BACKEND_WAITPKG)) {
+		set_backend_waitpkg(&Features);
+	}
 }
 
-static void detect_cycle_counter_frequency() {
-	// Intel reports the TSC frequency in CPUID which is nice.
-	bool has_cycle_counter = false;
+static void detect_hypervisor() {
+	uint32_t eax, ebx, ecx, edx;
+	__cpuid_count(1, 0, eax, ebx, ecx, edx);
+
+	// CPUID.1:ECX[31] is reserved for hypervisors to announce themselves.
+#define HYPERVISOR_BIT 31
+	if ((ecx >> HYPERVISOR_BIT) & 1) {
+		// Leaf 0x40000000 holds the 12 character vendor signature in EBX, ECX, EDX.
+		__cpuid_count(0x40000000U, 0, eax, ebx, ecx, edx);
+		char vendor[12];
+		memcpy(&vendor[0], &ebx, sizeof(ebx));
+		memcpy(&vendor[4], &ecx, sizeof(ecx));
+		memcpy(&vendor[8], &edx, sizeof(edx));
+		set_hypervisor_vendor(vendor, strnlen(vendor, sizeof(vendor)));
+		return;
+	}
+
+	// Some hypervisors hide the CPUID bit, the firmware still identifies them.
+	detect_hypervisor_firmware();
+}
+
+static uint64_t get_tsc_frequency_cpuid() {
 	uint32_t eax, ebx, ecx, edx;
 	__cpuid_count(0, 0, eax, ebx, ecx, edx);
-	if (eax >= 0x15) {
+	const uint32_t feature_limit = eax;
+
+	// Intel reports the TSC frequency in CPUID which is nice.
+	if (feature_limit >= 0x15) {
 		// CPUID function 0x15 returns a frequency if eax, ebx, and ecx are all not zero.
 		__cpuid_count(0x15, 0, eax, ebx, ecx, edx);
 
@@ -308,60 +1071,642 @@ static void detect_cycle_counter_frequency() {
 			// EBX = Numerator of TSC / "core crystal clock" ratio
 			// ECX = "core crystal clock frequency"
 			double Frequency = (double)ecx * ((double)ebx / (double)eax);
-			Features.cycle_hz = Frequency;
-			has_cycle_counter = true;
+			return Frequency;
 		}
 	}
 
-	if (!has_cycle_counter) {
-		// If TSC frequency isn't reported through cpuid like on AMD CPUs and older Intel CPUs then it must be calculated.
-		// Calculate the cycle counter frequency by spin-looping five times and getting the minimum cycle counter times.
+	// VMware and KVM report the guest's TSC frequency in kHz through the hypervisor timing leaf.
+	if (Features.running_under_hypervisor) {
+		__cpuid_count(0x40000000U, 0, eax, ebx, ecx, edx);
+		if (eax >= 0x40000010U) {
+			__cpuid_count(0x40000010U, 0, eax, ebx, ecx, edx);
+			if (eax) {
+				return (uint64_t)eax * 1000ULL;
+			}
+		}
+	}
 
-		uint64_t rdtsc_min = ~0ULL;
-		for (size_t i = 0; i < 5; ++i) {
-#define NANOSECOND_PER_MILLISECOND 1000000
-			struct timespec ts_start;
-			struct timespec ts_end;
+	return 0;
+}
 
-			uint64_t rdtsc_start = read_cycle_counter();
-			clock_gettime(CLOCK_MONOTONIC, &ts_start);
+static uint64_t get_tsc_frequency_base_cpuid() {
+	uint32_t eax, ebx, ecx, edx;
+	__cpuid_count(0, 0, eax, ebx, ecx, edx);
 
-			// Spin-loop until one millisecond has elapsed.
-			do {
-				if (clock_gettime(CLOCK_MONOTONIC, &ts_end) == -1) continue;
-			} while (ts_end.tv_nsec < (ts_start.tv_nsec + NANOSECOND_PER_MILLISECOND));
+	// Intel CPUs without a crystal clock in 0x15 still report their base frequency in MHz.
+	// The TSC of these runs at the base frequency, within rounding of the MHz value.
+	if (eax >= 0x16) {
+		__cpuid_count(0x16, 0, eax, ebx, ecx, edx);
+		if (eax) {
+			return (uint64_t)eax * 1000000ULL;
+		}
+	}
 
-			uint64_t rdtsc_end = read_cycle_counter();
-			uint64_t rdtsc_diff = rdtsc_end - rdtsc_start;
-			rdtsc_min = rdtsc_diff <= rdtsc_min ? rdtsc_diff : rdtsc_min;
+	return 0;
+}
+
+static uint64_t get_tsc_frequency_perf() {
+#if defined(__linux__) && defined(__NR_perf_event_open)
+	// The perf mmap page exposes the kernel's calibrated TSC to nanosecond conversion.
+	// `ns = (cycles * time_mult) >> time_shift`.
+	struct perf_event_attr attr = {
+		.type = PERF_TYPE_SOFTWARE,
+		.size = sizeof(attr),
+		.config = PERF_COUNT_SW_DUMMY,
+		.exclude_kernel = 1,
+		.exclude_hv = 1,
+	};
+
+	const int fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+	if (fd == -1) {
+		return 0;
+	}
+
+	uint64_t frequency = 0;
+	const long page_size = sysconf(_SC_PAGESIZE);
+	void *page = mmap(NULL, page_size, PROT_READ, MAP_SHARED, fd, 0);
+	if (page != MAP_FAILED) {
+		const struct perf_event_mmap_page *pc = (const struct perf_event_mmap_page *)page;
+		if (pc->cap_user_time && pc->time_mult) {
+			const double NanosecondsInSecond = 1000000000.0;
+			frequency = NanosecondsInSecond * (double)(1ULL << pc->time_shift) / (double)pc->time_mult;
 		}
+		munmap(page, page_size);
+	}
+
+	close(fd);
+	return frequency;
+#else
+	return 0;
+#endif
+}
 
-		Features.cycle_hz = rdtsc_min * 1000ULL;
+static uint64_t get_tsc_frequency_sysfs() {
+	// Only exposed by some kernels, but free to read when it is.
+	char line[32];
+	if (!read_first_line("/sys/devices/system/cpu/cpu0/tsc_freq_khz", line, sizeof(line))) {
+		return 0;
 	}
 
-	// Modern x86 CPUs have a very high cycle counter frequency.
-	// AMD Zen 3 5995WX = 2.7Ghz.
+	return strtoull(line, NULL, 10) * 1000ULL;
+}
 
-	// Assume that a 10,000 cycle scale is close enough to not matter.
-	// TODO: Make this more accurate?
+static uint64_t get_timespec_nanoseconds(const struct timespec *ts) {
 	const uint64_t NanosecondsInSecond = 1000000000ULL;
-	Features.cycles_per_nanosecond_multiplier = 10000;
-	Features.cycles_per_nanosecond_divisor = (NanosecondsInSecond * 10000) / Features.cycle_hz;
+	return ts->tv_sec * NanosecondsInSecond + ts->tv_nsec;
+}
+
+static uint64_t calibrate_tsc_frequency() {
+	// Last resort, like on AMD CPUs and older Intel CPUs without perf access.
+	// Measure the cycle counter against CLOCK_MONOTONIC over a few short windows and take the median.
+	// Both clocks cover the same window so a preemption doesn't skew the ratio, the window only bounds clock_gettime jitter.
+#define CALIBRATION_SAMPLES 3
+#define CALIBRATION_NANOSECONDS 100000
+	uint64_t frequency[CALIBRATION_SAMPLES];
+	for (size_t i = 0; i < CALIBRATION_SAMPLES; ++i) {
+		struct timespec ts_start;
+		struct timespec ts_end;
+
+		clock_gettime(CLOCK_MONOTONIC, &ts_start);
+		const uint64_t rdtsc_start = read_cycle_counter();
+		const uint64_t start = get_timespec_nanoseconds(&ts_start);
+
+		uint64_t elapsed;
+		do {
+			clock_gettime(CLOCK_MONOTONIC, &ts_end);
+			elapsed = get_timespec_nanoseconds(&ts_end) - start;
+		} while (elapsed < CALIBRATION_NANOSECONDS);
+
+		const uint64_t rdtsc_end = read_cycle_counter();
+		const double NanosecondsInSecond = 1000000000.0;
+		frequency[i] = (double)(rdtsc_end - rdtsc_start) * NanosecondsInSecond / (double)elapsed;
+	}
+
+	// Median of three.
+	const uint64_t a = frequency[0], b = frequency[1], c = frequency[2];
+	if ((a <= b && b <= c) || (c <= b && b <= a)) return b;
+	if ((b <= a && a <= c) || (c <= a && a <= b)) return a;
+	return c;
+}
+
+static void detect_cycle_counter_frequency() {
+	// The TSC frequency doesn't change, only look it up on the first init.
+	static uint64_t cached_cycle_hz = 0;
+	if (!cached_cycle_hz) {
+		// Sources ordered by precision.
+		uint64_t (*const Sources[])() = {
+			get_tsc_frequency_cpuid,
+			get_tsc_frequency_perf,
+			get_tsc_frequency_sysfs,
+			get_tsc_frequency_base_cpuid,
+			calibrate_tsc_frequency,
+		};
+
+		for (size_t i = 0; i < sizeof(Sources) / sizeof(Sources[0]) && !cached_cycle_hz; ++i) {
+			cached_cycle_hz = Sources[i]();
+		}
+	}
+
+	Features.cycle_hz = cached_cycle_hz;
+
+	// Without an invariant TSC the rate follows P-state changes and stops in deep C-states.
+	uint32_t eax, ebx, ecx, edx;
+	__cpuid_count(0x80000000U, 0, eax, ebx, ecx, edx);
+	if (eax >= 0x80000007U) {
+		__cpuid_count(0x80000007U, 0, eax, ebx, ecx, edx);
+#define INVARIANT_TSC_BIT 8
+		Features.supports_invariant_cycle_counter = (edx >> INVARIANT_TSC_BIT) & 1;
+	}
+
+	set_cycle_counter_conversion();
+}
+
+static void detect_event_stream() {
+	// Only ARM has an event stream, monitor waits here take a timeout.
 }
 
 #else
 static void detect() {
 }
 
+static void detect_event_stream() {
+}
+
+static void detect_umwait_control() {
+}
+
+static void detect_hypervisor() {
+	detect_hypervisor_firmware();
+}
+
 static void detect_cycle_counter_frequency() {
+	// `read_cycle_counter` returns CLOCK_MONOTONIC nanoseconds on unsupported platforms.
+	const uint64_t NanosecondsInSecond = 1000000000ULL;
+	Features.cycle_hz = NanosecondsInSecond;
+	Features.supports_invariant_cycle_counter = true;
+	set_cycle_counter_conversion();
 }
 #endif
 
-void wfe_mutex_detect_features() {
+static void detect_membarrier() {
+#if defined(__linux__) && defined(__NR_membarrier)
+	long supported = syscall(__NR_membarrier, MEMBARRIER_CMD_QUERY, 0);
+	if (supported == -1 || (supported & MEMBARRIER_CMD_PRIVATE_EXPEDITED) == 0) {
+		return;
+	}
+
+	// Private expedited membarrier requires the process to register before use.
+	if (syscall(__NR_membarrier, MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED, 0) == 0) {
+		Features.supports_membarrier = true;
+	}
+#endif
+}
+
+static void detect_futex() {
+#if defined(__linux__) && defined(__NR_futex)
+	// Waking a word nobody waits on only fails if futexes aren't available.
+	uint32_t word = 0;
+	if (syscall(__NR_futex, &word, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0) != -1) {
+		Features.supports_futex = true;
+	}
+#endif
+}
+
+// Hinted waits only enter a wait state if leaving it is cheap compared to the expected wait.
+#define HINT_SHORT_MAX_WAKE_NANOSECONDS 500
+#define HINT_MEDIUM_MAX_WAKE_NANOSECONDS 5000
+// Wake latency is measured by handing a word between two threads this many times, tuning uses more samples.
+#define WAKE_LATENCY_SAMPLES 8
+#define TUNE_SAMPLES 32
+// How long the waiter is left waiting before each store, long enough for it to enter the wait state.
+#define TUNE_STORE_DELAY_NANOSECONDS 20000
+
+typedef struct {
+	uint32_t word;
+	uint32_t ready;
+	uint32_t done;
+	uint32_t samples;
+	bool low_power;
+	const wfe_mutex_features *features;
+	uint64_t wake_cycles;
+	uint64_t spurious_wakeups;
+} tune_state;
+
+static void *tune_waiter(void *arg) {
+	tune_state *state = (tune_state*)arg;
+	for (uint32_t i = 1; i <= state->samples; ++i) {
+		__atomic_store_n(&state->ready, i, __ATOMIC_RELEASE);
+		while (!state->features->wait_for_value_spurious_oneshot_i32(&state->word, i, state->low_power)) {
+			++state->spurious_wakeups;
+		}
+		state->wake_cycles = read_cycle_counter();
+		__atomic_store_n(&state->done, i, __ATOMIC_RELEASE);
+	}
+	return NULL;
+}
+
+static void tune_wait_for_value(uint32_t *ptr, uint32_t value) {
+	// The waiter may share a CPU with us, so give it the chance to run.
+	while (__atomic_load_n(ptr, __ATOMIC_ACQUIRE) != value) {
+		sched_yield();
+	}
+}
+
+// Measures the median cycles from a store on this thread until a waiter on another thread returns
+// from the wait of the backend in `features`. Returns false if the waiter thread couldn't be created.
+static bool measure_wake_latency(const wfe_mutex_features *features, bool low_power, uint32_t samples, uint64_t *latency_median, uint64_t *spurious_wakeups) {
+	tune_state state = {0};
+	state.samples = samples;
+	state.low_power = low_power;
+	state.features = features;
+	pthread_t thread;
+	if (pthread_create(&thread, NULL, tune_waiter, &state) != 0) {
+		return false;
+	}
+
+	const uint64_t delay_cycles = wfe_mutex_detect_calculate_cycles_for_nanoseconds(TUNE_STORE_DELAY_NANOSECONDS);
+	uint64_t latency[TUNE_SAMPLES];
+	for (uint32_t i = 1; i <= samples; ++i) {
+		tune_wait_for_value(&state.ready, i);
+
+		const uint64_t delay_end = read_cycle_counter() + delay_cycles;
+		while (read_cycle_counter() < delay_end) {
+			sched_yield();
+		}
+
+		const uint64_t store_cycles = read_cycle_counter();
+		__atomic_store_n(&state.word, i, __ATOMIC_RELEASE);
+		tune_wait_for_value(&state.done, i);
+
+		// Cycle counters of different cores can be slightly skewed.
+		latency[i - 1] = state.wake_cycles > store_cycles ? state.wake_cycles - store_cycles : 0;
+	}
+	pthread_join(thread, NULL);
+
+	// Median, so a single preemption doesn't skew the result.
+	for (size_t i = 1; i < samples; ++i) {
+		const uint64_t value = latency[i];
+		size_t j = i;
+		for (; j > 0 && latency[j - 1] > value; --j) {
+			latency[j] = latency[j - 1];
+		}
+		latency[j] = value;
+	}
+
+	*latency_median = latency[samples / 2];
+	*spurious_wakeups = state.spurious_wakeups;
+	return true;
+}
+
+// Timed waits never spin for longer than this before their deadline, even if the wait overshoots by more.
+#define TIMEOUT_MAX_SPIN_NANOSECONDS 200000
+
+static uint64_t measure_timeout_overshoot(const wfe_mutex_features *features, bool low_power) {
+	// Time how far a wait on a word that never changes overshoots a short deadline.
+	uint32_t word = 0;
+	uint64_t overshoot[WAKE_LATENCY_SAMPLES];
+	for (size_t i = 0; i < WAKE_LATENCY_SAMPLES; ++i) {
+		const uint64_t deadline = wfe_mutex_detect_deadline_for_nanoseconds(1000);
+		features->wait_for_value_until_i32(&word, 1, deadline, low_power);
+		overshoot[i] = read_cycle_counter() - deadline;
+	}
+
+	// Median, so an interrupt or a preemption during one sample doesn't pin it at the cap.
+	for (size_t i = 1; i < WAKE_LATENCY_SAMPLES; ++i) {
+		const uint64_t value = overshoot[i];
+		size_t j = i;
+		for (; j > 0 && overshoot[j - 1] > value; --j) {
+			overshoot[j] = overshoot[j - 1];
+		}
+		overshoot[j] = value;
+	}
+
+	return overshoot[WAKE_LATENCY_SAMPLES / 2];
+}
+
+static uint64_t timeout_granularity(uint64_t overshoot) {
+	const uint64_t limit = wfe_mutex_detect_calculate_cycles_for_nanoseconds(TIMEOUT_MAX_SPIN_NANOSECONDS);
+	return overshoot < limit ? overshoot : limit;
+}
+
+static uint64_t detect_wake_latency(const wfe_mutex_features *features, bool low_power) {
+	uint64_t latency;
+	uint64_t spurious_wakeups;
+	if (!measure_wake_latency(features, low_power, WAKE_LATENCY_SAMPLES, &latency, &spurious_wakeups)) {
+		// Without a second thread to store, assume leaving the wait state is too slow for short waits.
+		return ~0ULL;
+	}
+	return latency;
+}
+
+// Fills the wake latencies, timeout granularity and hint strategies of `features` for its own backend.
+static void set_wait_hints(wfe_mutex_features *features) {
+	features->timeout_granularity_cycles = Features.backend_timeout_granularity_cycles[features->backend];
+	features->timeout_granularity_low_power_cycles = Features.backend_timeout_granularity_low_power_cycles[features->backend];
+	features->wake_latency_cycles = 0;
+	features->wake_latency_low_power_cycles = 0;
+
+	if (features->wait_type == WAIT_TYPE_SPIN) {
+		// Nothing to wake from, the spin-loop backend only differs by yielding.
+		features->hint_strategy[WFE_MUTEX_HINT_SHORT] = WAIT_STRATEGY_SPIN;
+		features->hint_strategy[WFE_MUTEX_HINT_MEDIUM] = WAIT_STRATEGY_MONITOR_LOW_POWER;
+	}
+	else {
+		features->wake_latency_cycles = detect_wake_latency(features, false);
+		features->wake_latency_low_power_cycles = features->supports_low_power_cstate_toggle ?
+			detect_wake_latency(features, true) : features->wake_latency_cycles;
+
+		features->hint_strategy[WFE_MUTEX_HINT_SHORT] =
+			features->wake_latency_cycles <= wfe_mutex_detect_calculate_cycles_for_nanoseconds(HINT_SHORT_MAX_WAKE_NANOSECONDS) ?
+				WAIT_STRATEGY_MONITOR : WAIT_STRATEGY_SPIN;
+		features->hint_strategy[WFE_MUTEX_HINT_MEDIUM] =
+			features->wake_latency_low_power_cycles <= wfe_mutex_detect_calculate_cycles_for_nanoseconds(HINT_MEDIUM_MAX_WAKE_NANOSECONDS) ?
+				WAIT_STRATEGY_MONITOR_LOW_POWER : WAIT_STRATEGY_MONITOR;
+	}
+
+	features->hint_strategy[WFE_MUTEX_HINT_LONG] = features->supports_futex ? WAIT_STRATEGY_FUTEX : WAIT_STRATEGY_MONITOR_LOW_POWER;
+}
+
+static void detect_wait_hints() {
+	set_wait_hints(&Features);
+}
+
+// Set when `WFE_MUTEX_BACKEND` picked the backend, so policies don't replace it.
+static bool backend_overridden = false;
+
+// A monitor wait trapped by the hypervisor needs an exit and a reschedule of the vCPU to notice a store,
+// slower than any bare metal wake.
+#define HYPERVISOR_MAX_WAKE_NANOSECONDS 5000
+
+static void detect_hypervisor_policy() {
+	Features.hypervisor_monitor_fallback = false;
+	if (!Features.running_under_hypervisor || Features.wait_type == WAIT_TYPE_SPIN || backend_overridden) {
+		return;
+	}
+
+	// `wake_latency_cycles` is the store-to-wake latency between two threads, not the timer granularity.
+	// Hypervisors that pass the monitor through wake as fast as bare metal, keep using it.
+	if (Features.wake_latency_cycles <= wfe_mutex_detect_calculate_cycles_for_nanoseconds(HYPERVISOR_MAX_WAKE_NANOSECONDS)) {
+		return;
+	}
+
+	Features.hypervisor_monitor_fallback = true;
+
+#if !defined(WFE_MUTEX_STATIC_BACKEND) && !defined(WFE_MUTEX_IFUNC)
+	wfe_mutex_detect_set_backend(WFE_MUTEX_BACKEND_SPIN);
+	detect_wait_hints();
+#endif
+
+	// Spin briefly then sleep in the kernel, rather than burning a vCPU the host may be sharing.
+	if (Features.supports_futex) {
+		Features.hint_strategy[WFE_MUTEX_HINT_MEDIUM] = WAIT_STRATEGY_FUTEX;
+		Features.hint_strategy[WFE_MUTEX_HINT_LONG] = WAIT_STRATEGY_FUTEX;
+	}
+}
+
+static const char *get_backend_name(uint32_t backend) {
+	switch (backend) {
+		case WFE_MUTEX_BACKEND_SPIN: return "spin";
+		case WFE_MUTEX_BACKEND_WFE: return "wfe";
+		case WFE_MUTEX_BACKEND_WFET: return "wfet";
+		case WFE_MUTEX_BACKEND_MONITORX: return "monitorx";
+		case WFE_MUTEX_BACKEND_WAITPKG: return "waitpkg";
+		default: return "<Unknown>";
+	}
+}
+
+// Fills `features` with the backend's functions, leaving everything else in it untouched.
+static bool set_backend(wfe_mutex_features *features, uint32_t backend) {
+	if (backend >= WFE_MUTEX_BACKEND_COUNT || !(Features.available_backends & WFE_MUTEX_BACKEND_BIT(backend))) {
+		return false;
+	}
+
+	switch (backend) {
+		case WFE_MUTEX_BACKEND_SPIN: set_backend_spin(features); break;
+#if defined(_M_ARM_64) || defined(_M_ARM_32)
+		case WFE_MUTEX_BACKEND_WFE: set_backend_wfe(features); break;
+#endif
+#if defined(_M_ARM_64)
+		case WFE_MUTEX_BACKEND_WFET: set_backend_wfet(features); break;
+#endif
+#if defined(_M_X86_64) || defined(_M_X86_32)
+		case WFE_MUTEX_BACKEND_MONITORX: set_backend_mwaitx(features); break;
+		case WFE_MUTEX_BACKEND_WAITPKG: set_backend_waitpkg(features); break;
+#endif
+		default: return false;
+	}
+
+	return true;
+}
+
+bool wfe_mutex_detect_set_backend(uint32_t backend) {
+	return set_backend(&Features, backend);
+}
+
+// Per-backend copies of Features handed out by `wfe_mutex_get_backend`.
+static wfe_mutex_features BackendTables[WFE_MUTEX_BACKEND_COUNT];
+
+static void detect_timeout_granularity() {
+	for (uint32_t backend = WFE_MUTEX_BACKEND_SPIN; backend < WFE_MUTEX_BACKEND_COUNT; ++backend) {
+		// Measure the bare wait instruction, not the timeout engine's spin.
+		Features.backend_timeout_granularity_cycles[backend] = 0;
+		Features.backend_timeout_granularity_low_power_cycles[backend] = 0;
+
+		// Measured through a copy, other threads keep dispatching through Features.
+		wfe_mutex_features table = Features;
+		if (!set_backend(&table, backend) || table.wait_type == WAIT_TYPE_SPIN) {
+			continue;
+		}
+
+		const uint64_t granularity = timeout_granularity(measure_timeout_overshoot(&table, false));
+		Features.backend_timeout_granularity_cycles[backend] = granularity;
+		Features.backend_timeout_granularity_low_power_cycles[backend] = table.supports_low_power_cstate_toggle ?
+			timeout_granularity(measure_timeout_overshoot(&table, true)) : granularity;
+	}
+}
+
+static void detect_backend_tables() {
+	// Built from a copy of the detected features, so other threads dispatching through Features never see
+	// another backend's functions.
+	for (uint32_t backend = WFE_MUTEX_BACKEND_SPIN; backend < WFE_MUTEX_BACKEND_COUNT; ++backend) {
+		BackendTables[backend] = Features;
+		if (!set_backend(&BackendTables[backend], backend) || backend == Features.backend) {
+			continue;
+		}
+
+		// Measurements and hints copied from Features belong to the active backend, redo them for this one.
+		set_wait_hints(&BackendTables[backend]);
+	}
+}
+
+// Lets `WFE_MUTEX_BACKEND=<name>` replace the detected backend without rebuilding.
+static void detect_backend_override() {
+	backend_overridden = false;
+	const char *name = getenv("WFE_MUTEX_BACKEND");
+	if (!name || !*name) {
+		return;
+	}
+
+#if defined(WFE_MUTEX_STATIC_BACKEND) || defined(WFE_MUTEX_IFUNC)
+	fprintf(stderr, "wfe_mutex: ignoring WFE_MUTEX_BACKEND=%s, dispatch is fixed to %s at build or load time\n", name, get_backend_name(Features.backend));
+#else
+	for (uint32_t backend = WFE_MUTEX_BACKEND_SPIN; backend < WFE_MUTEX_BACKEND_COUNT; ++backend) {
+		if (strcasecmp(name, get_backend_name(backend)) == 0) {
+			backend_overridden = wfe_mutex_detect_set_backend(backend);
+			if (!backend_overridden) {
+				fprintf(stderr, "wfe_mutex: WFE_MUTEX_BACKEND=%s isn't supported by this CPU, using %s\n", name, get_backend_name(Features.backend));
+			}
+			return;
+		}
+	}
+
+	fprintf(stderr, "wfe_mutex: unknown WFE_MUTEX_BACKEND=%s, using %s\n", name, get_backend_name(Features.backend));
+#endif
+}
+
+static void detect_backend() {
+	Features.available_backends = WFE_MUTEX_BACKEND_BIT(WFE_MUTEX_BACKEND_SPIN);
 	detect();
+
+#if defined(WFE_MUTEX_STATIC_BACKEND)
+	// Header wrappers call the static backend directly, keep Features consistent with it.
+	wfe_mutex_detect_set_backend(WFE_MUTEX_STATIC_BACKEND);
+#endif
+}
+
+void wfe_mutex_detect_backend() {
+	static bool detected = false;
+	if (detected) {
+		return;
+	}
+
+	detected = true;
+	detect_backend();
+}
+
+#if defined(WFE_MUTEX_STATIC_BACKEND)
+static void detect_static_backend() {
+	// Header wrappers call the static backend directly, it can't fall back if the CPU is missing the feature.
+	if (!(Features.available_backends & WFE_MUTEX_BACKEND_BIT(WFE_MUTEX_STATIC_BACKEND))) {
+		fprintf(stderr, "wfe_mutex: built with WFE_MUTEX_STATIC_BACKEND=%s but this CPU doesn't support it\n", get_backend_name(WFE_MUTEX_STATIC_BACKEND));
+		abort();
+	}
+}
+#endif
+
+void wfe_mutex_detect_features() {
+	detect_backend();
+#if defined(WFE_MUTEX_STATIC_BACKEND)
+	detect_static_backend();
+#endif
+	detect_umwait_control();
+	detect_hypervisor();
+	detect_backend_override();
 	detect_cycle_counter_frequency();
+	detect_event_stream();
+	detect_membarrier();
+	detect_futex();
+	detect_timeout_granularity();
+	detect_wait_hints();
+	detect_hypervisor_policy();
+	detect_backend_tables();
+}
+
+bool wfe_mutex_set_backend(uint32_t backend) {
+#if defined(WFE_MUTEX_STATIC_BACKEND) || defined(WFE_MUTEX_IFUNC)
+	// Dispatch was fixed at build or load time.
+	return backend == Features.backend;
+#else
+	if (!wfe_mutex_detect_set_backend(backend)) {
+		return false;
+	}
+
+	// The hint strategies depend on the backend's wake latency.
+	detect_wait_hints();
+	return true;
+#endif
+}
+
+const wfe_mutex_features *wfe_mutex_get_backend(uint32_t backend) {
+	if (backend >= WFE_MUTEX_BACKEND_COUNT || !(Features.available_backends & WFE_MUTEX_BACKEND_BIT(backend))) {
+		return NULL;
+	}
+
+	return &BackendTables[backend];
+}
+
+static void tune_backend(uint32_t backend) {
+	uint64_t latency;
+	uint64_t spurious_wakeups;
+	if (!measure_wake_latency(&Features, false, TUNE_SAMPLES, &latency, &spurious_wakeups)) {
+		return;
+	}
+
+	const uint64_t NanosecondsInSecond = 1000000000ULL;
+	Features.tuned_wake_latency_cycles[backend] = latency;
+	Features.tuned_spurious_wakeups_per_second[backend] =
+		spurious_wakeups * NanosecondsInSecond / (TUNE_SAMPLES * TUNE_STORE_DELAY_NANOSECONDS);
+}
+
+static uint32_t tune_pick_backend() {
+	uint32_t best = WFE_MUTEX_BACKEND_SPIN;
+	uint64_t best_score = Features.tuned_wake_latency_cycles[WFE_MUTEX_BACKEND_SPIN];
+	const uint64_t spin_spurious = Features.tuned_spurious_wakeups_per_second[WFE_MUTEX_BACKEND_SPIN];
+
+	for (uint32_t backend = WFE_MUTEX_BACKEND_SPIN + 1; backend < WFE_MUTEX_BACKEND_COUNT; ++backend) {
+		if (!(Features.available_backends & WFE_MUTEX_BACKEND_BIT(backend))) {
+			continue;
+		}
+
+		// A backend that actually sleeps saves power, so it may be up to twice as slow to wake as the spin-loop.
+		// One waking about as often as the spin-loop (WFE without monitor support) only competes on latency.
+		const bool sleeps = Features.tuned_spurious_wakeups_per_second[backend] * 2 < spin_spurious;
+		const uint64_t score = sleeps ? Features.tuned_wake_latency_cycles[backend] / 2 : Features.tuned_wake_latency_cycles[backend];
+		if (score <= best_score) {
+			best = backend;
+			best_score = score;
+		}
+	}
+
+	return best;
+}
+
+void wfe_mutex_detect_tune() {
+	for (uint32_t backend = WFE_MUTEX_BACKEND_SPIN; backend < WFE_MUTEX_BACKEND_COUNT; ++backend) {
+		Features.tuned_wake_latency_cycles[backend] = 0;
+		Features.tuned_spurious_wakeups_per_second[backend] = 0;
+
+		if (wfe_mutex_detect_set_backend(backend)) {
+			tune_backend(backend);
+		}
+	}
+
+	Features.tuned_backend = tune_pick_backend();
+
+	// The measurements already include any hypervisor exit cost.
+	Features.hypervisor_monitor_fallback = false;
+
+#if defined(WFE_MUTEX_STATIC_BACKEND) || defined(WFE_MUTEX_IFUNC)
+	// Dispatch was fixed at build or load time, only keep the measurements.
+	detect_backend();
+#else
+	wfe_mutex_detect_set_backend(Features.tuned_backend);
+	// An explicit override still wins over the measurements.
+	detect_backend_override();
+#endif
+
+	// The hint strategies depend on the backend's wake latency.
+	detect_wait_hints();
 }
 
 const wfe_mutex_features *wfe_mutex_get_features() {
 	return &Features;
 }
+
+#if defined(WFE_MUTEX_IFUNC)
+// The IFUNC entry points are already valid, finish initializing before other constructors use timeouts.
+__attribute__((constructor(101)))
+static void auto_init() {
+	wfe_mutex_init();
+}
+#endif
@@ -1,5 +1,8 @@
 #pragma once
 #include <wfe_mutex/wfe_mutex.h>
+#include "implementation_details_arm.h"
+#include "implementation_details_x86.h"
+#include "implementation_details_generic.h"
 
 #include <assert.h>
 #include <stdbool.h>
@@ -8,6 +11,25 @@
 extern wfe_mutex_features Features;
 
 void wfe_mutex_detect_features();
+
+///< Picks the backend functions without touching anything but CPU registers.
+/// Safe to call from IFUNC resolvers, only detects on the first call.
+void wfe_mutex_detect_backend();
+
+///< Repopulates the Features functions with `backend`, one of `WFE_MUTEX_BACKEND_*`.
+/// Returns false and leaves Features untouched if the CPU doesn't support it.
+bool wfe_mutex_detect_set_backend(uint32_t backend);
+
+///< Measures every available backend and switches to the fastest. Requires `wfe_mutex_detect_features` first.
+void wfe_mutex_detect_tune();
 static inline uint64_t wfe_mutex_detect_calculate_cycles_for_nanoseconds(uint64_t nanoseconds) {
-	return nanoseconds * Features.cycles_per_nanosecond_multiplier / Features.cycles_per_nanosecond_divisor;
+	return wfe_mutex_mul_shift_u64(nanoseconds, Features.nanoseconds_to_cycles_mult, Features.nanoseconds_to_cycles_shift);
+}
+
+static inline uint64_t wfe_mutex_detect_calculate_nanoseconds_for_cycles(uint64_t cycles) {
+	return wfe_mutex_mul_shift_u64(cycles, Features.cycles_to_nanoseconds_mult, Features.cycles_to_nanoseconds_shift);
+}
+
+static inline uint64_t wfe_mutex_detect_deadline_for_nanoseconds(uint64_t nanoseconds) {
+	return read_cycle_counter() + wfe_mutex_detect_calculate_cycles_for_nanoseconds(nanoseconds);
 }
@@ -0,0 +1,14 @@
+#include "detect.h"
+
+#if defined(WFE_MUTEX_IFUNC)
+// Resolvers run while the dynamic loader applies relocations, before any constructor.
+// Only backend detection is safe that early, `wfe_mutex_init` finishes the rest from a constructor.
+#define WFE_MUTEX_IFUNC_RESOLVER(name) \
+	static __typeof__(Features.name) resolve_##name() { \
+		wfe_mutex_detect_backend(); \
+		return Features.name; \
+	} \
+	__typeof__(*Features.name) wfe_mutex_ifunc_##name __attribute__((ifunc("resolve_" #name)));
+
+WFE_MUTEX_BACKEND_FUNCTIONS(WFE_MUTEX_IFUNC_RESOLVER, WFE_MUTEX_IFUNC_RESOLVER)
+#endif
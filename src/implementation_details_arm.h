@@ -4,6 +4,42 @@
 #if defined(_M_ARM_64) || defined(_M_ARM_32)
 
 #if defined(_M_ARM_64)
+#include <wfe_mutex/wfe_mutex.h>
+
+// LDAXP alone isn't single-copy atomic before LSE2, only a successful STLXP of the same value proves the pair was read atomically.
+static inline wfe_mutex_u128 atomic_load_u128(wfe_mutex_u128 *ptr) {
+	uint64_t low, high;
+	uint32_t status;
+	do {
+		__asm volatile(
+			"ldaxp %[Low], %[High], [%[Ptr]];\n"
+			"stlxp %w[Status], %[Low], %[High], [%[Ptr]];\n"
+			: [Low] "=&r" (low)
+			, [High] "=&r" (high)
+			, [Status] "=&r" (status)
+			: [Ptr] "r" (ptr)
+			: "memory");
+	} while (status);
+
+	wfe_mutex_u128 result = { low, high };
+	return result;
+}
+
+// FEAT_LSE2 makes a 16-byte aligned LDP single-copy atomic, reading the pair without the STLXP's write.
+static inline wfe_mutex_u128 atomic_load_u128_read_only(wfe_mutex_u128 *ptr) {
+	uint64_t low, high;
+	__asm volatile(
+		"ldp %[Low], %[High], [%[Ptr]];\n"
+		"dmb ishld;\n"
+		: [Low] "=r" (low)
+		, [High] "=r" (high)
+		: [Ptr] "r" (ptr)
+		: "memory");
+
+	wfe_mutex_u128 result = { low, high };
+	return result;
+}
+
 static inline uint64_t read_cycle_counter() {
 	uint64_t result;
 	__asm volatile(
@@ -0,0 +1,64 @@
+#pragma once
+#include <wfe_mutex/wfe_mutex.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(_M_ARM_64) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#if defined(__SSE2__)
+// Returns one bit per non-zero byte of the 16-byte chunk.
+static inline uint64_t doorbell_scan_chunk(const uint8_t *flags) {
+	const __m128i chunk = _mm_load_si128((const __m128i*)flags);
+	const uint32_t zero_bytes = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_setzero_si128()));
+	return ~zero_bytes & 0xFFFFU;
+}
+#elif defined(_M_ARM_64) && defined(__ARM_NEON)
+// Returns one bit per non-zero byte of the 16-byte chunk.
+static inline uint64_t doorbell_scan_chunk(const uint8_t *flags) {
+	static const uint8_t weights[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+	const uint8x16_t chunk = vld1q_u8(flags);
+	const uint8x16_t bits = vandq_u8(vtstq_u8(chunk, chunk), vld1q_u8(weights));
+	return vaddv_u8(vget_low_u8(bits)) | ((uint64_t)vaddv_u8(vget_high_u8(bits)) << 8);
+}
+#else
+// Returns one bit per non-zero byte of the 16-byte chunk.
+static inline uint64_t doorbell_scan_chunk(const uint8_t *flags) {
+	uint64_t result = 0;
+	for (uint32_t i = 0; i < 16; ++i) {
+		if (flags[i]) result |= 1ULL << i;
+	}
+	return result;
+}
+#endif
+
+// Returns a bitmask of every flag that is currently set.
+static inline uint64_t doorbell_scan(wfe_mutex_doorbell *doorbell) {
+	const uint8_t *flags = (const uint8_t*)doorbell->flags;
+	uint64_t result = 0;
+	for (uint32_t i = 0; i < WFE_MUTEX_DOORBELL_FLAGS; i += 16) {
+		result |= doorbell_scan_chunk(&flags[i]) << i;
+	}
+
+	// Order the flag reads before anything the producers published ahead of ringing.
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	return result;
+}
+
+// Clears the flags that were observed as set and returns the ones the clear took.
+// A producer can ring again between the scan and the clear, exchanging acquires its latest ring
+// instead of overwriting it.
+static inline uint64_t doorbell_consume(wfe_mutex_doorbell *doorbell, uint64_t mask) {
+	uint64_t result = 0;
+	for (uint64_t remaining = mask; remaining; remaining &= remaining - 1) {
+		const uint32_t index = __builtin_ctzll(remaining);
+		if (__atomic_exchange_n(&doorbell->flags[index], 0, __ATOMIC_ACQ_REL)) {
+			result |= 1ULL << index;
+		}
+	}
+	return result;
+}
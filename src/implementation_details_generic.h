@@ -0,0 +1,20 @@
+#pragma once
+#include <stdint.h>
+
+#if !(defined(_M_ARM_64) || defined(_M_ARM_32) || defined(_M_X86_64) || defined(_M_X86_32))
+#include <time.h>
+static inline uint64_t read_cycle_counter() {
+	// Unsupported platform. Read current nanosections from clock_gettime.
+	// Hopefully this is a VDSO call on this unsupported platform to be relatively fast.
+	// Returns the number of nanoseconds.
+	// `wfe_mutex_detect_calculate_cycles_for_nanoseconds` on an unsupported platform returns nanoseconds unmodified.
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	const uint64_t NanosecondsInSecond = 1000000000ULL;
+	return ts.tv_sec * NanosecondsInSecond + ts.tv_nsec;
+}
+
+static inline void do_yield() {
+	// Unsupported architecture, can't yield.
+}
+#endif
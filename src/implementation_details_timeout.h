@@ -0,0 +1,20 @@
+#pragma once
+#include "detect.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Timeout engine shared by the timed waits of every backend.
+// A wait instruction can return later than asked, from a clamped timer, a wake-up that only comes with the event stream,
+// or the C-state exit. Timed waits only use the wait instruction until `timeout_wait_deadline` and spin on the word
+// for the rest, so they return close to the real deadline.
+
+// Returns the deadline to give `backend`'s wait instruction, pulled in by its measured granularity.
+// Once the cycle counter passes it the caller spins until `cycles_deadline` instead.
+// Backends pass their own id, so a table from `wfe_mutex_get_backend` keeps its granularity whichever backend is active.
+static inline uint64_t timeout_wait_deadline(uint32_t backend, uint64_t cycles_deadline, bool low_power) {
+	const uint64_t granularity = low_power ?
+		Features.backend_timeout_granularity_low_power_cycles[backend] :
+		Features.backend_timeout_granularity_cycles[backend];
+	return cycles_deadline > granularity ? cycles_deadline - granularity : 0;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include "detect.h"
+
+#include <wfe_mutex/wfe_mutex.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Loads both halves separately. Fast enough to poll, but can tear between two writes.
+static inline wfe_mutex_u128 load_u128_halves(wfe_mutex_u128 *ptr) {
+	wfe_mutex_u128 result;
+	result.low = __atomic_load_n(&ptr->low, __ATOMIC_ACQUIRE);
+	result.high = __atomic_load_n(&ptr->high, __ATOMIC_ACQUIRE);
+	return result;
+}
+
+#if defined(_M_ARM_64) || defined(_M_X86_64)
+// Confirms a pair that polling the halves matched, without writing to the line when the CPU allows it.
+static inline wfe_mutex_u128 confirm_load_u128(wfe_mutex_u128 *ptr) {
+	if (Features.supports_atomic_load_u128) {
+		return atomic_load_u128_read_only(ptr);
+	}
+	return atomic_load_u128(ptr);
+}
+#endif
+
+static inline bool u128_masked_equal(wfe_mutex_u128 current, wfe_mutex_u128 mask, wfe_mutex_u128 value) {
+	return (current.low & mask.low) == value.low &&
+	       (current.high & mask.high) == value.high;
+}
+
+static inline wfe_mutex_u128 u128_all_ones() {
+	wfe_mutex_u128 result = { ~0ULL, ~0ULL };
+	return result;
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <wfe_mutex/wfe_mutex.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+static inline uint64_t wait_desc_load(const wfe_mutex_wait_desc *desc) {
+	switch (desc->size) {
+		case 1: return __atomic_load_n((uint8_t*)desc->ptr, __ATOMIC_ACQUIRE);
+		case 2: return __atomic_load_n((uint16_t*)desc->ptr, __ATOMIC_ACQUIRE);
+		case 4: return __atomic_load_n((uint32_t*)desc->ptr, __ATOMIC_ACQUIRE);
+		default: return __atomic_load_n((uint64_t*)desc->ptr, __ATOMIC_ACQUIRE);
+	}
+}
+
+static inline bool wait_desc_satisfied(const wfe_mutex_wait_desc *desc) {
+	const uint64_t current = wait_desc_load(desc);
+	switch (desc->condition) {
+		case WFE_MUTEX_WAIT_DESC_EQUAL: return current == desc->value;
+		case WFE_MUTEX_WAIT_DESC_NOT_EQUAL: return current != desc->value;
+		case WFE_MUTEX_WAIT_DESC_ANY_BIT_SET: return (current & desc->value) != 0;
+		case WFE_MUTEX_WAIT_DESC_ANY_BIT_NOT_SET: return (~current & desc->value) != 0;
+	}
+	return false;
+}
+
+// Returns the index of the first satisfied word, or `n` if none are.
+static inline size_t wait_any_find_satisfied(const wfe_mutex_wait_desc *descs, size_t n) {
+	for (size_t i = 0; i < n; ++i) {
+		if (wait_desc_satisfied(&descs[i])) return i;
+	}
+	return n;
+}
+
+// Returns true if every word lives in the same `granule` byte block, so a single monitor arm observes all of them.
+static inline bool wait_any_same_granule(const wfe_mutex_wait_desc *descs, size_t n, uint32_t granule) {
+	const uintptr_t mask = ~((uintptr_t)granule - 1);
+	const uintptr_t first = (uintptr_t)descs[0].ptr & mask;
+	for (size_t i = 0; i < n; ++i) {
+		const uintptr_t begin = (uintptr_t)descs[i].ptr;
+		const uintptr_t end = begin + descs[i].size - 1;
+		if ((begin & mask) != first || (end & mask) != first) return false;
+	}
+	return true;
+}
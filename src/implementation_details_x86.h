@@ -3,9 +3,43 @@
 
 #if defined(_M_X86_64) || defined(_M_X86_32)
 #if defined(_M_X86_64)
+#include <wfe_mutex/wfe_mutex.h>
+#include <emmintrin.h>
+
 static inline uint64_t read_cycle_counter() {
 	return __rdtsc();
 }
+
+// cmpxchg16b with a zero comparand loads the value atomically, storing zero back only if it was already zero.
+// Requires CPUID.01H:ECX.CMPXCHG16B.
+static inline wfe_mutex_u128 atomic_load_u128(wfe_mutex_u128 *ptr) {
+	uint64_t low = 0;
+	uint64_t high = 0;
+	__asm volatile(
+		"lock cmpxchg16b %[Mem];\n"
+		: "+a" (low)
+		, "+d" (high)
+		, [Mem] "+m" (*ptr)
+		: "b" (0ULL)
+		, "c" (0ULL)
+		: "memory", "cc");
+
+	wfe_mutex_u128 result = { low, high };
+	return result;
+}
+
+// Processors with AVX guarantee that 16-byte aligned vector loads are atomic, reading the pair without cmpxchg16b's write.
+static inline wfe_mutex_u128 atomic_load_u128_read_only(wfe_mutex_u128 *ptr) {
+	__m128i pair;
+	__asm volatile(
+		"movdqa %[Mem], %[Pair];\n"
+		: [Pair] "=x" (pair)
+		: [Mem] "m" (*ptr)
+		: "memory");
+
+	wfe_mutex_u128 result = { (uint64_t)_mm_cvtsi128_si64(pair), (uint64_t)_mm_cvtsi128_si64(_mm_unpackhi_epi64(pair, pair)) };
+	return result;
+}
 #elif defined(_M_X86_32)
 static inline uint64_t read_cycle_counter() {
 	uint32_t high, low;
@@ -2,27 +2,13 @@
 #include "implementations.h"
 #include "implementation_details_arm.h"
 #include "implementation_details_x86.h"
+#include "implementation_details_generic.h"
+#include "implementation_details_u128.h"
+#include "implementation_details_wait_any.h"
+#include "implementation_details_doorbell.h"
 
 #include <stdio.h>
 
-#if !(defined(_M_ARM_64) || defined(_M_ARM_32) || defined(_M_X86_64) || defined(_M_X86_32))
-#include <time.h>
-static uint64_t read_cycle_counter() {
-	// Unsupported platform. Read current nanosections from clock_gettime.
-	// Hopefully this is a VDSO call on this unsupported platform to be relatively fast.
-	// Returns the number of nanoseconds.
-	// `wfe_mutex_detect_calculate_cycles_for_nanoseconds` on an unsupported platform returns nanoseconds unmodified.
-	struct timespec ts;
-	clock_gettime(CLOCK_MONOTONIC, &ts);
-	const uint64_t NanosecondsInSecond = 1000000000ULL;
-	return ts.tv_sec * NanosecondsInSecond + ts.tv_nsec;
-}
-
-static void do_yield() {
-	// Unsupported architecture, can't yield.
-}
-#endif
-
 void spinloop_wait_for_value_i8 (uint8_t *ptr,  uint8_t value, bool low_power) {
 	if (low_power) {
 		while (__atomic_load_n(ptr, __ATOMIC_ACQUIRE) != value) {
@@ -251,11 +237,7 @@ uint64_t spinloop_wait_for_bit_not_set_i64(uint64_t *ptr, uint8_t bit, bool low_
 	return result;
 }
 
-bool spinloop_wait_for_value_timeout_i8 (uint8_t *ptr,  uint8_t value, uint64_t nanoseconds, bool low_power) {
-	const uint64_t total_cycles = wfe_mutex_detect_calculate_cycles_for_nanoseconds(nanoseconds);
-	const uint64_t begin_cycles = read_cycle_counter();
-	const uint64_t cycles_end = begin_cycles + total_cycles;
-
+bool spinloop_wait_for_value_until_i8 (uint8_t *ptr,  uint8_t value, uint64_t cycles_deadline, bool low_power) {
 	if (low_power) {
 		while (__atomic_load_n(ptr, __ATOMIC_ACQUIRE) != value) {
 			do_yield();
@@ -263,14 +245,14 @@ bool spinloop_wait_for_value_timeout_i8 (uint8_t *ptr,  uint8_t value, uint64_t
 			do_yield();
 			do_yield();
 			do_yield();
-			if (read_cycle_counter() >= cycles_end) {
+			if (read_cycle_counter() >= cycles_deadline) {
 				return false;
 			}
 		}
 	}
 	else {
 		while (__atomic_load_n(ptr, __ATOMIC_ACQUIRE) != value) {
-			if (read_cycle_counter() >= cycles_end) {
+			if (read_cycle_counter() >= cycles_deadline) {
 				return false;
 			}
 		}
@@ -279,11 +261,11 @@ bool spinloop_wait_for_value_timeout_i8 (uint8_t *ptr,  uint8_t value, uint64_t
 	return true;
 }
 
-bool spinloop_wait_for_value_timeout_i16(uint16_t *ptr, uint16_t value, uint64_t nanoseconds, bool low_power) {
-	const uint64_t total_cycles = wfe_mutex_detect_calculate_cycles_for_nanoseconds(nanoseconds);
-	const uint64_t begin_cycles = read_cycle_counter();
-	const uint64_t cycles_end = begin_cycles + total_cycles;
+bool spinloop_wait_for_value_timeout_i8 (uint8_t *ptr,  uint8_t value, uint64_t nanoseconds, bool low_power) {
+	return spinloop_wait_for_value_until_i8(ptr, value, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power);
+}
 
+bool spinloop_wait_for_value_until_i16(uint16_t *ptr, uint16_t value, uint64_t cycles_deadline, bool low_power) {
 	if (low_power) {
 		while (__atomic_load_n(ptr, __ATOMIC_ACQUIRE) != value) {
 			do_yield();
@@ -291,14 +273,14 @@ bool spinloop_wait_for_value_timeout_i16(uint16_t *ptr, uint16_t value, uint64_t
 			do_yield();
 			do_yield();
 			do_yield();
-			if (read_cycle_counter() >= cycles_end) {
+			if (read_cycle_counter() >= cycles_deadline) {
 				return false;
 			}
 		}
 	}
 	else {
 		while (__atomic_load_n(ptr, __ATOMIC_ACQUIRE) != value) {
-			if (read_cycle_counter() >= cycles_end) {
+			if (read_cycle_counter() >= cycles_deadline) {
 				return false;
 			}
 		}
@@ -307,11 +289,11 @@ bool spinloop_wait_for_value_timeout_i16(uint16_t *ptr, uint16_t value, uint64_t
 	return true;
 }
 
-bool spinloop_wait_for_value_timeout_i32(uint32_t *ptr, uint32_t value, uint64_t nanoseconds, bool low_power) {
-	const uint64_t total_cycles = wfe_mutex_detect_calculate_cycles_for_nanoseconds(nanoseconds);
-	const uint64_t begin_cycles = read_cycle_counter();
-	const uint64_t cycles_end = begin_cycles + total_cycles;
+bool spinloop_wait_for_value_timeout_i16(uint16_t *ptr, uint16_t value, uint64_t nanoseconds, bool low_power) {
+	return spinloop_wait_for_value_until_i16(ptr, value, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power);
+}
 
+bool spinloop_wait_for_value_until_i32(uint32_t *ptr, uint32_t value, uint64_t cycles_deadline, bool low_power) {
 	if (low_power) {
 		while (__atomic_load_n(ptr, __ATOMIC_ACQUIRE) != value) {
 			do_yield();
@@ -319,14 +301,14 @@ bool spinloop_wait_for_value_timeout_i32(uint32_t *ptr, uint32_t value, uint64_t
 			do_yield();
 			do_yield();
 			do_yield();
-			if (read_cycle_counter() >= cycles_end) {
+			if (read_cycle_counter() >= cycles_deadline) {
 				return false;
 			}
 		}
 	}
 	else {
 		while (__atomic_load_n(ptr, __ATOMIC_ACQUIRE) != value) {
-			if (read_cycle_counter() >= cycles_end) {
+			if (read_cycle_counter() >= cycles_deadline) {
 				return false;
 			}
 		}
@@ -335,11 +317,11 @@ bool spinloop_wait_for_value_timeout_i32(uint32_t *ptr, uint32_t value, uint64_t
 	return true;
 }
 
-bool spinloop_wait_for_value_timeout_i64(uint64_t *ptr, uint64_t value, uint64_t nanoseconds, bool low_power) {
-	const uint64_t total_cycles = wfe_mutex_detect_calculate_cycles_for_nanoseconds(nanoseconds);
-	const uint64_t begin_cycles = read_cycle_counter();
-	const uint64_t cycles_end = begin_cycles + total_cycles;
+bool spinloop_wait_for_value_timeout_i32(uint32_t *ptr, uint32_t value, uint64_t nanoseconds, bool low_power) {
+	return spinloop_wait_for_value_until_i32(ptr, value, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power);
+}
 
+bool spinloop_wait_for_value_until_i64(uint64_t *ptr, uint64_t value, uint64_t cycles_deadline, bool low_power) {
 	if (low_power) {
 		while (__atomic_load_n(ptr, __ATOMIC_ACQUIRE) != value) {
 			do_yield();
@@ -347,14 +329,14 @@ bool spinloop_wait_for_value_timeout_i64(uint64_t *ptr, uint64_t value, uint64_t
 			do_yield();
 			do_yield();
 			do_yield();
-			if (read_cycle_counter() >= cycles_end) {
+			if (read_cycle_counter() >= cycles_deadline) {
 				return false;
 			}
 		}
 	}
 	else {
 		while (__atomic_load_n(ptr, __ATOMIC_ACQUIRE) != value) {
-			if (read_cycle_counter() >= cycles_end) {
+			if (read_cycle_counter() >= cycles_deadline) {
 				return false;
 			}
 		}
@@ -363,6 +345,10 @@ bool spinloop_wait_for_value_timeout_i64(uint64_t *ptr, uint64_t value, uint64_t
 	return true;
 }
 
+bool spinloop_wait_for_value_timeout_i64(uint64_t *ptr, uint64_t value, uint64_t nanoseconds, bool low_power) {
+	return spinloop_wait_for_value_until_i64(ptr, value, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power);
+}
+
 ///< 10k cycles should be faster than anything that matters.
 const uint64_t SPURIOUS_WAKEUP_CYCLES = 10000;
 
@@ -473,3 +459,459 @@ bool spinloop_wait_for_value_spurious_oneshot_i64(uint64_t *ptr, uint64_t value,
 
 	return true;
 }
+
+uint8_t spinloop_wait_for_change_i8 (uint8_t *ptr,  uint8_t old_value, bool low_power) {
+	uint8_t result;
+	if (low_power) {
+		result = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+		while (result == old_value) {
+			do_yield();
+			do_yield();
+			do_yield();
+			do_yield();
+			do_yield();
+			result = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+		};
+	}
+	else {
+		do {
+			result = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+		} while (result == old_value);
+	}
+	return result;
+}
+
+uint16_t spinloop_wait_for_change_i16(uint16_t *ptr, uint16_t old_value, bool low_power) {
+	uint16_t result;
+	if (low_power) {
+		result = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+		while (result == old_value) {
+			do_yield();
+			do_yield();
+			do_yield();
+			do_yield();
+			do_yield();
+			result = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+		};
+	}
+	else {
+		do {
+			result = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+		} while (result == old_value);
+	}
+	return result;
+}
+
+uint32_t spinloop_wait_for_change_i32(uint32_t *ptr, uint32_t old_value, bool low_power) {
+	uint32_t result;
+	if (low_power) {
+		result = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+		while (result == old_value) {
+			do_yield();
+			do_yield();
+			do_yield();
+			do_yield();
+			do_yield();
+			result = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+		};
+	}
+	else {
+		do {
+			result = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+		} while (result == old_value);
+	}
+	return result;
+}
+
+uint64_t spinloop_wait_for_change_i64(uint64_t *ptr, uint64_t old_value, bool low_power) {
+	uint64_t result;
+	if (low_power) {
+		result = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+		while (result == old_value) {
+			do_yield();
+			do_yield();
+			do_yield();
+			do_yield();
+			do_yield();
+			result = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+		};
+	}
+	else {
+		do {
+			result = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+		} while (result == old_value);
+	}
+	return result;
+}
+
+// Predicate waits. `current` is the most recently loaded value that the predicate is evaluated against.
+#define SPINLOOP_WAIT_FOR_PREDICATE(T, predicate) \
+	T current = __atomic_load_n(ptr, __ATOMIC_ACQUIRE); \
+	while (!(predicate)) { \
+		if (low_power) { \
+			do_yield(); \
+			do_yield(); \
+			do_yield(); \
+			do_yield(); \
+			do_yield(); \
+		} \
+		current = __atomic_load_n(ptr, __ATOMIC_ACQUIRE); \
+	} \
+	return current;
+
+#define SPINLOOP_WAIT_FOR_PREDICATE_UNTIL(T, predicate) \
+	bool success = true; \
+	T current = __atomic_load_n(ptr, __ATOMIC_ACQUIRE); \
+	while (!(predicate)) { \
+		if (low_power) { \
+			do_yield(); \
+			do_yield(); \
+			do_yield(); \
+			do_yield(); \
+			do_yield(); \
+		} \
+		if (read_cycle_counter() >= cycles_deadline) { \
+			success = false; \
+			break; \
+		} \
+		current = __atomic_load_n(ptr, __ATOMIC_ACQUIRE); \
+	} \
+	if (result) *result = current; \
+	return success;
+
+#define SPINLOOP_WAIT_FOR_PREDICATE_SPURIOUS_ONESHOT(T, predicate) \
+	const uint64_t begin_cycles = read_cycle_counter(); \
+	const uint64_t cycles_end = begin_cycles + SPURIOUS_WAKEUP_CYCLES; \
+	bool success = true; \
+	T current = __atomic_load_n(ptr, __ATOMIC_ACQUIRE); \
+	while (!(predicate)) { \
+		if (low_power) { \
+			do_yield(); \
+			do_yield(); \
+			do_yield(); \
+			do_yield(); \
+			do_yield(); \
+		} \
+		if (read_cycle_counter() >= cycles_end) { \
+			success = false; \
+			break; \
+		} \
+		current = __atomic_load_n(ptr, __ATOMIC_ACQUIRE); \
+	} \
+	if (result) *result = current; \
+	return success;
+
+uint8_t spinloop_wait_for_masked_value_i8 (uint8_t *ptr,  uint8_t mask, uint8_t value, bool low_power) {
+	SPINLOOP_WAIT_FOR_PREDICATE(uint8_t, (current & mask) == value);
+}
+
+uint16_t spinloop_wait_for_masked_value_i16(uint16_t *ptr, uint16_t mask, uint16_t value, bool low_power) {
+	SPINLOOP_WAIT_FOR_PREDICATE(uint16_t, (current & mask) == value);
+}
+
+uint32_t spinloop_wait_for_masked_value_i32(uint32_t *ptr, uint32_t mask, uint32_t value, bool low_power) {
+	SPINLOOP_WAIT_FOR_PREDICATE(uint32_t, (current & mask) == value);
+}
+
+uint64_t spinloop_wait_for_masked_value_i64(uint64_t *ptr, uint64_t mask, uint64_t value, bool low_power) {
+	SPINLOOP_WAIT_FOR_PREDICATE(uint64_t, (current & mask) == value);
+}
+
+uint8_t spinloop_wait_for_any_bit_set_i8 (uint8_t *ptr,  uint8_t mask, bool low_power) {
+	SPINLOOP_WAIT_FOR_PREDICATE(uint8_t, (current & mask) != 0);
+}
+
+uint16_t spinloop_wait_for_any_bit_set_i16(uint16_t *ptr, uint16_t mask, bool low_power) {
+	SPINLOOP_WAIT_FOR_PREDICATE(uint16_t, (current & mask) != 0);
+}
+
+uint32_t spinloop_wait_for_any_bit_set_i32(uint32_t *ptr, uint32_t mask, bool low_power) {
+	SPINLOOP_WAIT_FOR_PREDICATE(uint32_t, (current & mask) != 0);
+}
+
+uint64_t spinloop_wait_for_any_bit_set_i64(uint64_t *ptr, uint64_t mask, bool low_power) {
+	SPINLOOP_WAIT_FOR_PREDICATE(uint64_t, (current & mask) != 0);
+}
+
+uint8_t spinloop_wait_for_sequence_ge_i8 (uint8_t *ptr,  uint8_t target, bool low_power) {
+	SPINLOOP_WAIT_FOR_PREDICATE(uint8_t, (int8_t)(current - target) >= 0);
+}
+
+uint16_t spinloop_wait_for_sequence_ge_i16(uint16_t *ptr, uint16_t target, bool low_power) {
+	SPINLOOP_WAIT_FOR_PREDICATE(uint16_t, (int16_t)(current - target) >= 0);
+}
+
+uint32_t spinloop_wait_for_sequence_ge_i32(uint32_t *ptr, uint32_t target, bool low_power) {
+	SPINLOOP_WAIT_FOR_PREDICATE(uint32_t, (int32_t)(current - target) >= 0);
+}
+
+uint64_t spinloop_wait_for_sequence_ge_i64(uint64_t *ptr, uint64_t target, bool low_power) {
+	SPINLOOP_WAIT_FOR_PREDICATE(uint64_t, (int64_t)(current - target) >= 0);
+}
+
+bool spinloop_wait_for_masked_value_until_i8 (uint8_t *ptr,  uint8_t mask, uint8_t value, uint64_t cycles_deadline, bool low_power, uint8_t *result) {
+	SPINLOOP_WAIT_FOR_PREDICATE_UNTIL(uint8_t, (current & mask) == value);
+}
+
+bool spinloop_wait_for_masked_value_timeout_i8 (uint8_t *ptr,  uint8_t mask, uint8_t value, uint64_t nanoseconds, bool low_power, uint8_t *result) {
+	return spinloop_wait_for_masked_value_until_i8(ptr, mask, value, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool spinloop_wait_for_masked_value_until_i16(uint16_t *ptr, uint16_t mask, uint16_t value, uint64_t cycles_deadline, bool low_power, uint16_t *result) {
+	SPINLOOP_WAIT_FOR_PREDICATE_UNTIL(uint16_t, (current & mask) == value);
+}
+
+bool spinloop_wait_for_masked_value_timeout_i16(uint16_t *ptr, uint16_t mask, uint16_t value, uint64_t nanoseconds, bool low_power, uint16_t *result) {
+	return spinloop_wait_for_masked_value_until_i16(ptr, mask, value, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool spinloop_wait_for_masked_value_until_i32(uint32_t *ptr, uint32_t mask, uint32_t value, uint64_t cycles_deadline, bool low_power, uint32_t *result) {
+	SPINLOOP_WAIT_FOR_PREDICATE_UNTIL(uint32_t, (current & mask) == value);
+}
+
+bool spinloop_wait_for_masked_value_timeout_i32(uint32_t *ptr, uint32_t mask, uint32_t value, uint64_t nanoseconds, bool low_power, uint32_t *result) {
+	return spinloop_wait_for_masked_value_until_i32(ptr, mask, value, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool spinloop_wait_for_masked_value_until_i64(uint64_t *ptr, uint64_t mask, uint64_t value, uint64_t cycles_deadline, bool low_power, uint64_t *result) {
+	SPINLOOP_WAIT_FOR_PREDICATE_UNTIL(uint64_t, (current & mask) == value);
+}
+
+bool spinloop_wait_for_masked_value_timeout_i64(uint64_t *ptr, uint64_t mask, uint64_t value, uint64_t nanoseconds, bool low_power, uint64_t *result) {
+	return spinloop_wait_for_masked_value_until_i64(ptr, mask, value, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool spinloop_wait_for_any_bit_set_until_i8 (uint8_t *ptr,  uint8_t mask, uint64_t cycles_deadline, bool low_power, uint8_t *result) {
+	SPINLOOP_WAIT_FOR_PREDICATE_UNTIL(uint8_t, (current & mask) != 0);
+}
+
+bool spinloop_wait_for_any_bit_set_timeout_i8 (uint8_t *ptr,  uint8_t mask, uint64_t nanoseconds, bool low_power, uint8_t *result) {
+	return spinloop_wait_for_any_bit_set_until_i8(ptr, mask, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool spinloop_wait_for_any_bit_set_until_i16(uint16_t *ptr, uint16_t mask, uint64_t cycles_deadline, bool low_power, uint16_t *result) {
+	SPINLOOP_WAIT_FOR_PREDICATE_UNTIL(uint16_t, (current & mask) != 0);
+}
+
+bool spinloop_wait_for_any_bit_set_timeout_i16(uint16_t *ptr, uint16_t mask, uint64_t nanoseconds, bool low_power, uint16_t *result) {
+	return spinloop_wait_for_any_bit_set_until_i16(ptr, mask, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool spinloop_wait_for_any_bit_set_until_i32(uint32_t *ptr, uint32_t mask, uint64_t cycles_deadline, bool low_power, uint32_t *result) {
+	SPINLOOP_WAIT_FOR_PREDICATE_UNTIL(uint32_t, (current & mask) != 0);
+}
+
+bool spinloop_wait_for_any_bit_set_timeout_i32(uint32_t *ptr, uint32_t mask, uint64_t nanoseconds, bool low_power, uint32_t *result) {
+	return spinloop_wait_for_any_bit_set_until_i32(ptr, mask, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool spinloop_wait_for_any_bit_set_until_i64(uint64_t *ptr, uint64_t mask, uint64_t cycles_deadline, bool low_power, uint64_t *result) {
+	SPINLOOP_WAIT_FOR_PREDICATE_UNTIL(uint64_t, (current & mask) != 0);
+}
+
+bool spinloop_wait_for_any_bit_set_timeout_i64(uint64_t *ptr, uint64_t mask, uint64_t nanoseconds, bool low_power, uint64_t *result) {
+	return spinloop_wait_for_any_bit_set_until_i64(ptr, mask, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool spinloop_wait_for_sequence_ge_until_i8 (uint8_t *ptr,  uint8_t target, uint64_t cycles_deadline, bool low_power, uint8_t *result) {
+	SPINLOOP_WAIT_FOR_PREDICATE_UNTIL(uint8_t, (int8_t)(current - target) >= 0);
+}
+
+bool spinloop_wait_for_sequence_ge_timeout_i8 (uint8_t *ptr,  uint8_t target, uint64_t nanoseconds, bool low_power, uint8_t *result) {
+	return spinloop_wait_for_sequence_ge_until_i8(ptr, target, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool spinloop_wait_for_sequence_ge_until_i16(uint16_t *ptr, uint16_t target, uint64_t cycles_deadline, bool low_power, uint16_t *result) {
+	SPINLOOP_WAIT_FOR_PREDICATE_UNTIL(uint16_t, (int16_t)(current - target) >= 0);
+}
+
+bool spinloop_wait_for_sequence_ge_timeout_i16(uint16_t *ptr, uint16_t target, uint64_t nanoseconds, bool low_power, uint16_t *result) {
+	return spinloop_wait_for_sequence_ge_until_i16(ptr, target, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool spinloop_wait_for_sequence_ge_until_i32(uint32_t *ptr, uint32_t target, uint64_t cycles_deadline, bool low_power, uint32_t *result) {
+	SPINLOOP_WAIT_FOR_PREDICATE_UNTIL(uint32_t, (int32_t)(current - target) >= 0);
+}
+
+bool spinloop_wait_for_sequence_ge_timeout_i32(uint32_t *ptr, uint32_t target, uint64_t nanoseconds, bool low_power, uint32_t *result) {
+	return spinloop_wait_for_sequence_ge_until_i32(ptr, target, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool spinloop_wait_for_sequence_ge_until_i64(uint64_t *ptr, uint64_t target, uint64_t cycles_deadline, bool low_power, uint64_t *result) {
+	SPINLOOP_WAIT_FOR_PREDICATE_UNTIL(uint64_t, (int64_t)(current - target) >= 0);
+}
+
+bool spinloop_wait_for_sequence_ge_timeout_i64(uint64_t *ptr, uint64_t target, uint64_t nanoseconds, bool low_power, uint64_t *result) {
+	return spinloop_wait_for_sequence_ge_until_i64(ptr, target, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool spinloop_wait_for_bit_set_until_i8 (uint8_t *ptr,  uint8_t bit, uint64_t cycles_deadline, bool low_power, uint8_t *result) {
+	SPINLOOP_WAIT_FOR_PREDICATE_UNTIL(uint8_t, ((current >> bit) & 1) == 1);
+}
+
+bool spinloop_wait_for_bit_set_timeout_i8 (uint8_t *ptr,  uint8_t bit, uint64_t nanoseconds, bool low_power, uint8_t *result) {
+	return spinloop_wait_for_bit_set_until_i8(ptr, bit, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool spinloop_wait_for_bit_set_until_i16(uint16_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint16_t *result) {
+	SPINLOOP_WAIT_FOR_PREDICATE_UNTIL(uint16_t, ((current >> bit) & 1) == 1);
+}
+
+bool spinloop_wait_for_bit_set_timeout_i16(uint16_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint16_t *result) {
+	return spinloop_wait_for_bit_set_until_i16(ptr, bit, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool spinloop_wait_for_bit_set_until_i32(uint32_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint32_t *result) {
+	SPINLOOP_WAIT_FOR_PREDICATE_UNTIL(uint32_t, ((current >> bit) & 1) == 1);
+}
+
+bool spinloop_wait_for_bit_set_timeout_i32(uint32_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint32_t *result) {
+	return spinloop_wait_for_bit_set_until_i32(ptr, bit, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool spinloop_wait_for_bit_set_until_i64(uint64_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint64_t *result) {
+	SPINLOOP_WAIT_FOR_PREDICATE_UNTIL(uint64_t, ((current >> bit) & 1) == 1);
+}
+
+bool spinloop_wait_for_bit_set_timeout_i64(uint64_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint64_t *result) {
+	return spinloop_wait_for_bit_set_until_i64(ptr, bit, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool spinloop_wait_for_bit_not_set_until_i8 (uint8_t *ptr,  uint8_t bit, uint64_t cycles_deadline, bool low_power, uint8_t *result) {
+	SPINLOOP_WAIT_FOR_PREDICATE_UNTIL(uint8_t, ((current >> bit) & 1) == 0);
+}
+
+bool spinloop_wait_for_bit_not_set_timeout_i8 (uint8_t *ptr,  uint8_t bit, uint64_t nanoseconds, bool low_power, uint8_t *result) {
+	return spinloop_wait_for_bit_not_set_until_i8(ptr, bit, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool spinloop_wait_for_bit_not_set_until_i16(uint16_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint16_t *result) {
+	SPINLOOP_WAIT_FOR_PREDICATE_UNTIL(uint16_t, ((current >> bit) & 1) == 0);
+}
+
+bool spinloop_wait_for_bit_not_set_timeout_i16(uint16_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint16_t *result) {
+	return spinloop_wait_for_bit_not_set_until_i16(ptr, bit, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool spinloop_wait_for_bit_not_set_until_i32(uint32_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint32_t *result) {
+	SPINLOOP_WAIT_FOR_PREDICATE_UNTIL(uint32_t, ((current >> bit) & 1) == 0);
+}
+
+bool spinloop_wait_for_bit_not_set_timeout_i32(uint32_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint32_t *result) {
+	return spinloop_wait_for_bit_not_set_until_i32(ptr, bit, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool spinloop_wait_for_bit_not_set_until_i64(uint64_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint64_t *result) {
+	SPINLOOP_WAIT_FOR_PREDICATE_UNTIL(uint64_t, ((current >> bit) & 1) == 0);
+}
+
+bool spinloop_wait_for_bit_not_set_timeout_i64(uint64_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint64_t *result) {
+	return spinloop_wait_for_bit_not_set_until_i64(ptr, bit, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool spinloop_wait_for_bit_set_spurious_oneshot_i8 (uint8_t *ptr,  uint8_t bit, bool low_power, uint8_t *result) {
+	SPINLOOP_WAIT_FOR_PREDICATE_SPURIOUS_ONESHOT(uint8_t, ((current >> bit) & 1) == 1);
+}
+
+bool spinloop_wait_for_bit_set_spurious_oneshot_i16(uint16_t *ptr, uint8_t bit, bool low_power, uint16_t *result) {
+	SPINLOOP_WAIT_FOR_PREDICATE_SPURIOUS_ONESHOT(uint16_t, ((current >> bit) & 1) == 1);
+}
+
+bool spinloop_wait_for_bit_set_spurious_oneshot_i32(uint32_t *ptr, uint8_t bit, bool low_power, uint32_t *result) {
+	SPINLOOP_WAIT_FOR_PREDICATE_SPURIOUS_ONESHOT(uint32_t, ((current >> bit) & 1) == 1);
+}
+
+bool spinloop_wait_for_bit_set_spurious_oneshot_i64(uint64_t *ptr, uint8_t bit, bool low_power, uint64_t *result) {
+	SPINLOOP_WAIT_FOR_PREDICATE_SPURIOUS_ONESHOT(uint64_t, ((current >> bit) & 1) == 1);
+}
+
+bool spinloop_wait_for_bit_not_set_spurious_oneshot_i8 (uint8_t *ptr,  uint8_t bit, bool low_power, uint8_t *result) {
+	SPINLOOP_WAIT_FOR_PREDICATE_SPURIOUS_ONESHOT(uint8_t, ((current >> bit) & 1) == 0);
+}
+
+bool spinloop_wait_for_bit_not_set_spurious_oneshot_i16(uint16_t *ptr, uint8_t bit, bool low_power, uint16_t *result) {
+	SPINLOOP_WAIT_FOR_PREDICATE_SPURIOUS_ONESHOT(uint16_t, ((current >> bit) & 1) == 0);
+}
+
+bool spinloop_wait_for_bit_not_set_spurious_oneshot_i32(uint32_t *ptr, uint8_t bit, bool low_power, uint32_t *result) {
+	SPINLOOP_WAIT_FOR_PREDICATE_SPURIOUS_ONESHOT(uint32_t, ((current >> bit) & 1) == 0);
+}
+
+bool spinloop_wait_for_bit_not_set_spurious_oneshot_i64(uint64_t *ptr, uint8_t bit, bool low_power, uint64_t *result) {
+	SPINLOOP_WAIT_FOR_PREDICATE_SPURIOUS_ONESHOT(uint64_t, ((current >> bit) & 1) == 0);
+}
+
+wfe_mutex_u128 spinloop_wait_for_masked_value_i128(wfe_mutex_u128 *ptr, wfe_mutex_u128 mask, wfe_mutex_u128 value, bool low_power) {
+	while (true) {
+		wfe_mutex_u128 current = load_u128_halves(ptr);
+		if (u128_masked_equal(current, mask, value)) {
+#if defined(_M_ARM_64) || defined(_M_X86_64)
+			// Confirm that both halves were observed together.
+			if (Features.supports_wait_for_i128) {
+				current = confirm_load_u128(ptr);
+				if (u128_masked_equal(current, mask, value)) return current;
+				continue;
+			}
+#endif
+			return current;
+		}
+
+		if (low_power) {
+			do_yield();
+			do_yield();
+			do_yield();
+			do_yield();
+			do_yield();
+		}
+	}
+}
+
+void spinloop_wait_for_value_i128(wfe_mutex_u128 *ptr, wfe_mutex_u128 value, bool low_power) {
+	spinloop_wait_for_masked_value_i128(ptr, u128_all_ones(), value, low_power);
+}
+
+size_t spinloop_wait_any_oneshot(const wfe_mutex_wait_desc *descs, size_t n, size_t monitor_index, uint64_t nanoseconds, bool low_power) {
+	// Nothing to arm, poll every word until one is satisfied or the wait would have spuriously woken.
+	const uint64_t total_cycles = nanoseconds ? wfe_mutex_detect_calculate_cycles_for_nanoseconds(nanoseconds) : SPURIOUS_WAKEUP_CYCLES;
+	const uint64_t begin_cycles = read_cycle_counter();
+	const uint64_t cycles_end = begin_cycles + total_cycles;
+
+	size_t index;
+	while ((index = wait_any_find_satisfied(descs, n)) == n) {
+		if (low_power) {
+			do_yield();
+			do_yield();
+			do_yield();
+			do_yield();
+			do_yield();
+		}
+		if (read_cycle_counter() >= cycles_end) break;
+	}
+	return index;
+}
+
+uint64_t spinloop_doorbell_wait(wfe_mutex_doorbell *doorbell, bool low_power) {
+	uint64_t mask;
+	while ((mask = doorbell_scan(doorbell)) == 0) {
+		if (low_power) {
+			do_yield();
+			do_yield();
+			do_yield();
+			do_yield();
+			do_yield();
+		}
+	}
+	return doorbell_consume(doorbell, mask);
+}
+
+void spinloop_sleep_until(uint64_t cycles_deadline, bool low_power) {
+	while (read_cycle_counter() < cycles_deadline) {
+		if (low_power) {
+			do_yield();
+			do_yield();
+			do_yield();
+			do_yield();
+			do_yield();
+		}
+	}
+}
@@ -1,4 +1,6 @@
 #pragma once
+#include <wfe_mutex/wfe_mutex.h>
+
 #include <stdbool.h>
 #include <stdint.h>
 
@@ -8,6 +10,10 @@
 #define SYMBOL_EXPORT
 #endif
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 // spin-loop implementations
 void spinloop_wait_for_value_i8 (uint8_t *ptr,  uint8_t value, bool low_power);
 void spinloop_wait_for_value_i16(uint16_t *ptr, uint16_t value, bool low_power);
@@ -24,6 +30,11 @@ uint16_t spinloop_wait_for_bit_not_set_i16(uint16_t *ptr, uint8_t bit, bool low_
 uint32_t spinloop_wait_for_bit_not_set_i32(uint32_t *ptr, uint8_t bit, bool low_power);
 uint64_t spinloop_wait_for_bit_not_set_i64(uint64_t *ptr, uint8_t bit, bool low_power);
 
+bool spinloop_wait_for_value_until_i8 (uint8_t *ptr,  uint8_t value, uint64_t cycles_deadline, bool low_power);
+bool spinloop_wait_for_value_until_i16(uint16_t *ptr, uint16_t value, uint64_t cycles_deadline, bool low_power);
+bool spinloop_wait_for_value_until_i32(uint32_t *ptr, uint32_t value, uint64_t cycles_deadline, bool low_power);
+bool spinloop_wait_for_value_until_i64(uint64_t *ptr, uint64_t value, uint64_t cycles_deadline, bool low_power);
+
 bool spinloop_wait_for_value_timeout_i8 (uint8_t *ptr,  uint8_t value, uint64_t nanoseconds, bool low_power);
 bool spinloop_wait_for_value_timeout_i16(uint16_t *ptr, uint16_t value, uint64_t nanoseconds, bool low_power);
 bool spinloop_wait_for_value_timeout_i32(uint32_t *ptr, uint32_t value, uint64_t nanoseconds, bool low_power);
@@ -34,6 +45,93 @@ bool spinloop_wait_for_value_spurious_oneshot_i16(uint16_t *ptr, uint16_t value,
 bool spinloop_wait_for_value_spurious_oneshot_i32(uint32_t *ptr, uint32_t value, bool low_power);
 bool spinloop_wait_for_value_spurious_oneshot_i64(uint64_t *ptr, uint64_t value, bool low_power);
 
+uint8_t spinloop_wait_for_change_i8 (uint8_t *ptr,  uint8_t old_value, bool low_power);
+uint16_t spinloop_wait_for_change_i16(uint16_t *ptr, uint16_t old_value, bool low_power);
+uint32_t spinloop_wait_for_change_i32(uint32_t *ptr, uint32_t old_value, bool low_power);
+uint64_t spinloop_wait_for_change_i64(uint64_t *ptr, uint64_t old_value, bool low_power);
+
+uint8_t spinloop_wait_for_masked_value_i8 (uint8_t *ptr,  uint8_t mask, uint8_t value, bool low_power);
+uint16_t spinloop_wait_for_masked_value_i16(uint16_t *ptr, uint16_t mask, uint16_t value, bool low_power);
+uint32_t spinloop_wait_for_masked_value_i32(uint32_t *ptr, uint32_t mask, uint32_t value, bool low_power);
+uint64_t spinloop_wait_for_masked_value_i64(uint64_t *ptr, uint64_t mask, uint64_t value, bool low_power);
+
+uint8_t spinloop_wait_for_any_bit_set_i8 (uint8_t *ptr,  uint8_t mask, bool low_power);
+uint16_t spinloop_wait_for_any_bit_set_i16(uint16_t *ptr, uint16_t mask, bool low_power);
+uint32_t spinloop_wait_for_any_bit_set_i32(uint32_t *ptr, uint32_t mask, bool low_power);
+uint64_t spinloop_wait_for_any_bit_set_i64(uint64_t *ptr, uint64_t mask, bool low_power);
+
+uint8_t spinloop_wait_for_sequence_ge_i8 (uint8_t *ptr,  uint8_t target, bool low_power);
+uint16_t spinloop_wait_for_sequence_ge_i16(uint16_t *ptr, uint16_t target, bool low_power);
+uint32_t spinloop_wait_for_sequence_ge_i32(uint32_t *ptr, uint32_t target, bool low_power);
+uint64_t spinloop_wait_for_sequence_ge_i64(uint64_t *ptr, uint64_t target, bool low_power);
+
+bool spinloop_wait_for_masked_value_until_i8 (uint8_t *ptr,  uint8_t mask, uint8_t value, uint64_t cycles_deadline, bool low_power, uint8_t *result);
+bool spinloop_wait_for_masked_value_until_i16(uint16_t *ptr, uint16_t mask, uint16_t value, uint64_t cycles_deadline, bool low_power, uint16_t *result);
+bool spinloop_wait_for_masked_value_until_i32(uint32_t *ptr, uint32_t mask, uint32_t value, uint64_t cycles_deadline, bool low_power, uint32_t *result);
+bool spinloop_wait_for_masked_value_until_i64(uint64_t *ptr, uint64_t mask, uint64_t value, uint64_t cycles_deadline, bool low_power, uint64_t *result);
+
+bool spinloop_wait_for_masked_value_timeout_i8 (uint8_t *ptr,  uint8_t mask, uint8_t value, uint64_t nanoseconds, bool low_power, uint8_t *result);
+bool spinloop_wait_for_masked_value_timeout_i16(uint16_t *ptr, uint16_t mask, uint16_t value, uint64_t nanoseconds, bool low_power, uint16_t *result);
+bool spinloop_wait_for_masked_value_timeout_i32(uint32_t *ptr, uint32_t mask, uint32_t value, uint64_t nanoseconds, bool low_power, uint32_t *result);
+bool spinloop_wait_for_masked_value_timeout_i64(uint64_t *ptr, uint64_t mask, uint64_t value, uint64_t nanoseconds, bool low_power, uint64_t *result);
+
+bool spinloop_wait_for_any_bit_set_until_i8 (uint8_t *ptr,  uint8_t mask, uint64_t cycles_deadline, bool low_power, uint8_t *result);
+bool spinloop_wait_for_any_bit_set_until_i16(uint16_t *ptr, uint16_t mask, uint64_t cycles_deadline, bool low_power, uint16_t *result);
+bool spinloop_wait_for_any_bit_set_until_i32(uint32_t *ptr, uint32_t mask, uint64_t cycles_deadline, bool low_power, uint32_t *result);
+bool spinloop_wait_for_any_bit_set_until_i64(uint64_t *ptr, uint64_t mask, uint64_t cycles_deadline, bool low_power, uint64_t *result);
+
+bool spinloop_wait_for_any_bit_set_timeout_i8 (uint8_t *ptr,  uint8_t mask, uint64_t nanoseconds, bool low_power, uint8_t *result);
+bool spinloop_wait_for_any_bit_set_timeout_i16(uint16_t *ptr, uint16_t mask, uint64_t nanoseconds, bool low_power, uint16_t *result);
+bool spinloop_wait_for_any_bit_set_timeout_i32(uint32_t *ptr, uint32_t mask, uint64_t nanoseconds, bool low_power, uint32_t *result);
+bool spinloop_wait_for_any_bit_set_timeout_i64(uint64_t *ptr, uint64_t mask, uint64_t nanoseconds, bool low_power, uint64_t *result);
+
+bool spinloop_wait_for_sequence_ge_until_i8 (uint8_t *ptr,  uint8_t target, uint64_t cycles_deadline, bool low_power, uint8_t *result);
+bool spinloop_wait_for_sequence_ge_until_i16(uint16_t *ptr, uint16_t target, uint64_t cycles_deadline, bool low_power, uint16_t *result);
+bool spinloop_wait_for_sequence_ge_until_i32(uint32_t *ptr, uint32_t target, uint64_t cycles_deadline, bool low_power, uint32_t *result);
+bool spinloop_wait_for_sequence_ge_until_i64(uint64_t *ptr, uint64_t target, uint64_t cycles_deadline, bool low_power, uint64_t *result);
+
+bool spinloop_wait_for_sequence_ge_timeout_i8 (uint8_t *ptr,  uint8_t target, uint64_t nanoseconds, bool low_power, uint8_t *result);
+bool spinloop_wait_for_sequence_ge_timeout_i16(uint16_t *ptr, uint16_t target, uint64_t nanoseconds, bool low_power, uint16_t *result);
+bool spinloop_wait_for_sequence_ge_timeout_i32(uint32_t *ptr, uint32_t target, uint64_t nanoseconds, bool low_power, uint32_t *result);
+bool spinloop_wait_for_sequence_ge_timeout_i64(uint64_t *ptr, uint64_t target, uint64_t nanoseconds, bool low_power, uint64_t *result);
+
+void spinloop_wait_for_value_i128(wfe_mutex_u128 *ptr, wfe_mutex_u128 value, bool low_power);
+wfe_mutex_u128 spinloop_wait_for_masked_value_i128(wfe_mutex_u128 *ptr, wfe_mutex_u128 mask, wfe_mutex_u128 value, bool low_power);
+
+bool spinloop_wait_for_bit_set_until_i8 (uint8_t *ptr,  uint8_t bit, uint64_t cycles_deadline, bool low_power, uint8_t *result);
+bool spinloop_wait_for_bit_set_until_i16(uint16_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint16_t *result);
+bool spinloop_wait_for_bit_set_until_i32(uint32_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint32_t *result);
+bool spinloop_wait_for_bit_set_until_i64(uint64_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint64_t *result);
+
+bool spinloop_wait_for_bit_set_timeout_i8 (uint8_t *ptr,  uint8_t bit, uint64_t nanoseconds, bool low_power, uint8_t *result);
+bool spinloop_wait_for_bit_set_timeout_i16(uint16_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint16_t *result);
+bool spinloop_wait_for_bit_set_timeout_i32(uint32_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint32_t *result);
+bool spinloop_wait_for_bit_set_timeout_i64(uint64_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint64_t *result);
+
+bool spinloop_wait_for_bit_not_set_until_i8 (uint8_t *ptr,  uint8_t bit, uint64_t cycles_deadline, bool low_power, uint8_t *result);
+bool spinloop_wait_for_bit_not_set_until_i16(uint16_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint16_t *result);
+bool spinloop_wait_for_bit_not_set_until_i32(uint32_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint32_t *result);
+bool spinloop_wait_for_bit_not_set_until_i64(uint64_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint64_t *result);
+
+bool spinloop_wait_for_bit_not_set_timeout_i8 (uint8_t *ptr,  uint8_t bit, uint64_t nanoseconds, bool low_power, uint8_t *result);
+bool spinloop_wait_for_bit_not_set_timeout_i16(uint16_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint16_t *result);
+bool spinloop_wait_for_bit_not_set_timeout_i32(uint32_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint32_t *result);
+bool spinloop_wait_for_bit_not_set_timeout_i64(uint64_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint64_t *result);
+
+bool spinloop_wait_for_bit_set_spurious_oneshot_i8 (uint8_t *ptr,  uint8_t bit, bool low_power, uint8_t *result);
+bool spinloop_wait_for_bit_set_spurious_oneshot_i16(uint16_t *ptr, uint8_t bit, bool low_power, uint16_t *result);
+bool spinloop_wait_for_bit_set_spurious_oneshot_i32(uint32_t *ptr, uint8_t bit, bool low_power, uint32_t *result);
+bool spinloop_wait_for_bit_set_spurious_oneshot_i64(uint64_t *ptr, uint8_t bit, bool low_power, uint64_t *result);
+
+bool spinloop_wait_for_bit_not_set_spurious_oneshot_i8 (uint8_t *ptr,  uint8_t bit, bool low_power, uint8_t *result);
+bool spinloop_wait_for_bit_not_set_spurious_oneshot_i16(uint16_t *ptr, uint8_t bit, bool low_power, uint16_t *result);
+bool spinloop_wait_for_bit_not_set_spurious_oneshot_i32(uint32_t *ptr, uint8_t bit, bool low_power, uint32_t *result);
+bool spinloop_wait_for_bit_not_set_spurious_oneshot_i64(uint64_t *ptr, uint8_t bit, bool low_power, uint64_t *result);
+
+size_t spinloop_wait_any_oneshot(const wfe_mutex_wait_desc *descs, size_t n, size_t monitor_index, uint64_t nanoseconds, bool low_power);
+uint64_t spinloop_doorbell_wait(wfe_mutex_doorbell *doorbell, bool low_power);
+void spinloop_sleep_until(uint64_t cycles_deadline, bool low_power);
+
 #if defined(_M_ARM_64) || defined(_M_ARM_32)
 // wfe implementation
 void wfe_wait_for_value_i8 (uint8_t *ptr,  uint8_t value, bool low_power);
@@ -58,6 +156,13 @@ uint32_t wfe_wait_for_bit_not_set_i32(uint32_t *ptr, uint8_t bit, bool low_power
 uint64_t wfe_wait_for_bit_not_set_i64(uint64_t *ptr, uint8_t bit, bool low_power);
 #endif
 
+bool wfe_wait_for_value_until_i8 (uint8_t *ptr,  uint8_t value, uint64_t cycles_deadline, bool low_power);
+bool wfe_wait_for_value_until_i16(uint16_t *ptr, uint16_t value, uint64_t cycles_deadline, bool low_power);
+bool wfe_wait_for_value_until_i32(uint32_t *ptr, uint32_t value, uint64_t cycles_deadline, bool low_power);
+#if defined(_M_ARM_64)
+bool wfe_wait_for_value_until_i64(uint64_t *ptr, uint64_t value, uint64_t cycles_deadline, bool low_power);
+#endif
+
 bool wfe_wait_for_value_timeout_i8 (uint8_t *ptr,  uint8_t value, uint64_t nanoseconds, bool low_power);
 bool wfe_wait_for_value_timeout_i16(uint16_t *ptr, uint16_t value, uint64_t nanoseconds, bool low_power);
 bool wfe_wait_for_value_timeout_i32(uint32_t *ptr, uint32_t value, uint64_t nanoseconds, bool low_power);
@@ -72,11 +177,190 @@ bool wfe_wait_for_value_spurious_oneshot_i32(uint32_t *ptr, uint32_t value, bool
 bool wfe_wait_for_value_spurious_oneshot_i64(uint64_t *ptr, uint64_t value, bool low_power);
 #endif
 
+uint8_t wfe_wait_for_change_i8 (uint8_t *ptr,  uint8_t old_value, bool low_power);
+uint16_t wfe_wait_for_change_i16(uint16_t *ptr, uint16_t old_value, bool low_power);
+uint32_t wfe_wait_for_change_i32(uint32_t *ptr, uint32_t old_value, bool low_power);
+#if defined(_M_ARM_64)
+uint64_t wfe_wait_for_change_i64(uint64_t *ptr, uint64_t old_value, bool low_power);
+#endif
+
+uint8_t wfe_wait_for_masked_value_i8 (uint8_t *ptr,  uint8_t mask, uint8_t value, bool low_power);
+uint16_t wfe_wait_for_masked_value_i16(uint16_t *ptr, uint16_t mask, uint16_t value, bool low_power);
+uint32_t wfe_wait_for_masked_value_i32(uint32_t *ptr, uint32_t mask, uint32_t value, bool low_power);
+#if defined(_M_ARM_64)
+uint64_t wfe_wait_for_masked_value_i64(uint64_t *ptr, uint64_t mask, uint64_t value, bool low_power);
+#endif
+
+uint8_t wfe_wait_for_any_bit_set_i8 (uint8_t *ptr,  uint8_t mask, bool low_power);
+uint16_t wfe_wait_for_any_bit_set_i16(uint16_t *ptr, uint16_t mask, bool low_power);
+uint32_t wfe_wait_for_any_bit_set_i32(uint32_t *ptr, uint32_t mask, bool low_power);
+#if defined(_M_ARM_64)
+uint64_t wfe_wait_for_any_bit_set_i64(uint64_t *ptr, uint64_t mask, bool low_power);
+#endif
+
+uint8_t wfe_wait_for_sequence_ge_i8 (uint8_t *ptr,  uint8_t target, bool low_power);
+uint16_t wfe_wait_for_sequence_ge_i16(uint16_t *ptr, uint16_t target, bool low_power);
+uint32_t wfe_wait_for_sequence_ge_i32(uint32_t *ptr, uint32_t target, bool low_power);
+#if defined(_M_ARM_64)
+uint64_t wfe_wait_for_sequence_ge_i64(uint64_t *ptr, uint64_t target, bool low_power);
+#endif
+
+bool wfe_wait_for_masked_value_until_i8 (uint8_t *ptr,  uint8_t mask, uint8_t value, uint64_t cycles_deadline, bool low_power, uint8_t *result);
+bool wfe_wait_for_masked_value_until_i16(uint16_t *ptr, uint16_t mask, uint16_t value, uint64_t cycles_deadline, bool low_power, uint16_t *result);
+bool wfe_wait_for_masked_value_until_i32(uint32_t *ptr, uint32_t mask, uint32_t value, uint64_t cycles_deadline, bool low_power, uint32_t *result);
+#if defined(_M_ARM_64)
+bool wfe_wait_for_masked_value_until_i64(uint64_t *ptr, uint64_t mask, uint64_t value, uint64_t cycles_deadline, bool low_power, uint64_t *result);
+#endif
+
+bool wfe_wait_for_masked_value_timeout_i8 (uint8_t *ptr,  uint8_t mask, uint8_t value, uint64_t nanoseconds, bool low_power, uint8_t *result);
+bool wfe_wait_for_masked_value_timeout_i16(uint16_t *ptr, uint16_t mask, uint16_t value, uint64_t nanoseconds, bool low_power, uint16_t *result);
+bool wfe_wait_for_masked_value_timeout_i32(uint32_t *ptr, uint32_t mask, uint32_t value, uint64_t nanoseconds, bool low_power, uint32_t *result);
+#if defined(_M_ARM_64)
+bool wfe_wait_for_masked_value_timeout_i64(uint64_t *ptr, uint64_t mask, uint64_t value, uint64_t nanoseconds, bool low_power, uint64_t *result);
+#endif
+
+bool wfe_wait_for_any_bit_set_until_i8 (uint8_t *ptr,  uint8_t mask, uint64_t cycles_deadline, bool low_power, uint8_t *result);
+bool wfe_wait_for_any_bit_set_until_i16(uint16_t *ptr, uint16_t mask, uint64_t cycles_deadline, bool low_power, uint16_t *result);
+bool wfe_wait_for_any_bit_set_until_i32(uint32_t *ptr, uint32_t mask, uint64_t cycles_deadline, bool low_power, uint32_t *result);
+#if defined(_M_ARM_64)
+bool wfe_wait_for_any_bit_set_until_i64(uint64_t *ptr, uint64_t mask, uint64_t cycles_deadline, bool low_power, uint64_t *result);
+#endif
+
+bool wfe_wait_for_any_bit_set_timeout_i8 (uint8_t *ptr,  uint8_t mask, uint64_t nanoseconds, bool low_power, uint8_t *result);
+bool wfe_wait_for_any_bit_set_timeout_i16(uint16_t *ptr, uint16_t mask, uint64_t nanoseconds, bool low_power, uint16_t *result);
+bool wfe_wait_for_any_bit_set_timeout_i32(uint32_t *ptr, uint32_t mask, uint64_t nanoseconds, bool low_power, uint32_t *result);
+#if defined(_M_ARM_64)
+bool wfe_wait_for_any_bit_set_timeout_i64(uint64_t *ptr, uint64_t mask, uint64_t nanoseconds, bool low_power, uint64_t *result);
+#endif
+
+bool wfe_wait_for_sequence_ge_until_i8 (uint8_t *ptr,  uint8_t target, uint64_t cycles_deadline, bool low_power, uint8_t *result);
+bool wfe_wait_for_sequence_ge_until_i16(uint16_t *ptr, uint16_t target, uint64_t cycles_deadline, bool low_power, uint16_t *result);
+bool wfe_wait_for_sequence_ge_until_i32(uint32_t *ptr, uint32_t target, uint64_t cycles_deadline, bool low_power, uint32_t *result);
+#if defined(_M_ARM_64)
+bool wfe_wait_for_sequence_ge_until_i64(uint64_t *ptr, uint64_t target, uint64_t cycles_deadline, bool low_power, uint64_t *result);
+#endif
+
+bool wfe_wait_for_sequence_ge_timeout_i8 (uint8_t *ptr,  uint8_t target, uint64_t nanoseconds, bool low_power, uint8_t *result);
+bool wfe_wait_for_sequence_ge_timeout_i16(uint16_t *ptr, uint16_t target, uint64_t nanoseconds, bool low_power, uint16_t *result);
+bool wfe_wait_for_sequence_ge_timeout_i32(uint32_t *ptr, uint32_t target, uint64_t nanoseconds, bool low_power, uint32_t *result);
+#if defined(_M_ARM_64)
+bool wfe_wait_for_sequence_ge_timeout_i64(uint64_t *ptr, uint64_t target, uint64_t nanoseconds, bool low_power, uint64_t *result);
+#endif
+
+bool wfe_wait_for_bit_set_until_i8 (uint8_t *ptr,  uint8_t bit, uint64_t cycles_deadline, bool low_power, uint8_t *result);
+bool wfe_wait_for_bit_set_until_i16(uint16_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint16_t *result);
+bool wfe_wait_for_bit_set_until_i32(uint32_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint32_t *result);
+#if defined(_M_ARM_64)
+bool wfe_wait_for_bit_set_until_i64(uint64_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint64_t *result);
+#endif
+
+bool wfe_wait_for_bit_set_timeout_i8 (uint8_t *ptr,  uint8_t bit, uint64_t nanoseconds, bool low_power, uint8_t *result);
+bool wfe_wait_for_bit_set_timeout_i16(uint16_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint16_t *result);
+bool wfe_wait_for_bit_set_timeout_i32(uint32_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint32_t *result);
+#if defined(_M_ARM_64)
+bool wfe_wait_for_bit_set_timeout_i64(uint64_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint64_t *result);
+#endif
+
+bool wfe_wait_for_bit_not_set_until_i8 (uint8_t *ptr,  uint8_t bit, uint64_t cycles_deadline, bool low_power, uint8_t *result);
+bool wfe_wait_for_bit_not_set_until_i16(uint16_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint16_t *result);
+bool wfe_wait_for_bit_not_set_until_i32(uint32_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint32_t *result);
+#if defined(_M_ARM_64)
+bool wfe_wait_for_bit_not_set_until_i64(uint64_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint64_t *result);
+#endif
+
+bool wfe_wait_for_bit_not_set_timeout_i8 (uint8_t *ptr,  uint8_t bit, uint64_t nanoseconds, bool low_power, uint8_t *result);
+bool wfe_wait_for_bit_not_set_timeout_i16(uint16_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint16_t *result);
+bool wfe_wait_for_bit_not_set_timeout_i32(uint32_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint32_t *result);
+#if defined(_M_ARM_64)
+bool wfe_wait_for_bit_not_set_timeout_i64(uint64_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint64_t *result);
+#endif
+
+bool wfe_wait_for_bit_set_spurious_oneshot_i8 (uint8_t *ptr,  uint8_t bit, bool low_power, uint8_t *result);
+bool wfe_wait_for_bit_set_spurious_oneshot_i16(uint16_t *ptr, uint8_t bit, bool low_power, uint16_t *result);
+bool wfe_wait_for_bit_set_spurious_oneshot_i32(uint32_t *ptr, uint8_t bit, bool low_power, uint32_t *result);
+#if defined(_M_ARM_64)
+bool wfe_wait_for_bit_set_spurious_oneshot_i64(uint64_t *ptr, uint8_t bit, bool low_power, uint64_t *result);
+#endif
+
+bool wfe_wait_for_bit_not_set_spurious_oneshot_i8 (uint8_t *ptr,  uint8_t bit, bool low_power, uint8_t *result);
+bool wfe_wait_for_bit_not_set_spurious_oneshot_i16(uint16_t *ptr, uint8_t bit, bool low_power, uint16_t *result);
+bool wfe_wait_for_bit_not_set_spurious_oneshot_i32(uint32_t *ptr, uint8_t bit, bool low_power, uint32_t *result);
+#if defined(_M_ARM_64)
+bool wfe_wait_for_bit_not_set_spurious_oneshot_i64(uint64_t *ptr, uint8_t bit, bool low_power, uint64_t *result);
+#endif
+
+size_t wfe_wait_any_oneshot(const wfe_mutex_wait_desc *descs, size_t n, size_t monitor_index, uint64_t nanoseconds, bool low_power);
+uint64_t wfe_doorbell_wait(wfe_mutex_doorbell *doorbell, bool low_power);
+void wfe_sleep_until(uint64_t cycles_deadline, bool low_power);
+
 #if defined(_M_ARM_64)
+void wfe_wait_for_value_i128(wfe_mutex_u128 *ptr, wfe_mutex_u128 value, bool low_power);
+wfe_mutex_u128 wfe_wait_for_masked_value_i128(wfe_mutex_u128 *ptr, wfe_mutex_u128 mask, wfe_mutex_u128 value, bool low_power);
+#endif
+
+#if defined(_M_ARM_64)
+bool wfet_wait_for_value_until_i8 (uint8_t *ptr,  uint8_t value, uint64_t cycles_deadline, bool low_power);
+bool wfet_wait_for_value_until_i16(uint16_t *ptr, uint16_t value, uint64_t cycles_deadline, bool low_power);
+bool wfet_wait_for_value_until_i32(uint32_t *ptr, uint32_t value, uint64_t cycles_deadline, bool low_power);
+bool wfet_wait_for_value_until_i64(uint64_t *ptr, uint64_t value, uint64_t cycles_deadline, bool low_power);
+
 bool wfet_wait_for_value_timeout_i8 (uint8_t *ptr,  uint8_t value, uint64_t nanoseconds, bool low_power);
 bool wfet_wait_for_value_timeout_i16(uint16_t *ptr, uint16_t value, uint64_t nanoseconds, bool low_power);
 bool wfet_wait_for_value_timeout_i32(uint32_t *ptr, uint32_t value, uint64_t nanoseconds, bool low_power);
 bool wfet_wait_for_value_timeout_i64(uint64_t *ptr, uint64_t value, uint64_t nanoseconds, bool low_power);
+
+bool wfet_wait_for_masked_value_until_i8 (uint8_t *ptr,  uint8_t mask, uint8_t value, uint64_t cycles_deadline, bool low_power, uint8_t *result);
+bool wfet_wait_for_masked_value_until_i16(uint16_t *ptr, uint16_t mask, uint16_t value, uint64_t cycles_deadline, bool low_power, uint16_t *result);
+bool wfet_wait_for_masked_value_until_i32(uint32_t *ptr, uint32_t mask, uint32_t value, uint64_t cycles_deadline, bool low_power, uint32_t *result);
+bool wfet_wait_for_masked_value_until_i64(uint64_t *ptr, uint64_t mask, uint64_t value, uint64_t cycles_deadline, bool low_power, uint64_t *result);
+
+bool wfet_wait_for_masked_value_timeout_i8 (uint8_t *ptr,  uint8_t mask, uint8_t value, uint64_t nanoseconds, bool low_power, uint8_t *result);
+bool wfet_wait_for_masked_value_timeout_i16(uint16_t *ptr, uint16_t mask, uint16_t value, uint64_t nanoseconds, bool low_power, uint16_t *result);
+bool wfet_wait_for_masked_value_timeout_i32(uint32_t *ptr, uint32_t mask, uint32_t value, uint64_t nanoseconds, bool low_power, uint32_t *result);
+bool wfet_wait_for_masked_value_timeout_i64(uint64_t *ptr, uint64_t mask, uint64_t value, uint64_t nanoseconds, bool low_power, uint64_t *result);
+
+bool wfet_wait_for_any_bit_set_until_i8 (uint8_t *ptr,  uint8_t mask, uint64_t cycles_deadline, bool low_power, uint8_t *result);
+bool wfet_wait_for_any_bit_set_until_i16(uint16_t *ptr, uint16_t mask, uint64_t cycles_deadline, bool low_power, uint16_t *result);
+bool wfet_wait_for_any_bit_set_until_i32(uint32_t *ptr, uint32_t mask, uint64_t cycles_deadline, bool low_power, uint32_t *result);
+bool wfet_wait_for_any_bit_set_until_i64(uint64_t *ptr, uint64_t mask, uint64_t cycles_deadline, bool low_power, uint64_t *result);
+
+bool wfet_wait_for_any_bit_set_timeout_i8 (uint8_t *ptr,  uint8_t mask, uint64_t nanoseconds, bool low_power, uint8_t *result);
+bool wfet_wait_for_any_bit_set_timeout_i16(uint16_t *ptr, uint16_t mask, uint64_t nanoseconds, bool low_power, uint16_t *result);
+bool wfet_wait_for_any_bit_set_timeout_i32(uint32_t *ptr, uint32_t mask, uint64_t nanoseconds, bool low_power, uint32_t *result);
+bool wfet_wait_for_any_bit_set_timeout_i64(uint64_t *ptr, uint64_t mask, uint64_t nanoseconds, bool low_power, uint64_t *result);
+
+bool wfet_wait_for_sequence_ge_until_i8 (uint8_t *ptr,  uint8_t target, uint64_t cycles_deadline, bool low_power, uint8_t *result);
+bool wfet_wait_for_sequence_ge_until_i16(uint16_t *ptr, uint16_t target, uint64_t cycles_deadline, bool low_power, uint16_t *result);
+bool wfet_wait_for_sequence_ge_until_i32(uint32_t *ptr, uint32_t target, uint64_t cycles_deadline, bool low_power, uint32_t *result);
+bool wfet_wait_for_sequence_ge_until_i64(uint64_t *ptr, uint64_t target, uint64_t cycles_deadline, bool low_power, uint64_t *result);
+
+bool wfet_wait_for_sequence_ge_timeout_i8 (uint8_t *ptr,  uint8_t target, uint64_t nanoseconds, bool low_power, uint8_t *result);
+bool wfet_wait_for_sequence_ge_timeout_i16(uint16_t *ptr, uint16_t target, uint64_t nanoseconds, bool low_power, uint16_t *result);
+bool wfet_wait_for_sequence_ge_timeout_i32(uint32_t *ptr, uint32_t target, uint64_t nanoseconds, bool low_power, uint32_t *result);
+bool wfet_wait_for_sequence_ge_timeout_i64(uint64_t *ptr, uint64_t target, uint64_t nanoseconds, bool low_power, uint64_t *result);
+
+bool wfet_wait_for_bit_set_until_i8 (uint8_t *ptr,  uint8_t bit, uint64_t cycles_deadline, bool low_power, uint8_t *result);
+bool wfet_wait_for_bit_set_until_i16(uint16_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint16_t *result);
+bool wfet_wait_for_bit_set_until_i32(uint32_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint32_t *result);
+bool wfet_wait_for_bit_set_until_i64(uint64_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint64_t *result);
+
+bool wfet_wait_for_bit_set_timeout_i8 (uint8_t *ptr,  uint8_t bit, uint64_t nanoseconds, bool low_power, uint8_t *result);
+bool wfet_wait_for_bit_set_timeout_i16(uint16_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint16_t *result);
+bool wfet_wait_for_bit_set_timeout_i32(uint32_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint32_t *result);
+bool wfet_wait_for_bit_set_timeout_i64(uint64_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint64_t *result);
+
+bool wfet_wait_for_bit_not_set_until_i8 (uint8_t *ptr,  uint8_t bit, uint64_t cycles_deadline, bool low_power, uint8_t *result);
+bool wfet_wait_for_bit_not_set_until_i16(uint16_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint16_t *result);
+bool wfet_wait_for_bit_not_set_until_i32(uint32_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint32_t *result);
+bool wfet_wait_for_bit_not_set_until_i64(uint64_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint64_t *result);
+
+bool wfet_wait_for_bit_not_set_timeout_i8 (uint8_t *ptr,  uint8_t bit, uint64_t nanoseconds, bool low_power, uint8_t *result);
+bool wfet_wait_for_bit_not_set_timeout_i16(uint16_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint16_t *result);
+bool wfet_wait_for_bit_not_set_timeout_i32(uint32_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint32_t *result);
+bool wfet_wait_for_bit_not_set_timeout_i64(uint64_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint64_t *result);
+
+size_t wfet_wait_any_oneshot(const wfe_mutex_wait_desc *descs, size_t n, size_t monitor_index, uint64_t nanoseconds, bool low_power);
+void wfet_sleep_until(uint64_t cycles_deadline, bool low_power);
 #endif
 #elif defined(_M_X86_64) || defined(_M_X86_32)
 
@@ -96,6 +380,11 @@ SYMBOL_EXPORT uint16_t mwaitx_wait_for_bit_not_set_i16(uint16_t *ptr, uint8_t bi
 SYMBOL_EXPORT uint32_t mwaitx_wait_for_bit_not_set_i32(uint32_t *ptr, uint8_t bit, bool low_power);
 SYMBOL_EXPORT uint64_t mwaitx_wait_for_bit_not_set_i64(uint64_t *ptr, uint8_t bit, bool low_power);
 
+SYMBOL_EXPORT bool mwaitx_wait_for_value_until_i8 (uint8_t *ptr,  uint8_t value, uint64_t cycles_deadline, bool low_power);
+SYMBOL_EXPORT bool mwaitx_wait_for_value_until_i16(uint16_t *ptr, uint16_t value, uint64_t cycles_deadline, bool low_power);
+SYMBOL_EXPORT bool mwaitx_wait_for_value_until_i32(uint32_t *ptr, uint32_t value, uint64_t cycles_deadline, bool low_power);
+SYMBOL_EXPORT bool mwaitx_wait_for_value_until_i64(uint64_t *ptr, uint64_t value, uint64_t cycles_deadline, bool low_power);
+
 SYMBOL_EXPORT bool mwaitx_wait_for_value_timeout_i8 (uint8_t *ptr,  uint8_t value, uint64_t nanoseconds, bool low_power);
 SYMBOL_EXPORT bool mwaitx_wait_for_value_timeout_i16(uint16_t *ptr, uint16_t value, uint64_t nanoseconds, bool low_power);
 SYMBOL_EXPORT bool mwaitx_wait_for_value_timeout_i32(uint32_t *ptr, uint32_t value, uint64_t nanoseconds, bool low_power);
@@ -106,6 +395,95 @@ SYMBOL_EXPORT bool mwaitx_wait_for_value_spurious_oneshot_i16(uint16_t *ptr, uin
 SYMBOL_EXPORT bool mwaitx_wait_for_value_spurious_oneshot_i32(uint32_t *ptr, uint32_t value, bool low_power);
 SYMBOL_EXPORT bool mwaitx_wait_for_value_spurious_oneshot_i64(uint64_t *ptr, uint64_t value, bool low_power);
 
+SYMBOL_EXPORT uint8_t mwaitx_wait_for_change_i8 (uint8_t *ptr,  uint8_t old_value, bool low_power);
+SYMBOL_EXPORT uint16_t mwaitx_wait_for_change_i16(uint16_t *ptr, uint16_t old_value, bool low_power);
+SYMBOL_EXPORT uint32_t mwaitx_wait_for_change_i32(uint32_t *ptr, uint32_t old_value, bool low_power);
+SYMBOL_EXPORT uint64_t mwaitx_wait_for_change_i64(uint64_t *ptr, uint64_t old_value, bool low_power);
+
+SYMBOL_EXPORT uint8_t mwaitx_wait_for_masked_value_i8 (uint8_t *ptr,  uint8_t mask, uint8_t value, bool low_power);
+SYMBOL_EXPORT uint16_t mwaitx_wait_for_masked_value_i16(uint16_t *ptr, uint16_t mask, uint16_t value, bool low_power);
+SYMBOL_EXPORT uint32_t mwaitx_wait_for_masked_value_i32(uint32_t *ptr, uint32_t mask, uint32_t value, bool low_power);
+SYMBOL_EXPORT uint64_t mwaitx_wait_for_masked_value_i64(uint64_t *ptr, uint64_t mask, uint64_t value, bool low_power);
+
+SYMBOL_EXPORT uint8_t mwaitx_wait_for_any_bit_set_i8 (uint8_t *ptr,  uint8_t mask, bool low_power);
+SYMBOL_EXPORT uint16_t mwaitx_wait_for_any_bit_set_i16(uint16_t *ptr, uint16_t mask, bool low_power);
+SYMBOL_EXPORT uint32_t mwaitx_wait_for_any_bit_set_i32(uint32_t *ptr, uint32_t mask, bool low_power);
+SYMBOL_EXPORT uint64_t mwaitx_wait_for_any_bit_set_i64(uint64_t *ptr, uint64_t mask, bool low_power);
+
+SYMBOL_EXPORT uint8_t mwaitx_wait_for_sequence_ge_i8 (uint8_t *ptr,  uint8_t target, bool low_power);
+SYMBOL_EXPORT uint16_t mwaitx_wait_for_sequence_ge_i16(uint16_t *ptr, uint16_t target, bool low_power);
+SYMBOL_EXPORT uint32_t mwaitx_wait_for_sequence_ge_i32(uint32_t *ptr, uint32_t target, bool low_power);
+SYMBOL_EXPORT uint64_t mwaitx_wait_for_sequence_ge_i64(uint64_t *ptr, uint64_t target, bool low_power);
+
+SYMBOL_EXPORT bool mwaitx_wait_for_masked_value_until_i8 (uint8_t *ptr,  uint8_t mask, uint8_t value, uint64_t cycles_deadline, bool low_power, uint8_t *result);
+SYMBOL_EXPORT bool mwaitx_wait_for_masked_value_until_i16(uint16_t *ptr, uint16_t mask, uint16_t value, uint64_t cycles_deadline, bool low_power, uint16_t *result);
+SYMBOL_EXPORT bool mwaitx_wait_for_masked_value_until_i32(uint32_t *ptr, uint32_t mask, uint32_t value, uint64_t cycles_deadline, bool low_power, uint32_t *result);
+SYMBOL_EXPORT bool mwaitx_wait_for_masked_value_until_i64(uint64_t *ptr, uint64_t mask, uint64_t value, uint64_t cycles_deadline, bool low_power, uint64_t *result);
+
+SYMBOL_EXPORT bool mwaitx_wait_for_masked_value_timeout_i8 (uint8_t *ptr,  uint8_t mask, uint8_t value, uint64_t nanoseconds, bool low_power, uint8_t *result);
+SYMBOL_EXPORT bool mwaitx_wait_for_masked_value_timeout_i16(uint16_t *ptr, uint16_t mask, uint16_t value, uint64_t nanoseconds, bool low_power, uint16_t *result);
+SYMBOL_EXPORT bool mwaitx_wait_for_masked_value_timeout_i32(uint32_t *ptr, uint32_t mask, uint32_t value, uint64_t nanoseconds, bool low_power, uint32_t *result);
+SYMBOL_EXPORT bool mwaitx_wait_for_masked_value_timeout_i64(uint64_t *ptr, uint64_t mask, uint64_t value, uint64_t nanoseconds, bool low_power, uint64_t *result);
+
+SYMBOL_EXPORT bool mwaitx_wait_for_any_bit_set_until_i8 (uint8_t *ptr,  uint8_t mask, uint64_t cycles_deadline, bool low_power, uint8_t *result);
+SYMBOL_EXPORT bool mwaitx_wait_for_any_bit_set_until_i16(uint16_t *ptr, uint16_t mask, uint64_t cycles_deadline, bool low_power, uint16_t *result);
+SYMBOL_EXPORT bool mwaitx_wait_for_any_bit_set_until_i32(uint32_t *ptr, uint32_t mask, uint64_t cycles_deadline, bool low_power, uint32_t *result);
+SYMBOL_EXPORT bool mwaitx_wait_for_any_bit_set_until_i64(uint64_t *ptr, uint64_t mask, uint64_t cycles_deadline, bool low_power, uint64_t *result);
+
+SYMBOL_EXPORT bool mwaitx_wait_for_any_bit_set_timeout_i8 (uint8_t *ptr,  uint8_t mask, uint64_t nanoseconds, bool low_power, uint8_t *result);
+SYMBOL_EXPORT bool mwaitx_wait_for_any_bit_set_timeout_i16(uint16_t *ptr, uint16_t mask, uint64_t nanoseconds, bool low_power, uint16_t *result);
+SYMBOL_EXPORT bool mwaitx_wait_for_any_bit_set_timeout_i32(uint32_t *ptr, uint32_t mask, uint64_t nanoseconds, bool low_power, uint32_t *result);
+SYMBOL_EXPORT bool mwaitx_wait_for_any_bit_set_timeout_i64(uint64_t *ptr, uint64_t mask, uint64_t nanoseconds, bool low_power, uint64_t *result);
+
+SYMBOL_EXPORT bool mwaitx_wait_for_sequence_ge_until_i8 (uint8_t *ptr,  uint8_t target, uint64_t cycles_deadline, bool low_power, uint8_t *result);
+SYMBOL_EXPORT bool mwaitx_wait_for_sequence_ge_until_i16(uint16_t *ptr, uint16_t target, uint64_t cycles_deadline, bool low_power, uint16_t *result);
+SYMBOL_EXPORT bool mwaitx_wait_for_sequence_ge_until_i32(uint32_t *ptr, uint32_t target, uint64_t cycles_deadline, bool low_power, uint32_t *result);
+SYMBOL_EXPORT bool mwaitx_wait_for_sequence_ge_until_i64(uint64_t *ptr, uint64_t target, uint64_t cycles_deadline, bool low_power, uint64_t *result);
+
+SYMBOL_EXPORT bool mwaitx_wait_for_sequence_ge_timeout_i8 (uint8_t *ptr,  uint8_t target, uint64_t nanoseconds, bool low_power, uint8_t *result);
+SYMBOL_EXPORT bool mwaitx_wait_for_sequence_ge_timeout_i16(uint16_t *ptr, uint16_t target, uint64_t nanoseconds, bool low_power, uint16_t *result);
+SYMBOL_EXPORT bool mwaitx_wait_for_sequence_ge_timeout_i32(uint32_t *ptr, uint32_t target, uint64_t nanoseconds, bool low_power, uint32_t *result);
+SYMBOL_EXPORT bool mwaitx_wait_for_sequence_ge_timeout_i64(uint64_t *ptr, uint64_t target, uint64_t nanoseconds, bool low_power, uint64_t *result);
+
+SYMBOL_EXPORT bool mwaitx_wait_for_bit_set_until_i8 (uint8_t *ptr,  uint8_t bit, uint64_t cycles_deadline, bool low_power, uint8_t *result);
+SYMBOL_EXPORT bool mwaitx_wait_for_bit_set_until_i16(uint16_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint16_t *result);
+SYMBOL_EXPORT bool mwaitx_wait_for_bit_set_until_i32(uint32_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint32_t *result);
+SYMBOL_EXPORT bool mwaitx_wait_for_bit_set_until_i64(uint64_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint64_t *result);
+
+SYMBOL_EXPORT bool mwaitx_wait_for_bit_set_timeout_i8 (uint8_t *ptr,  uint8_t bit, uint64_t nanoseconds, bool low_power, uint8_t *result);
+SYMBOL_EXPORT bool mwaitx_wait_for_bit_set_timeout_i16(uint16_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint16_t *result);
+SYMBOL_EXPORT bool mwaitx_wait_for_bit_set_timeout_i32(uint32_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint32_t *result);
+SYMBOL_EXPORT bool mwaitx_wait_for_bit_set_timeout_i64(uint64_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint64_t *result);
+
+SYMBOL_EXPORT bool mwaitx_wait_for_bit_not_set_until_i8 (uint8_t *ptr,  uint8_t bit, uint64_t cycles_deadline, bool low_power, uint8_t *result);
+SYMBOL_EXPORT bool mwaitx_wait_for_bit_not_set_until_i16(uint16_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint16_t *result);
+SYMBOL_EXPORT bool mwaitx_wait_for_bit_not_set_until_i32(uint32_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint32_t *result);
+SYMBOL_EXPORT bool mwaitx_wait_for_bit_not_set_until_i64(uint64_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint64_t *result);
+
+SYMBOL_EXPORT bool mwaitx_wait_for_bit_not_set_timeout_i8 (uint8_t *ptr,  uint8_t bit, uint64_t nanoseconds, bool low_power, uint8_t *result);
+SYMBOL_EXPORT bool mwaitx_wait_for_bit_not_set_timeout_i16(uint16_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint16_t *result);
+SYMBOL_EXPORT bool mwaitx_wait_for_bit_not_set_timeout_i32(uint32_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint32_t *result);
+SYMBOL_EXPORT bool mwaitx_wait_for_bit_not_set_timeout_i64(uint64_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint64_t *result);
+
+SYMBOL_EXPORT bool mwaitx_wait_for_bit_set_spurious_oneshot_i8 (uint8_t *ptr,  uint8_t bit, bool low_power, uint8_t *result);
+SYMBOL_EXPORT bool mwaitx_wait_for_bit_set_spurious_oneshot_i16(uint16_t *ptr, uint8_t bit, bool low_power, uint16_t *result);
+SYMBOL_EXPORT bool mwaitx_wait_for_bit_set_spurious_oneshot_i32(uint32_t *ptr, uint8_t bit, bool low_power, uint32_t *result);
+SYMBOL_EXPORT bool mwaitx_wait_for_bit_set_spurious_oneshot_i64(uint64_t *ptr, uint8_t bit, bool low_power, uint64_t *result);
+
+SYMBOL_EXPORT bool mwaitx_wait_for_bit_not_set_spurious_oneshot_i8 (uint8_t *ptr,  uint8_t bit, bool low_power, uint8_t *result);
+SYMBOL_EXPORT bool mwaitx_wait_for_bit_not_set_spurious_oneshot_i16(uint16_t *ptr, uint8_t bit, bool low_power, uint16_t *result);
+SYMBOL_EXPORT bool mwaitx_wait_for_bit_not_set_spurious_oneshot_i32(uint32_t *ptr, uint8_t bit, bool low_power, uint32_t *result);
+SYMBOL_EXPORT bool mwaitx_wait_for_bit_not_set_spurious_oneshot_i64(uint64_t *ptr, uint8_t bit, bool low_power, uint64_t *result);
+
+SYMBOL_EXPORT size_t mwaitx_wait_any_oneshot(const wfe_mutex_wait_desc *descs, size_t n, size_t monitor_index, uint64_t nanoseconds, bool low_power);
+SYMBOL_EXPORT uint64_t mwaitx_doorbell_wait(wfe_mutex_doorbell *doorbell, bool low_power);
+SYMBOL_EXPORT void mwaitx_sleep_until(uint64_t cycles_deadline, bool low_power);
+
+#if defined(_M_X86_64)
+SYMBOL_EXPORT void mwaitx_wait_for_value_i128(wfe_mutex_u128 *ptr, wfe_mutex_u128 value, bool low_power);
+SYMBOL_EXPORT wfe_mutex_u128 mwaitx_wait_for_masked_value_i128(wfe_mutex_u128 *ptr, wfe_mutex_u128 mask, wfe_mutex_u128 value, bool low_power);
+#endif
+
 // waitpkg implementation
 SYMBOL_EXPORT void waitpkg_wait_for_value_i8 (uint8_t *ptr,  uint8_t value, bool low_power);
 SYMBOL_EXPORT void waitpkg_wait_for_value_i16(uint16_t *ptr, uint16_t value, bool low_power);
@@ -122,6 +500,11 @@ SYMBOL_EXPORT uint16_t waitpkg_wait_for_bit_not_set_i16(uint16_t *ptr, uint8_t b
 SYMBOL_EXPORT uint32_t waitpkg_wait_for_bit_not_set_i32(uint32_t *ptr, uint8_t bit, bool low_power);
 SYMBOL_EXPORT uint64_t waitpkg_wait_for_bit_not_set_i64(uint64_t *ptr, uint8_t bit, bool low_power);
 
+SYMBOL_EXPORT bool waitpkg_wait_for_value_until_i8 (uint8_t *ptr,  uint8_t value, uint64_t cycles_deadline, bool low_power);
+SYMBOL_EXPORT bool waitpkg_wait_for_value_until_i16(uint16_t *ptr, uint16_t value, uint64_t cycles_deadline, bool low_power);
+SYMBOL_EXPORT bool waitpkg_wait_for_value_until_i32(uint32_t *ptr, uint32_t value, uint64_t cycles_deadline, bool low_power);
+SYMBOL_EXPORT bool waitpkg_wait_for_value_until_i64(uint64_t *ptr, uint64_t value, uint64_t cycles_deadline, bool low_power);
+
 SYMBOL_EXPORT bool waitpkg_wait_for_value_timeout_i8 (uint8_t *ptr,  uint8_t value, uint64_t nanoseconds, bool low_power);
 SYMBOL_EXPORT bool waitpkg_wait_for_value_timeout_i16(uint16_t *ptr, uint16_t value, uint64_t nanoseconds, bool low_power);
 SYMBOL_EXPORT bool waitpkg_wait_for_value_timeout_i32(uint32_t *ptr, uint32_t value, uint64_t nanoseconds, bool low_power);
@@ -132,5 +515,97 @@ SYMBOL_EXPORT bool waitpkg_wait_for_value_spurious_oneshot_i16(uint16_t *ptr, ui
 SYMBOL_EXPORT bool waitpkg_wait_for_value_spurious_oneshot_i32(uint32_t *ptr, uint32_t value, bool low_power);
 SYMBOL_EXPORT bool waitpkg_wait_for_value_spurious_oneshot_i64(uint64_t *ptr, uint64_t value, bool low_power);
 
+SYMBOL_EXPORT uint8_t waitpkg_wait_for_change_i8 (uint8_t *ptr,  uint8_t old_value, bool low_power);
+SYMBOL_EXPORT uint16_t waitpkg_wait_for_change_i16(uint16_t *ptr, uint16_t old_value, bool low_power);
+SYMBOL_EXPORT uint32_t waitpkg_wait_for_change_i32(uint32_t *ptr, uint32_t old_value, bool low_power);
+SYMBOL_EXPORT uint64_t waitpkg_wait_for_change_i64(uint64_t *ptr, uint64_t old_value, bool low_power);
+
+SYMBOL_EXPORT uint8_t waitpkg_wait_for_masked_value_i8 (uint8_t *ptr,  uint8_t mask, uint8_t value, bool low_power);
+SYMBOL_EXPORT uint16_t waitpkg_wait_for_masked_value_i16(uint16_t *ptr, uint16_t mask, uint16_t value, bool low_power);
+SYMBOL_EXPORT uint32_t waitpkg_wait_for_masked_value_i32(uint32_t *ptr, uint32_t mask, uint32_t value, bool low_power);
+SYMBOL_EXPORT uint64_t waitpkg_wait_for_masked_value_i64(uint64_t *ptr, uint64_t mask, uint64_t value, bool low_power);
+
+SYMBOL_EXPORT uint8_t waitpkg_wait_for_any_bit_set_i8 (uint8_t *ptr,  uint8_t mask, bool low_power);
+SYMBOL_EXPORT uint16_t waitpkg_wait_for_any_bit_set_i16(uint16_t *ptr, uint16_t mask, bool low_power);
+SYMBOL_EXPORT uint32_t waitpkg_wait_for_any_bit_set_i32(uint32_t *ptr, uint32_t mask, bool low_power);
+SYMBOL_EXPORT uint64_t waitpkg_wait_for_any_bit_set_i64(uint64_t *ptr, uint64_t mask, bool low_power);
+
+SYMBOL_EXPORT uint8_t waitpkg_wait_for_sequence_ge_i8 (uint8_t *ptr,  uint8_t target, bool low_power);
+SYMBOL_EXPORT uint16_t waitpkg_wait_for_sequence_ge_i16(uint16_t *ptr, uint16_t target, bool low_power);
+SYMBOL_EXPORT uint32_t waitpkg_wait_for_sequence_ge_i32(uint32_t *ptr, uint32_t target, bool low_power);
+SYMBOL_EXPORT uint64_t waitpkg_wait_for_sequence_ge_i64(uint64_t *ptr, uint64_t target, bool low_power);
+
+SYMBOL_EXPORT bool waitpkg_wait_for_masked_value_until_i8 (uint8_t *ptr,  uint8_t mask, uint8_t value, uint64_t cycles_deadline, bool low_power, uint8_t *result);
+SYMBOL_EXPORT bool waitpkg_wait_for_masked_value_until_i16(uint16_t *ptr, uint16_t mask, uint16_t value, uint64_t cycles_deadline, bool low_power, uint16_t *result);
+SYMBOL_EXPORT bool waitpkg_wait_for_masked_value_until_i32(uint32_t *ptr, uint32_t mask, uint32_t value, uint64_t cycles_deadline, bool low_power, uint32_t *result);
+SYMBOL_EXPORT bool waitpkg_wait_for_masked_value_until_i64(uint64_t *ptr, uint64_t mask, uint64_t value, uint64_t cycles_deadline, bool low_power, uint64_t *result);
+
+SYMBOL_EXPORT bool waitpkg_wait_for_masked_value_timeout_i8 (uint8_t *ptr,  uint8_t mask, uint8_t value, uint64_t nanoseconds, bool low_power, uint8_t *result);
+SYMBOL_EXPORT bool waitpkg_wait_for_masked_value_timeout_i16(uint16_t *ptr, uint16_t mask, uint16_t value, uint64_t nanoseconds, bool low_power, uint16_t *result);
+SYMBOL_EXPORT bool waitpkg_wait_for_masked_value_timeout_i32(uint32_t *ptr, uint32_t mask, uint32_t value, uint64_t nanoseconds, bool low_power, uint32_t *result);
+SYMBOL_EXPORT bool waitpkg_wait_for_masked_value_timeout_i64(uint64_t *ptr, uint64_t mask, uint64_t value, uint64_t nanoseconds, bool low_power, uint64_t *result);
+
+SYMBOL_EXPORT bool waitpkg_wait_for_any_bit_set_until_i8 (uint8_t *ptr,  uint8_t mask, uint64_t cycles_deadline, bool low_power, uint8_t *result);
+SYMBOL_EXPORT bool waitpkg_wait_for_any_bit_set_until_i16(uint16_t *ptr, uint16_t mask, uint64_t cycles_deadline, bool low_power, uint16_t *result);
+SYMBOL_EXPORT bool waitpkg_wait_for_any_bit_set_until_i32(uint32_t *ptr, uint32_t mask, uint64_t cycles_deadline, bool low_power, uint32_t *result);
+SYMBOL_EXPORT bool waitpkg_wait_for_any_bit_set_until_i64(uint64_t *ptr, uint64_t mask, uint64_t cycles_deadline, bool low_power, uint64_t *result);
+
+SYMBOL_EXPORT bool waitpkg_wait_for_any_bit_set_timeout_i8 (uint8_t *ptr,  uint8_t mask, uint64_t nanoseconds, bool low_power, uint8_t *result);
+SYMBOL_EXPORT bool waitpkg_wait_for_any_bit_set_timeout_i16(uint16_t *ptr, uint16_t mask, uint64_t nanoseconds, bool low_power, uint16_t *result);
+SYMBOL_EXPORT bool waitpkg_wait_for_any_bit_set_timeout_i32(uint32_t *ptr, uint32_t mask, uint64_t nanoseconds, bool low_power, uint32_t *result);
+SYMBOL_EXPORT bool waitpkg_wait_for_any_bit_set_timeout_i64(uint64_t *ptr, uint64_t mask, uint64_t nanoseconds, bool low_power, uint64_t *result);
+
+SYMBOL_EXPORT bool waitpkg_wait_for_sequence_ge_until_i8 (uint8_t *ptr,  uint8_t target, uint64_t cycles_deadline, bool low_power, uint8_t *result);
+SYMBOL_EXPORT bool waitpkg_wait_for_sequence_ge_until_i16(uint16_t *ptr, uint16_t target, uint64_t cycles_deadline, bool low_power, uint16_t *result);
+SYMBOL_EXPORT bool waitpkg_wait_for_sequence_ge_until_i32(uint32_t *ptr, uint32_t target, uint64_t cycles_deadline, bool low_power, uint32_t *result);
+SYMBOL_EXPORT bool waitpkg_wait_for_sequence_ge_until_i64(uint64_t *ptr, uint64_t target, uint64_t cycles_deadline, bool low_power, uint64_t *result);
+
+SYMBOL_EXPORT bool waitpkg_wait_for_sequence_ge_timeout_i8 (uint8_t *ptr,  uint8_t target, uint64_t nanoseconds, bool low_power, uint8_t *result);
+SYMBOL_EXPORT bool waitpkg_wait_for_sequence_ge_timeout_i16(uint16_t *ptr, uint16_t target, uint64_t nanoseconds, bool low_power, uint16_t *result);
+SYMBOL_EXPORT bool waitpkg_wait_for_sequence_ge_timeout_i32(uint32_t *ptr, uint32_t target, uint64_t nanoseconds, bool low_power, uint32_t *result);
+SYMBOL_EXPORT bool waitpkg_wait_for_sequence_ge_timeout_i64(uint64_t *ptr, uint64_t target, uint64_t nanoseconds, bool low_power, uint64_t *result);
+
+SYMBOL_EXPORT bool waitpkg_wait_for_bit_set_until_i8 (uint8_t *ptr,  uint8_t bit, uint64_t cycles_deadline, bool low_power, uint8_t *result);
+SYMBOL_EXPORT bool waitpkg_wait_for_bit_set_until_i16(uint16_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint16_t *result);
+SYMBOL_EXPORT bool waitpkg_wait_for_bit_set_until_i32(uint32_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint32_t *result);
+SYMBOL_EXPORT bool waitpkg_wait_for_bit_set_until_i64(uint64_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint64_t *result);
+
+SYMBOL_EXPORT bool waitpkg_wait_for_bit_set_timeout_i8 (uint8_t *ptr,  uint8_t bit, uint64_t nanoseconds, bool low_power, uint8_t *result);
+SYMBOL_EXPORT bool waitpkg_wait_for_bit_set_timeout_i16(uint16_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint16_t *result);
+SYMBOL_EXPORT bool waitpkg_wait_for_bit_set_timeout_i32(uint32_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint32_t *result);
+SYMBOL_EXPORT bool waitpkg_wait_for_bit_set_timeout_i64(uint64_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint64_t *result);
+
+SYMBOL_EXPORT bool waitpkg_wait_for_bit_not_set_until_i8 (uint8_t *ptr,  uint8_t bit, uint64_t cycles_deadline, bool low_power, uint8_t *result);
+SYMBOL_EXPORT bool waitpkg_wait_for_bit_not_set_until_i16(uint16_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint16_t *result);
+SYMBOL_EXPORT bool waitpkg_wait_for_bit_not_set_until_i32(uint32_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint32_t *result);
+SYMBOL_EXPORT bool waitpkg_wait_for_bit_not_set_until_i64(uint64_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint64_t *result);
+
+SYMBOL_EXPORT bool waitpkg_wait_for_bit_not_set_timeout_i8 (uint8_t *ptr,  uint8_t bit, uint64_t nanoseconds, bool low_power, uint8_t *result);
+SYMBOL_EXPORT bool waitpkg_wait_for_bit_not_set_timeout_i16(uint16_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint16_t *result);
+SYMBOL_EXPORT bool waitpkg_wait_for_bit_not_set_timeout_i32(uint32_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint32_t *result);
+SYMBOL_EXPORT bool waitpkg_wait_for_bit_not_set_timeout_i64(uint64_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint64_t *result);
+
+SYMBOL_EXPORT bool waitpkg_wait_for_bit_set_spurious_oneshot_i8 (uint8_t *ptr,  uint8_t bit, bool low_power, uint8_t *result);
+SYMBOL_EXPORT bool waitpkg_wait_for_bit_set_spurious_oneshot_i16(uint16_t *ptr, uint8_t bit, bool low_power, uint16_t *result);
+SYMBOL_EXPORT bool waitpkg_wait_for_bit_set_spurious_oneshot_i32(uint32_t *ptr, uint8_t bit, bool low_power, uint32_t *result);
+SYMBOL_EXPORT bool waitpkg_wait_for_bit_set_spurious_oneshot_i64(uint64_t *ptr, uint8_t bit, bool low_power, uint64_t *result);
+
+SYMBOL_EXPORT bool waitpkg_wait_for_bit_not_set_spurious_oneshot_i8 (uint8_t *ptr,  uint8_t bit, bool low_power, uint8_t *result);
+SYMBOL_EXPORT bool waitpkg_wait_for_bit_not_set_spurious_oneshot_i16(uint16_t *ptr, uint8_t bit, bool low_power, uint16_t *result);
+SYMBOL_EXPORT bool waitpkg_wait_for_bit_not_set_spurious_oneshot_i32(uint32_t *ptr, uint8_t bit, bool low_power, uint32_t *result);
+SYMBOL_EXPORT bool waitpkg_wait_for_bit_not_set_spurious_oneshot_i64(uint64_t *ptr, uint8_t bit, bool low_power, uint64_t *result);
+
+SYMBOL_EXPORT size_t waitpkg_wait_any_oneshot(const wfe_mutex_wait_desc *descs, size_t n, size_t monitor_index, uint64_t nanoseconds, bool low_power);
+SYMBOL_EXPORT uint64_t waitpkg_doorbell_wait(wfe_mutex_doorbell *doorbell, bool low_power);
+SYMBOL_EXPORT void waitpkg_sleep_until(uint64_t cycles_deadline, bool low_power);
+
+#if defined(_M_X86_64)
+SYMBOL_EXPORT void waitpkg_wait_for_value_i128(wfe_mutex_u128 *ptr, wfe_mutex_u128 value, bool low_power);
+SYMBOL_EXPORT wfe_mutex_u128 waitpkg_wait_for_masked_value_i128(wfe_mutex_u128 *ptr, wfe_mutex_u128 mask, wfe_mutex_u128 value, bool low_power);
 #endif
 
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,6 +1,10 @@
 #include "detect.h"
 #include "implementations.h"
 #include "implementation_details_arm.h"
+#include "implementation_details_u128.h"
+#include "implementation_details_wait_any.h"
+#include "implementation_details_doorbell.h"
+#include "implementation_details_timeout.h"
 
 #if defined(_M_ARM_64) || defined(_M_ARM_32)
 #define LOADEXCLUSIVE(LoadExclusiveOp, RegSize) \
@@ -333,18 +337,38 @@ uint64_t wfe_wait_for_bit_not_set_i64(uint64_t *ptr, uint8_t bit, bool low_power
 }
 #endif
 
-bool wfe_wait_for_value_timeout_i8 (uint8_t *ptr,  uint8_t value, uint64_t nanoseconds, bool low_power) {
+// WFE has no timer, it only notices the deadline on an event stream tick.
+// Stop waiting at least one event stream period before the deadline so the last tick can't land past it.
+// Without an event stream only an interrupt ends a WFE, so the whole wait spins.
+static inline uint64_t wfe_wait_deadline(uint64_t cycles_deadline, bool low_power) {
+	const uint64_t period = Features.event_stream_period_cycles;
+	if (period == 0) return 0;
+
+	const uint64_t wait_deadline = timeout_wait_deadline(WFE_MUTEX_BACKEND_WFE, cycles_deadline, low_power);
+	const uint64_t period_deadline = cycles_deadline > period ? cycles_deadline - period : 0;
+	return wait_deadline < period_deadline ? wait_deadline : period_deadline;
+}
+
+bool wfe_wait_for_value_until_i8 (uint8_t *ptr,  uint8_t value, uint64_t cycles_deadline, bool low_power) {
 	uint8_t tmp;
 	uint8_t result = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
 
 	// Early return if the value is already set.
 	if (result == value) return true;
 
-	const uint64_t total_cycles = wfe_mutex_detect_calculate_cycles_for_nanoseconds(nanoseconds);
-	const uint64_t begin_cycles = read_cycle_counter();
-	const uint64_t cycles_end = begin_cycles + total_cycles;
+	const uint64_t wait_deadline = wfe_wait_deadline(cycles_deadline, low_power);
 
 	do {
+		if (read_cycle_counter() >= wait_deadline) {
+			// Too close to the deadline for the event stream to wake in time, spin the rest.
+			do_yield();
+			result = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+			if (result != value && read_cycle_counter() >= cycles_deadline) {
+				return false;
+			}
+			continue;
+		}
+
 		__asm volatile(SPINLOOP_WFE_LDX_8BIT
 			: [Result] "=r" (result)
 			, [Futex] "+r" (ptr)
@@ -357,7 +381,7 @@ bool wfe_wait_for_value_timeout_i8 (uint8_t *ptr,  uint8_t value, uint64_t nanos
 			, [Futex] "+r" (ptr)
 			:: "memory");
 
-		if (read_cycle_counter() >= cycles_end) {
+		if (read_cycle_counter() >= cycles_deadline) {
 			return false;
 		}
 	} while (result != value);
@@ -365,18 +389,30 @@ bool wfe_wait_for_value_timeout_i8 (uint8_t *ptr,  uint8_t value, uint64_t nanos
 	return true;
 }
 
-bool wfe_wait_for_value_timeout_i16(uint16_t *ptr, uint16_t value, uint64_t nanoseconds, bool low_power) {
+bool wfe_wait_for_value_timeout_i8 (uint8_t *ptr,  uint8_t value, uint64_t nanoseconds, bool low_power) {
+	return wfe_wait_for_value_until_i8(ptr, value, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power);
+}
+
+bool wfe_wait_for_value_until_i16(uint16_t *ptr, uint16_t value, uint64_t cycles_deadline, bool low_power) {
 	uint16_t tmp;
 	uint16_t result = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
 
 	// Early return if the value is already set.
 	if (result == value) return true;
 
-	const uint64_t total_cycles = wfe_mutex_detect_calculate_cycles_for_nanoseconds(nanoseconds);
-	const uint64_t begin_cycles = read_cycle_counter();
-	const uint64_t cycles_end = begin_cycles + total_cycles;
+	const uint64_t wait_deadline = wfe_wait_deadline(cycles_deadline, low_power);
 
 	do {
+		if (read_cycle_counter() >= wait_deadline) {
+			// Too close to the deadline for the event stream to wake in time, spin the rest.
+			do_yield();
+			result = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+			if (result != value && read_cycle_counter() >= cycles_deadline) {
+				return false;
+			}
+			continue;
+		}
+
 		__asm volatile(SPINLOOP_WFE_LDX_16BIT
 			: [Result] "=r" (result)
 			, [Futex] "+r" (ptr)
@@ -389,7 +425,7 @@ bool wfe_wait_for_value_timeout_i16(uint16_t *ptr, uint16_t value, uint64_t nano
 			, [Futex] "+r" (ptr)
 			:: "memory");
 
-		if (read_cycle_counter() >= cycles_end) {
+		if (read_cycle_counter() >= cycles_deadline) {
 			return false;
 		}
 	} while (result != value);
@@ -397,18 +433,30 @@ bool wfe_wait_for_value_timeout_i16(uint16_t *ptr, uint16_t value, uint64_t nano
 	return true;
 }
 
-bool wfe_wait_for_value_timeout_i32(uint32_t *ptr, uint32_t value, uint64_t nanoseconds, bool low_power) {
+bool wfe_wait_for_value_timeout_i16(uint16_t *ptr, uint16_t value, uint64_t nanoseconds, bool low_power) {
+	return wfe_wait_for_value_until_i16(ptr, value, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power);
+}
+
+bool wfe_wait_for_value_until_i32(uint32_t *ptr, uint32_t value, uint64_t cycles_deadline, bool low_power) {
 	uint32_t tmp;
 	uint32_t result = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
 
 	// Early return if the value is already set.
 	if (result == value) return true;
 
-	const uint64_t total_cycles = wfe_mutex_detect_calculate_cycles_for_nanoseconds(nanoseconds);
-	const uint64_t begin_cycles = read_cycle_counter();
-	const uint64_t cycles_end = begin_cycles + total_cycles;
+	const uint64_t wait_deadline = wfe_wait_deadline(cycles_deadline, low_power);
 
 	do {
+		if (read_cycle_counter() >= wait_deadline) {
+			// Too close to the deadline for the event stream to wake in time, spin the rest.
+			do_yield();
+			result = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+			if (result != value && read_cycle_counter() >= cycles_deadline) {
+				return false;
+			}
+			continue;
+		}
+
 		__asm volatile(SPINLOOP_WFE_LDX_32BIT
 			: [Result] "=r" (result)
 			, [Futex] "+r" (ptr)
@@ -421,7 +469,7 @@ bool wfe_wait_for_value_timeout_i32(uint32_t *ptr, uint32_t value, uint64_t nano
 			, [Futex] "+r" (ptr)
 			:: "memory");
 
-		if (read_cycle_counter() >= cycles_end) {
+		if (read_cycle_counter() >= cycles_deadline) {
 			return false;
 		}
 	} while (result != value);
@@ -429,19 +477,31 @@ bool wfe_wait_for_value_timeout_i32(uint32_t *ptr, uint32_t value, uint64_t nano
 	return true;
 }
 
+bool wfe_wait_for_value_timeout_i32(uint32_t *ptr, uint32_t value, uint64_t nanoseconds, bool low_power) {
+	return wfe_wait_for_value_until_i32(ptr, value, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power);
+}
+
 #if defined(_M_ARM_64)
-bool wfe_wait_for_value_timeout_i64(uint64_t *ptr, uint64_t value, uint64_t nanoseconds, bool low_power) {
+bool wfe_wait_for_value_until_i64(uint64_t *ptr, uint64_t value, uint64_t cycles_deadline, bool low_power) {
 	uint64_t tmp;
 	uint64_t result = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
 
 	// Early return if the value is already set.
 	if (result == value) return true;
 
-	const uint64_t total_cycles = wfe_mutex_detect_calculate_cycles_for_nanoseconds(nanoseconds);
-	const uint64_t begin_cycles = read_cycle_counter();
-	const uint64_t cycles_end = begin_cycles + total_cycles;
+	const uint64_t wait_deadline = wfe_wait_deadline(cycles_deadline, low_power);
 
 	do {
+		if (read_cycle_counter() >= wait_deadline) {
+			// Too close to the deadline for the event stream to wake in time, spin the rest.
+			do_yield();
+			result = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+			if (result != value && read_cycle_counter() >= cycles_deadline) {
+				return false;
+			}
+			continue;
+		}
+
 		__asm volatile(SPINLOOP_WFE_LDX_64BIT
 			: [Result] "=r" (result)
 			, [Futex] "+r" (ptr)
@@ -454,7 +514,7 @@ bool wfe_wait_for_value_timeout_i64(uint64_t *ptr, uint64_t value, uint64_t nano
 			, [Futex] "+r" (ptr)
 			:: "memory");
 
-		if (read_cycle_counter() >= cycles_end) {
+		if (read_cycle_counter() >= cycles_deadline) {
 			return false;
 		}
 	} while (result != value);
@@ -462,18 +522,30 @@ bool wfe_wait_for_value_timeout_i64(uint64_t *ptr, uint64_t value, uint64_t nano
 	return true;
 }
 
-bool wfet_wait_for_value_timeout_i8 (uint8_t *ptr,  uint8_t value, uint64_t nanoseconds, bool low_power) {
+bool wfe_wait_for_value_timeout_i64(uint64_t *ptr, uint64_t value, uint64_t nanoseconds, bool low_power) {
+	return wfe_wait_for_value_until_i64(ptr, value, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power);
+}
+
+bool wfet_wait_for_value_until_i8 (uint8_t *ptr,  uint8_t value, uint64_t cycles_deadline, bool low_power) {
 	uint8_t tmp;
 	uint8_t result = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
 
 	// Early return if the value is already set.
 	if (result == value) return true;
 
-	const uint64_t total_cycles = wfe_mutex_detect_calculate_cycles_for_nanoseconds(nanoseconds);
-	const uint64_t begin_cycles = read_cycle_counter();
-	register const uint64_t cycles_end asm("r2") = begin_cycles + total_cycles;
+	register const uint64_t cycles_end asm("r2") = timeout_wait_deadline(WFE_MUTEX_BACKEND_WFET, cycles_deadline, low_power);
 
 	do {
+		if (read_cycle_counter() >= cycles_end) {
+			// Too close to the deadline for wfet to wake in time, spin the rest.
+			do_yield();
+			result = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+			if (result != value && read_cycle_counter() >= cycles_deadline) {
+				return false;
+			}
+			continue;
+		}
+
 		__asm volatile(SPINLOOP_WFE_LDX_8BIT
 			: [Result] "=r" (result)
 			, [Futex] "+r" (ptr)
@@ -487,7 +559,7 @@ bool wfet_wait_for_value_timeout_i8 (uint8_t *ptr,  uint8_t value, uint64_t nano
 			: [WaitCycles] "r" (cycles_end)
 			: "memory");
 
-		if (read_cycle_counter() >= cycles_end) {
+		if (read_cycle_counter() >= cycles_deadline) {
 			return false;
 		}
 	} while (result != value);
@@ -495,18 +567,30 @@ bool wfet_wait_for_value_timeout_i8 (uint8_t *ptr,  uint8_t value, uint64_t nano
 	return true;
 }
 
-bool wfet_wait_for_value_timeout_i16(uint16_t *ptr, uint16_t value, uint64_t nanoseconds, bool low_power) {
+bool wfet_wait_for_value_timeout_i8 (uint8_t *ptr,  uint8_t value, uint64_t nanoseconds, bool low_power) {
+	return wfet_wait_for_value_until_i8(ptr, value, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power);
+}
+
+bool wfet_wait_for_value_until_i16(uint16_t *ptr, uint16_t value, uint64_t cycles_deadline, bool low_power) {
 	uint16_t tmp;
 	uint16_t result = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
 
 	// Early return if the value is already set.
 	if (result == value) return true;
 
-	const uint64_t total_cycles = wfe_mutex_detect_calculate_cycles_for_nanoseconds(nanoseconds);
-	const uint64_t begin_cycles = read_cycle_counter();
-	register const uint64_t cycles_end asm("r2") = begin_cycles + total_cycles;
+	register const uint64_t cycles_end asm("r2") = timeout_wait_deadline(WFE_MUTEX_BACKEND_WFET, cycles_deadline, low_power);
 
 	do {
+		if (read_cycle_counter() >= cycles_end) {
+			// Too close to the deadline for wfet to wake in time, spin the rest.
+			do_yield();
+			result = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+			if (result != value && read_cycle_counter() >= cycles_deadline) {
+				return false;
+			}
+			continue;
+		}
+
 		__asm volatile(SPINLOOP_WFE_LDX_16BIT
 			: [Result] "=r" (result)
 			, [Futex] "+r" (ptr)
@@ -520,7 +604,7 @@ bool wfet_wait_for_value_timeout_i16(uint16_t *ptr, uint16_t value, uint64_t nan
 			: [WaitCycles] "r" (cycles_end)
 			: "memory");
 
-		if (read_cycle_counter() >= cycles_end) {
+		if (read_cycle_counter() >= cycles_deadline) {
 			return false;
 		}
 	} while (result != value);
@@ -528,18 +612,30 @@ bool wfet_wait_for_value_timeout_i16(uint16_t *ptr, uint16_t value, uint64_t nan
 	return true;
 }
 
-bool wfet_wait_for_value_timeout_i32(uint32_t *ptr, uint32_t value, uint64_t nanoseconds, bool low_power) {
+bool wfet_wait_for_value_timeout_i16(uint16_t *ptr, uint16_t value, uint64_t nanoseconds, bool low_power) {
+	return wfet_wait_for_value_until_i16(ptr, value, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power);
+}
+
+bool wfet_wait_for_value_until_i32(uint32_t *ptr, uint32_t value, uint64_t cycles_deadline, bool low_power) {
 	uint32_t tmp;
 	uint32_t result = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
 
 	// Early return if the value is already set.
 	if (result == value) return true;
 
-	const uint64_t begin_cycles = read_cycle_counter();
-	const uint64_t total_cycles = wfe_mutex_detect_calculate_cycles_for_nanoseconds(nanoseconds);
-	register const uint64_t cycles_end asm("r2") = begin_cycles + total_cycles;
+	register const uint64_t cycles_end asm("r2") = timeout_wait_deadline(WFE_MUTEX_BACKEND_WFET, cycles_deadline, low_power);
 
 	do {
+		if (read_cycle_counter() >= cycles_end) {
+			// Too close to the deadline for wfet to wake in time, spin the rest.
+			do_yield();
+			result = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+			if (result != value && read_cycle_counter() >= cycles_deadline) {
+				return false;
+			}
+			continue;
+		}
+
 		__asm volatile(SPINLOOP_WFE_LDX_32BIT
 			: [Result] "=r" (result)
 			, [Futex] "+r" (ptr)
@@ -554,7 +650,7 @@ bool wfet_wait_for_value_timeout_i32(uint32_t *ptr, uint32_t value, uint64_t nan
 			: [WaitCycles] "r" (cycles_end)
 			: "memory");
 
-		if (read_cycle_counter() >= cycles_end) {
+		if (read_cycle_counter() >= cycles_deadline) {
 			return false;
 		}
 	} while (result != value);
@@ -562,18 +658,30 @@ bool wfet_wait_for_value_timeout_i32(uint32_t *ptr, uint32_t value, uint64_t nan
 	return true;
 }
 
-bool wfet_wait_for_value_timeout_i64(uint64_t *ptr, uint64_t value, uint64_t nanoseconds, bool low_power) {
+bool wfet_wait_for_value_timeout_i32(uint32_t *ptr, uint32_t value, uint64_t nanoseconds, bool low_power) {
+	return wfet_wait_for_value_until_i32(ptr, value, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power);
+}
+
+bool wfet_wait_for_value_until_i64(uint64_t *ptr, uint64_t value, uint64_t cycles_deadline, bool low_power) {
 	uint64_t tmp;
 	uint64_t result = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
 
 	// Early return if the value is already set.
 	if (result == value) return true;
 
-	const uint64_t total_cycles = wfe_mutex_detect_calculate_cycles_for_nanoseconds(nanoseconds);
-	const uint64_t begin_cycles = read_cycle_counter();
-	register const uint64_t cycles_end asm("r2") = begin_cycles + total_cycles;
+	register const uint64_t cycles_end asm("r2") = timeout_wait_deadline(WFE_MUTEX_BACKEND_WFET, cycles_deadline, low_power);
 
 	do {
+		if (read_cycle_counter() >= cycles_end) {
+			// Too close to the deadline for wfet to wake in time, spin the rest.
+			do_yield();
+			result = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+			if (result != value && read_cycle_counter() >= cycles_deadline) {
+				return false;
+			}
+			continue;
+		}
+
 		__asm volatile(SPINLOOP_WFE_LDX_64BIT
 			: [Result] "=r" (result)
 			, [Futex] "+r" (ptr)
@@ -587,13 +695,17 @@ bool wfet_wait_for_value_timeout_i64(uint64_t *ptr, uint64_t value, uint64_t nan
 			: [WaitCycles] "r" (cycles_end)
 			: "memory");
 
-		if (read_cycle_counter() >= cycles_end) {
+		if (read_cycle_counter() >= cycles_deadline) {
 			return false;
 		}
 	} while (result != value);
 
 	return true;
 }
+
+bool wfet_wait_for_value_timeout_i64(uint64_t *ptr, uint64_t value, uint64_t nanoseconds, bool low_power) {
+	return wfet_wait_for_value_until_i64(ptr, value, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power);
+}
 #endif
 
 bool wfe_wait_for_value_spurious_oneshot_i8 (uint8_t *ptr,  uint8_t value, bool low_power) {
@@ -685,4 +797,793 @@ bool wfe_wait_for_value_spurious_oneshot_i64(uint64_t *ptr, uint64_t value, bool
 	return result == value;
 }
 #endif
+
+uint8_t wfe_wait_for_change_i8 (uint8_t *ptr,  uint8_t old_value, bool low_power) {
+	uint8_t tmp;
+	uint8_t result = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+
+	// Early return if the value has already changed.
+	if (result != old_value) return result;
+
+	do {
+		__asm volatile(SPINLOOP_WFE_LDX_8BIT
+			: [Result] "=r" (result)
+			, [Futex] "+r" (ptr)
+			:: "memory");
+		if (result != old_value) return result;
+
+		__asm volatile(SPINLOOP_WFE_8BIT
+			: [Result] "=r" (result)
+			, [Tmp] "=r" (tmp)
+			, [Futex] "+r" (ptr)
+			:: "memory");
+	} while (result == old_value);
+
+	return result;
+}
+
+uint16_t wfe_wait_for_change_i16(uint16_t *ptr, uint16_t old_value, bool low_power) {
+	uint16_t tmp;
+	uint16_t result = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+
+	// Early return if the value has already changed.
+	if (result != old_value) return result;
+
+	do {
+		__asm volatile(SPINLOOP_WFE_LDX_16BIT
+			: [Result] "=r" (result)
+			, [Futex] "+r" (ptr)
+			:: "memory");
+		if (result != old_value) return result;
+
+		__asm volatile(SPINLOOP_WFE_16BIT
+			: [Result] "=r" (result)
+			, [Tmp] "=r" (tmp)
+			, [Futex] "+r" (ptr)
+			:: "memory");
+	} while (result == old_value);
+
+	return result;
+}
+
+uint32_t wfe_wait_for_change_i32(uint32_t *ptr, uint32_t old_value, bool low_power) {
+	uint32_t tmp;
+	uint32_t result = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+
+	// Early return if the value has already changed.
+	if (result != old_value) return result;
+
+	do {
+		__asm volatile(SPINLOOP_WFE_LDX_32BIT
+			: [Result] "=r" (result)
+			, [Futex] "+r" (ptr)
+			:: "memory");
+		if (result != old_value) return result;
+
+		__asm volatile(SPINLOOP_WFE_32BIT
+			: [Result] "=r" (result)
+			, [Tmp] "=r" (tmp)
+			, [Futex] "+r" (ptr)
+			:: "memory");
+	} while (result == old_value);
+
+	return result;
+}
+
+#if defined(_M_ARM_64)
+uint64_t wfe_wait_for_change_i64(uint64_t *ptr, uint64_t old_value, bool low_power) {
+	uint64_t tmp;
+	uint64_t result = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+
+	// Early return if the value has already changed.
+	if (result != old_value) return result;
+
+	do {
+		__asm volatile(SPINLOOP_WFE_LDX_64BIT
+			: [Result] "=r" (result)
+			, [Futex] "+r" (ptr)
+			:: "memory");
+		if (result != old_value) return result;
+
+		__asm volatile(SPINLOOP_WFE_64BIT
+			: [Result] "=r" (result)
+			, [Tmp] "=r" (tmp)
+			, [Futex] "+r" (ptr)
+			:: "memory");
+	} while (result == old_value);
+
+	return result;
+}
+#endif
+
+// Predicate waits. `current` is the most recently loaded value that the predicate is evaluated against.
+#define WFE_WAIT_FOR_PREDICATE(T, Bits, predicate) \
+	T tmp; \
+	T current = __atomic_load_n(ptr, __ATOMIC_ACQUIRE); \
+	if (predicate) return current; \
+	do { \
+		__asm volatile(SPINLOOP_WFE_LDX_##Bits##BIT \
+			: [Result] "=r" (current) \
+			, [Futex] "+r" (ptr) \
+			:: "memory"); \
+		if (predicate) return current; \
+		__asm volatile(SPINLOOP_WFE_##Bits##BIT \
+			: [Result] "=r" (current) \
+			, [Tmp] "=r" (tmp) \
+			, [Futex] "+r" (ptr) \
+			:: "memory"); \
+	} while (!(predicate)); \
+	return current;
+
+#define WFE_WAIT_FOR_PREDICATE_UNTIL(T, Bits, predicate) \
+	T tmp; \
+	T current = __atomic_load_n(ptr, __ATOMIC_ACQUIRE); \
+	bool success = true; \
+	if (!(predicate)) { \
+		const uint64_t wait_deadline = wfe_wait_deadline(cycles_deadline, low_power); \
+		do { \
+			if (read_cycle_counter() >= wait_deadline) { \
+				/* Too close to the deadline for the event stream to wake in time, spin the rest. */ \
+				do_yield(); \
+				current = __atomic_load_n(ptr, __ATOMIC_ACQUIRE); \
+				if (!(predicate) && read_cycle_counter() >= cycles_deadline) { \
+					success = false; \
+					break; \
+				} \
+				continue; \
+			} \
+			__asm volatile(SPINLOOP_WFE_LDX_##Bits##BIT \
+				: [Result] "=r" (current) \
+				, [Futex] "+r" (ptr) \
+				:: "memory"); \
+			if (predicate) break; \
+			__asm volatile(SPINLOOP_WFE_##Bits##BIT \
+				: [Result] "=r" (current) \
+				, [Tmp] "=r" (tmp) \
+				, [Futex] "+r" (ptr) \
+				:: "memory"); \
+			if (!(predicate) && read_cycle_counter() >= cycles_deadline) { \
+				success = false; \
+				break; \
+			} \
+		} while (!(predicate)); \
+	} \
+	if (result) *result = current; \
+	return success;
+
+#define WFE_WAIT_FOR_PREDICATE_SPURIOUS_ONESHOT(T, Bits, predicate) \
+	T tmp; \
+	T current = __atomic_load_n(ptr, __ATOMIC_ACQUIRE); \
+	if (!(predicate)) { \
+		__asm volatile(SPINLOOP_WFE_LDX_##Bits##BIT \
+			: [Result] "=r" (current) \
+			, [Futex] "+r" (ptr) \
+			:: "memory"); \
+		if (!(predicate)) { \
+			__asm volatile(SPINLOOP_WFE_##Bits##BIT \
+				: [Result] "=r" (current) \
+				, [Tmp] "=r" (tmp) \
+				, [Futex] "+r" (ptr) \
+				:: "memory"); \
+		} \
+	} \
+	if (result) *result = current; \
+	return predicate;
+
+#if defined(_M_ARM_64)
+#define WFET_WAIT_FOR_PREDICATE_UNTIL(T, Bits, predicate) \
+	T tmp; \
+	T current = __atomic_load_n(ptr, __ATOMIC_ACQUIRE); \
+	bool success = true; \
+	if (!(predicate)) { \
+		register const uint64_t cycles_end asm("r2") = timeout_wait_deadline(WFE_MUTEX_BACKEND_WFET, cycles_deadline, low_power); \
+		do { \
+			if (read_cycle_counter() >= cycles_end) { \
+				/* Too close to the deadline for wfet to wake in time, spin the rest. */ \
+				do_yield(); \
+				current = __atomic_load_n(ptr, __ATOMIC_ACQUIRE); \
+				if (!(predicate) && read_cycle_counter() >= cycles_deadline) { \
+					success = false; \
+					break; \
+				} \
+				continue; \
+			} \
+			__asm volatile(SPINLOOP_WFE_LDX_##Bits##BIT \
+				: [Result] "=r" (current) \
+				, [Futex] "+r" (ptr) \
+				:: "memory"); \
+			if (predicate) break; \
+			__asm volatile(SPINLOOP_WFET_##Bits##BIT \
+				: [Result] "=r" (current) \
+				, [Tmp] "=r" (tmp) \
+				, [Futex] "+r" (ptr) \
+				: [WaitCycles] "r" (cycles_end) \
+				: "memory"); \
+			if (!(predicate) && read_cycle_counter() >= cycles_deadline) { \
+				success = false; \
+				break; \
+			} \
+		} while (!(predicate)); \
+	} \
+	if (result) *result = current; \
+	return success;
+#endif
+
+uint8_t wfe_wait_for_masked_value_i8 (uint8_t *ptr,  uint8_t mask, uint8_t value, bool low_power) {
+	WFE_WAIT_FOR_PREDICATE(uint8_t, 8, (current & mask) == value);
+}
+
+uint16_t wfe_wait_for_masked_value_i16(uint16_t *ptr, uint16_t mask, uint16_t value, bool low_power) {
+	WFE_WAIT_FOR_PREDICATE(uint16_t, 16, (current & mask) == value);
+}
+
+uint32_t wfe_wait_for_masked_value_i32(uint32_t *ptr, uint32_t mask, uint32_t value, bool low_power) {
+	WFE_WAIT_FOR_PREDICATE(uint32_t, 32, (current & mask) == value);
+}
+
+#if defined(_M_ARM_64)
+uint64_t wfe_wait_for_masked_value_i64(uint64_t *ptr, uint64_t mask, uint64_t value, bool low_power) {
+	WFE_WAIT_FOR_PREDICATE(uint64_t, 64, (current & mask) == value);
+}
+#endif
+
+uint8_t wfe_wait_for_any_bit_set_i8 (uint8_t *ptr,  uint8_t mask, bool low_power) {
+	WFE_WAIT_FOR_PREDICATE(uint8_t, 8, (current & mask) != 0);
+}
+
+uint16_t wfe_wait_for_any_bit_set_i16(uint16_t *ptr, uint16_t mask, bool low_power) {
+	WFE_WAIT_FOR_PREDICATE(uint16_t, 16, (current & mask) != 0);
+}
+
+uint32_t wfe_wait_for_any_bit_set_i32(uint32_t *ptr, uint32_t mask, bool low_power) {
+	WFE_WAIT_FOR_PREDICATE(uint32_t, 32, (current & mask) != 0);
+}
+
+#if defined(_M_ARM_64)
+uint64_t wfe_wait_for_any_bit_set_i64(uint64_t *ptr, uint64_t mask, bool low_power) {
+	WFE_WAIT_FOR_PREDICATE(uint64_t, 64, (current & mask) != 0);
+}
+#endif
+
+uint8_t wfe_wait_for_sequence_ge_i8 (uint8_t *ptr,  uint8_t target, bool low_power) {
+	WFE_WAIT_FOR_PREDICATE(uint8_t, 8, (int8_t)(current - target) >= 0);
+}
+
+uint16_t wfe_wait_for_sequence_ge_i16(uint16_t *ptr, uint16_t target, bool low_power) {
+	WFE_WAIT_FOR_PREDICATE(uint16_t, 16, (int16_t)(current - target) >= 0);
+}
+
+uint32_t wfe_wait_for_sequence_ge_i32(uint32_t *ptr, uint32_t target, bool low_power) {
+	WFE_WAIT_FOR_PREDICATE(uint32_t, 32, (int32_t)(current - target) >= 0);
+}
+
+#if defined(_M_ARM_64)
+uint64_t wfe_wait_for_sequence_ge_i64(uint64_t *ptr, uint64_t target, bool low_power) {
+	WFE_WAIT_FOR_PREDICATE(uint64_t, 64, (int64_t)(current - target) >= 0);
+}
+#endif
+
+bool wfe_wait_for_masked_value_until_i8 (uint8_t *ptr,  uint8_t mask, uint8_t value, uint64_t cycles_deadline, bool low_power, uint8_t *result) {
+	WFE_WAIT_FOR_PREDICATE_UNTIL(uint8_t, 8, (current & mask) == value);
+}
+
+bool wfe_wait_for_masked_value_timeout_i8 (uint8_t *ptr,  uint8_t mask, uint8_t value, uint64_t nanoseconds, bool low_power, uint8_t *result) {
+	return wfe_wait_for_masked_value_until_i8(ptr, mask, value, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool wfe_wait_for_masked_value_until_i16(uint16_t *ptr, uint16_t mask, uint16_t value, uint64_t cycles_deadline, bool low_power, uint16_t *result) {
+	WFE_WAIT_FOR_PREDICATE_UNTIL(uint16_t, 16, (current & mask) == value);
+}
+
+bool wfe_wait_for_masked_value_timeout_i16(uint16_t *ptr, uint16_t mask, uint16_t value, uint64_t nanoseconds, bool low_power, uint16_t *result) {
+	return wfe_wait_for_masked_value_until_i16(ptr, mask, value, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool wfe_wait_for_masked_value_until_i32(uint32_t *ptr, uint32_t mask, uint32_t value, uint64_t cycles_deadline, bool low_power, uint32_t *result) {
+	WFE_WAIT_FOR_PREDICATE_UNTIL(uint32_t, 32, (current & mask) == value);
+}
+
+bool wfe_wait_for_masked_value_timeout_i32(uint32_t *ptr, uint32_t mask, uint32_t value, uint64_t nanoseconds, bool low_power, uint32_t *result) {
+	return wfe_wait_for_masked_value_until_i32(ptr, mask, value, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+#if defined(_M_ARM_64)
+bool wfe_wait_for_masked_value_until_i64(uint64_t *ptr, uint64_t mask, uint64_t value, uint64_t cycles_deadline, bool low_power, uint64_t *result) {
+	WFE_WAIT_FOR_PREDICATE_UNTIL(uint64_t, 64, (current & mask) == value);
+}
+
+bool wfe_wait_for_masked_value_timeout_i64(uint64_t *ptr, uint64_t mask, uint64_t value, uint64_t nanoseconds, bool low_power, uint64_t *result) {
+	return wfe_wait_for_masked_value_until_i64(ptr, mask, value, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+#endif
+
+bool wfe_wait_for_any_bit_set_until_i8 (uint8_t *ptr,  uint8_t mask, uint64_t cycles_deadline, bool low_power, uint8_t *result) {
+	WFE_WAIT_FOR_PREDICATE_UNTIL(uint8_t, 8, (current & mask) != 0);
+}
+
+bool wfe_wait_for_any_bit_set_timeout_i8 (uint8_t *ptr,  uint8_t mask, uint64_t nanoseconds, bool low_power, uint8_t *result) {
+	return wfe_wait_for_any_bit_set_until_i8(ptr, mask, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool wfe_wait_for_any_bit_set_until_i16(uint16_t *ptr, uint16_t mask, uint64_t cycles_deadline, bool low_power, uint16_t *result) {
+	WFE_WAIT_FOR_PREDICATE_UNTIL(uint16_t, 16, (current & mask) != 0);
+}
+
+bool wfe_wait_for_any_bit_set_timeout_i16(uint16_t *ptr, uint16_t mask, uint64_t nanoseconds, bool low_power, uint16_t *result) {
+	return wfe_wait_for_any_bit_set_until_i16(ptr, mask, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool wfe_wait_for_any_bit_set_until_i32(uint32_t *ptr, uint32_t mask, uint64_t cycles_deadline, bool low_power, uint32_t *result) {
+	WFE_WAIT_FOR_PREDICATE_UNTIL(uint32_t, 32, (current & mask) != 0);
+}
+
+bool wfe_wait_for_any_bit_set_timeout_i32(uint32_t *ptr, uint32_t mask, uint64_t nanoseconds, bool low_power, uint32_t *result) {
+	return wfe_wait_for_any_bit_set_until_i32(ptr, mask, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+#if defined(_M_ARM_64)
+bool wfe_wait_for_any_bit_set_until_i64(uint64_t *ptr, uint64_t mask, uint64_t cycles_deadline, bool low_power, uint64_t *result) {
+	WFE_WAIT_FOR_PREDICATE_UNTIL(uint64_t, 64, (current & mask) != 0);
+}
+
+bool wfe_wait_for_any_bit_set_timeout_i64(uint64_t *ptr, uint64_t mask, uint64_t nanoseconds, bool low_power, uint64_t *result) {
+	return wfe_wait_for_any_bit_set_until_i64(ptr, mask, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+#endif
+
+bool wfe_wait_for_sequence_ge_until_i8 (uint8_t *ptr,  uint8_t target, uint64_t cycles_deadline, bool low_power, uint8_t *result) {
+	WFE_WAIT_FOR_PREDICATE_UNTIL(uint8_t, 8, (int8_t)(current - target) >= 0);
+}
+
+bool wfe_wait_for_sequence_ge_timeout_i8 (uint8_t *ptr,  uint8_t target, uint64_t nanoseconds, bool low_power, uint8_t *result) {
+	return wfe_wait_for_sequence_ge_until_i8(ptr, target, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool wfe_wait_for_sequence_ge_until_i16(uint16_t *ptr, uint16_t target, uint64_t cycles_deadline, bool low_power, uint16_t *result) {
+	WFE_WAIT_FOR_PREDICATE_UNTIL(uint16_t, 16, (int16_t)(current - target) >= 0);
+}
+
+bool wfe_wait_for_sequence_ge_timeout_i16(uint16_t *ptr, uint16_t target, uint64_t nanoseconds, bool low_power, uint16_t *result) {
+	return wfe_wait_for_sequence_ge_until_i16(ptr, target, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool wfe_wait_for_sequence_ge_until_i32(uint32_t *ptr, uint32_t target, uint64_t cycles_deadline, bool low_power, uint32_t *result) {
+	WFE_WAIT_FOR_PREDICATE_UNTIL(uint32_t, 32, (int32_t)(current - target) >= 0);
+}
+
+bool wfe_wait_for_sequence_ge_timeout_i32(uint32_t *ptr, uint32_t target, uint64_t nanoseconds, bool low_power, uint32_t *result) {
+	return wfe_wait_for_sequence_ge_until_i32(ptr, target, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+#if defined(_M_ARM_64)
+bool wfe_wait_for_sequence_ge_until_i64(uint64_t *ptr, uint64_t target, uint64_t cycles_deadline, bool low_power, uint64_t *result) {
+	WFE_WAIT_FOR_PREDICATE_UNTIL(uint64_t, 64, (int64_t)(current - target) >= 0);
+}
+
+bool wfe_wait_for_sequence_ge_timeout_i64(uint64_t *ptr, uint64_t target, uint64_t nanoseconds, bool low_power, uint64_t *result) {
+	return wfe_wait_for_sequence_ge_until_i64(ptr, target, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+#endif
+
+bool wfe_wait_for_bit_set_until_i8 (uint8_t *ptr,  uint8_t bit, uint64_t cycles_deadline, bool low_power, uint8_t *result) {
+	WFE_WAIT_FOR_PREDICATE_UNTIL(uint8_t, 8, ((current >> bit) & 1) == 1);
+}
+
+bool wfe_wait_for_bit_set_timeout_i8 (uint8_t *ptr,  uint8_t bit, uint64_t nanoseconds, bool low_power, uint8_t *result) {
+	return wfe_wait_for_bit_set_until_i8(ptr, bit, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool wfe_wait_for_bit_set_until_i16(uint16_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint16_t *result) {
+	WFE_WAIT_FOR_PREDICATE_UNTIL(uint16_t, 16, ((current >> bit) & 1) == 1);
+}
+
+bool wfe_wait_for_bit_set_timeout_i16(uint16_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint16_t *result) {
+	return wfe_wait_for_bit_set_until_i16(ptr, bit, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool wfe_wait_for_bit_set_until_i32(uint32_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint32_t *result) {
+	WFE_WAIT_FOR_PREDICATE_UNTIL(uint32_t, 32, ((current >> bit) & 1) == 1);
+}
+
+bool wfe_wait_for_bit_set_timeout_i32(uint32_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint32_t *result) {
+	return wfe_wait_for_bit_set_until_i32(ptr, bit, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+#if defined(_M_ARM_64)
+bool wfe_wait_for_bit_set_until_i64(uint64_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint64_t *result) {
+	WFE_WAIT_FOR_PREDICATE_UNTIL(uint64_t, 64, ((current >> bit) & 1) == 1);
+}
+
+bool wfe_wait_for_bit_set_timeout_i64(uint64_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint64_t *result) {
+	return wfe_wait_for_bit_set_until_i64(ptr, bit, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+#endif
+
+bool wfe_wait_for_bit_not_set_until_i8 (uint8_t *ptr,  uint8_t bit, uint64_t cycles_deadline, bool low_power, uint8_t *result) {
+	WFE_WAIT_FOR_PREDICATE_UNTIL(uint8_t, 8, ((current >> bit) & 1) == 0);
+}
+
+bool wfe_wait_for_bit_not_set_timeout_i8 (uint8_t *ptr,  uint8_t bit, uint64_t nanoseconds, bool low_power, uint8_t *result) {
+	return wfe_wait_for_bit_not_set_until_i8(ptr, bit, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool wfe_wait_for_bit_not_set_until_i16(uint16_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint16_t *result) {
+	WFE_WAIT_FOR_PREDICATE_UNTIL(uint16_t, 16, ((current >> bit) & 1) == 0);
+}
+
+bool wfe_wait_for_bit_not_set_timeout_i16(uint16_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint16_t *result) {
+	return wfe_wait_for_bit_not_set_until_i16(ptr, bit, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool wfe_wait_for_bit_not_set_until_i32(uint32_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint32_t *result) {
+	WFE_WAIT_FOR_PREDICATE_UNTIL(uint32_t, 32, ((current >> bit) & 1) == 0);
+}
+
+bool wfe_wait_for_bit_not_set_timeout_i32(uint32_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint32_t *result) {
+	return wfe_wait_for_bit_not_set_until_i32(ptr, bit, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+#if defined(_M_ARM_64)
+bool wfe_wait_for_bit_not_set_until_i64(uint64_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint64_t *result) {
+	WFE_WAIT_FOR_PREDICATE_UNTIL(uint64_t, 64, ((current >> bit) & 1) == 0);
+}
+
+bool wfe_wait_for_bit_not_set_timeout_i64(uint64_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint64_t *result) {
+	return wfe_wait_for_bit_not_set_until_i64(ptr, bit, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+#endif
+
+bool wfe_wait_for_bit_set_spurious_oneshot_i8 (uint8_t *ptr,  uint8_t bit, bool low_power, uint8_t *result) {
+	WFE_WAIT_FOR_PREDICATE_SPURIOUS_ONESHOT(uint8_t, 8, ((current >> bit) & 1) == 1);
+}
+
+bool wfe_wait_for_bit_set_spurious_oneshot_i16(uint16_t *ptr, uint8_t bit, bool low_power, uint16_t *result) {
+	WFE_WAIT_FOR_PREDICATE_SPURIOUS_ONESHOT(uint16_t, 16, ((current >> bit) & 1) == 1);
+}
+
+bool wfe_wait_for_bit_set_spurious_oneshot_i32(uint32_t *ptr, uint8_t bit, bool low_power, uint32_t *result) {
+	WFE_WAIT_FOR_PREDICATE_SPURIOUS_ONESHOT(uint32_t, 32, ((current >> bit) & 1) == 1);
+}
+
+#if defined(_M_ARM_64)
+bool wfe_wait_for_bit_set_spurious_oneshot_i64(uint64_t *ptr, uint8_t bit, bool low_power, uint64_t *result) {
+	WFE_WAIT_FOR_PREDICATE_SPURIOUS_ONESHOT(uint64_t, 64, ((current >> bit) & 1) == 1);
+}
+#endif
+
+bool wfe_wait_for_bit_not_set_spurious_oneshot_i8 (uint8_t *ptr,  uint8_t bit, bool low_power, uint8_t *result) {
+	WFE_WAIT_FOR_PREDICATE_SPURIOUS_ONESHOT(uint8_t, 8, ((current >> bit) & 1) == 0);
+}
+
+bool wfe_wait_for_bit_not_set_spurious_oneshot_i16(uint16_t *ptr, uint8_t bit, bool low_power, uint16_t *result) {
+	WFE_WAIT_FOR_PREDICATE_SPURIOUS_ONESHOT(uint16_t, 16, ((current >> bit) & 1) == 0);
+}
+
+bool wfe_wait_for_bit_not_set_spurious_oneshot_i32(uint32_t *ptr, uint8_t bit, bool low_power, uint32_t *result) {
+	WFE_WAIT_FOR_PREDICATE_SPURIOUS_ONESHOT(uint32_t, 32, ((current >> bit) & 1) == 0);
+}
+
+#if defined(_M_ARM_64)
+bool wfe_wait_for_bit_not_set_spurious_oneshot_i64(uint64_t *ptr, uint8_t bit, bool low_power, uint64_t *result) {
+	WFE_WAIT_FOR_PREDICATE_SPURIOUS_ONESHOT(uint64_t, 64, ((current >> bit) & 1) == 0);
+}
+#endif
+
+size_t wfe_wait_any_oneshot(const wfe_mutex_wait_desc *descs, size_t n, size_t monitor_index, uint64_t nanoseconds, bool low_power) {
+	// WFE can't time out, the event stream bounds how long the unarmed words go unobserved.
+	// Without one a timed oneshot would never recheck them, poll every word for the timeout instead.
+	if (nanoseconds && Features.event_stream_period_cycles == 0) {
+		return spinloop_wait_any_oneshot(descs, n, monitor_index, nanoseconds, low_power);
+	}
+
+	uint8_t *ptr = (uint8_t*)descs[monitor_index].ptr;
+	uint8_t tmp;
+	uint8_t current;
+
+	__asm volatile(SPINLOOP_WFE_LDX_8BIT
+		: [Result] "=r" (current)
+		, [Futex] "+r" (ptr)
+		:: "memory");
+
+	// Check every word after arming so a store between the check and the wait still wakes us.
+	const size_t index = wait_any_find_satisfied(descs, n);
+	if (index != n) return index;
+
+	__asm volatile(SPINLOOP_WFE_8BIT
+		: [Result] "=r" (current)
+		, [Tmp] "=r" (tmp)
+		, [Futex] "+r" (ptr)
+		:: "memory");
+
+	return wait_any_find_satisfied(descs, n);
+}
+
+uint64_t wfe_doorbell_wait(wfe_mutex_doorbell *doorbell, bool low_power) {
+	uint8_t *ptr = doorbell->flags;
+	uint8_t tmp;
+	uint8_t current;
+	uint64_t mask = doorbell_scan(doorbell);
+
+	while (mask == 0) {
+		// Arm the monitor on the whole block, then scan every flag before waiting.
+		__asm volatile(SPINLOOP_WFE_LDX_8BIT
+			: [Result] "=r" (current)
+			, [Futex] "+r" (ptr)
+			:: "memory");
+
+		mask = doorbell_scan(doorbell);
+		if (mask) break;
+
+		__asm volatile(SPINLOOP_WFE_8BIT
+			: [Result] "=r" (current)
+			, [Tmp] "=r" (tmp)
+			, [Futex] "+r" (ptr)
+			:: "memory");
+
+		mask = doorbell_scan(doorbell);
+	}
+	return doorbell_consume(doorbell, mask);
+}
+
+void wfe_sleep_until(uint64_t cycles_deadline, bool low_power) {
+	// Without WFET a WFE only ends on the event stream. Without one use the yield loop.
+	if (Features.event_stream_period_cycles == 0) {
+		spinloop_sleep_until(cycles_deadline, low_power);
+		return;
+	}
+
+	const uint64_t wait_deadline = wfe_wait_deadline(cycles_deadline, low_power);
+	while (read_cycle_counter() < wait_deadline) {
+		__asm volatile("wfe;\n" ::: "memory");
+	}
+
+	// Spin the rest that the event stream can't hit precisely.
+	while (read_cycle_counter() < cycles_deadline) {
+		do_yield();
+	}
+}
+
+#if defined(_M_ARM_64)
+bool wfet_wait_for_masked_value_until_i8 (uint8_t *ptr,  uint8_t mask, uint8_t value, uint64_t cycles_deadline, bool low_power, uint8_t *result) {
+	WFET_WAIT_FOR_PREDICATE_UNTIL(uint8_t, 8, (current & mask) == value);
+}
+
+bool wfet_wait_for_masked_value_timeout_i8 (uint8_t *ptr,  uint8_t mask, uint8_t value, uint64_t nanoseconds, bool low_power, uint8_t *result) {
+	return wfet_wait_for_masked_value_until_i8(ptr, mask, value, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool wfet_wait_for_masked_value_until_i16(uint16_t *ptr, uint16_t mask, uint16_t value, uint64_t cycles_deadline, bool low_power, uint16_t *result) {
+	WFET_WAIT_FOR_PREDICATE_UNTIL(uint16_t, 16, (current & mask) == value);
+}
+
+bool wfet_wait_for_masked_value_timeout_i16(uint16_t *ptr, uint16_t mask, uint16_t value, uint64_t nanoseconds, bool low_power, uint16_t *result) {
+	return wfet_wait_for_masked_value_until_i16(ptr, mask, value, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool wfet_wait_for_masked_value_until_i32(uint32_t *ptr, uint32_t mask, uint32_t value, uint64_t cycles_deadline, bool low_power, uint32_t *result) {
+	WFET_WAIT_FOR_PREDICATE_UNTIL(uint32_t, 32, (current & mask) == value);
+}
+
+bool wfet_wait_for_masked_value_timeout_i32(uint32_t *ptr, uint32_t mask, uint32_t value, uint64_t nanoseconds, bool low_power, uint32_t *result) {
+	return wfet_wait_for_masked_value_until_i32(ptr, mask, value, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool wfet_wait_for_masked_value_until_i64(uint64_t *ptr, uint64_t mask, uint64_t value, uint64_t cycles_deadline, bool low_power, uint64_t *result) {
+	WFET_WAIT_FOR_PREDICATE_UNTIL(uint64_t, 64, (current & mask) == value);
+}
+
+bool wfet_wait_for_masked_value_timeout_i64(uint64_t *ptr, uint64_t mask, uint64_t value, uint64_t nanoseconds, bool low_power, uint64_t *result) {
+	return wfet_wait_for_masked_value_until_i64(ptr, mask, value, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool wfet_wait_for_any_bit_set_until_i8 (uint8_t *ptr,  uint8_t mask, uint64_t cycles_deadline, bool low_power, uint8_t *result) {
+	WFET_WAIT_FOR_PREDICATE_UNTIL(uint8_t, 8, (current & mask) != 0);
+}
+
+bool wfet_wait_for_any_bit_set_timeout_i8 (uint8_t *ptr,  uint8_t mask, uint64_t nanoseconds, bool low_power, uint8_t *result) {
+	return wfet_wait_for_any_bit_set_until_i8(ptr, mask, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool wfet_wait_for_any_bit_set_until_i16(uint16_t *ptr, uint16_t mask, uint64_t cycles_deadline, bool low_power, uint16_t *result) {
+	WFET_WAIT_FOR_PREDICATE_UNTIL(uint16_t, 16, (current & mask) != 0);
+}
+
+bool wfet_wait_for_any_bit_set_timeout_i16(uint16_t *ptr, uint16_t mask, uint64_t nanoseconds, bool low_power, uint16_t *result) {
+	return wfet_wait_for_any_bit_set_until_i16(ptr, mask, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool wfet_wait_for_any_bit_set_until_i32(uint32_t *ptr, uint32_t mask, uint64_t cycles_deadline, bool low_power, uint32_t *result) {
+	WFET_WAIT_FOR_PREDICATE_UNTIL(uint32_t, 32, (current & mask) != 0);
+}
+
+bool wfet_wait_for_any_bit_set_timeout_i32(uint32_t *ptr, uint32_t mask, uint64_t nanoseconds, bool low_power, uint32_t *result) {
+	return wfet_wait_for_any_bit_set_until_i32(ptr, mask, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool wfet_wait_for_any_bit_set_until_i64(uint64_t *ptr, uint64_t mask, uint64_t cycles_deadline, bool low_power, uint64_t *result) {
+	WFET_WAIT_FOR_PREDICATE_UNTIL(uint64_t, 64, (current & mask) != 0);
+}
+
+bool wfet_wait_for_any_bit_set_timeout_i64(uint64_t *ptr, uint64_t mask, uint64_t nanoseconds, bool low_power, uint64_t *result) {
+	return wfet_wait_for_any_bit_set_until_i64(ptr, mask, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool wfet_wait_for_sequence_ge_until_i8 (uint8_t *ptr,  uint8_t target, uint64_t cycles_deadline, bool low_power, uint8_t *result) {
+	WFET_WAIT_FOR_PREDICATE_UNTIL(uint8_t, 8, (int8_t)(current - target) >= 0);
+}
+
+bool wfet_wait_for_sequence_ge_timeout_i8 (uint8_t *ptr,  uint8_t target, uint64_t nanoseconds, bool low_power, uint8_t *result) {
+	return wfet_wait_for_sequence_ge_until_i8(ptr, target, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool wfet_wait_for_sequence_ge_until_i16(uint16_t *ptr, uint16_t target, uint64_t cycles_deadline, bool low_power, uint16_t *result) {
+	WFET_WAIT_FOR_PREDICATE_UNTIL(uint16_t, 16, (int16_t)(current - target) >= 0);
+}
+
+bool wfet_wait_for_sequence_ge_timeout_i16(uint16_t *ptr, uint16_t target, uint64_t nanoseconds, bool low_power, uint16_t *result) {
+	return wfet_wait_for_sequence_ge_until_i16(ptr, target, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool wfet_wait_for_sequence_ge_until_i32(uint32_t *ptr, uint32_t target, uint64_t cycles_deadline, bool low_power, uint32_t *result) {
+	WFET_WAIT_FOR_PREDICATE_UNTIL(uint32_t, 32, (int32_t)(current - target) >= 0);
+}
+
+bool wfet_wait_for_sequence_ge_timeout_i32(uint32_t *ptr, uint32_t target, uint64_t nanoseconds, bool low_power, uint32_t *result) {
+	return wfet_wait_for_sequence_ge_until_i32(ptr, target, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool wfet_wait_for_sequence_ge_until_i64(uint64_t *ptr, uint64_t target, uint64_t cycles_deadline, bool low_power, uint64_t *result) {
+	WFET_WAIT_FOR_PREDICATE_UNTIL(uint64_t, 64, (int64_t)(current - target) >= 0);
+}
+
+bool wfet_wait_for_sequence_ge_timeout_i64(uint64_t *ptr, uint64_t target, uint64_t nanoseconds, bool low_power, uint64_t *result) {
+	return wfet_wait_for_sequence_ge_until_i64(ptr, target, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool wfet_wait_for_bit_set_until_i8 (uint8_t *ptr,  uint8_t bit, uint64_t cycles_deadline, bool low_power, uint8_t *result) {
+	WFET_WAIT_FOR_PREDICATE_UNTIL(uint8_t, 8, ((current >> bit) & 1) == 1);
+}
+
+bool wfet_wait_for_bit_set_timeout_i8 (uint8_t *ptr,  uint8_t bit, uint64_t nanoseconds, bool low_power, uint8_t *result) {
+	return wfet_wait_for_bit_set_until_i8(ptr, bit, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool wfet_wait_for_bit_set_until_i16(uint16_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint16_t *result) {
+	WFET_WAIT_FOR_PREDICATE_UNTIL(uint16_t, 16, ((current >> bit) & 1) == 1);
+}
+
+bool wfet_wait_for_bit_set_timeout_i16(uint16_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint16_t *result) {
+	return wfet_wait_for_bit_set_until_i16(ptr, bit, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool wfet_wait_for_bit_set_until_i32(uint32_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint32_t *result) {
+	WFET_WAIT_FOR_PREDICATE_UNTIL(uint32_t, 32, ((current >> bit) & 1) == 1);
+}
+
+bool wfet_wait_for_bit_set_timeout_i32(uint32_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint32_t *result) {
+	return wfet_wait_for_bit_set_until_i32(ptr, bit, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool wfet_wait_for_bit_set_until_i64(uint64_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint64_t *result) {
+	WFET_WAIT_FOR_PREDICATE_UNTIL(uint64_t, 64, ((current >> bit) & 1) == 1);
+}
+
+bool wfet_wait_for_bit_set_timeout_i64(uint64_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint64_t *result) {
+	return wfet_wait_for_bit_set_until_i64(ptr, bit, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool wfet_wait_for_bit_not_set_until_i8 (uint8_t *ptr,  uint8_t bit, uint64_t cycles_deadline, bool low_power, uint8_t *result) {
+	WFET_WAIT_FOR_PREDICATE_UNTIL(uint8_t, 8, ((current >> bit) & 1) == 0);
+}
+
+bool wfet_wait_for_bit_not_set_timeout_i8 (uint8_t *ptr,  uint8_t bit, uint64_t nanoseconds, bool low_power, uint8_t *result) {
+	return wfet_wait_for_bit_not_set_until_i8(ptr, bit, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool wfet_wait_for_bit_not_set_until_i16(uint16_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint16_t *result) {
+	WFET_WAIT_FOR_PREDICATE_UNTIL(uint16_t, 16, ((current >> bit) & 1) == 0);
+}
+
+bool wfet_wait_for_bit_not_set_timeout_i16(uint16_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint16_t *result) {
+	return wfet_wait_for_bit_not_set_until_i16(ptr, bit, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool wfet_wait_for_bit_not_set_until_i32(uint32_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint32_t *result) {
+	WFET_WAIT_FOR_PREDICATE_UNTIL(uint32_t, 32, ((current >> bit) & 1) == 0);
+}
+
+bool wfet_wait_for_bit_not_set_timeout_i32(uint32_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint32_t *result) {
+	return wfet_wait_for_bit_not_set_until_i32(ptr, bit, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool wfet_wait_for_bit_not_set_until_i64(uint64_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint64_t *result) {
+	WFET_WAIT_FOR_PREDICATE_UNTIL(uint64_t, 64, ((current >> bit) & 1) == 0);
+}
+
+bool wfet_wait_for_bit_not_set_timeout_i64(uint64_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint64_t *result) {
+	return wfet_wait_for_bit_not_set_until_i64(ptr, bit, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+size_t wfet_wait_any_oneshot(const wfe_mutex_wait_desc *descs, size_t n, size_t monitor_index, uint64_t nanoseconds, bool low_power) {
+	if (!nanoseconds) return wfe_wait_any_oneshot(descs, n, monitor_index, nanoseconds, low_power);
+
+	uint8_t *ptr = (uint8_t*)descs[monitor_index].ptr;
+	uint8_t tmp;
+	uint8_t current;
+
+	const uint64_t total_cycles = wfe_mutex_detect_calculate_cycles_for_nanoseconds(nanoseconds);
+	const uint64_t begin_cycles = read_cycle_counter();
+	register const uint64_t cycles_end asm("r2") = begin_cycles + total_cycles;
+
+	__asm volatile(SPINLOOP_WFE_LDX_8BIT
+		: [Result] "=r" (current)
+		, [Futex] "+r" (ptr)
+		:: "memory");
+
+	// Check every word after arming so a store between the check and the wait still wakes us.
+	const size_t index = wait_any_find_satisfied(descs, n);
+	if (index != n) return index;
+
+	__asm volatile(SPINLOOP_WFET_8BIT
+		: [Result] "=r" (current)
+		, [Tmp] "=r" (tmp)
+		, [Futex] "+r" (ptr)
+		: [WaitCycles] "r" (cycles_end)
+		: "memory");
+
+	return wait_any_find_satisfied(descs, n);
+}
+
+void wfet_sleep_until(uint64_t cycles_deadline, bool low_power) {
+	register const uint64_t cycles_end asm("r2") = timeout_wait_deadline(WFE_MUTEX_BACKEND_WFET, cycles_deadline, low_power);
+
+	// Nothing is monitored, so only the timeout, the event stream or a SEV ends the wait.
+	while (read_cycle_counter() < cycles_end) {
+		__asm volatile(
+			/* Hardcoded `wfet x2`. Required to bypass compile-time checks */
+			".word 0b11010101000000110001000000000010;\n"
+			:: [WaitCycles] "r" (cycles_end)
+			: "memory");
+	}
+
+	// Spin the rest that wfet can't hit precisely.
+	while (read_cycle_counter() < cycles_deadline) {
+		do_yield();
+	}
+}
+#endif
+
+#if defined(_M_ARM_64)
+wfe_mutex_u128 wfe_wait_for_masked_value_i128(wfe_mutex_u128 *ptr, wfe_mutex_u128 mask, wfe_mutex_u128 value, bool low_power) {
+	// Poll with the exclusive load alone, only a match needs the pair confirmed.
+	wfe_mutex_u128 current;
+	while (true) {
+		uint64_t low, high;
+
+		// Prime the exclusive monitor with the pair.
+		__asm volatile(
+			"ldaxp %[Low], %[High], [%[Futex]];\n"
+			: [Low] "=&r" (low)
+			, [High] "=&r" (high)
+			: [Futex] "r" (ptr)
+			: "memory");
+
+		current.low = low;
+		current.high = high;
+		if (u128_masked_equal(current, mask, value)) {
+			// The exclusive load can tear, confirm that both halves were observed together.
+			current = confirm_load_u128(ptr);
+			if (u128_masked_equal(current, mask, value)) return current;
+			continue;
+		}
+
+		// WFE will wait for either the memory to change or spurious wake-up.
+		__asm volatile("wfe;\n" ::: "memory");
+	}
+}
+
+void wfe_wait_for_value_i128(wfe_mutex_u128 *ptr, wfe_mutex_u128 value, bool low_power) {
+	wfe_wait_for_masked_value_i128(ptr, u128_all_ones(), value, low_power);
+}
+#endif
 #endif
@@ -1,6 +1,10 @@
 #include "detect.h"
 #include "implementations.h"
 #include "implementation_details_x86.h"
+#include "implementation_details_u128.h"
+#include "implementation_details_wait_any.h"
+#include "implementation_details_doorbell.h"
+#include "implementation_details_timeout.h"
 
 #include <limits>
 #include <stdint.h>
@@ -78,21 +82,31 @@ T mwaitx_wait_for_bit_impl(T *ptr, uint8_t bit, bool low_power) {
 }
 
 template<typename T>
-static inline bool mwaitx_wait_for_value_impl(T *ptr, T value, uint64_t nanoseconds, bool low_power) {
+static inline bool mwaitx_wait_for_value_impl(T *ptr, T value, uint64_t cycles_deadline, bool low_power) {
 	// Early return if the value is already set.
 	if (__atomic_load_n(ptr, __ATOMIC_ACQUIRE) == value) return true;
 
-	const uint64_t total_cycles = wfe_mutex_detect_calculate_cycles_for_nanoseconds(nanoseconds);
-	const uint64_t begin_cycles = read_cycle_counter();
-	const uint64_t cycles_end = begin_cycles + total_cycles;
+	const uint64_t wait_deadline = timeout_wait_deadline(WFE_MUTEX_BACKEND_MONITORX, cycles_deadline, low_power);
+	uint64_t last_cycle_counter = read_cycle_counter();
 
-	uint64_t last_cycle_counter = begin_cycles;
+	// A deadline already in the past times out before any remaining cycles are computed.
+	if (last_cycle_counter >= cycles_deadline) return false;
 
 	do {
+		if (last_cycle_counter >= wait_deadline) {
+			// Too close to the deadline for mwaitx to return in time, spin the rest.
+			do_yield();
+			last_cycle_counter = read_cycle_counter();
+			if (last_cycle_counter >= cycles_deadline) {
+				return false;
+			}
+			continue;
+		}
+
 		uint32_t extension = 0;
 		uint32_t hints = 0;
 
-		const uint64_t cycles_u64 = cycles_end - last_cycle_counter;
+		const uint64_t cycles_u64 = wait_deadline - last_cycle_counter;
 		const uint32_t cycles_remaining = cycles_u64 >= std::numeric_limits<uint32_t>::max() ? std::numeric_limits<uint32_t>::max() : cycles_u64;
 
 		__asm volatile (
@@ -119,7 +133,7 @@ static inline bool mwaitx_wait_for_value_impl(T *ptr, T value, uint64_t nanoseco
 		: "memory");
 
 		last_cycle_counter = read_cycle_counter();
-		if (last_cycle_counter >= cycles_end) {
+		if (last_cycle_counter >= cycles_deadline) {
 			return false;
 		}
 	}
@@ -161,6 +175,194 @@ static inline bool mwaitx_wait_for_value_spurious_oneshot_impl(T *ptr, T value,
 	return __atomic_load_n(ptr, __ATOMIC_ACQUIRE) == value;
 }
 
+template<typename T>
+static inline T mwaitx_wait_for_change_impl(T *ptr, T old_value, bool low_power) {
+	// Early return if the value has already changed.
+	T result = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+	if (result != old_value) return result;
+
+	do {
+		uint32_t extension = 0;
+		uint32_t hints = 0;
+
+		__asm volatile (
+			"monitorx; # eax, ecx, edx\n"
+			:: "a" (ptr)
+			, "c" (extension)
+			, "d" (hints)
+			: "memory");
+
+		result = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+		if (result != old_value) return result;
+
+		// bit [7:4] + 1 = cstate request.
+		// Request C0 to wake up faster
+		uint32_t waitx_hints = low_power ? 0 : (0xF << 4);
+		// bit 0 = allow interrupts to wake.
+		// bit 1 = ebx contains timeout.
+		uint32_t waitx_extensions = 0;
+		__asm volatile(
+			"mwaitx; # eax, ecx\n"
+		:: "a" (waitx_hints)
+		, "c" (waitx_extensions)
+		: "memory");
+
+		result = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+	}
+	while (result == old_value);
+	return result;
+}
+
+template<typename T, typename Predicate>
+static inline T mwaitx_wait_for_predicate_impl(T *ptr, Predicate predicate, bool low_power) {
+	// Early return if the predicate is already satisfied.
+	T result = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+	if (predicate(result)) return result;
+
+	do {
+		uint32_t extension = 0;
+		uint32_t hints = 0;
+
+		__asm volatile (
+			"monitorx; # eax, ecx, edx\n"
+			:: "a" (ptr)
+			, "c" (extension)
+			, "d" (hints)
+			: "memory");
+
+		result = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+		if (predicate(result)) return result;
+
+		// bit [7:4] + 1 = cstate request.
+		// Request C0 to wake up faster
+		uint32_t waitx_hints = low_power ? 0 : (0xF << 4);
+		// bit 0 = allow interrupts to wake.
+		// bit 1 = ebx contains timeout.
+		uint32_t waitx_extensions = 0;
+		__asm volatile(
+			"mwaitx; # eax, ecx\n"
+		:: "a" (waitx_hints)
+		, "c" (waitx_extensions)
+		: "memory");
+
+		result = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+	}
+	while (!predicate(result));
+	return result;
+}
+
+template<typename T, typename Predicate>
+static inline bool mwaitx_wait_for_predicate_impl(T *ptr, Predicate predicate, uint64_t cycles_deadline, bool low_power, T *result) {
+	// Early return if the predicate is already satisfied.
+	T current = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+	if (predicate(current)) {
+		if (result) *result = current;
+		return true;
+	}
+
+	const uint64_t wait_deadline = timeout_wait_deadline(WFE_MUTEX_BACKEND_MONITORX, cycles_deadline, low_power);
+	uint64_t last_cycle_counter = read_cycle_counter();
+	bool success = true;
+
+	// A deadline already in the past times out before any remaining cycles are computed.
+	if (last_cycle_counter >= cycles_deadline) {
+		if (result) *result = current;
+		return false;
+	}
+
+	do {
+		if (last_cycle_counter >= wait_deadline) {
+			// Too close to the deadline for mwaitx to return in time, spin the rest.
+			do_yield();
+			current = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+			last_cycle_counter = read_cycle_counter();
+			if (!predicate(current) && last_cycle_counter >= cycles_deadline) {
+				success = false;
+				break;
+			}
+			continue;
+		}
+
+		uint32_t extension = 0;
+		uint32_t hints = 0;
+
+		const uint64_t cycles_u64 = wait_deadline - last_cycle_counter;
+		const uint32_t cycles_remaining = cycles_u64 >= std::numeric_limits<uint32_t>::max() ? std::numeric_limits<uint32_t>::max() : cycles_u64;
+
+		__asm volatile (
+			"monitorx; # eax, ecx, edx\n"
+			:: "a" (ptr)
+			, "c" (extension)
+			, "d" (hints)
+			: "memory");
+
+		current = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+		if (predicate(current)) break;
+
+		// bit [7:4] + 1 = cstate request.
+		// Request C0 to wake up faster
+		uint32_t waitx_hints = low_power ? 0 : (0xF << 4);
+		// bit 0 = allow interrupts to wake.
+		// bit 1 = ebx contains timeout.
+		uint32_t waitx_extensions = (1U << 1);
+
+		__asm volatile(
+			"mwaitx; # eax, ecx\n"
+		:: "a" (waitx_hints)
+		, "b" (cycles_remaining)
+		, "c" (waitx_extensions)
+		: "memory");
+
+		current = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+		last_cycle_counter = read_cycle_counter();
+		if (!predicate(current) && last_cycle_counter >= cycles_deadline) {
+			success = false;
+			break;
+		}
+	}
+	while (!predicate(current));
+
+	if (result) *result = current;
+	return success;
+}
+
+template<typename T, typename Predicate>
+static inline bool mwaitx_wait_for_predicate_spurious_oneshot_impl(T *ptr, Predicate predicate, bool low_power, T *result) {
+	// Early return if the predicate is already satisfied.
+	T current = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+	if (!predicate(current)) {
+		uint32_t extension = 0;
+		uint32_t hints = 0;
+
+		__asm volatile (
+			"monitorx; # eax, ecx, edx\n"
+			:: "a" (ptr)
+			, "c" (extension)
+			, "d" (hints)
+			: "memory");
+
+		current = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+		if (!predicate(current)) {
+			// bit [7:4] + 1 = cstate request.
+			// Request C0 to wake up faster
+			uint32_t waitx_hints = low_power ? 0 : (0xF << 4);
+			// bit 0 = allow interrupts to wake.
+			// bit 1 = ebx contains timeout.
+			uint32_t waitx_extensions = 0;
+			__asm volatile(
+				"mwaitx; # eax, ecx\n"
+			:: "a" (waitx_hints)
+			, "c" (waitx_extensions)
+			: "memory");
+
+			current = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+		}
+	}
+
+	if (result) *result = current;
+	return predicate(current);
+}
+
 void mwaitx_wait_for_value_i8 (uint8_t *ptr,  uint8_t value, bool low_power) {
 	mwaitx_wait_for_value_impl(ptr, value, low_power);
 }
@@ -209,20 +411,36 @@ uint64_t mwaitx_wait_for_bit_not_set_i64(uint64_t *ptr, uint8_t bit, bool low_po
 	return mwaitx_wait_for_bit_impl<0, 1>(ptr, bit, low_power);
 }
 
+bool mwaitx_wait_for_value_until_i8 (uint8_t *ptr,  uint8_t value, uint64_t cycles_deadline, bool low_power) {
+	return mwaitx_wait_for_value_impl(ptr, value, cycles_deadline, low_power);
+}
+
 bool mwaitx_wait_for_value_timeout_i8 (uint8_t *ptr,  uint8_t value, uint64_t nanoseconds, bool low_power) {
-	return mwaitx_wait_for_value_impl(ptr, value, nanoseconds, low_power);
+	return mwaitx_wait_for_value_until_i8(ptr, value, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power);
+}
+
+bool mwaitx_wait_for_value_until_i16(uint16_t *ptr, uint16_t value, uint64_t cycles_deadline, bool low_power) {
+	return mwaitx_wait_for_value_impl(ptr, value, cycles_deadline, low_power);
 }
 
 bool mwaitx_wait_for_value_timeout_i16(uint16_t *ptr, uint16_t value, uint64_t nanoseconds, bool low_power) {
-	return mwaitx_wait_for_value_impl(ptr, value, nanoseconds, low_power);
+	return mwaitx_wait_for_value_until_i16(ptr, value, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power);
+}
+
+bool mwaitx_wait_for_value_until_i32(uint32_t *ptr, uint32_t value, uint64_t cycles_deadline, bool low_power) {
+	return mwaitx_wait_for_value_impl(ptr, value, cycles_deadline, low_power);
 }
 
 bool mwaitx_wait_for_value_timeout_i32(uint32_t *ptr, uint32_t value, uint64_t nanoseconds, bool low_power) {
-	return mwaitx_wait_for_value_impl(ptr, value, nanoseconds, low_power);
+	return mwaitx_wait_for_value_until_i32(ptr, value, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power);
+}
+
+bool mwaitx_wait_for_value_until_i64(uint64_t *ptr, uint64_t value, uint64_t cycles_deadline, bool low_power) {
+	return mwaitx_wait_for_value_impl(ptr, value, cycles_deadline, low_power);
 }
 
 bool mwaitx_wait_for_value_timeout_i64(uint64_t *ptr, uint64_t value, uint64_t nanoseconds, bool low_power) {
-	return mwaitx_wait_for_value_impl(ptr, value, nanoseconds, low_power);
+	return mwaitx_wait_for_value_until_i64(ptr, value, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power);
 }
 
 bool mwaitx_wait_for_value_spurious_oneshot_i8 (uint8_t *ptr,  uint8_t value, bool low_power) {
@@ -241,5 +459,422 @@ bool mwaitx_wait_for_value_spurious_oneshot_i64(uint64_t *ptr, uint64_t value, b
 	return mwaitx_wait_for_value_spurious_oneshot_impl(ptr, value, low_power);
 }
 
+uint8_t mwaitx_wait_for_change_i8 (uint8_t *ptr,  uint8_t old_value, bool low_power) {
+	return mwaitx_wait_for_change_impl(ptr, old_value, low_power);
+}
+
+uint16_t mwaitx_wait_for_change_i16(uint16_t *ptr, uint16_t old_value, bool low_power) {
+	return mwaitx_wait_for_change_impl(ptr, old_value, low_power);
+}
+
+uint32_t mwaitx_wait_for_change_i32(uint32_t *ptr, uint32_t old_value, bool low_power) {
+	return mwaitx_wait_for_change_impl(ptr, old_value, low_power);
+}
+
+uint64_t mwaitx_wait_for_change_i64(uint64_t *ptr, uint64_t old_value, bool low_power) {
+	return mwaitx_wait_for_change_impl(ptr, old_value, low_power);
+}
+
+uint8_t mwaitx_wait_for_masked_value_i8 (uint8_t *ptr,  uint8_t mask, uint8_t value, bool low_power) {
+	return mwaitx_wait_for_predicate_impl(ptr, [=](uint8_t current) { return (current & mask) == value; }, low_power);
+}
+
+uint16_t mwaitx_wait_for_masked_value_i16(uint16_t *ptr, uint16_t mask, uint16_t value, bool low_power) {
+	return mwaitx_wait_for_predicate_impl(ptr, [=](uint16_t current) { return (current & mask) == value; }, low_power);
+}
+
+uint32_t mwaitx_wait_for_masked_value_i32(uint32_t *ptr, uint32_t mask, uint32_t value, bool low_power) {
+	return mwaitx_wait_for_predicate_impl(ptr, [=](uint32_t current) { return (current & mask) == value; }, low_power);
+}
+
+uint64_t mwaitx_wait_for_masked_value_i64(uint64_t *ptr, uint64_t mask, uint64_t value, bool low_power) {
+	return mwaitx_wait_for_predicate_impl(ptr, [=](uint64_t current) { return (current & mask) == value; }, low_power);
+}
+
+uint8_t mwaitx_wait_for_any_bit_set_i8 (uint8_t *ptr,  uint8_t mask, bool low_power) {
+	return mwaitx_wait_for_predicate_impl(ptr, [=](uint8_t current) { return (current & mask) != 0; }, low_power);
+}
+
+uint16_t mwaitx_wait_for_any_bit_set_i16(uint16_t *ptr, uint16_t mask, bool low_power) {
+	return mwaitx_wait_for_predicate_impl(ptr, [=](uint16_t current) { return (current & mask) != 0; }, low_power);
+}
+
+uint32_t mwaitx_wait_for_any_bit_set_i32(uint32_t *ptr, uint32_t mask, bool low_power) {
+	return mwaitx_wait_for_predicate_impl(ptr, [=](uint32_t current) { return (current & mask) != 0; }, low_power);
+}
+
+uint64_t mwaitx_wait_for_any_bit_set_i64(uint64_t *ptr, uint64_t mask, bool low_power) {
+	return mwaitx_wait_for_predicate_impl(ptr, [=](uint64_t current) { return (current & mask) != 0; }, low_power);
+}
+
+uint8_t mwaitx_wait_for_sequence_ge_i8 (uint8_t *ptr,  uint8_t target, bool low_power) {
+	return mwaitx_wait_for_predicate_impl(ptr, [=](uint8_t current) { return (int8_t)(current - target) >= 0; }, low_power);
+}
+
+uint16_t mwaitx_wait_for_sequence_ge_i16(uint16_t *ptr, uint16_t target, bool low_power) {
+	return mwaitx_wait_for_predicate_impl(ptr, [=](uint16_t current) { return (int16_t)(current - target) >= 0; }, low_power);
+}
+
+uint32_t mwaitx_wait_for_sequence_ge_i32(uint32_t *ptr, uint32_t target, bool low_power) {
+	return mwaitx_wait_for_predicate_impl(ptr, [=](uint32_t current) { return (int32_t)(current - target) >= 0; }, low_power);
+}
+
+uint64_t mwaitx_wait_for_sequence_ge_i64(uint64_t *ptr, uint64_t target, bool low_power) {
+	return mwaitx_wait_for_predicate_impl(ptr, [=](uint64_t current) { return (int64_t)(current - target) >= 0; }, low_power);
+}
+
+bool mwaitx_wait_for_masked_value_until_i8 (uint8_t *ptr,  uint8_t mask, uint8_t value, uint64_t cycles_deadline, bool low_power, uint8_t *result) {
+	return mwaitx_wait_for_predicate_impl(ptr, [=](uint8_t current) { return (current & mask) == value; }, cycles_deadline, low_power, result);
+}
+
+bool mwaitx_wait_for_masked_value_timeout_i8 (uint8_t *ptr,  uint8_t mask, uint8_t value, uint64_t nanoseconds, bool low_power, uint8_t *result) {
+	return mwaitx_wait_for_masked_value_until_i8(ptr, mask, value, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool mwaitx_wait_for_masked_value_until_i16(uint16_t *ptr, uint16_t mask, uint16_t value, uint64_t cycles_deadline, bool low_power, uint16_t *result) {
+	return mwaitx_wait_for_predicate_impl(ptr, [=](uint16_t current) { return (current & mask) == value; }, cycles_deadline, low_power, result);
+}
+
+bool mwaitx_wait_for_masked_value_timeout_i16(uint16_t *ptr, uint16_t mask, uint16_t value, uint64_t nanoseconds, bool low_power, uint16_t *result) {
+	return mwaitx_wait_for_masked_value_until_i16(ptr, mask, value, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool mwaitx_wait_for_masked_value_until_i32(uint32_t *ptr, uint32_t mask, uint32_t value, uint64_t cycles_deadline, bool low_power, uint32_t *result) {
+	return mwaitx_wait_for_predicate_impl(ptr, [=](uint32_t current) { return (current & mask) == value; }, cycles_deadline, low_power, result);
+}
+
+bool mwaitx_wait_for_masked_value_timeout_i32(uint32_t *ptr, uint32_t mask, uint32_t value, uint64_t nanoseconds, bool low_power, uint32_t *result) {
+	return mwaitx_wait_for_masked_value_until_i32(ptr, mask, value, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool mwaitx_wait_for_masked_value_until_i64(uint64_t *ptr, uint64_t mask, uint64_t value, uint64_t cycles_deadline, bool low_power, uint64_t *result) {
+	return mwaitx_wait_for_predicate_impl(ptr, [=](uint64_t current) { return (current & mask) == value; }, cycles_deadline, low_power, result);
+}
+
+bool mwaitx_wait_for_masked_value_timeout_i64(uint64_t *ptr, uint64_t mask, uint64_t value, uint64_t nanoseconds, bool low_power, uint64_t *result) {
+	return mwaitx_wait_for_masked_value_until_i64(ptr, mask, value, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool mwaitx_wait_for_any_bit_set_until_i8 (uint8_t *ptr,  uint8_t mask, uint64_t cycles_deadline, bool low_power, uint8_t *result) {
+	return mwaitx_wait_for_predicate_impl(ptr, [=](uint8_t current) { return (current & mask) != 0; }, cycles_deadline, low_power, result);
+}
+
+bool mwaitx_wait_for_any_bit_set_timeout_i8 (uint8_t *ptr,  uint8_t mask, uint64_t nanoseconds, bool low_power, uint8_t *result) {
+	return mwaitx_wait_for_any_bit_set_until_i8(ptr, mask, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool mwaitx_wait_for_any_bit_set_until_i16(uint16_t *ptr, uint16_t mask, uint64_t cycles_deadline, bool low_power, uint16_t *result) {
+	return mwaitx_wait_for_predicate_impl(ptr, [=](uint16_t current) { return (current & mask) != 0; }, cycles_deadline, low_power, result);
+}
+
+bool mwaitx_wait_for_any_bit_set_timeout_i16(uint16_t *ptr, uint16_t mask, uint64_t nanoseconds, bool low_power, uint16_t *result) {
+	return mwaitx_wait_for_any_bit_set_until_i16(ptr, mask, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool mwaitx_wait_for_any_bit_set_until_i32(uint32_t *ptr, uint32_t mask, uint64_t cycles_deadline, bool low_power, uint32_t *result) {
+	return mwaitx_wait_for_predicate_impl(ptr, [=](uint32_t current) { return (current & mask) != 0; }, cycles_deadline, low_power, result);
+}
+
+bool mwaitx_wait_for_any_bit_set_timeout_i32(uint32_t *ptr, uint32_t mask, uint64_t nanoseconds, bool low_power, uint32_t *result) {
+	return mwaitx_wait_for_any_bit_set_until_i32(ptr, mask, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool mwaitx_wait_for_any_bit_set_until_i64(uint64_t *ptr, uint64_t mask, uint64_t cycles_deadline, bool low_power, uint64_t *result) {
+	return mwaitx_wait_for_predicate_impl(ptr, [=](uint64_t current) { return (current & mask) != 0; }, cycles_deadline, low_power, result);
+}
+
+bool mwaitx_wait_for_any_bit_set_timeout_i64(uint64_t *ptr, uint64_t mask, uint64_t nanoseconds, bool low_power, uint64_t *result) {
+	return mwaitx_wait_for_any_bit_set_until_i64(ptr, mask, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool mwaitx_wait_for_sequence_ge_until_i8 (uint8_t *ptr,  uint8_t target, uint64_t cycles_deadline, bool low_power, uint8_t *result) {
+	return mwaitx_wait_for_predicate_impl(ptr, [=](uint8_t current) { return (int8_t)(current - target) >= 0; }, cycles_deadline, low_power, result);
+}
+
+bool mwaitx_wait_for_sequence_ge_timeout_i8 (uint8_t *ptr,  uint8_t target, uint64_t nanoseconds, bool low_power, uint8_t *result) {
+	return mwaitx_wait_for_sequence_ge_until_i8(ptr, target, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool mwaitx_wait_for_sequence_ge_until_i16(uint16_t *ptr, uint16_t target, uint64_t cycles_deadline, bool low_power, uint16_t *result) {
+	return mwaitx_wait_for_predicate_impl(ptr, [=](uint16_t current) { return (int16_t)(current - target) >= 0; }, cycles_deadline, low_power, result);
+}
+
+bool mwaitx_wait_for_sequence_ge_timeout_i16(uint16_t *ptr, uint16_t target, uint64_t nanoseconds, bool low_power, uint16_t *result) {
+	return mwaitx_wait_for_sequence_ge_until_i16(ptr, target, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool mwaitx_wait_for_sequence_ge_until_i32(uint32_t *ptr, uint32_t target, uint64_t cycles_deadline, bool low_power, uint32_t *result) {
+	return mwaitx_wait_for_predicate_impl(ptr, [=](uint32_t current) { return (int32_t)(current - target) >= 0; }, cycles_deadline, low_power, result);
+}
+
+bool mwaitx_wait_for_sequence_ge_timeout_i32(uint32_t *ptr, uint32_t target, uint64_t nanoseconds, bool low_power, uint32_t *result) {
+	return mwaitx_wait_for_sequence_ge_until_i32(ptr, target, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool mwaitx_wait_for_sequence_ge_until_i64(uint64_t *ptr, uint64_t target, uint64_t cycles_deadline, bool low_power, uint64_t *result) {
+	return mwaitx_wait_for_predicate_impl(ptr, [=](uint64_t current) { return (int64_t)(current - target) >= 0; }, cycles_deadline, low_power, result);
+}
+
+bool mwaitx_wait_for_sequence_ge_timeout_i64(uint64_t *ptr, uint64_t target, uint64_t nanoseconds, bool low_power, uint64_t *result) {
+	return mwaitx_wait_for_sequence_ge_until_i64(ptr, target, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool mwaitx_wait_for_bit_set_until_i8 (uint8_t *ptr,  uint8_t bit, uint64_t cycles_deadline, bool low_power, uint8_t *result) {
+	return mwaitx_wait_for_predicate_impl(ptr, [=](uint8_t current) { return ((current >> bit) & 1) == 1; }, cycles_deadline, low_power, result);
+}
+
+bool mwaitx_wait_for_bit_set_timeout_i8 (uint8_t *ptr,  uint8_t bit, uint64_t nanoseconds, bool low_power, uint8_t *result) {
+	return mwaitx_wait_for_bit_set_until_i8(ptr, bit, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool mwaitx_wait_for_bit_set_until_i16(uint16_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint16_t *result) {
+	return mwaitx_wait_for_predicate_impl(ptr, [=](uint16_t current) { return ((current >> bit) & 1) == 1; }, cycles_deadline, low_power, result);
+}
+
+bool mwaitx_wait_for_bit_set_timeout_i16(uint16_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint16_t *result) {
+	return mwaitx_wait_for_bit_set_until_i16(ptr, bit, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool mwaitx_wait_for_bit_set_until_i32(uint32_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint32_t *result) {
+	return mwaitx_wait_for_predicate_impl(ptr, [=](uint32_t current) { return ((current >> bit) & 1) == 1; }, cycles_deadline, low_power, result);
+}
+
+bool mwaitx_wait_for_bit_set_timeout_i32(uint32_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint32_t *result) {
+	return mwaitx_wait_for_bit_set_until_i32(ptr, bit, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool mwaitx_wait_for_bit_set_until_i64(uint64_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint64_t *result) {
+	return mwaitx_wait_for_predicate_impl(ptr, [=](uint64_t current) { return ((current >> bit) & 1) == 1; }, cycles_deadline, low_power, result);
+}
+
+bool mwaitx_wait_for_bit_set_timeout_i64(uint64_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint64_t *result) {
+	return mwaitx_wait_for_bit_set_until_i64(ptr, bit, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool mwaitx_wait_for_bit_not_set_until_i8 (uint8_t *ptr,  uint8_t bit, uint64_t cycles_deadline, bool low_power, uint8_t *result) {
+	return mwaitx_wait_for_predicate_impl(ptr, [=](uint8_t current) { return ((current >> bit) & 1) == 0; }, cycles_deadline, low_power, result);
+}
+
+bool mwaitx_wait_for_bit_not_set_timeout_i8 (uint8_t *ptr,  uint8_t bit, uint64_t nanoseconds, bool low_power, uint8_t *result) {
+	return mwaitx_wait_for_bit_not_set_until_i8(ptr, bit, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool mwaitx_wait_for_bit_not_set_until_i16(uint16_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint16_t *result) {
+	return mwaitx_wait_for_predicate_impl(ptr, [=](uint16_t current) { return ((current >> bit) & 1) == 0; }, cycles_deadline, low_power, result);
+}
+
+bool mwaitx_wait_for_bit_not_set_timeout_i16(uint16_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint16_t *result) {
+	return mwaitx_wait_for_bit_not_set_until_i16(ptr, bit, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool mwaitx_wait_for_bit_not_set_until_i32(uint32_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint32_t *result) {
+	return mwaitx_wait_for_predicate_impl(ptr, [=](uint32_t current) { return ((current >> bit) & 1) == 0; }, cycles_deadline, low_power, result);
+}
+
+bool mwaitx_wait_for_bit_not_set_timeout_i32(uint32_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint32_t *result) {
+	return mwaitx_wait_for_bit_not_set_until_i32(ptr, bit, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool mwaitx_wait_for_bit_not_set_until_i64(uint64_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint64_t *result) {
+	return mwaitx_wait_for_predicate_impl(ptr, [=](uint64_t current) { return ((current >> bit) & 1) == 0; }, cycles_deadline, low_power, result);
+}
+
+bool mwaitx_wait_for_bit_not_set_timeout_i64(uint64_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint64_t *result) {
+	return mwaitx_wait_for_bit_not_set_until_i64(ptr, bit, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool mwaitx_wait_for_bit_set_spurious_oneshot_i8 (uint8_t *ptr,  uint8_t bit, bool low_power, uint8_t *result) {
+	return mwaitx_wait_for_predicate_spurious_oneshot_impl(ptr, [=](uint8_t current) { return ((current >> bit) & 1) == 1; }, low_power, result);
+}
+
+bool mwaitx_wait_for_bit_set_spurious_oneshot_i16(uint16_t *ptr, uint8_t bit, bool low_power, uint16_t *result) {
+	return mwaitx_wait_for_predicate_spurious_oneshot_impl(ptr, [=](uint16_t current) { return ((current >> bit) & 1) == 1; }, low_power, result);
+}
+
+bool mwaitx_wait_for_bit_set_spurious_oneshot_i32(uint32_t *ptr, uint8_t bit, bool low_power, uint32_t *result) {
+	return mwaitx_wait_for_predicate_spurious_oneshot_impl(ptr, [=](uint32_t current) { return ((current >> bit) & 1) == 1; }, low_power, result);
+}
+
+bool mwaitx_wait_for_bit_set_spurious_oneshot_i64(uint64_t *ptr, uint8_t bit, bool low_power, uint64_t *result) {
+	return mwaitx_wait_for_predicate_spurious_oneshot_impl(ptr, [=](uint64_t current) { return ((current >> bit) & 1) == 1; }, low_power, result);
+}
+
+bool mwaitx_wait_for_bit_not_set_spurious_oneshot_i8 (uint8_t *ptr,  uint8_t bit, bool low_power, uint8_t *result) {
+	return mwaitx_wait_for_predicate_spurious_oneshot_impl(ptr, [=](uint8_t current) { return ((current >> bit) & 1) == 0; }, low_power, result);
+}
+
+bool mwaitx_wait_for_bit_not_set_spurious_oneshot_i16(uint16_t *ptr, uint8_t bit, bool low_power, uint16_t *result) {
+	return mwaitx_wait_for_predicate_spurious_oneshot_impl(ptr, [=](uint16_t current) { return ((current >> bit) & 1) == 0; }, low_power, result);
+}
+
+bool mwaitx_wait_for_bit_not_set_spurious_oneshot_i32(uint32_t *ptr, uint8_t bit, bool low_power, uint32_t *result) {
+	return mwaitx_wait_for_predicate_spurious_oneshot_impl(ptr, [=](uint32_t current) { return ((current >> bit) & 1) == 0; }, low_power, result);
+}
+
+bool mwaitx_wait_for_bit_not_set_spurious_oneshot_i64(uint64_t *ptr, uint8_t bit, bool low_power, uint64_t *result) {
+	return mwaitx_wait_for_predicate_spurious_oneshot_impl(ptr, [=](uint64_t current) { return ((current >> bit) & 1) == 0; }, low_power, result);
+}
+
+size_t mwaitx_wait_any_oneshot(const wfe_mutex_wait_desc *descs, size_t n, size_t monitor_index, uint64_t nanoseconds, bool low_power) {
+	uint32_t extension = 0;
+	uint32_t hints = 0;
+
+	__asm volatile (
+		"monitorx; # eax, ecx, edx\n"
+		:: "a" (descs[monitor_index].ptr)
+		, "c" (extension)
+		, "d" (hints)
+		: "memory");
+
+	// Check every word after arming so a store between the check and the wait still wakes us.
+	const size_t index = wait_any_find_satisfied(descs, n);
+	if (index != n) return index;
+
+	const uint64_t cycles_u64 = wfe_mutex_detect_calculate_cycles_for_nanoseconds(nanoseconds);
+	const uint32_t cycles = cycles_u64 >= std::numeric_limits<uint32_t>::max() ? std::numeric_limits<uint32_t>::max() : cycles_u64;
+
+	// bit [7:4] + 1 = cstate request.
+	// Request C0 to wake up faster
+	uint32_t waitx_hints = low_power ? 0 : (0xF << 4);
+	// bit 0 = allow interrupts to wake.
+	// bit 1 = ebx contains timeout.
+	uint32_t waitx_extensions = nanoseconds ? (1U << 1) : 0;
+
+	__asm volatile(
+		"mwaitx; # eax, ecx\n"
+	:: "a" (waitx_hints)
+	, "b" (cycles)
+	, "c" (waitx_extensions)
+	: "memory");
+
+	return wait_any_find_satisfied(descs, n);
+}
+
+uint64_t mwaitx_doorbell_wait(wfe_mutex_doorbell *doorbell, bool low_power) {
+	uint64_t mask = doorbell_scan(doorbell);
+
+	while (mask == 0) {
+		uint32_t extension = 0;
+		uint32_t hints = 0;
+
+		// Arm the monitor on the whole block, then scan every flag before waiting.
+		__asm volatile (
+			"monitorx; # eax, ecx, edx\n"
+			:: "a" (doorbell->flags)
+			, "c" (extension)
+			, "d" (hints)
+			: "memory");
+
+		mask = doorbell_scan(doorbell);
+		if (mask) break;
+
+		// bit [7:4] + 1 = cstate request.
+		// Request C0 to wake up faster
+		uint32_t waitx_hints = low_power ? 0 : (0xF << 4);
+		// bit 0 = allow interrupts to wake.
+		// bit 1 = ebx contains timeout.
+		uint32_t waitx_extensions = 0;
+		__asm volatile(
+			"mwaitx; # eax, ecx\n"
+		:: "a" (waitx_hints)
+		, "c" (waitx_extensions)
+		: "memory");
+
+		mask = doorbell_scan(doorbell);
+	}
+	return doorbell_consume(doorbell, mask);
+}
+
+void mwaitx_sleep_until(uint64_t cycles_deadline, bool low_power) {
+	// mwaitx without an armed monitor returns immediately, arm it on a stack line nothing else writes to.
+	uint64_t monitor_line = 0;
+	const uint64_t wait_deadline = timeout_wait_deadline(WFE_MUTEX_BACKEND_MONITORX, cycles_deadline, low_power);
+	uint64_t now = read_cycle_counter();
+
+	while (now < wait_deadline) {
+		uint32_t extension = 0;
+		uint32_t hints = 0;
+
+		const uint64_t cycles_u64 = wait_deadline - now;
+		const uint32_t cycles_remaining = cycles_u64 >= std::numeric_limits<uint32_t>::max() ? std::numeric_limits<uint32_t>::max() : cycles_u64;
+
+		__asm volatile (
+			"monitorx; # eax, ecx, edx\n"
+			:: "a" (&monitor_line)
+			, "c" (extension)
+			, "d" (hints)
+			: "memory");
+
+		// bit [7:4] + 1 = cstate request.
+		// Request C0 to wake up faster
+		uint32_t waitx_hints = low_power ? 0 : (0xF << 4);
+		// bit 0 = allow interrupts to wake.
+		// bit 1 = ebx contains timeout.
+		uint32_t waitx_extensions = (1U << 1);
+
+		__asm volatile(
+			"mwaitx; # eax, ecx\n"
+		:: "a" (waitx_hints)
+		, "b" (cycles_remaining)
+		, "c" (waitx_extensions)
+		: "memory");
+
+		now = read_cycle_counter();
+	}
+
+	// Spin the rest that mwaitx can't hit precisely.
+	while (now < cycles_deadline) {
+		do_yield();
+		now = read_cycle_counter();
+	}
+}
+
+#if defined(_M_X86_64)
+template<typename Predicate>
+static inline wfe_mutex_u128 mwaitx_wait_for_predicate_i128_impl(wfe_mutex_u128 *ptr, Predicate predicate, bool low_power) {
+	while (true) {
+		wfe_mutex_u128 current = load_u128_halves(ptr);
+		if (predicate(current)) {
+			// Confirm that both halves were observed together.
+			current = confirm_load_u128(ptr);
+			if (predicate(current)) return current;
+			continue;
+		}
+
+		uint32_t extension = 0;
+		uint32_t hints = 0;
+
+		// 16-byte alignment keeps both halves in the monitored line.
+		__asm volatile (
+			"monitorx; # eax, ecx, edx\n"
+			:: "a" (ptr)
+			, "c" (extension)
+			, "d" (hints)
+			: "memory");
+
+		if (predicate(load_u128_halves(ptr))) continue;
+
+		// bit [7:4] + 1 = cstate request.
+		// Request C0 to wake up faster
+		uint32_t waitx_hints = low_power ? 0 : (0xF << 4);
+		// bit 0 = allow interrupts to wake.
+		// bit 1 = ebx contains timeout.
+		uint32_t waitx_extensions = 0;
+		__asm volatile(
+			"mwaitx; # eax, ecx\n"
+		:: "a" (waitx_hints)
+		, "c" (waitx_extensions)
+		: "memory");
+	}
+}
+
+wfe_mutex_u128 mwaitx_wait_for_masked_value_i128(wfe_mutex_u128 *ptr, wfe_mutex_u128 mask, wfe_mutex_u128 value, bool low_power) {
+	return mwaitx_wait_for_predicate_i128_impl(ptr, [=](wfe_mutex_u128 current) { return u128_masked_equal(current, mask, value); }, low_power);
+}
+
+void mwaitx_wait_for_value_i128(wfe_mutex_u128 *ptr, wfe_mutex_u128 value, bool low_power) {
+	mwaitx_wait_for_masked_value_i128(ptr, u128_all_ones(), value, low_power);
+}
 #endif
 
+#endif
@@ -1,8 +1,26 @@
 #include "detect.h"
 #include "implementations.h"
 #include "implementation_details_x86.h"
+#include "implementation_details_u128.h"
+#include "implementation_details_wait_any.h"
+#include "implementation_details_doorbell.h"
+#include "implementation_details_timeout.h"
 
 #if defined(_M_X86_64) || defined(_M_X86_32)
+// Returns the deadline for the next timed umwait or tpause.
+// IA32_UMWAIT_CONTROL ends every wait after `umwait_max_time_cycles`. Splitting the remaining time evenly between the
+// waits that forces avoids a last wait too short to be worth its wakeup.
+static inline uint64_t waitpkg_next_deadline(uint64_t now, uint64_t wait_deadline) {
+	const uint64_t max_time = Features.umwait_max_time_cycles;
+	const uint64_t remaining = wait_deadline - now;
+	if (max_time == 0 || remaining <= max_time) {
+		return wait_deadline;
+	}
+
+	const uint64_t waits = (remaining + max_time - 1) / max_time;
+	return now + remaining / waits;
+}
+
 template<typename T>
 static inline void waitpkg_wait_for_value_impl (T *ptr, T value, bool low_power) {
 	// Early return if the value is already set.
@@ -87,17 +105,24 @@ static inline T waitpkg_wait_for_bit_impl (T *ptr, uint8_t bit, bool low_power)
 }
 
 template<typename T>
-static inline bool waitpkg_wait_for_value_impl(T *ptr, T value, uint64_t nanoseconds, bool low_power) {
+static inline bool waitpkg_wait_for_value_impl(T *ptr, T value, uint64_t cycles_deadline, bool low_power) {
 	// Early return if the value is already set.
 	if (__atomic_load_n(ptr, __ATOMIC_ACQUIRE) == value) return true;
 
-	const uint64_t total_cycles = wfe_mutex_detect_calculate_cycles_for_nanoseconds(nanoseconds);
-	const uint64_t begin_cycles = read_cycle_counter();
-	const uint64_t cycles_end = begin_cycles + total_cycles;
-
-	uint64_t last_cycle_counter = begin_cycles;
+	const uint64_t wait_deadline = timeout_wait_deadline(WFE_MUTEX_BACKEND_WAITPKG, cycles_deadline, low_power);
+	uint64_t last_cycle_counter = read_cycle_counter();
 
 	do {
+		if (last_cycle_counter >= wait_deadline) {
+			// Too close to the deadline for umwait to return in time, spin the rest.
+			do_yield();
+			last_cycle_counter = read_cycle_counter();
+			if (last_cycle_counter >= cycles_deadline) {
+				return false;
+			}
+			continue;
+		}
+
 		__asm volatile (
 			"umonitor %[ptr];\n"
 			:: [ptr] "r" (ptr)
@@ -114,12 +139,11 @@ static inline bool waitpkg_wait_for_value_impl(T *ptr, T value, uint64_t nanosec
 		// Request C0.1 for faster wakeup.
 		uint32_t power_state = low_power ? 0 : 1;
 
-		// Have no way to know if our timeout is larger than IA32_UMWAIT_CONTROL.
-		// Although we don't really care if we overrun the os deadline, we'll just loop again.
 		// umwait behaviour is slightly different than mwaitx behaviour with timeout.
 		// umwait waits until absolute TSC timestamp has elapsed instead of relative cycles.
-		uint32_t timeout_lower = cycles_end;
-		uint32_t timeout_upper = cycles_end >> 32;
+		const uint64_t next_deadline = waitpkg_next_deadline(last_cycle_counter, wait_deadline);
+		uint32_t timeout_lower = next_deadline;
+		uint32_t timeout_upper = next_deadline >> 32;
 
 		// umwait writes to CF if the the instruction timed out due to OS time limit.
 		// It does not write CF if it timed out due to provided timeout.
@@ -132,7 +156,7 @@ static inline bool waitpkg_wait_for_value_impl(T *ptr, T value, uint64_t nanosec
 		: "memory", "cc");
 
 		last_cycle_counter = read_cycle_counter();
-		if (last_cycle_counter >= cycles_end) {
+		if (last_cycle_counter >= cycles_deadline) {
 			return false;
 		}
 	}
@@ -183,6 +207,199 @@ static inline bool waitpkg_wait_for_value_spurious_oneshot_impl(T *ptr, T value,
 	return __atomic_load_n(ptr, __ATOMIC_ACQUIRE) == value;
 }
 
+template<typename T>
+static inline T waitpkg_wait_for_change_impl(T *ptr, T old_value, bool low_power) {
+	// Early return if the value has already changed.
+	T result = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+	if (result != old_value) return result;
+
+	do {
+		__asm volatile (
+			"umonitor %[ptr];\n"
+			:: [ptr] "r" (ptr)
+			: "memory");
+
+		// Check to ensure the value didn't already change.
+		result = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+		if (result != old_value) return result;
+
+		// bit 0 = Power state
+		//     0 = C0.2 (Larger power savings, slower wakeup)
+		//     1 = C0.1 (Faster wakeup, small power savings)
+		// bits [31:1] = reserved
+
+		// Request C0.1 for faster wakeup.
+		uint32_t power_state = low_power ? 0 : 1;
+
+		// Max timeout, will likely be clamped to IA32_UMWAIT_CONTROL
+		uint32_t timeout_lower = ~0U;
+		uint32_t timeout_upper = ~0U;
+
+		// umwait writes to CF if the the instruction timed out due to OS time limit.
+		// It does not write CF if it timed out due to provided timeout.
+		__asm volatile(
+			"umwait %[power_state]; # eax, edx\n"
+		:
+		: "a" (timeout_lower)
+		, "d" (timeout_upper)
+		, [power_state] "r" (power_state)
+		: "memory", "cc");
+
+		result = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+	}
+	while (result == old_value);
+	return result;
+}
+
+template<typename T, typename Predicate>
+static inline T waitpkg_wait_for_predicate_impl(T *ptr, Predicate predicate, bool low_power) {
+	// Early return if the predicate is already satisfied.
+	T result = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+	if (predicate(result)) return result;
+
+	do {
+		__asm volatile (
+			"umonitor %[ptr];\n"
+			:: [ptr] "r" (ptr)
+			: "memory");
+
+		// Check to ensure the predicate wasn't already satisfied.
+		result = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+		if (predicate(result)) return result;
+
+		// bit 0 = Power state
+		//     0 = C0.2 (Larger power savings, slower wakeup)
+		//     1 = C0.1 (Faster wakeup, small power savings)
+		// bits [31:1] = reserved
+
+		// Request C0.1 for faster wakeup.
+		uint32_t power_state = low_power ? 0 : 1;
+
+		// Max timeout, will likely be clamped to IA32_UMWAIT_CONTROL
+		uint32_t timeout_lower = ~0U;
+		uint32_t timeout_upper = ~0U;
+
+		// umwait writes to CF if the the instruction timed out due to OS time limit.
+		// It does not write CF if it timed out due to provided timeout.
+		__asm volatile(
+			"umwait %[power_state]; # eax, edx\n"
+		:
+		: "a" (timeout_lower)
+		, "d" (timeout_upper)
+		, [power_state] "r" (power_state)
+		: "memory", "cc");
+
+		result = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+	}
+	while (!predicate(result));
+	return result;
+}
+
+template<typename T, typename Predicate>
+static inline bool waitpkg_wait_for_predicate_impl(T *ptr, Predicate predicate, uint64_t cycles_deadline, bool low_power, T *result) {
+	// Early return if the predicate is already satisfied.
+	T current = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+	if (predicate(current)) {
+		if (result) *result = current;
+		return true;
+	}
+
+	const uint64_t wait_deadline = timeout_wait_deadline(WFE_MUTEX_BACKEND_WAITPKG, cycles_deadline, low_power);
+	bool success = true;
+
+	do {
+		const uint64_t now = read_cycle_counter();
+		if (now >= wait_deadline) {
+			// Too close to the deadline for umwait to return in time, spin the rest.
+			do_yield();
+			current = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+			if (!predicate(current) && read_cycle_counter() >= cycles_deadline) {
+				success = false;
+				break;
+			}
+			continue;
+		}
+
+		__asm volatile (
+			"umonitor %[ptr];\n"
+			:: [ptr] "r" (ptr)
+			: "memory");
+
+		// Check to ensure the predicate wasn't already satisfied.
+		current = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+		if (predicate(current)) break;
+
+		// bit 0 = Power state
+		//     0 = C0.2 (Larger power savings, slower wakeup)
+		//     1 = C0.1 (Faster wakeup, small power savings)
+		// bits [31:1] = reserved
+
+		// Request C0.1 for faster wakeup.
+		uint32_t power_state = low_power ? 0 : 1;
+
+		// umwait waits until absolute TSC timestamp has elapsed instead of relative cycles.
+		const uint64_t next_deadline = waitpkg_next_deadline(now, wait_deadline);
+		uint32_t timeout_lower = next_deadline;
+		uint32_t timeout_upper = next_deadline >> 32;
+
+		// umwait writes to CF if the the instruction timed out due to OS time limit.
+		// It does not write CF if it timed out due to provided timeout.
+		__asm volatile(
+			"umwait %[power_state]; # eax, edx\n"
+		:
+		: "a" (timeout_lower)
+		, "d" (timeout_upper)
+		, [power_state] "r" (power_state)
+		: "memory", "cc");
+
+		current = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+		if (!predicate(current) && read_cycle_counter() >= cycles_deadline) {
+			success = false;
+			break;
+		}
+	}
+	while (!predicate(current));
+
+	if (result) *result = current;
+	return success;
+}
+
+template<typename T, typename Predicate>
+static inline bool waitpkg_wait_for_predicate_spurious_oneshot_impl(T *ptr, Predicate predicate, bool low_power, T *result) {
+	// Early return if the predicate is already satisfied.
+	T current = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+	if (!predicate(current)) {
+		__asm volatile (
+			"umonitor %[ptr];\n"
+			:: [ptr] "r" (ptr)
+			: "memory");
+
+		// Check to ensure the predicate wasn't already satisfied.
+		current = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+		if (!predicate(current)) {
+			// Request C0.1 for faster wakeup.
+			uint32_t power_state = low_power ? 0 : 1;
+
+			// Wait for absolute maximum TSC value, the OS deadline or a store ends the wait.
+			uint32_t timeout_lower = ~0U;
+			uint32_t timeout_upper = ~0U;
+
+			__asm volatile(
+				"umwait %[power_state]; # eax, edx\n"
+			:
+			: "a" (timeout_lower)
+			, "d" (timeout_upper)
+			, [power_state] "r" (power_state)
+			: "memory", "cc");
+
+			current = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+		}
+	}
+
+	if (result) *result = current;
+	return predicate(current);
+}
+
 void waitpkg_wait_for_value_i8 (uint8_t *ptr,  uint8_t value, bool low_power) {
 	waitpkg_wait_for_value_impl(ptr, value, low_power);
 }
@@ -231,20 +448,36 @@ uint64_t waitpkg_wait_for_bit_not_set_i64 (uint64_t *ptr,  uint8_t bit, bool low
 	return waitpkg_wait_for_bit_impl<0, 1>(ptr, bit, low_power);
 }
 
+bool waitpkg_wait_for_value_until_i8 (uint8_t *ptr,  uint8_t value, uint64_t cycles_deadline, bool low_power) {
+	return waitpkg_wait_for_value_impl(ptr, value, cycles_deadline, low_power);
+}
+
 bool waitpkg_wait_for_value_timeout_i8 (uint8_t *ptr,  uint8_t value, uint64_t nanoseconds, bool low_power) {
-	return waitpkg_wait_for_value_impl(ptr, value, nanoseconds, low_power);
+	return waitpkg_wait_for_value_until_i8(ptr, value, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power);
+}
+
+bool waitpkg_wait_for_value_until_i16 (uint16_t *ptr,  uint16_t value, uint64_t cycles_deadline, bool low_power) {
+	return waitpkg_wait_for_value_impl(ptr, value, cycles_deadline, low_power);
 }
 
 bool waitpkg_wait_for_value_timeout_i16 (uint16_t *ptr,  uint16_t value, uint64_t nanoseconds, bool low_power) {
-	return waitpkg_wait_for_value_impl(ptr, value, nanoseconds, low_power);
+	return waitpkg_wait_for_value_until_i16(ptr, value, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power);
+}
+
+bool waitpkg_wait_for_value_until_i32 (uint32_t *ptr,  uint32_t value, uint64_t cycles_deadline, bool low_power) {
+	return waitpkg_wait_for_value_impl(ptr, value, cycles_deadline, low_power);
 }
 
 bool waitpkg_wait_for_value_timeout_i32 (uint32_t *ptr,  uint32_t value, uint64_t nanoseconds, bool low_power) {
-	return waitpkg_wait_for_value_impl(ptr, value, nanoseconds, low_power);
+	return waitpkg_wait_for_value_until_i32(ptr, value, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power);
+}
+
+bool waitpkg_wait_for_value_until_i64 (uint64_t *ptr,  uint64_t value, uint64_t cycles_deadline, bool low_power) {
+	return waitpkg_wait_for_value_impl(ptr, value, cycles_deadline, low_power);
 }
 
 bool waitpkg_wait_for_value_timeout_i64 (uint64_t *ptr,  uint64_t value, uint64_t nanoseconds, bool low_power) {
-	return waitpkg_wait_for_value_impl(ptr, value, nanoseconds, low_power);
+	return waitpkg_wait_for_value_until_i64(ptr, value, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power);
 }
 
 bool waitpkg_wait_for_value_spurious_oneshot_i8 (uint8_t *ptr,  uint8_t value, bool low_power) {
@@ -263,4 +496,406 @@ bool waitpkg_wait_for_value_spurious_oneshot_i64(uint64_t *ptr, uint64_t value,
 	return waitpkg_wait_for_value_spurious_oneshot_impl(ptr, value, low_power);
 }
 
+uint8_t waitpkg_wait_for_change_i8 (uint8_t *ptr,  uint8_t old_value, bool low_power) {
+	return waitpkg_wait_for_change_impl(ptr, old_value, low_power);
+}
+
+uint16_t waitpkg_wait_for_change_i16(uint16_t *ptr, uint16_t old_value, bool low_power) {
+	return waitpkg_wait_for_change_impl(ptr, old_value, low_power);
+}
+
+uint32_t waitpkg_wait_for_change_i32(uint32_t *ptr, uint32_t old_value, bool low_power) {
+	return waitpkg_wait_for_change_impl(ptr, old_value, low_power);
+}
+
+uint64_t waitpkg_wait_for_change_i64(uint64_t *ptr, uint64_t old_value, bool low_power) {
+	return waitpkg_wait_for_change_impl(ptr, old_value, low_power);
+}
+
+uint8_t waitpkg_wait_for_masked_value_i8 (uint8_t *ptr,  uint8_t mask, uint8_t value, bool low_power) {
+	return waitpkg_wait_for_predicate_impl(ptr, [=](uint8_t current) { return (current & mask) == value; }, low_power);
+}
+
+uint16_t waitpkg_wait_for_masked_value_i16(uint16_t *ptr, uint16_t mask, uint16_t value, bool low_power) {
+	return waitpkg_wait_for_predicate_impl(ptr, [=](uint16_t current) { return (current & mask) == value; }, low_power);
+}
+
+uint32_t waitpkg_wait_for_masked_value_i32(uint32_t *ptr, uint32_t mask, uint32_t value, bool low_power) {
+	return waitpkg_wait_for_predicate_impl(ptr, [=](uint32_t current) { return (current & mask) == value; }, low_power);
+}
+
+uint64_t waitpkg_wait_for_masked_value_i64(uint64_t *ptr, uint64_t mask, uint64_t value, bool low_power) {
+	return waitpkg_wait_for_predicate_impl(ptr, [=](uint64_t current) { return (current & mask) == value; }, low_power);
+}
+
+uint8_t waitpkg_wait_for_any_bit_set_i8 (uint8_t *ptr,  uint8_t mask, bool low_power) {
+	return waitpkg_wait_for_predicate_impl(ptr, [=](uint8_t current) { return (current & mask) != 0; }, low_power);
+}
+
+uint16_t waitpkg_wait_for_any_bit_set_i16(uint16_t *ptr, uint16_t mask, bool low_power) {
+	return waitpkg_wait_for_predicate_impl(ptr, [=](uint16_t current) { return (current & mask) != 0; }, low_power);
+}
+
+uint32_t waitpkg_wait_for_any_bit_set_i32(uint32_t *ptr, uint32_t mask, bool low_power) {
+	return waitpkg_wait_for_predicate_impl(ptr, [=](uint32_t current) { return (current & mask) != 0; }, low_power);
+}
+
+uint64_t waitpkg_wait_for_any_bit_set_i64(uint64_t *ptr, uint64_t mask, bool low_power) {
+	return waitpkg_wait_for_predicate_impl(ptr, [=](uint64_t current) { return (current & mask) != 0; }, low_power);
+}
+
+uint8_t waitpkg_wait_for_sequence_ge_i8 (uint8_t *ptr,  uint8_t target, bool low_power) {
+	return waitpkg_wait_for_predicate_impl(ptr, [=](uint8_t current) { return (int8_t)(current - target) >= 0; }, low_power);
+}
+
+uint16_t waitpkg_wait_for_sequence_ge_i16(uint16_t *ptr, uint16_t target, bool low_power) {
+	return waitpkg_wait_for_predicate_impl(ptr, [=](uint16_t current) { return (int16_t)(current - target) >= 0; }, low_power);
+}
+
+uint32_t waitpkg_wait_for_sequence_ge_i32(uint32_t *ptr, uint32_t target, bool low_power) {
+	return waitpkg_wait_for_predicate_impl(ptr, [=](uint32_t current) { return (int32_t)(current - target) >= 0; }, low_power);
+}
+
+uint64_t waitpkg_wait_for_sequence_ge_i64(uint64_t *ptr, uint64_t target, bool low_power) {
+	return waitpkg_wait_for_predicate_impl(ptr, [=](uint64_t current) { return (int64_t)(current - target) >= 0; }, low_power);
+}
+
+bool waitpkg_wait_for_masked_value_until_i8 (uint8_t *ptr,  uint8_t mask, uint8_t value, uint64_t cycles_deadline, bool low_power, uint8_t *result) {
+	return waitpkg_wait_for_predicate_impl(ptr, [=](uint8_t current) { return (current & mask) == value; }, cycles_deadline, low_power, result);
+}
+
+bool waitpkg_wait_for_masked_value_timeout_i8 (uint8_t *ptr,  uint8_t mask, uint8_t value, uint64_t nanoseconds, bool low_power, uint8_t *result) {
+	return waitpkg_wait_for_masked_value_until_i8(ptr, mask, value, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool waitpkg_wait_for_masked_value_until_i16(uint16_t *ptr, uint16_t mask, uint16_t value, uint64_t cycles_deadline, bool low_power, uint16_t *result) {
+	return waitpkg_wait_for_predicate_impl(ptr, [=](uint16_t current) { return (current & mask) == value; }, cycles_deadline, low_power, result);
+}
+
+bool waitpkg_wait_for_masked_value_timeout_i16(uint16_t *ptr, uint16_t mask, uint16_t value, uint64_t nanoseconds, bool low_power, uint16_t *result) {
+	return waitpkg_wait_for_masked_value_until_i16(ptr, mask, value, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool waitpkg_wait_for_masked_value_until_i32(uint32_t *ptr, uint32_t mask, uint32_t value, uint64_t cycles_deadline, bool low_power, uint32_t *result) {
+	return waitpkg_wait_for_predicate_impl(ptr, [=](uint32_t current) { return (current & mask) == value; }, cycles_deadline, low_power, result);
+}
+
+bool waitpkg_wait_for_masked_value_timeout_i32(uint32_t *ptr, uint32_t mask, uint32_t value, uint64_t nanoseconds, bool low_power, uint32_t *result) {
+	return waitpkg_wait_for_masked_value_until_i32(ptr, mask, value, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool waitpkg_wait_for_masked_value_until_i64(uint64_t *ptr, uint64_t mask, uint64_t value, uint64_t cycles_deadline, bool low_power, uint64_t *result) {
+	return waitpkg_wait_for_predicate_impl(ptr, [=](uint64_t current) { return (current & mask) == value; }, cycles_deadline, low_power, result);
+}
+
+bool waitpkg_wait_for_masked_value_timeout_i64(uint64_t *ptr, uint64_t mask, uint64_t value, uint64_t nanoseconds, bool low_power, uint64_t *result) {
+	return waitpkg_wait_for_masked_value_until_i64(ptr, mask, value, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool waitpkg_wait_for_any_bit_set_until_i8 (uint8_t *ptr,  uint8_t mask, uint64_t cycles_deadline, bool low_power, uint8_t *result) {
+	return waitpkg_wait_for_predicate_impl(ptr, [=](uint8_t current) { return (current & mask) != 0; }, cycles_deadline, low_power, result);
+}
+
+bool waitpkg_wait_for_any_bit_set_timeout_i8 (uint8_t *ptr,  uint8_t mask, uint64_t nanoseconds, bool low_power, uint8_t *result) {
+	return waitpkg_wait_for_any_bit_set_until_i8(ptr, mask, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool waitpkg_wait_for_any_bit_set_until_i16(uint16_t *ptr, uint16_t mask, uint64_t cycles_deadline, bool low_power, uint16_t *result) {
+	return waitpkg_wait_for_predicate_impl(ptr, [=](uint16_t current) { return (current & mask) != 0; }, cycles_deadline, low_power, result);
+}
+
+bool waitpkg_wait_for_any_bit_set_timeout_i16(uint16_t *ptr, uint16_t mask, uint64_t nanoseconds, bool low_power, uint16_t *result) {
+	return waitpkg_wait_for_any_bit_set_until_i16(ptr, mask, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool waitpkg_wait_for_any_bit_set_until_i32(uint32_t *ptr, uint32_t mask, uint64_t cycles_deadline, bool low_power, uint32_t *result) {
+	return waitpkg_wait_for_predicate_impl(ptr, [=](uint32_t current) { return (current & mask) != 0; }, cycles_deadline, low_power, result);
+}
+
+bool waitpkg_wait_for_any_bit_set_timeout_i32(uint32_t *ptr, uint32_t mask, uint64_t nanoseconds, bool low_power, uint32_t *result) {
+	return waitpkg_wait_for_any_bit_set_until_i32(ptr, mask, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool waitpkg_wait_for_any_bit_set_until_i64(uint64_t *ptr, uint64_t mask, uint64_t cycles_deadline, bool low_power, uint64_t *result) {
+	return waitpkg_wait_for_predicate_impl(ptr, [=](uint64_t current) { return (current & mask) != 0; }, cycles_deadline, low_power, result);
+}
+
+bool waitpkg_wait_for_any_bit_set_timeout_i64(uint64_t *ptr, uint64_t mask, uint64_t nanoseconds, bool low_power, uint64_t *result) {
+	return waitpkg_wait_for_any_bit_set_until_i64(ptr, mask, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool waitpkg_wait_for_sequence_ge_until_i8 (uint8_t *ptr,  uint8_t target, uint64_t cycles_deadline, bool low_power, uint8_t *result) {
+	return waitpkg_wait_for_predicate_impl(ptr, [=](uint8_t current) { return (int8_t)(current - target) >= 0; }, cycles_deadline, low_power, result);
+}
+
+bool waitpkg_wait_for_sequence_ge_timeout_i8 (uint8_t *ptr,  uint8_t target, uint64_t nanoseconds, bool low_power, uint8_t *result) {
+	return waitpkg_wait_for_sequence_ge_until_i8(ptr, target, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool waitpkg_wait_for_sequence_ge_until_i16(uint16_t *ptr, uint16_t target, uint64_t cycles_deadline, bool low_power, uint16_t *result) {
+	return waitpkg_wait_for_predicate_impl(ptr, [=](uint16_t current) { return (int16_t)(current - target) >= 0; }, cycles_deadline, low_power, result);
+}
+
+bool waitpkg_wait_for_sequence_ge_timeout_i16(uint16_t *ptr, uint16_t target, uint64_t nanoseconds, bool low_power, uint16_t *result) {
+	return waitpkg_wait_for_sequence_ge_until_i16(ptr, target, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool waitpkg_wait_for_sequence_ge_until_i32(uint32_t *ptr, uint32_t target, uint64_t cycles_deadline, bool low_power, uint32_t *result) {
+	return waitpkg_wait_for_predicate_impl(ptr, [=](uint32_t current) { return (int32_t)(current - target) >= 0; }, cycles_deadline, low_power, result);
+}
+
+bool waitpkg_wait_for_sequence_ge_timeout_i32(uint32_t *ptr, uint32_t target, uint64_t nanoseconds, bool low_power, uint32_t *result) {
+	return waitpkg_wait_for_sequence_ge_until_i32(ptr, target, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool waitpkg_wait_for_sequence_ge_until_i64(uint64_t *ptr, uint64_t target, uint64_t cycles_deadline, bool low_power, uint64_t *result) {
+	return waitpkg_wait_for_predicate_impl(ptr, [=](uint64_t current) { return (int64_t)(current - target) >= 0; }, cycles_deadline, low_power, result);
+}
+
+bool waitpkg_wait_for_sequence_ge_timeout_i64(uint64_t *ptr, uint64_t target, uint64_t nanoseconds, bool low_power, uint64_t *result) {
+	return waitpkg_wait_for_sequence_ge_until_i64(ptr, target, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool waitpkg_wait_for_bit_set_until_i8 (uint8_t *ptr,  uint8_t bit, uint64_t cycles_deadline, bool low_power, uint8_t *result) {
+	return waitpkg_wait_for_predicate_impl(ptr, [=](uint8_t current) { return ((current >> bit) & 1) == 1; }, cycles_deadline, low_power, result);
+}
+
+bool waitpkg_wait_for_bit_set_timeout_i8 (uint8_t *ptr,  uint8_t bit, uint64_t nanoseconds, bool low_power, uint8_t *result) {
+	return waitpkg_wait_for_bit_set_until_i8(ptr, bit, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool waitpkg_wait_for_bit_set_until_i16(uint16_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint16_t *result) {
+	return waitpkg_wait_for_predicate_impl(ptr, [=](uint16_t current) { return ((current >> bit) & 1) == 1; }, cycles_deadline, low_power, result);
+}
+
+bool waitpkg_wait_for_bit_set_timeout_i16(uint16_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint16_t *result) {
+	return waitpkg_wait_for_bit_set_until_i16(ptr, bit, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool waitpkg_wait_for_bit_set_until_i32(uint32_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint32_t *result) {
+	return waitpkg_wait_for_predicate_impl(ptr, [=](uint32_t current) { return ((current >> bit) & 1) == 1; }, cycles_deadline, low_power, result);
+}
+
+bool waitpkg_wait_for_bit_set_timeout_i32(uint32_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint32_t *result) {
+	return waitpkg_wait_for_bit_set_until_i32(ptr, bit, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool waitpkg_wait_for_bit_set_until_i64(uint64_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint64_t *result) {
+	return waitpkg_wait_for_predicate_impl(ptr, [=](uint64_t current) { return ((current >> bit) & 1) == 1; }, cycles_deadline, low_power, result);
+}
+
+bool waitpkg_wait_for_bit_set_timeout_i64(uint64_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint64_t *result) {
+	return waitpkg_wait_for_bit_set_until_i64(ptr, bit, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool waitpkg_wait_for_bit_not_set_until_i8 (uint8_t *ptr,  uint8_t bit, uint64_t cycles_deadline, bool low_power, uint8_t *result) {
+	return waitpkg_wait_for_predicate_impl(ptr, [=](uint8_t current) { return ((current >> bit) & 1) == 0; }, cycles_deadline, low_power, result);
+}
+
+bool waitpkg_wait_for_bit_not_set_timeout_i8 (uint8_t *ptr,  uint8_t bit, uint64_t nanoseconds, bool low_power, uint8_t *result) {
+	return waitpkg_wait_for_bit_not_set_until_i8(ptr, bit, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool waitpkg_wait_for_bit_not_set_until_i16(uint16_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint16_t *result) {
+	return waitpkg_wait_for_predicate_impl(ptr, [=](uint16_t current) { return ((current >> bit) & 1) == 0; }, cycles_deadline, low_power, result);
+}
+
+bool waitpkg_wait_for_bit_not_set_timeout_i16(uint16_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint16_t *result) {
+	return waitpkg_wait_for_bit_not_set_until_i16(ptr, bit, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool waitpkg_wait_for_bit_not_set_until_i32(uint32_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint32_t *result) {
+	return waitpkg_wait_for_predicate_impl(ptr, [=](uint32_t current) { return ((current >> bit) & 1) == 0; }, cycles_deadline, low_power, result);
+}
+
+bool waitpkg_wait_for_bit_not_set_timeout_i32(uint32_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint32_t *result) {
+	return waitpkg_wait_for_bit_not_set_until_i32(ptr, bit, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool waitpkg_wait_for_bit_not_set_until_i64(uint64_t *ptr, uint8_t bit, uint64_t cycles_deadline, bool low_power, uint64_t *result) {
+	return waitpkg_wait_for_predicate_impl(ptr, [=](uint64_t current) { return ((current >> bit) & 1) == 0; }, cycles_deadline, low_power, result);
+}
+
+bool waitpkg_wait_for_bit_not_set_timeout_i64(uint64_t *ptr, uint8_t bit, uint64_t nanoseconds, bool low_power, uint64_t *result) {
+	return waitpkg_wait_for_bit_not_set_until_i64(ptr, bit, wfe_mutex_detect_deadline_for_nanoseconds(nanoseconds), low_power, result);
+}
+
+bool waitpkg_wait_for_bit_set_spurious_oneshot_i8 (uint8_t *ptr,  uint8_t bit, bool low_power, uint8_t *result) {
+	return waitpkg_wait_for_predicate_spurious_oneshot_impl(ptr, [=](uint8_t current) { return ((current >> bit) & 1) == 1; }, low_power, result);
+}
+
+bool waitpkg_wait_for_bit_set_spurious_oneshot_i16(uint16_t *ptr, uint8_t bit, bool low_power, uint16_t *result) {
+	return waitpkg_wait_for_predicate_spurious_oneshot_impl(ptr, [=](uint16_t current) { return ((current >> bit) & 1) == 1; }, low_power, result);
+}
+
+bool waitpkg_wait_for_bit_set_spurious_oneshot_i32(uint32_t *ptr, uint8_t bit, bool low_power, uint32_t *result) {
+	return waitpkg_wait_for_predicate_spurious_oneshot_impl(ptr, [=](uint32_t current) { return ((current >> bit) & 1) == 1; }, low_power, result);
+}
+
+bool waitpkg_wait_for_bit_set_spurious_oneshot_i64(uint64_t *ptr, uint8_t bit, bool low_power, uint64_t *result) {
+	return waitpkg_wait_for_predicate_spurious_oneshot_impl(ptr, [=](uint64_t current) { return ((current >> bit) & 1) == 1; }, low_power, result);
+}
+
+bool waitpkg_wait_for_bit_not_set_spurious_oneshot_i8 (uint8_t *ptr,  uint8_t bit, bool low_power, uint8_t *result) {
+	return waitpkg_wait_for_predicate_spurious_oneshot_impl(ptr, [=](uint8_t current) { return ((current >> bit) & 1) == 0; }, low_power, result);
+}
+
+bool waitpkg_wait_for_bit_not_set_spurious_oneshot_i16(uint16_t *ptr, uint8_t bit, bool low_power, uint16_t *result) {
+	return waitpkg_wait_for_predicate_spurious_oneshot_impl(ptr, [=](uint16_t current) { return ((current >> bit) & 1) == 0; }, low_power, result);
+}
+
+bool waitpkg_wait_for_bit_not_set_spurious_oneshot_i32(uint32_t *ptr, uint8_t bit, bool low_power, uint32_t *result) {
+	return waitpkg_wait_for_predicate_spurious_oneshot_impl(ptr, [=](uint32_t current) { return ((current >> bit) & 1) == 0; }, low_power, result);
+}
+
+bool waitpkg_wait_for_bit_not_set_spurious_oneshot_i64(uint64_t *ptr, uint8_t bit, bool low_power, uint64_t *result) {
+	return waitpkg_wait_for_predicate_spurious_oneshot_impl(ptr, [=](uint64_t current) { return ((current >> bit) & 1) == 0; }, low_power, result);
+}
+
+size_t waitpkg_wait_any_oneshot(const wfe_mutex_wait_desc *descs, size_t n, size_t monitor_index, uint64_t nanoseconds, bool low_power) {
+	__asm volatile (
+		"umonitor %[ptr];\n"
+		:: [ptr] "r" (descs[monitor_index].ptr)
+		: "memory");
+
+	// Check every word after arming so a store between the check and the wait still wakes us.
+	const size_t index = wait_any_find_satisfied(descs, n);
+	if (index != n) return index;
+
+	// Request C0.1 for faster wakeup.
+	uint32_t power_state = low_power ? 0 : 1;
+
+	// umwait waits until absolute TSC timestamp has elapsed instead of relative cycles.
+	// Without a timeout wait for absolute maximum TSC value, the OS deadline still bounds the wait.
+	const uint64_t cycles_end = nanoseconds ? read_cycle_counter() + wfe_mutex_detect_calculate_cycles_for_nanoseconds(nanoseconds) : ~0ULL;
+	uint32_t timeout_lower = cycles_end;
+	uint32_t timeout_upper = cycles_end >> 32;
+
+	__asm volatile(
+		"umwait %[power_state]; # eax, edx\n"
+	:
+	: "a" (timeout_lower)
+	, "d" (timeout_upper)
+	, [power_state] "r" (power_state)
+	: "memory", "cc");
+
+	return wait_any_find_satisfied(descs, n);
+}
+
+uint64_t waitpkg_doorbell_wait(wfe_mutex_doorbell *doorbell, bool low_power) {
+	uint64_t mask = doorbell_scan(doorbell);
+
+	while (mask == 0) {
+		// Arm the monitor on the whole block, then scan every flag before waiting.
+		__asm volatile (
+			"umonitor %[ptr];\n"
+			:: [ptr] "r" (doorbell->flags)
+			: "memory");
+
+		mask = doorbell_scan(doorbell);
+		if (mask) break;
+
+		// Request C0.1 for faster wakeup.
+		uint32_t power_state = low_power ? 0 : 1;
+
+		// Wait for absolute maximum TSC value, the OS deadline or a store ends the wait.
+		uint32_t timeout_lower = ~0U;
+		uint32_t timeout_upper = ~0U;
+
+		__asm volatile(
+			"umwait %[power_state]; # eax, edx\n"
+		:
+		: "a" (timeout_lower)
+		, "d" (timeout_upper)
+		, [power_state] "r" (power_state)
+		: "memory", "cc");
+
+		mask = doorbell_scan(doorbell);
+	}
+	return doorbell_consume(doorbell, mask);
+}
+
+void waitpkg_sleep_until(uint64_t cycles_deadline, bool low_power) {
+	// tpause takes the same absolute TSC deadline as umwait without needing a monitor.
+	const uint64_t wait_deadline = timeout_wait_deadline(WFE_MUTEX_BACKEND_WAITPKG, cycles_deadline, low_power);
+	uint64_t now = read_cycle_counter();
+	while (now < wait_deadline) {
+		// Request C0.1 for faster wakeup.
+		uint32_t power_state = low_power ? 0 : 1;
+
+		const uint64_t next_deadline = waitpkg_next_deadline(now, wait_deadline);
+		uint32_t timeout_lower = next_deadline;
+		uint32_t timeout_upper = next_deadline >> 32;
+
+		// tpause writes to CF if the the instruction timed out due to OS time limit.
+		__asm volatile(
+			"tpause %[power_state]; # eax, edx\n"
+		:
+		: "a" (timeout_lower)
+		, "d" (timeout_upper)
+		, [power_state] "r" (power_state)
+		: "memory", "cc");
+
+		now = read_cycle_counter();
+	}
+
+	// Spin the rest that tpause can't hit precisely.
+	while (read_cycle_counter() < cycles_deadline) {
+		do_yield();
+	}
+}
+
+#if defined(_M_X86_64)
+template<typename Predicate>
+static inline wfe_mutex_u128 waitpkg_wait_for_predicate_i128_impl(wfe_mutex_u128 *ptr, Predicate predicate, bool low_power) {
+	while (true) {
+		wfe_mutex_u128 current = load_u128_halves(ptr);
+		if (predicate(current)) {
+			// Confirm that both halves were observed together.
+			current = confirm_load_u128(ptr);
+			if (predicate(current)) return current;
+			continue;
+		}
+
+		// 16-byte alignment keeps both halves in the monitored line.
+		__asm volatile (
+			"umonitor %[ptr];\n"
+			:: [ptr] "r" (ptr)
+			: "memory");
+
+		if (predicate(load_u128_halves(ptr))) continue;
+
+		// bit 0 = Power state
+		//     0 = C0.2 (Larger power savings, slower wakeup)
+		//     1 = C0.1 (Faster wakeup, small power savings)
+		// bits [31:1] = reserved
+
+		// Request C0.1 for faster wakeup.
+		uint32_t power_state = low_power ? 0 : 1;
+
+		// Max timeout, will likely be clamped to IA32_UMWAIT_CONTROL
+		uint32_t timeout_lower = ~0U;
+		uint32_t timeout_upper = ~0U;
+
+		// umwait writes to CF if the the instruction timed out due to OS time limit.
+		// It does not write CF if it timed out due to provided timeout.
+		__asm volatile(
+			"umwait %[power_state]; # eax, edx\n"
+		:
+		: "a" (timeout_lower)
+		, "d" (timeout_upper)
+		, [power_state] "r" (power_state)
+		: "memory", "cc");
+	}
+}
+
+wfe_mutex_u128 waitpkg_wait_for_masked_value_i128(wfe_mutex_u128 *ptr, wfe_mutex_u128 mask, wfe_mutex_u128 value, bool low_power) {
+	return waitpkg_wait_for_predicate_i128_impl(ptr, [=](wfe_mutex_u128 current) { return u128_masked_equal(current, mask, value); }, low_power);
+}
+
+void waitpkg_wait_for_value_i128(wfe_mutex_u128 *ptr, wfe_mutex_u128 value, bool low_power) {
+	waitpkg_wait_for_masked_value_i128(ptr, u128_all_ones(), value, low_power);
+}
+#endif
+
 #endif
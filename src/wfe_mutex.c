@@ -1,5 +1,156 @@
 #include "detect.h"
+#include "implementation_details_arm.h"
+#include "implementation_details_x86.h"
+#include "implementation_details_generic.h"
+#include "implementation_details_wait_any.h"
+
+#include <time.h>
+
+#if defined(__linux__)
+#include <linux/membarrier.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 void wfe_mutex_init() {
 	wfe_mutex_detect_features();
 }
+
+void wfe_mutex_init_tuned() {
+	wfe_mutex_detect_features();
+	wfe_mutex_detect_tune();
+}
+
+uint64_t wfe_mutex_read_cycle_counter() {
+	return read_cycle_counter();
+}
+
+uint64_t wfe_mutex_deadline_from_clock_monotonic(uint64_t monotonic_nanoseconds) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	const uint64_t NanosecondsInSecond = 1000000000ULL;
+	const uint64_t now = ts.tv_sec * NanosecondsInSecond + ts.tv_nsec;
+
+	const uint64_t remaining = monotonic_nanoseconds > now ? monotonic_nanoseconds - now : 0;
+	return wfe_mutex_detect_deadline_for_nanoseconds(remaining);
+}
+
+// Bounds for how long an unarmed word can go unobserved when the words span multiple monitor granules.
+#define WAIT_ANY_MIN_NANOSECONDS 1000
+#define WAIT_ANY_MAX_NANOSECONDS 100000
+
+size_t wfe_mutex_wait_any(const wfe_mutex_wait_desc *descs, size_t n, bool low_power) {
+	if (n == 0) return 0;
+
+	size_t index = wait_any_find_satisfied(descs, n);
+	if (index != n) return index;
+
+	// Spin-loop implementation doesn't report a granule size, assume a cacheline.
+	const uint32_t granule = Features.monitor_granule_size_bytes_min ? Features.monitor_granule_size_bytes_min : 64;
+
+	if (wait_any_same_granule(descs, n, granule)) {
+		// A single monitor arm observes every word, wait without a timeout.
+		do {
+			index = Features.wait_any_oneshot(descs, n, 0, 0, low_power);
+		} while (index == n);
+		return index;
+	}
+
+	// Only one word can be armed at a time. Rotate the armed word and escalate the timeout so
+	// quickly changing words are caught early while long waits don't thrash the monitor.
+	uint64_t nanoseconds = WAIT_ANY_MIN_NANOSECONDS;
+	size_t monitor_index = 0;
+	while ((index = Features.wait_any_oneshot(descs, n, monitor_index, nanoseconds, low_power)) == n) {
+		monitor_index = monitor_index + 1 == n ? 0 : monitor_index + 1;
+		if (nanoseconds < WAIT_ANY_MAX_NANOSECONDS) nanoseconds *= 2;
+	}
+	return index;
+}
+
+void wfe_mutex_membarrier() {
+#if defined(__linux__) && defined(__NR_membarrier)
+	if (Features.supports_membarrier) {
+		syscall(__NR_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0);
+		return;
+	}
+#endif
+
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+// How long a futex strategy waits in the backend before sleeping in the kernel.
+#define FUTEX_SPIN_NANOSECONDS 50000
+
+#if defined(__linux__) && defined(__NR_futex)
+static void futex_wait_i32(uint32_t *ptr, uint32_t current) {
+	const uint64_t NanosecondsInSecond = 1000000000ULL;
+	const struct timespec ts = {
+		.tv_sec = WFE_MUTEX_FUTEX_POLL_NANOSECONDS / NanosecondsInSecond,
+		.tv_nsec = WFE_MUTEX_FUTEX_POLL_NANOSECONDS % NanosecondsInSecond,
+	};
+
+	// Returns immediately if the word no longer holds `current`.
+	syscall(__NR_futex, ptr, FUTEX_WAIT_PRIVATE, current, &ts, NULL, 0);
+}
+#endif
+
+void wfe_mutex_wait_for_value_hinted_i32(uint32_t *ptr, uint32_t value, wfe_mutex_wait_hint hint) {
+	switch (Features.hint_strategy[hint]) {
+		case WAIT_STRATEGY_SPIN:
+			while (__atomic_load_n(ptr, __ATOMIC_ACQUIRE) != value) {
+				do_yield();
+			}
+			break;
+		case WAIT_STRATEGY_MONITOR:
+			Features.wait_for_value_i32(ptr, value, false);
+			break;
+		case WAIT_STRATEGY_MONITOR_LOW_POWER:
+			Features.wait_for_value_i32(ptr, value, true);
+			break;
+		case WAIT_STRATEGY_FUTEX:
+			if (Features.wait_for_value_timeout_i32(ptr, value, FUTEX_SPIN_NANOSECONDS, true)) {
+				break;
+			}
+
+#if defined(__linux__) && defined(__NR_futex)
+			for (uint32_t current; (current = __atomic_load_n(ptr, __ATOMIC_ACQUIRE)) != value;) {
+				futex_wait_i32(ptr, current);
+			}
+#else
+			Features.wait_for_value_i32(ptr, value, true);
+#endif
+			break;
+	}
+}
+
+#define WAIT_FOR_VALUE_HINTED(size) \
+void wfe_mutex_wait_for_value_hinted_i##size(uint##size##_t *ptr, uint##size##_t value, wfe_mutex_wait_hint hint) { \
+	switch (Features.hint_strategy[hint]) { \
+		case WAIT_STRATEGY_SPIN: \
+			while (__atomic_load_n(ptr, __ATOMIC_ACQUIRE) != value) { \
+				do_yield(); \
+			} \
+			break; \
+		case WAIT_STRATEGY_MONITOR: \
+			Features.wait_for_value_i##size(ptr, value, false); \
+			break; \
+		/* Futexes only wait on 32-bit words. */ \
+		case WAIT_STRATEGY_MONITOR_LOW_POWER: \
+		case WAIT_STRATEGY_FUTEX: \
+			Features.wait_for_value_i##size(ptr, value, true); \
+			break; \
+	} \
+}
+
+WAIT_FOR_VALUE_HINTED(8)
+WAIT_FOR_VALUE_HINTED(16)
+WAIT_FOR_VALUE_HINTED(64)
+
+void wfe_mutex_wake_i32(uint32_t *ptr, bool all) {
+#if defined(__linux__) && defined(__NR_futex)
+	if (Features.supports_futex) {
+		syscall(__NR_futex, ptr, FUTEX_WAKE_PRIVATE, all ? INT32_MAX : 1, NULL, NULL, 0);
+	}
+#endif
+}
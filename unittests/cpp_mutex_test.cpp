@@ -13,6 +13,20 @@ extern "C" int cpp_mutex_test() {
 
 	std::shared_lock lk3 {shared_hi};
 	std::shared_lock lk4 {shared_lo};
+
+	wfe_mutex::mutex<false> mutex_a;
+	wfe_mutex::shared_mutex<true> shared_b;
+	wfe_mutex::shared_mutex<false> shared_c;
+	wfe_mutex::scoped_lock lk5 {mutex_a, shared_b, wfe_mutex::shared(shared_c)};
+
+	wfe_mutex::atomic<uint32_t> atomic_value {1};
+	if (atomic_value.wait(0) != 1) return 1;
+	atomic_value.store(2, std::memory_order_release);
+	atomic_value.notify_all();
+	if (atomic_value.wait(1, std::memory_order_acquire) != 2) return 1;
+	uint32_t expected = 2;
+	if (!atomic_value.compare_exchange_strong(expected, 3, std::memory_order_acq_rel)) return 1;
+	if (atomic_value.load(std::memory_order_relaxed) != 3) return 1;
 	return 0;
 }
 
@@ -1,7 +1,14 @@
 #define WFE_MUTEX_DEBUG 1
 #include <catch2/catch_all.hpp>
 #include <wfe_mutex/wfe_mutex.h>
+#include <sys/mman.h>
 #include <sys/wait.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <utility>
 
 TEST_CASE("Basic Test") {
 	wfe_mutex_init();
@@ -41,6 +48,957 @@ TEST_CASE("Basic Test - wfe_mutex_lock") {
 	wfe_mutex_lock_unlock(&lock);
 }
 
+TEST_CASE("Basic Test - wfe_mutex_flat_combining") {
+	wfe_mutex_init();
+
+	constexpr uint32_t ThreadCount = 4;
+	constexpr uint64_t IncrementsPerThread = 1000;
+
+	const uint32_t stride = wfe_mutex_flat_combining_slot_stride();
+	REQUIRE(stride >= sizeof(wfe_mutex_flat_combining_slot));
+	void *slots = aligned_alloc(stride, stride * ThreadCount);
+
+	uint64_t counter = 0;
+	wfe_mutex_flat_combining fc;
+	wfe_mutex_flat_combining_init(&fc, &counter, slots, ThreadCount);
+
+	auto increment = [](void *data, void *arg) {
+		uint64_t *counter = reinterpret_cast<uint64_t*>(data);
+		*reinterpret_cast<uint64_t*>(arg) = ++*counter;
+	};
+
+	// Single threaded, operation executes on the calling thread and writes back the result.
+	uint64_t result = 0;
+	wfe_mutex_flat_combining_execute(&fc, 0, increment, &result, false);
+	REQUIRE(result == 1);
+	REQUIRE(counter == 1);
+
+	std::vector<std::thread> threads;
+	for (uint32_t i = 0; i < ThreadCount; ++i) {
+		threads.emplace_back([&fc, increment, i]() {
+			uint64_t result = 0;
+			for (uint64_t j = 0; j < IncrementsPerThread; ++j) {
+				wfe_mutex_flat_combining_execute(&fc, i, increment, &result, false);
+			}
+		});
+	}
+
+	for (auto &t : threads) {
+		t.join();
+	}
+
+	REQUIRE(counter == ThreadCount * IncrementsPerThread + 1);
+	free(slots);
+}
+
+TEST_CASE("Basic Test - wfe_mutex_biased_lock") {
+	wfe_mutex_init();
+
+	wfe_mutex_biased_lock lock;
+	wfe_mutex_biased_lock_init(&lock);
+
+	// Owner fast path.
+	wfe_mutex_biased_lock_owner_lock(&lock, false);
+	REQUIRE(lock.owner_locked == 1);
+	wfe_mutex_biased_lock_owner_unlock(&lock);
+	REQUIRE(lock.owner_locked == 0);
+
+	// Non-owner path.
+	wfe_mutex_biased_lock_lock(&lock, false);
+	REQUIRE(lock.revoked == 1);
+	wfe_mutex_biased_lock_unlock(&lock);
+	REQUIRE(lock.revoked == 0);
+
+	// Owner and non-owner contending.
+	constexpr uint64_t IncrementsPerThread = 10000;
+	uint64_t counter = 0;
+
+	std::thread non_owner([&lock, &counter]() {
+		for (uint64_t i = 0; i < IncrementsPerThread; ++i) {
+			wfe_mutex_biased_lock_lock(&lock, false);
+			++counter;
+			wfe_mutex_biased_lock_unlock(&lock);
+		}
+	});
+
+	for (uint64_t i = 0; i < IncrementsPerThread; ++i) {
+		wfe_mutex_biased_lock_owner_lock(&lock, false);
+		++counter;
+		wfe_mutex_biased_lock_owner_unlock(&lock);
+	}
+
+	non_owner.join();
+	REQUIRE(counter == IncrementsPerThread * 2);
+}
+
+TEST_CASE("Basic Test - wfe_mutex_queue_lock") {
+	wfe_mutex_init();
+
+	wfe_mutex_queue_lock lock = WFE_MUTEX_QUEUE_LOCK_INITIALIZER;
+	wfe_mutex_queue_lock_node node{};
+
+	wfe_mutex_queue_lock_lock(&lock, &node, false);
+	REQUIRE(lock.tail == &node);
+	wfe_mutex_queue_lock_node other{};
+	REQUIRE(wfe_mutex_queue_lock_trylock(&lock, &other) == false);
+	wfe_mutex_queue_lock_unlock(&lock, &node);
+	REQUIRE(lock.tail == nullptr);
+
+	REQUIRE(wfe_mutex_queue_lock_trylock(&lock, &other) == true);
+	wfe_mutex_queue_lock_unlock(&lock, &other);
+	REQUIRE(lock.tail == nullptr);
+
+	// Contended, with a short patience so that skipping preempted waiters gets exercised.
+	lock.patience_nanoseconds = 10000;
+	constexpr uint64_t ThreadCount = 3;
+	constexpr uint64_t IncrementsPerThread = 300;
+	uint64_t counter = 0;
+
+	std::vector<std::thread> threads;
+	for (uint64_t i = 0; i < ThreadCount; ++i) {
+		threads.emplace_back([&lock, &counter]() {
+			wfe_mutex_queue_lock_node thread_node{};
+			for (uint64_t j = 0; j < IncrementsPerThread; ++j) {
+				wfe_mutex_queue_lock_lock(&lock, &thread_node, false);
+				++counter;
+				wfe_mutex_queue_lock_unlock(&lock, &thread_node);
+			}
+		});
+	}
+
+	for (auto &t : threads) {
+		t.join();
+	}
+
+	REQUIRE(counter == ThreadCount * IncrementsPerThread);
+	REQUIRE(lock.tail == nullptr);
+}
+
+TEST_CASE("Basic Test - wfe_mutex_lock_many") {
+	wfe_mutex_init();
+
+	wfe_mutex_lock lock_a = WFE_MUTEX_LOCK_INITIALIZER;
+	wfe_mutex_lock lock_b = WFE_MUTEX_LOCK_INITIALIZER;
+	wfe_mutex_rwlock rwlock = WFE_MUTEX_RWLOCK_INITIALIZER;
+
+	wfe_mutex_lock_many_entry entries[] = {
+		{&rwlock, WFE_MUTEX_LOCK_MANY_RWLOCK_READ},
+		{&lock_b, WFE_MUTEX_LOCK_MANY_LOCK},
+		{&lock_a, WFE_MUTEX_LOCK_MANY_LOCK},
+	};
+
+	wfe_mutex_lock_many(entries, 3, false);
+	REQUIRE(lock_a.mutex == 1);
+	REQUIRE(lock_b.mutex == 1);
+	REQUIRE(rwlock.mutex == 1);
+	REQUIRE((uintptr_t)entries[0].lock < (uintptr_t)entries[1].lock);
+	REQUIRE((uintptr_t)entries[1].lock < (uintptr_t)entries[2].lock);
+
+	// Shared mode doesn't exclude other readers.
+	REQUIRE(wfe_mutex_rwlock_trylock_shared(&rwlock) == true);
+	wfe_mutex_rwlock_read_unlock(&rwlock);
+
+	wfe_mutex_unlock_many(entries, 3);
+	REQUIRE(lock_a.mutex == 0);
+	REQUIRE(lock_b.mutex == 0);
+	REQUIRE(rwlock.mutex == 0);
+
+	// Threads listing the locks in opposite orders must not deadlock.
+	constexpr uint64_t IncrementsPerThread = 10000;
+	uint64_t counter = 0;
+
+	auto Worker = [&](bool reversed) {
+		for (uint64_t i = 0; i < IncrementsPerThread; ++i) {
+			wfe_mutex_lock_many_entry thread_entries[] = {
+				{&lock_a, WFE_MUTEX_LOCK_MANY_LOCK},
+				{&lock_b, WFE_MUTEX_LOCK_MANY_LOCK},
+				{&rwlock, WFE_MUTEX_LOCK_MANY_RWLOCK_WRITE},
+			};
+			if (reversed) {
+				std::swap(thread_entries[0], thread_entries[2]);
+			}
+			wfe_mutex_lock_many(thread_entries, 3, false);
+			++counter;
+			wfe_mutex_unlock_many(thread_entries, 3);
+		}
+	};
+
+	std::thread other(Worker, true);
+	Worker(false);
+	other.join();
+
+	REQUIRE(counter == IncrementsPerThread * 2);
+}
+
+TEST_CASE("Basic Test - wfe_mutex_eventcount") {
+	wfe_mutex_init();
+
+	wfe_mutex_eventcount ec = WFE_MUTEX_EVENTCOUNT_INITIALIZER;
+
+	// No waiters, notify doesn't touch the epoch.
+	wfe_mutex_eventcount_notify_one(&ec);
+	REQUIRE(ec.epoch == 0);
+
+	uint32_t key = wfe_mutex_eventcount_prepare_wait(&ec);
+	REQUIRE(ec.waiters == 1);
+	wfe_mutex_eventcount_cancel_wait(&ec);
+	REQUIRE(ec.waiters == 0);
+
+	// Single producer, single consumer.
+	constexpr uint32_t ItemCount = 10000;
+	uint32_t produced = 0;
+	uint32_t consumed = 0;
+
+	std::thread consumer([&]() {
+		while (consumed < ItemCount) {
+			if (__atomic_load_n(&produced, __ATOMIC_ACQUIRE) > consumed) {
+				++consumed;
+				continue;
+			}
+
+			key = wfe_mutex_eventcount_prepare_wait(&ec);
+			if (__atomic_load_n(&produced, __ATOMIC_ACQUIRE) > consumed) {
+				wfe_mutex_eventcount_cancel_wait(&ec);
+				continue;
+			}
+			wfe_mutex_eventcount_commit_wait(&ec, key, false);
+		}
+	});
+
+	for (uint32_t i = 0; i < ItemCount; ++i) {
+		__atomic_fetch_add(&produced, 1, __ATOMIC_RELEASE);
+		wfe_mutex_eventcount_notify_one(&ec);
+	}
+
+	consumer.join();
+	REQUIRE(consumed == ItemCount);
+	REQUIRE(ec.waiters == 0);
+}
+
+TEST_CASE("Basic Test - wfe_mutex_wait_for_change") {
+	wfe_mutex_init();
+
+	uint8_t value_i8 = 1;
+	uint16_t value_i16 = 1;
+	uint32_t value_i32 = 1;
+	uint64_t value_i64 = 1;
+
+	// Already different.
+	REQUIRE(wfe_mutex_wait_for_change_i8(&value_i8, 0, false) == 1);
+	REQUIRE(wfe_mutex_wait_for_change_i16(&value_i16, 0, false) == 1);
+	REQUIRE(wfe_mutex_wait_for_change_i32(&value_i32, 0, false) == 1);
+	REQUIRE(wfe_mutex_wait_for_change_i64(&value_i64, 0, false) == 1);
+
+	std::thread writer([&]() {
+		__atomic_store_n(&value_i8, 2, __ATOMIC_RELEASE);
+		__atomic_store_n(&value_i16, 2, __ATOMIC_RELEASE);
+		__atomic_store_n(&value_i32, 2, __ATOMIC_RELEASE);
+		__atomic_store_n(&value_i64, 2, __ATOMIC_RELEASE);
+	});
+
+	REQUIRE(wfe_mutex_wait_for_change_i8(&value_i8, 1, false) == 2);
+	REQUIRE(wfe_mutex_wait_for_change_i16(&value_i16, 1, true) == 2);
+	REQUIRE(wfe_mutex_wait_for_change_i32(&value_i32, 1, false) == 2);
+	REQUIRE(wfe_mutex_wait_for_change_i64(&value_i64, 1, true) == 2);
+	writer.join();
+}
+
+TEST_CASE("Basic Test - predicate waits") {
+	wfe_mutex_init();
+
+	// Already satisfied.
+	uint32_t value = 0xF0;
+	REQUIRE(wfe_mutex_wait_for_masked_value_i32(&value, 0x30, 0x30, false) == 0xF0);
+	REQUIRE(wfe_mutex_wait_for_any_bit_set_i32(&value, 0x11, false) == 0xF0);
+	REQUIRE(wfe_mutex_wait_for_sequence_ge_i32(&value, 0xF0, false) == 0xF0);
+
+	// Sequence comparisons are wraparound safe.
+	uint8_t sequence = 2;
+	REQUIRE(wfe_mutex_wait_for_sequence_ge_i8(&sequence, 250, false) == 2);
+	uint8_t observed = 0;
+	REQUIRE(wfe_mutex_wait_for_sequence_ge_timeout_i8(&sequence, 3, 1000, false, &observed) == false);
+	REQUIRE(observed == 2);
+
+	uint64_t value_i64 = 0;
+	REQUIRE(wfe_mutex_wait_for_masked_value_timeout_i64(&value_i64, 1, 1, 1000, false, nullptr) == false);
+	REQUIRE(wfe_mutex_wait_for_any_bit_set_timeout_i64(&value_i64, ~0ULL, 1000, false, nullptr) == false);
+
+	uint16_t state = 0;
+	std::thread writer([&]() {
+		__atomic_store_n(&state, 0x100, __ATOMIC_RELEASE);
+		__atomic_store_n(&state, 0x103, __ATOMIC_RELEASE);
+		__atomic_store_n(&sequence, 4, __ATOMIC_RELEASE);
+	});
+
+	REQUIRE((wfe_mutex_wait_for_any_bit_set_i16(&state, 0x100, false) & 0x100) == 0x100);
+	REQUIRE(wfe_mutex_wait_for_masked_value_i16(&state, 0xF, 0x3, true) == 0x103);
+	uint16_t state_observed = 0;
+	REQUIRE(wfe_mutex_wait_for_masked_value_timeout_i16(&state, 0xF, 0x3, 1000000000ULL, false, &state_observed) == true);
+	REQUIRE(state_observed == 0x103);
+	REQUIRE(wfe_mutex_wait_for_sequence_ge_i8(&sequence, 3, false) == 4);
+	writer.join();
+}
+
+TEST_CASE("Basic Test - timed bit waits") {
+	wfe_mutex_init();
+
+	// Already satisfied.
+	uint8_t value_i8 = 0x80;
+	uint8_t observed_i8 = 0;
+	REQUIRE(wfe_mutex_wait_for_bit_set_timeout_i8(&value_i8, 7, 1000, false, &observed_i8) == true);
+	REQUIRE(observed_i8 == 0x80);
+	REQUIRE(wfe_mutex_wait_for_bit_not_set_spurious_oneshot_i8(&value_i8, 0, false, nullptr) == true);
+
+	// Times out.
+	uint64_t value_i64 = 0;
+	REQUIRE(wfe_mutex_wait_for_bit_set_timeout_i64(&value_i64, 63, 1000, false, nullptr) == false);
+	REQUIRE(wfe_mutex_wait_for_bit_not_set_timeout_i64(&value_i64, 0, 1000, false, nullptr) == true);
+
+	wfe_mutex_rwlock lock = WFE_MUTEX_RWLOCK_INITIALIZER;
+	wfe_mutex_rwlock_wrlock(&lock, false);
+	REQUIRE(wfe_mutex_rwlock_timedrdlock(&lock, 1000, false) == false);
+
+	std::thread writer([&]() {
+		wfe_mutex_rwlock_unlock(&lock);
+	});
+
+	REQUIRE(wfe_mutex_rwlock_timedrdlock(&lock, 1000000000ULL, false) == true);
+	REQUIRE(wfe_mutex_rwlock_timedrdlock(&lock, 1000, true) == true);
+	writer.join();
+	REQUIRE(__atomic_load_n(&lock.mutex, __ATOMIC_ACQUIRE) == 2);
+}
+
+TEST_CASE("Basic Test - wfe_mutex_wait_any") {
+	wfe_mutex_init();
+
+	// Work queue, shutdown flag and config epoch sharing one granule.
+	struct alignas(64) {
+		uint32_t queue_size;
+		uint8_t shutdown;
+		uint64_t epoch;
+	} shared{};
+
+	wfe_mutex_wait_desc descs[3] = {
+		{ &shared.queue_size, 0, sizeof(shared.queue_size), WFE_MUTEX_WAIT_DESC_NOT_EQUAL },
+		{ &shared.shutdown, 1, sizeof(shared.shutdown), WFE_MUTEX_WAIT_DESC_EQUAL },
+		{ &shared.epoch, 0x4, sizeof(shared.epoch), WFE_MUTEX_WAIT_DESC_ANY_BIT_SET },
+	};
+
+	// Nothing satisfied, a single oneshot returns n.
+	REQUIRE(wfe_mutex_wait_any_oneshot(descs, 3, 0, 1000, false) == 3);
+
+	std::thread writer([&]() {
+		__atomic_store_n(&shared.epoch, 0x4, __ATOMIC_RELEASE);
+	});
+	REQUIRE(wfe_mutex_wait_any(descs, 3, false) == 2);
+	writer.join();
+
+	// Words in different granules.
+	struct alignas(256) padded_word {
+		uint32_t value;
+	};
+	padded_word words[2]{};
+	wfe_mutex_wait_desc split_descs[2] = {
+		{ &words[0].value, 1, sizeof(uint32_t), WFE_MUTEX_WAIT_DESC_EQUAL },
+		{ &words[1].value, 1, sizeof(uint32_t), WFE_MUTEX_WAIT_DESC_EQUAL },
+	};
+
+	std::thread split_writer([&]() {
+		__atomic_store_n(&words[1].value, 1, __ATOMIC_RELEASE);
+	});
+	REQUIRE(wfe_mutex_wait_any(split_descs, 2, true) == 1);
+	split_writer.join();
+}
+
+TEST_CASE("Basic Test - wfe_mutex_doorbell") {
+	wfe_mutex_init();
+
+	wfe_mutex_doorbell doorbell = WFE_MUTEX_DOORBELL_INITIALIZER;
+	const uint32_t flag_count = wfe_mutex_doorbell_flag_count();
+	REQUIRE(flag_count > 0);
+	REQUIRE(flag_count <= WFE_MUTEX_DOORBELL_FLAGS);
+
+	// Already rung flags are returned and cleared.
+	wfe_mutex_doorbell_ring(&doorbell, 0);
+	wfe_mutex_doorbell_ring(&doorbell, flag_count - 1);
+	const uint64_t expected = 1ULL | (1ULL << (flag_count - 1));
+	REQUIRE(wfe_mutex_doorbell_wait(&doorbell, false) == expected);
+	for (uint32_t i = 0; i < WFE_MUTEX_DOORBELL_FLAGS; ++i) {
+		REQUIRE(doorbell.flags[i] == 0);
+	}
+
+	// Every producer rings its own flag.
+	std::vector<std::thread> producers;
+	for (uint32_t i = 0; i < flag_count; ++i) {
+		producers.emplace_back([&doorbell, i]() {
+			wfe_mutex_doorbell_ring(&doorbell, i);
+		});
+	}
+
+	const uint64_t all = flag_count == 64 ? ~0ULL : (1ULL << flag_count) - 1;
+	uint64_t seen = 0;
+	while (seen != all) {
+		seen |= wfe_mutex_doorbell_wait(&doorbell, true);
+	}
+
+	for (auto &producer : producers) {
+		producer.join();
+	}
+	REQUIRE(seen == all);
+
+	// A producer re-ringing while the consumer drains must not have its ring cleared unseen.
+	constexpr uint32_t RingCount = 10000;
+	uint32_t published = 0;
+	std::thread producer([&doorbell, &published]() {
+		for (uint32_t i = 1; i <= RingCount; ++i) {
+			__atomic_store_n(&published, i, __ATOMIC_RELAXED);
+			wfe_mutex_doorbell_ring(&doorbell, 0);
+		}
+	});
+
+	uint32_t consumed = 0;
+	while (consumed != RingCount) {
+		REQUIRE(wfe_mutex_doorbell_wait(&doorbell, false) == 1);
+		consumed = __atomic_load_n(&published, __ATOMIC_RELAXED);
+	}
+	producer.join();
+}
+
+TEST_CASE("Basic Test - cancel token") {
+	wfe_mutex_init();
+
+	// Token in the same granule as the waited on word.
+	struct alignas(64) {
+		uint32_t value;
+		wfe_mutex_cancel_token token;
+	} shared = { 0, WFE_MUTEX_CANCEL_TOKEN_INITIALIZER };
+
+	REQUIRE(wfe_mutex_wait_for_value_cancellable_i32(&shared.value, 0, &shared.token, false) == true);
+
+	std::thread canceller([&]() {
+		wfe_mutex_cancel_token_cancel(&shared.token);
+	});
+	REQUIRE(wfe_mutex_wait_for_value_cancellable_i32(&shared.value, 1, &shared.token, false) == false);
+	canceller.join();
+	REQUIRE(wfe_mutex_cancel_token_is_cancelled(&shared.token));
+
+	// A cancelled token fails every lock attempt that would block.
+	wfe_mutex_lock lock = WFE_MUTEX_LOCK_INITIALIZER;
+	wfe_mutex_lock_lock(&lock, false);
+	REQUIRE(wfe_mutex_lock_lock_cancellable(&lock, &shared.token, false) == false);
+	wfe_mutex_lock_unlock(&lock);
+
+	wfe_mutex_rwlock rwlock = WFE_MUTEX_RWLOCK_INITIALIZER;
+	wfe_mutex_rwlock_wrlock(&rwlock, false);
+	REQUIRE(wfe_mutex_rwlock_rdlock_cancellable(&rwlock, &shared.token, false) == false);
+	REQUIRE(wfe_mutex_rwlock_wrlock_cancellable(&rwlock, &shared.token, false) == false);
+	wfe_mutex_rwlock_unlock(&rwlock);
+
+	// Token in a different granule, cancelling a blocked lock attempt.
+	wfe_mutex_cancel_token token = WFE_MUTEX_CANCEL_TOKEN_INITIALIZER;
+	wfe_mutex_lock_lock(&lock, false);
+	std::thread lock_canceller([&]() {
+		wfe_mutex_cancel_token_cancel(&token);
+	});
+	REQUIRE(wfe_mutex_lock_lock_cancellable(&lock, &token, true) == false);
+	lock_canceller.join();
+	wfe_mutex_lock_unlock(&lock);
+
+	// Once reset, the lock can be acquired again.
+	wfe_mutex_cancel_token_reset(&token);
+	REQUIRE(wfe_mutex_lock_lock_cancellable(&lock, &token, false) == true);
+	wfe_mutex_lock_unlock(&lock);
+
+	wfe_mutex_rwlock_wrlock(&rwlock, false);
+	std::thread unlocker([&]() {
+		wfe_mutex_rwlock_unlock(&rwlock);
+	});
+	REQUIRE(wfe_mutex_rwlock_rdlock_cancellable(&rwlock, &token, false) == true);
+	unlocker.join();
+	wfe_mutex_rwlock_read_unlock(&rwlock);
+}
+
+TEST_CASE("Basic Test - deadline waits") {
+	wfe_mutex_init();
+
+	// Deadlines in the past time out immediately.
+	uint32_t value = 0;
+	const uint64_t past = wfe_mutex_read_cycle_counter();
+	REQUIRE(wfe_mutex_wait_for_value_until_i32(&value, 1, past, false) == false);
+	REQUIRE(wfe_mutex_wait_for_value_until_i32(&value, 0, past, false) == true);
+	uint32_t observed = 1;
+	REQUIRE(wfe_mutex_wait_for_bit_set_until_i32(&value, 3, past, false, &observed) == false);
+	REQUIRE(observed == 0);
+	const uint64_t monotonic_deadline = wfe_mutex_deadline_from_clock_monotonic(0);
+	REQUIRE(monotonic_deadline <= wfe_mutex_read_cycle_counter());
+
+	// Every retry shares one deadline.
+	wfe_mutex_lock lock = WFE_MUTEX_LOCK_INITIALIZER;
+	wfe_mutex_lock_lock(&lock, false);
+	const uint64_t deadline = wfe_mutex_deadline_from_nanoseconds(100000);
+	REQUIRE(wfe_mutex_lock_timedlock_until(&lock, deadline, false) == false);
+	REQUIRE(wfe_mutex_read_cycle_counter() >= deadline);
+
+	wfe_mutex_rwlock rwlock = WFE_MUTEX_RWLOCK_INITIALIZER;
+	wfe_mutex_rwlock_wrlock(&rwlock, false);
+	REQUIRE(wfe_mutex_rwlock_timedrdlock_until(&rwlock, wfe_mutex_deadline_from_nanoseconds(1000), false) == false);
+	REQUIRE(wfe_mutex_rwlock_timedwrlock_until(&rwlock, wfe_mutex_deadline_from_nanoseconds(1000), false) == false);
+	wfe_mutex_rwlock_unlock(&rwlock);
+
+	std::thread unlocker([&]() {
+		wfe_mutex_lock_unlock(&lock);
+	});
+	REQUIRE(wfe_mutex_lock_timedlock_until(&lock, wfe_mutex_deadline_from_nanoseconds(1000000000ULL), true) == true);
+	unlocker.join();
+	wfe_mutex_lock_unlock(&lock);
+}
+
+TEST_CASE("Basic Test - contended timed locks") {
+	wfe_mutex_init();
+
+	// Threads losing the CAS race keep retrying within their timeout and all eventually succeed.
+	constexpr uint64_t ThreadCount = 3;
+	constexpr uint64_t IncrementsPerThread = 1000;
+	const uint64_t MAX_NANOSECONDS = 10000000000ULL;
+	wfe_mutex_lock lock = WFE_MUTEX_LOCK_INITIALIZER;
+	wfe_mutex_rwlock rwlock = WFE_MUTEX_RWLOCK_INITIALIZER;
+	uint64_t counter = 0;
+	uint64_t rw_counter = 0;
+	uint32_t failures = 0;
+
+	std::vector<std::thread> threads;
+	for (uint64_t i = 0; i < ThreadCount; ++i) {
+		threads.emplace_back([&]() {
+			for (uint64_t j = 0; j < IncrementsPerThread; ++j) {
+				if (wfe_mutex_lock_timedlock(&lock, MAX_NANOSECONDS, false)) {
+					++counter;
+					wfe_mutex_lock_unlock(&lock);
+				}
+				else {
+					__atomic_fetch_add(&failures, 1, __ATOMIC_RELAXED);
+				}
+
+				if (wfe_mutex_rwlock_timedwrlock(&rwlock, MAX_NANOSECONDS, false)) {
+					++rw_counter;
+					wfe_mutex_rwlock_unlock(&rwlock);
+				}
+				else {
+					__atomic_fetch_add(&failures, 1, __ATOMIC_RELAXED);
+				}
+
+				if (wfe_mutex_rwlock_timedrdlock(&rwlock, MAX_NANOSECONDS, false)) {
+					wfe_mutex_rwlock_read_unlock(&rwlock);
+				}
+				else {
+					__atomic_fetch_add(&failures, 1, __ATOMIC_RELAXED);
+				}
+			}
+		});
+	}
+
+	for (auto &t : threads) {
+		t.join();
+	}
+
+	REQUIRE(failures == 0);
+	REQUIRE(counter == ThreadCount * IncrementsPerThread);
+	REQUIRE(rw_counter == ThreadCount * IncrementsPerThread);
+	REQUIRE(lock.mutex == 0);
+	REQUIRE(rwlock.mutex == 0);
+}
+
+TEST_CASE("Basic Test - sleep") {
+	wfe_mutex_init();
+
+	// Sleeps never return before the deadline.
+	for (bool low_power : { false, true }) {
+		const uint64_t deadline = wfe_mutex_deadline_from_nanoseconds(10000);
+		wfe_mutex_sleep_until(deadline, low_power);
+		REQUIRE(wfe_mutex_read_cycle_counter() >= deadline);
+
+		const uint64_t cycles = wfe_mutex_calculate_cycles_for_nanoseconds(1000);
+		const uint64_t begin = wfe_mutex_read_cycle_counter();
+		wfe_mutex_sleep_cycles(cycles, low_power);
+		REQUIRE(wfe_mutex_read_cycle_counter() - begin >= cycles);
+
+		wfe_mutex_sleep_nanoseconds(100, low_power);
+	}
+
+	// Deadlines in the past return immediately.
+	wfe_mutex_sleep_until(0, false);
+}
+
+TEST_CASE("Basic Test - hinted waits") {
+	wfe_mutex_init();
+
+	const wfe_mutex_features *features = wfe_mutex_get_features();
+	for (int hint = WFE_MUTEX_HINT_SHORT; hint < WFE_MUTEX_HINT_COUNT; ++hint) {
+		REQUIRE(features->hint_strategy[hint] <= WAIT_STRATEGY_FUTEX);
+	}
+
+#if defined(__linux__)
+	REQUIRE(features->supports_futex);
+	REQUIRE(features->hint_strategy[WFE_MUTEX_HINT_LONG] == WAIT_STRATEGY_FUTEX);
+#endif
+
+	for (int hint = WFE_MUTEX_HINT_SHORT; hint < WFE_MUTEX_HINT_COUNT; ++hint) {
+		uint32_t value = 0;
+		wfe_mutex_wait_for_value_hinted_i32(&value, 0, (wfe_mutex_wait_hint)hint);
+
+		std::thread waker([&]() {
+			__atomic_store_n(&value, 1, __ATOMIC_RELEASE);
+			wfe_mutex_wake_i32(&value, true);
+		});
+		wfe_mutex_wait_for_value_hinted_i32(&value, 1, (wfe_mutex_wait_hint)hint);
+		waker.join();
+
+		// Other widths never sleep in a futex, so they don't need a wake.
+		uint8_t value_8 = 0;
+		uint16_t value_16 = 0;
+		uint64_t value_64 = 0;
+		std::thread setter([&]() {
+			__atomic_store_n(&value_8, 1, __ATOMIC_RELEASE);
+			__atomic_store_n(&value_16, 1, __ATOMIC_RELEASE);
+			__atomic_store_n(&value_64, 1, __ATOMIC_RELEASE);
+		});
+		wfe_mutex_wait_for_value_hinted_i8(&value_8, 1, (wfe_mutex_wait_hint)hint);
+		wfe_mutex_wait_for_value_hinted_i16(&value_16, 1, (wfe_mutex_wait_hint)hint);
+		wfe_mutex_wait_for_value_hinted_i64(&value_64, 1, (wfe_mutex_wait_hint)hint);
+		setter.join();
+	}
+
+	// Long waiters that are never woken still observe the store.
+	uint32_t value = 0;
+	std::thread setter([&]() {
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		__atomic_store_n(&value, 1, __ATOMIC_RELEASE);
+	});
+	wfe_mutex_wait_for_value_hinted_i32(&value, 1, WFE_MUTEX_HINT_LONG);
+	setter.join();
+}
+
+#if defined(WFE_MUTEX_IFUNC)
+// Runs as a static constructor without calling `wfe_mutex_init`.
+static const bool static_constructor_initialized = []() {
+	wfe_mutex_lock lock = WFE_MUTEX_LOCK_INITIALIZER;
+	wfe_mutex_lock_lock(&lock, false);
+	wfe_mutex_lock_unlock(&lock);
+	return wfe_mutex_get_features()->cycle_hz != 0;
+}();
+
+TEST_CASE("Basic Test - ifunc automatic init") {
+	REQUIRE(static_constructor_initialized);
+
+	uint32_t value = 0;
+	REQUIRE(get_wfe_mutex_wait_for_value_i32_ptr() == &wfe_mutex_ifunc_wait_for_value_i32);
+	wfe_mutex_wait_for_value_i32(&value, 0, false);
+	REQUIRE(wfe_mutex_wait_for_value_timeout_i32(&value, 1, 1000, false) == false);
+}
+#endif
+
+#if defined(_M_X86_64) || defined(_M_X86_32)
+TEST_CASE("Basic Test - cycle counter frequency") {
+	wfe_mutex_init();
+	const uint64_t cycle_hz = wfe_mutex_get_features()->cycle_hz;
+	REQUIRE(cycle_hz != 0);
+
+	// Later inits reuse the cached frequency.
+	wfe_mutex_init();
+	REQUIRE(wfe_mutex_get_features()->cycle_hz == cycle_hz);
+
+	// Within 2% of the cycle counter measured against the steady clock.
+	const auto start = std::chrono::steady_clock::now();
+	const uint64_t cycles_start = wfe_mutex_read_cycle_counter();
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	const uint64_t cycles_end = wfe_mutex_read_cycle_counter();
+	const auto end = std::chrono::steady_clock::now();
+
+	const double seconds = std::chrono::duration<double>(end - start).count();
+	const double measured_hz = (double)(cycles_end - cycles_start) / seconds;
+	REQUIRE(measured_hz > (double)cycle_hz * 0.98);
+	REQUIRE(measured_hz < (double)cycle_hz * 1.02);
+}
+#endif
+
+TEST_CASE("Basic Test - nanosecond conversion") {
+	// Every cycle counter frequency from the README.
+	const uint64_t Frequencies[] = {
+		19200000ULL,
+		24000000ULL,
+		31250000ULL,
+		1000000000ULL,
+		2500000000ULL,
+		2700000000ULL,
+	};
+
+	const uint64_t Nanoseconds[] = {
+		0,
+		1,
+		999,
+		1000,
+		123456789ULL,
+		1000000000ULL,
+		3600ULL * 1000000000ULL,
+	};
+
+	const uint64_t NanosecondsInSecond = 1000000000ULL;
+	for (uint64_t hz : Frequencies) {
+		uint64_t to_cycles_mult, to_nanoseconds_mult;
+		uint32_t to_cycles_shift, to_nanoseconds_shift;
+		wfe_mutex_calculate_mult_shift(NanosecondsInSecond, hz, &to_cycles_mult, &to_cycles_shift);
+		wfe_mutex_calculate_mult_shift(hz, NanosecondsInSecond, &to_nanoseconds_mult, &to_nanoseconds_shift);
+
+		for (uint64_t nanoseconds : Nanoseconds) {
+			const uint64_t cycles = wfe_mutex_mul_shift_u64(nanoseconds, to_cycles_mult, to_cycles_shift);
+#if defined(__SIZEOF_INT128__)
+			// Within one cycle of the exact result, even an hour out.
+			const uint64_t expected_cycles = (uint64_t)((unsigned __int128)nanoseconds * hz / NanosecondsInSecond);
+			REQUIRE(cycles + 1 >= expected_cycles);
+			REQUIRE(cycles <= expected_cycles + 1);
+#endif
+
+			// Converting back loses at most the nanoseconds of one cycle.
+			const uint64_t nanoseconds_per_cycle = NanosecondsInSecond / hz + 1;
+			const uint64_t round_trip = wfe_mutex_mul_shift_u64(cycles, to_nanoseconds_mult, to_nanoseconds_shift);
+			REQUIRE(round_trip + nanoseconds_per_cycle >= nanoseconds);
+			REQUIRE(round_trip <= nanoseconds + nanoseconds_per_cycle);
+		}
+
+		// Results that don't fit saturate instead of wrapping.
+		if (hz > NanosecondsInSecond) {
+			REQUIRE(wfe_mutex_mul_shift_u64(~0ULL, to_cycles_mult, to_cycles_shift) == ~0ULL);
+		}
+	}
+
+	wfe_mutex_init();
+	const uint64_t cycle_hz = wfe_mutex_get_features()->cycle_hz;
+	REQUIRE(wfe_mutex_calculate_cycles_for_nanoseconds(NanosecondsInSecond) + 1 >= cycle_hz);
+	REQUIRE(wfe_mutex_calculate_cycles_for_nanoseconds(NanosecondsInSecond) <= cycle_hz + 1);
+	REQUIRE(wfe_mutex_calculate_nanoseconds_for_cycles(cycle_hz) + 1 >= NanosecondsInSecond);
+	REQUIRE(wfe_mutex_calculate_nanoseconds_for_cycles(cycle_hz) <= NanosecondsInSecond + 1);
+}
+
+TEST_CASE("Basic Test - timeout granularity") {
+	wfe_mutex_init();
+	const wfe_mutex_features *features = wfe_mutex_get_features();
+
+	// Spinning before the deadline is bounded.
+	const uint64_t max_spin = wfe_mutex_calculate_cycles_for_nanoseconds(200000);
+	REQUIRE(features->timeout_granularity_cycles <= max_spin);
+	REQUIRE(features->timeout_granularity_low_power_cycles <= max_spin);
+	if (features->wait_type == WAIT_TYPE_SPIN) {
+		REQUIRE(features->timeout_granularity_cycles == 0);
+	}
+
+	// Every backend's table reports its own granularity, not the active backend's.
+	REQUIRE(features->backend_timeout_granularity_cycles[WFE_MUTEX_BACKEND_SPIN] == 0);
+	for (uint32_t backend = WFE_MUTEX_BACKEND_SPIN; backend < WFE_MUTEX_BACKEND_COUNT; ++backend) {
+		const wfe_mutex_backend *table = wfe_mutex_get_backend(backend);
+		if (!table) continue;
+		REQUIRE(features->backend_timeout_granularity_cycles[backend] <= max_spin);
+		REQUIRE(features->backend_timeout_granularity_low_power_cycles[backend] <= max_spin);
+		REQUIRE(table->timeout_granularity_cycles == features->backend_timeout_granularity_cycles[backend]);
+		REQUIRE(table->timeout_granularity_low_power_cycles == features->backend_timeout_granularity_low_power_cycles[backend]);
+	}
+
+	// Handing the tail to the spin never returns before the deadline.
+	uint32_t value = 0;
+	for (uint64_t nanoseconds : {0ULL, 1000ULL, 50000ULL}) {
+		for (bool low_power : {false, true}) {
+			const uint64_t deadline = wfe_mutex_deadline_from_nanoseconds(nanoseconds);
+			REQUIRE(wfe_mutex_wait_for_value_until_i32(&value, 1, deadline, low_power) == false);
+			REQUIRE(wfe_mutex_read_cycle_counter() >= deadline);
+
+			const uint64_t bit_deadline = wfe_mutex_deadline_from_nanoseconds(nanoseconds);
+			REQUIRE(wfe_mutex_wait_for_bit_set_until_i32(&value, 0, bit_deadline, low_power, nullptr) == false);
+			REQUIRE(wfe_mutex_read_cycle_counter() >= bit_deadline);
+
+			const uint64_t sleep_deadline = wfe_mutex_deadline_from_nanoseconds(nanoseconds);
+			wfe_mutex_sleep_until(sleep_deadline, low_power);
+			REQUIRE(wfe_mutex_read_cycle_counter() >= sleep_deadline);
+		}
+	}
+}
+
+TEST_CASE("Basic Test - event stream period") {
+	wfe_mutex_init();
+	const wfe_mutex_features *features = wfe_mutex_get_features();
+
+#if defined(_M_ARM_64) || defined(_M_ARM_32)
+	if (features->event_stream_period_cycles) {
+		// Linux runs the event stream at 10Khz, allow anything from 1Mhz to 100hz.
+		REQUIRE(features->event_stream_period_cycles >= wfe_mutex_calculate_cycles_for_nanoseconds(1000));
+		REQUIRE(features->event_stream_period_cycles <= wfe_mutex_calculate_cycles_for_nanoseconds(10000000));
+	}
+#else
+	REQUIRE(features->event_stream_period_cycles == 0);
+#endif
+
+	// Sleeps shorter than a period still reach their deadline.
+	const uint64_t deadline = wfe_mutex_read_cycle_counter() + features->event_stream_period_cycles / 2 + 1;
+	wfe_mutex_sleep_until(deadline, false);
+	REQUIRE(wfe_mutex_read_cycle_counter() >= deadline);
+}
+
+TEST_CASE("Basic Test - umwait control") {
+	wfe_mutex_init();
+	const wfe_mutex_features *features = wfe_mutex_get_features();
+
+	if (!(features->available_backends & WFE_MUTEX_BACKEND_BIT(WFE_MUTEX_BACKEND_WAITPKG))) {
+		REQUIRE(features->umwait_max_time_cycles == 0);
+		REQUIRE(features->umwait_c02_enabled == false);
+		return;
+	}
+
+	if (features->backend == WFE_MUTEX_BACKEND_WAITPKG) {
+		REQUIRE(features->supports_low_power_cstate_toggle == features->umwait_c02_enabled);
+	}
+
+	// Waits longer than the OS limit still reach their deadline.
+	uint32_t value = 0;
+	const uint64_t deadline = wfe_mutex_read_cycle_counter() + features->umwait_max_time_cycles * 3ULL + 1;
+	REQUIRE(wfe_mutex_wait_for_value_until_i32(&value, 1, deadline, true) == false);
+	REQUIRE(wfe_mutex_read_cycle_counter() >= deadline);
+}
+
+TEST_CASE("Basic Test - tuned init") {
+	wfe_mutex_init_tuned();
+
+	const wfe_mutex_features *features = wfe_mutex_get_features();
+	REQUIRE(features->available_backends & WFE_MUTEX_BACKEND_BIT(WFE_MUTEX_BACKEND_SPIN));
+	REQUIRE(features->available_backends & WFE_MUTEX_BACKEND_BIT(features->tuned_backend));
+	REQUIRE(features->tuned_spurious_wakeups_per_second[WFE_MUTEX_BACKEND_SPIN] != 0);
+
+	for (uint32_t backend = 0; backend < WFE_MUTEX_BACKEND_COUNT; ++backend) {
+		if (!(features->available_backends & WFE_MUTEX_BACKEND_BIT(backend))) {
+			REQUIRE(features->tuned_wake_latency_cycles[backend] == 0);
+			REQUIRE(features->tuned_spurious_wakeups_per_second[backend] == 0);
+		}
+	}
+
+	// The tuned backend still works.
+	uint32_t value = 0;
+	std::thread setter([&]() {
+		__atomic_store_n(&value, 1, __ATOMIC_RELEASE);
+	});
+	wfe_mutex_wait_for_value_i32(&value, 1, false);
+	setter.join();
+
+	wfe_mutex_init();
+}
+
+TEST_CASE("Basic Test - backend selection") {
+	wfe_mutex_init();
+
+	const wfe_mutex_features *features = wfe_mutex_get_features();
+	const uint32_t detected = features->backend;
+	REQUIRE(features->available_backends & WFE_MUTEX_BACKEND_BIT(detected));
+
+	for (uint32_t backend = 0; backend < WFE_MUTEX_BACKEND_COUNT; ++backend) {
+		const wfe_mutex_backend *table = wfe_mutex_get_backend(backend);
+		if (!(features->available_backends & WFE_MUTEX_BACKEND_BIT(backend))) {
+			REQUIRE(table == nullptr);
+			REQUIRE(!wfe_mutex_set_backend(backend));
+			continue;
+		}
+
+		REQUIRE(table != nullptr);
+		REQUIRE(table->backend == backend);
+
+#if !defined(WFE_MUTEX_STATIC_BACKEND) && !defined(WFE_MUTEX_IFUNC)
+		REQUIRE(wfe_mutex_set_backend(backend));
+		REQUIRE(features->backend == backend);
+#endif
+
+		// Locks pinned to the backend interoperate with the active backend.
+		wfe_mutex_lock lock = WFE_MUTEX_LOCK_INITIALIZER;
+		wfe_mutex_rwlock rwlock = WFE_MUTEX_RWLOCK_INITIALIZER;
+		wfe_mutex_lock_lock(&lock, false);
+		wfe_mutex_rwlock_wrlock(&rwlock, false);
+		std::thread unlocker([&]() {
+			wfe_mutex_lock_unlock(&lock);
+			wfe_mutex_rwlock_unlock(&rwlock);
+		});
+		wfe_mutex_lock_lock_backend(&lock, table, false);
+		wfe_mutex_rwlock_rdlock_backend(&rwlock, table, false);
+		unlocker.join();
+		wfe_mutex_rwlock_read_unlock(&rwlock);
+		wfe_mutex_rwlock_wrlock_backend(&rwlock, table, false);
+		wfe_mutex_rwlock_unlock(&rwlock);
+		wfe_mutex_lock_unlock(&lock);
+	}
+
+#if !defined(WFE_MUTEX_STATIC_BACKEND) && !defined(WFE_MUTEX_IFUNC)
+	setenv("WFE_MUTEX_BACKEND", "spin", 1);
+	wfe_mutex_init();
+	REQUIRE(features->backend == WFE_MUTEX_BACKEND_SPIN);
+	unsetenv("WFE_MUTEX_BACKEND");
+#endif
+
+	wfe_mutex_init();
+	REQUIRE(features->backend == detected);
+}
+
+TEST_CASE("Basic Test - hypervisor detection") {
+	wfe_mutex_init();
+
+	const wfe_mutex_features *features = wfe_mutex_get_features();
+	REQUIRE(strnlen(features->hypervisor_vendor, sizeof(features->hypervisor_vendor)) < sizeof(features->hypervisor_vendor));
+	if (!features->running_under_hypervisor) {
+		REQUIRE(features->hypervisor_vendor[0] == 0);
+		REQUIRE(!features->hypervisor_monitor_fallback);
+	}
+
+	if (features->hypervisor_monitor_fallback) {
+#if !defined(WFE_MUTEX_STATIC_BACKEND) && !defined(WFE_MUTEX_IFUNC)
+		REQUIRE(features->backend == WFE_MUTEX_BACKEND_SPIN);
+#endif
+		if (features->supports_futex) {
+			REQUIRE(features->hint_strategy[WFE_MUTEX_HINT_MEDIUM] == WAIT_STRATEGY_FUTEX);
+			REQUIRE(features->hint_strategy[WFE_MUTEX_HINT_LONG] == WAIT_STRATEGY_FUTEX);
+		}
+	}
+}
+
+TEST_CASE("Basic Test - 128-bit waits") {
+	wfe_mutex_init();
+
+	wfe_mutex_u128 value = { 1, 2 };
+	wfe_mutex_u128 expected = { 1, 2 };
+	wfe_mutex_wait_for_value_i128(&value, expected, false);
+
+	// Tagged pointer style, wait for the tag in the high half only.
+	wfe_mutex_u128 mask = { 0, ~0ULL };
+	wfe_mutex_u128 tag = { 0, 3 };
+
+	std::thread writer([&]() {
+		wfe_mutex_u128 desired = { 0x1234, 3 };
+		__atomic_store_n(&value.low, desired.low, __ATOMIC_RELAXED);
+		__atomic_store_n(&value.high, desired.high, __ATOMIC_RELEASE);
+	});
+
+	wfe_mutex_u128 result = wfe_mutex_wait_for_masked_value_i128(&value, mask, tag, false);
+	REQUIRE(result.high == 3);
+	writer.join();
+
+	wfe_mutex_u128 final_value = { 0x1234, 3 };
+	wfe_mutex_wait_for_value_i128(&value, final_value, true);
+	REQUIRE(value.low == 0x1234);
+
+	// Without a write to confirm the pair, read-only mappings can be waited on.
+	if (wfe_mutex_get_features()->supports_atomic_load_u128) {
+		const size_t page_size = sysconf(_SC_PAGESIZE);
+		void *page = mmap(nullptr, page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		REQUIRE(page != MAP_FAILED);
+		wfe_mutex_u128 *read_only = reinterpret_cast<wfe_mutex_u128*>(page);
+		*read_only = final_value;
+		REQUIRE(mprotect(page, page_size, PROT_READ) == 0);
+		result = wfe_mutex_wait_for_masked_value_i128(read_only, mask, tag, false);
+		REQUIRE(result.low == 0x1234);
+		munmap(page, page_size);
+	}
+}
+
 template<typename F>
 int CheckIfExitsWithSignal(F&& func) {
 	if (fork() == 0) {